@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <aqbanking/banking.h>
+
+#include "ab-test-util.h"
+
+
+#define TEST_COUNT 3
+
+static const char *testDates[TEST_COUNT] = {"20261016", "20261017", "20261019"};
+static const char *testValues[TEST_COUNT] = {"12.5:EUR", "-100:EUR", "0.99:EUR"};
+static const char *testNames[TEST_COUNT] = {"Alice", "Bob", "Carol"};
+static const char *testPurposes[TEST_COUNT] = {"Invoice 1", "Rent", "Coffee"};
+
+
+static GWEN_DB_NODE *mkProfile(int nativeReader)
+{
+  GWEN_DB_NODE *db;
+
+  db = GWEN_DB_Group_new("profile");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "name", "csv-test");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_DEFAULT, "groupNames", "transaction");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_DEFAULT, "groupNames", "line");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "dateFormat", "YYYY/MM/DD");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "valueFormat", "float");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "transactionType", "statement");
+  GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "nativeReader", nativeReader);
+  GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/quote", 1);
+  GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/title", 1);
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/delimiter", ";");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/columns/1", "date");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/columns/2", "value/value");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/columns/3", "value/currency");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/columns/4", "remoteName");
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "params/columns/5", "purpose[0]");
+  return db;
+}
+
+
+static int checkTransaction(const char *testName, const AB_TRANSACTION *t, int i)
+{
+  const GWEN_DATE *dt;
+  const AB_VALUE *v;
+  AB_VALUE *vExpected;
+  const char *s;
+  int result = 0;
+
+  dt = AB_Transaction_GetDate(t);
+  if (dt == NULL || strcmp(GWEN_Date_GetString(dt), testDates[i]) != 0) {
+    fprintf(stderr, "%s: transaction %d: unexpected date\n", testName, i);
+    result = -1;
+  }
+  v = AB_Transaction_GetValue(t);
+  vExpected = AB_Value_fromString(testValues[i]);
+  if (v == NULL || AB_Value_Compare(v, vExpected) != 0 ||
+      AB_Value_GetCurrency(v) == NULL || strcmp(AB_Value_GetCurrency(v), "EUR") != 0) {
+    fprintf(stderr, "%s: transaction %d: unexpected value\n", testName, i);
+    result = -1;
+  }
+  AB_Value_free(vExpected);
+  s = AB_Transaction_GetRemoteName(t);
+  if (s == NULL || strcmp(s, testNames[i]) != 0) {
+    fprintf(stderr, "%s: transaction %d: unexpected remote name [%s]\n", testName, i, s ? s : "<null>");
+    result = -1;
+  }
+  s = AB_Transaction_GetPurpose(t);
+  if (s == NULL || strcmp(s, testPurposes[i]) != 0) {
+    fprintf(stderr, "%s: transaction %d: unexpected purpose [%s]\n", testName, i, s ? s : "<null>");
+    result = -1;
+  }
+  if (AB_Transaction_GetType(t) != AB_Transaction_TypeStatement) {
+    fprintf(stderr, "%s: transaction %d: unexpected type %d\n", testName, i, AB_Transaction_GetType(t));
+    result = -1;
+  }
+  return result;
+}
+
+
+/* export the given context, import it again and compare the transactions with the test data */
+static int roundTrip(AB_BANKING *ab, const char *testName, AB_IMEXPORTER_CONTEXT *ctx, int nativeReader)
+{
+  AB_IMEXPORTER_CONTEXT *ctx2;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  GWEN_DB_NODE *dbProfile;
+  GWEN_BUFFER *buf;
+  int count = 0;
+  int rv, result = 0;
+
+  dbProfile = mkProfile(nativeReader);
+  buf = GWEN_Buffer_new(NULL, 1024, 0, 1);
+  ctx2 = AB_ImExporterContext_new();
+  rv = AB_Banking_ExportToBuffer(ab, "csv", ctx, buf, dbProfile);
+  if (rv < 0) {
+    fprintf(stderr, "%s: error exporting (%d)\n", testName, rv);
+    result = -1;
+  }
+  else {
+    rv = AB_Banking_ImportFromBuffer(ab, "csv", ctx2, (const uint8_t *) GWEN_Buffer_GetStart(buf),
+                                     GWEN_Buffer_GetUsedBytes(buf), dbProfile);
+    if (rv < 0) {
+      fprintf(stderr, "%s: error importing (%d)\n%s\n", testName, rv, GWEN_Buffer_GetStart(buf));
+      result = -1;
+    }
+  }
+
+  ai = AB_ImExporterContext_GetFirstAccountInfo(ctx2);
+  while (ai) {
+    const AB_TRANSACTION_LIST *tl;
+    const AB_TRANSACTION *t;
+
+    tl = AB_ImExporterAccountInfo_GetTransactionList(ai);
+    t = tl ? AB_Transaction_List_First(tl) : NULL;
+    while (t) {
+      if (count < TEST_COUNT && checkTransaction(testName, t, count))
+        result = -1;
+      count++;
+      t = AB_Transaction_List_Next(t);
+    }
+    ai = AB_ImExporterAccountInfo_List_Next(ai);
+  }
+  if (result == 0 && count != TEST_COUNT) {
+    fprintf(stderr, "%s: %d transactions imported, expected %d\n%s\n", testName, count, TEST_COUNT,
+            GWEN_Buffer_GetStart(buf));
+    result = -1;
+  }
+
+  AB_ImExporterContext_free(ctx2);
+  GWEN_Buffer_free(buf);
+  GWEN_DB_Group_free(dbProfile);
+  return abTestReport(testName, result);
+}
+
+
+int main(int argc, char *argv[])
+{
+  AB_BANKING *ab;
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  int i;
+  int result = 0;
+
+  ab = abTestSetup("ab-csv-test");
+  if (ab == NULL)
+    return 2;
+
+  ctx = AB_ImExporterContext_new();
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  for (i = 0; i < TEST_COUNT; i++) {
+    AB_TRANSACTION *t;
+
+    t = abTestTransaction(testDates[i], testValues[i]);
+    AB_Transaction_SetRemoteName(t, testNames[i]);
+    AB_Transaction_SetPurpose(t, testPurposes[i]);
+    AB_ImExporterAccountInfo_AddTransaction(ai, t);
+  }
+
+  /* both the line reader of the importer and the GWEN_DBIO plugin must give the same result */
+  if (roundTrip(ab, "csv (native reader)", ctx, 1))
+    result = -1;
+  if (roundTrip(ab, "csv (dbio)", ctx, 0))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  abTestTeardown(ab);
+  return result;
+}
@@ -0,0 +1,135 @@
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <aqbanking/banking.h>
+#include <aqbanking/types/imexporter_context_bin.h>
+
+#include "ab-test-util.h"
+
+
+static AB_TRANSACTION *mkTransaction(const char *iban, const char *remoteName, const char *value, const char *purpose)
+{
+  AB_TRANSACTION *t;
+
+  t = abTestTransaction("20261016", value);
+  AB_Transaction_SetLocalIban(t, iban);
+  AB_Transaction_SetRemoteName(t, remoteName);
+  AB_Transaction_SetPurpose(t, purpose);
+  return t;
+}
+
+
+static int contextToText(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_BUFFER *buf)
+{
+  GWEN_DB_NODE *db;
+  int rv;
+
+  db = GWEN_DB_Group_new("context");
+  rv = AB_ImExporterContext_toDb(ctx, db);
+  if (rv == 0)
+    rv = GWEN_DB_WriteToBuffer(db, buf, GWEN_DB_FLAGS_DEFAULT);
+  GWEN_DB_Group_free(db);
+  return rv;
+}
+
+
+static int compareContexts(const char *testName, const AB_IMEXPORTER_CONTEXT *ctx1, const AB_IMEXPORTER_CONTEXT *ctx2)
+{
+  GWEN_BUFFER *buf1, *buf2;
+  int result = 0;
+
+  buf1 = GWEN_Buffer_new(NULL, 1024, 0, 1);
+  buf2 = GWEN_Buffer_new(NULL, 1024, 0, 1);
+  if (contextToText(ctx1, buf1) || contextToText(ctx2, buf2)) {
+    fprintf(stderr, "%s: error converting context to text\n", testName);
+    result = -1;
+  }
+  else if (strcmp(GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2)) != 0) {
+    fprintf(stderr, "%s: contexts differ:\n%s\n---\n%s\n", testName,
+            GWEN_Buffer_GetStart(buf1), GWEN_Buffer_GetStart(buf2));
+    result = -1;
+  }
+
+  GWEN_Buffer_free(buf2);
+  GWEN_Buffer_free(buf1);
+  return abTestReport(testName, result);
+}
+
+
+int main(int argc, char *argv[])
+{
+  AB_IMEXPORTER_CONTEXT *ctx1, *ctx2, *ctxAll, *ctxRead, *ctxExpected;
+  AB_IMEXPORTER_CONTEXT_INDEX *idx;
+  GWEN_BUFFER *binBuf;
+  int result = 0;
+
+  ctx1 = AB_ImExporterContext_new();
+  AB_ImExporterContext_AddTransaction(ctx1, mkTransaction("DE89370400440532013000", "Max Mustermann", "12.34", "Rent \"March\"\nline 2"));
+  AB_ImExporterContext_AddTransaction(ctx1, mkTransaction("DE02120300000000202051", "\xc3\x9c" "ber Umlaute", "-1,361.54", "Payment"));
+
+  ctx2 = AB_ImExporterContext_new();
+  AB_ImExporterContext_AddTransaction(ctx2, mkTransaction("DE89370400440532013000", "Erika Mustermann", "99.99", "Refund"));
+
+  ctxAll = AB_ImExporterContext_new();
+  AB_ImExporterContext_AddTransaction(ctxAll, mkTransaction("DE89370400440532013000", "Max Mustermann", "12.34", "Rent \"March\"\nline 2"));
+  AB_ImExporterContext_AddTransaction(ctxAll, mkTransaction("DE02120300000000202051", "\xc3\x9c" "ber Umlaute", "-1,361.54", "Payment"));
+  AB_ImExporterContext_AddTransaction(ctxAll, mkTransaction("DE89370400440532013000", "Erika Mustermann", "99.99", "Refund"));
+
+  /* single chunk round trip */
+  binBuf = GWEN_Buffer_new(NULL, 1024, 0, 1);
+  ctxRead = AB_ImExporterContext_new();
+  if (AB_ImExporterContext_WriteBinary(ctx1, binBuf) ||
+      !AB_ImExporterContext_IsBinary((const uint8_t *) GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf)) ||
+      AB_ImExporterContext_ReadBinary(ctxRead, (const uint8_t *) GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf))) {
+    fprintf(stderr, "roundtrip: error writing or reading binary context\n");
+    result = -1;
+  }
+  else if (compareContexts("roundtrip", ctx1, ctxRead))
+    result = -1;
+  AB_ImExporterContext_free(ctxRead);
+
+  /* appended chunk is merged into the existing accounts */
+  ctxRead = AB_ImExporterContext_new();
+  if (AB_ImExporterContext_WriteBinary(ctx2, binBuf) ||
+      AB_ImExporterContext_ReadBinary(ctxRead, (const uint8_t *) GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf))) {
+    fprintf(stderr, "append: error writing or reading binary context\n");
+    result = -1;
+  }
+  else if (compareContexts("append", ctxAll, ctxRead))
+    result = -1;
+  AB_ImExporterContext_free(ctxRead);
+
+  /* indexed access only reads the matching account */
+  idx = AB_ImExporterContextIndex_fromBinary((const uint8_t *) GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf));
+  ctxRead = AB_ImExporterContext_new();
+  ctxExpected = AB_ImExporterContext_new();
+  AB_ImExporterContext_AddTransaction(ctxExpected, mkTransaction("DE02120300000000202051", "\xc3\x9c" "ber Umlaute", "-1,361.54", "Payment"));
+  if (idx == NULL ||
+      AB_ImExporterContextIndex_ReadAccountInfos(idx, ctxRead, 0, NULL, NULL, NULL, NULL, "DE02120300000000202051", NULL,
+                                                 AB_AccountType_Unknown, NULL, NULL) != 1) {
+    fprintf(stderr, "index: error reading indexed binary context\n");
+    result = -1;
+  }
+  else if (compareContexts("index", ctxExpected, ctxRead))
+    result = -1;
+  AB_ImExporterContext_free(ctxExpected);
+  AB_ImExporterContext_free(ctxRead);
+  AB_ImExporterContextIndex_free(idx);
+
+  /* truncated data must be rejected */
+  ctxRead = AB_ImExporterContext_new();
+  if (AB_ImExporterContext_ReadBinary(ctxRead, (const uint8_t *) GWEN_Buffer_GetStart(binBuf), GWEN_Buffer_GetUsedBytes(binBuf) - 1) == 0) {
+    fprintf(stderr, "truncated: truncated data accepted\n");
+    result = -1;
+  }
+  else
+    abTestReport("truncated", 0);
+  AB_ImExporterContext_free(ctxRead);
+
+  GWEN_Buffer_free(binBuf);
+  AB_ImExporterContext_free(ctxAll);
+  AB_ImExporterContext_free(ctx2);
+  AB_ImExporterContext_free(ctx1);
+
+  return result;
+}
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <aqbanking/banking.h>
+
+#include "ab-test-util.h"
+
+
+#define TEST_LOCAL_IBAN  "DE89370400440532013000"
+#define TEST_REMOTE_IBAN "DE02120300000000202051"
+#define TEST_BIC         "COBADEFFXXX"
+
+
+static AB_TRANSACTION *mkTransaction(const char *localName, const char *date, const char *value, const char *endToEndId)
+{
+  AB_TRANSACTION *t;
+
+  t = abTestTransaction(date, value);
+  if (localName)
+    AB_Transaction_SetLocalName(t, localName);
+  AB_Transaction_SetRemoteName(t, "Remote");
+  AB_Transaction_SetRemoteIban(t, TEST_REMOTE_IBAN);
+  AB_Transaction_SetRemoteBic(t, TEST_BIC);
+  AB_Transaction_SetPurpose(t, "Purpose");
+  AB_Transaction_SetEndToEndReference(t, endToEndId);
+  return t;
+}
+
+
+static AB_TRANSACTION *mkDebitNote(AB_TRANSACTION_SEQUENCE sequence, const char *creditorSchemeId, const char *value,
+                                   const char *endToEndId)
+{
+  AB_TRANSACTION *t;
+  GWEN_DATE *dt;
+
+  t = mkTransaction(NULL, "20261102", value, endToEndId);
+  AB_Transaction_SetSequence(t, sequence);
+  AB_Transaction_SetCreditorSchemeId(t, creditorSchemeId);
+  AB_Transaction_SetMandateId(t, "MANDATE-1");
+  dt = GWEN_Date_fromString("20250101");
+  AB_Transaction_SetMandateDate(t, dt);
+  GWEN_Date_free(dt);
+  return t;
+}
+
+
+/* collect the values of the given single line elements ("Name" or "Parent/Name"), "|" marks the start of a PmtInf block */
+static void summarize(const char *xml, const char **names, GWEN_BUFFER *out)
+{
+  char lastOpen[64] = "";
+
+  while (*xml) {
+    const char *eol, *nameEnd, *valueEnd;
+
+    while (*xml == ' ')
+      xml++;
+    eol = strchr(xml, '\n');
+    if (eol == NULL)
+      eol = xml + strlen(xml);
+
+    if (*xml == '<' && xml[1] != '/' && xml[1] != '?') {
+      nameEnd = xml + 1 + strcspn(xml + 1, " >");
+      valueEnd = strstr(xml, "</");
+      if (valueEnd == NULL || valueEnd > eol) {
+        /* start tag on its own line */
+        snprintf(lastOpen, sizeof(lastOpen), "%.*s", (int)(nameEnd - xml - 1), xml + 1);
+        if (strcmp(lastOpen, "PmtInf") == 0)
+          GWEN_Buffer_AppendString(out, "|");
+      }
+      else {
+        char name[64], path[128];
+        const char *value;
+        int i;
+
+        snprintf(name, sizeof(name), "%.*s", (int)(nameEnd - xml - 1), xml + 1);
+        snprintf(path, sizeof(path), "%s/%s", lastOpen, name);
+        value = strchr(xml, '>') + 1;
+        for (i = 0; names[i]; i++) {
+          if (strcmp(names[i], name) == 0 || strcmp(names[i], path) == 0) {
+            for (; value < valueEnd; value++)
+              GWEN_Buffer_AppendByte(out, (*value == ',') ? '.' : *value);
+            GWEN_Buffer_AppendString(out, ";");
+            break;
+          }
+        }
+      }
+    }
+    xml = *eol ? eol + 1 : eol;
+  }
+}
+
+
+static int exportAndCompare(AB_BANKING *ab, const char *testName, AB_IMEXPORTER_CONTEXT *ctx,
+                            const char *type, const char *xmlns, const char **names, const char *expected)
+{
+  GWEN_DB_NODE *dbProfile;
+  GWEN_BUFFER *buf, *summary;
+  int rv, result = 0;
+
+  dbProfile = GWEN_DB_Group_new("profile");
+  GWEN_DB_SetCharValue(dbProfile, GWEN_DB_FLAGS_OVERWRITE_VARS, "name", testName);
+  GWEN_DB_SetCharValue(dbProfile, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", type);
+  GWEN_DB_SetCharValue(dbProfile, GWEN_DB_FLAGS_OVERWRITE_VARS, "xmlns", xmlns);
+
+  buf = GWEN_Buffer_new(NULL, 4096, 0, 1);
+  summary = GWEN_Buffer_new(NULL, 256, 0, 1);
+  rv = AB_Banking_ExportToBuffer(ab, "sepa", ctx, buf, dbProfile);
+  if (rv < 0) {
+    fprintf(stderr, "%s: error exporting (%d)\n", testName, rv);
+    result = -1;
+  }
+  else {
+    summarize(GWEN_Buffer_GetStart(buf), names, summary);
+    if (strcmp(GWEN_Buffer_GetStart(summary), expected) != 0) {
+      fprintf(stderr, "%s: unexpected grouping:\n%s\n---\n%s\n---\n%s\n", testName,
+              GWEN_Buffer_GetStart(summary), expected, GWEN_Buffer_GetStart(buf));
+      result = -1;
+    }
+  }
+
+  GWEN_Buffer_free(summary);
+  GWEN_Buffer_free(buf);
+  GWEN_DB_Group_free(dbProfile);
+  return abTestReport(testName, result);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char *transferNames[] = {"NbOfTxs", "CtrlSum", "ReqdExctnDt", "Dbtr/Nm", "EndToEndId", NULL};
+  const char *debitNoteNames[] = {"NbOfTxs", "CtrlSum", "SeqTp", "Othr/Id", "EndToEndId", NULL};
+  AB_BANKING *ab;
+  AB_IMEXPORTER_CONTEXT *ctx;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  int result = 0;
+
+  ab = abTestSetup("ab-sepa-test");
+  if (ab == NULL)
+    return 2;
+
+  /* transfers are grouped by date and local name, blocks appear in the order of their first transaction */
+  ctx = AB_ImExporterContext_new();
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterAccountInfo_SetIban(ai, TEST_LOCAL_IBAN);
+  AB_ImExporterAccountInfo_SetBic(ai, TEST_BIC);
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Alice", "20261102", "1", "T1"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Alice", "20261103", "2", "T2"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Bob", "20261102", "3", "T3"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Alice", "20261102", "4", "T4"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Alice", "20261104", "5", "T5"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Bob", "20261102", "6", "T6"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkTransaction("Alice", "20261103", "7", "T7"));
+  if (exportAndCompare(ab, "pain.001", ctx, "001.003.03", "urn:iso:std:iso:20022:tech:xsd:pain.001.003.03",
+                       transferNames,
+                       "7;"
+                       "|2;5.00;2026-11-02;Alice;T1;T4;"
+                       "|2;9.00;2026-11-03;Alice;T2;T7;"
+                       "|2;9.00;2026-11-02;Bob;T3;T6;"
+                       "|1;5.00;2026-11-04;Alice;T5;"))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  /* debit notes are additionally grouped by sequence type and creditor scheme id */
+  ctx = AB_ImExporterContext_new();
+  ai = AB_ImExporterAccountInfo_new();
+  AB_ImExporterAccountInfo_SetIban(ai, TEST_LOCAL_IBAN);
+  AB_ImExporterAccountInfo_SetBic(ai, TEST_BIC);
+  AB_ImExporterAccountInfo_SetOwner(ai, "Creditor");
+  AB_ImExporterContext_AddAccountInfo(ctx, ai);
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkDebitNote(AB_Transaction_SequenceFirst, "DE98ZZZ09999999999", "1", "D1"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkDebitNote(AB_Transaction_SequenceFollowing, "DE98ZZZ09999999999", "2", "D2"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkDebitNote(AB_Transaction_SequenceFirst, "DE12ZZZ00000012345", "3", "D3"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkDebitNote(AB_Transaction_SequenceFirst, "DE98ZZZ09999999999", "4", "D4"));
+  AB_ImExporterAccountInfo_AddTransaction(ai, mkDebitNote(AB_Transaction_SequenceFollowing, "DE98ZZZ09999999999", "5", "D5"));
+  if (exportAndCompare(ab, "pain.008", ctx, "008.003.02", "urn:iso:std:iso:20022:tech:xsd:pain.008.003.02",
+                       debitNoteNames,
+                       "5;"
+                       "|2;5.00;FRST;DE98ZZZ09999999999;D1;D4;"
+                       "|2;7.00;RCUR;DE98ZZZ09999999999;D2;D5;"
+                       "|1;3.00;FRST;DE12ZZZ00000012345;D3;"))
+    result = -1;
+  AB_ImExporterContext_free(ctx);
+
+  abTestTeardown(ab);
+  return result;
+}
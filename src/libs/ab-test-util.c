@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <gwenhywfar/gwenhywfar.h>
+#include <gwenhywfar/cgui.h>
+#include <gwenhywfar/directory.h>
+
+#include "ab-test-util.h"
+
+
+static GWEN_GUI *testGui = NULL;
+static char testConfigDir[256];
+
+
+static void removeTree(const char *path)
+{
+  DIR *d;
+  struct dirent *de;
+  char buf[512];
+  struct stat st;
+
+  d = opendir(path);
+  if (d == NULL)
+    return;
+  while ((de = readdir(d)) != NULL) {
+    if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+      continue;
+    snprintf(buf, sizeof(buf), "%s/%s", path, de->d_name);
+    if (stat(buf, &st) == 0 && S_ISDIR(st.st_mode))
+      removeTree(buf);
+    else
+      unlink(buf);
+  }
+  closedir(d);
+  rmdir(path);
+}
+
+
+AB_BANKING *abTestSetup(const char *appName)
+{
+  AB_BANKING *ab;
+  char tmpDir[200];
+  int rv;
+
+  rv = GWEN_Init();
+  if (rv) {
+    fprintf(stderr, "ERROR: Unable to init Gwen.\n");
+    return NULL;
+  }
+  testGui = GWEN_Gui_CGui_new();
+  GWEN_Gui_SetGui(testGui);
+
+  if (GWEN_Directory_GetTmpDirectory(tmpDir, sizeof(tmpDir)))
+    strcpy(tmpDir, ".");
+  snprintf(testConfigDir, sizeof(testConfigDir), "%s/%s-%lu.d", tmpDir, appName, (unsigned long) getpid());
+
+  ab = AB_Banking_new(appName, testConfigDir, 0);
+  rv = AB_Banking_Init(ab);
+  if (rv) {
+    fprintf(stderr, "ERROR: Unable to init AqBanking (%d).\n", rv);
+    AB_Banking_free(ab);
+    abTestTeardown(NULL);
+    return NULL;
+  }
+  return ab;
+}
+
+
+void abTestTeardown(AB_BANKING *ab)
+{
+  if (ab) {
+    AB_Banking_Fini(ab);
+    AB_Banking_free(ab);
+  }
+  removeTree(testConfigDir);
+  GWEN_Gui_SetGui(NULL);
+  GWEN_Gui_free(testGui);
+  testGui = NULL;
+  GWEN_Fini();
+}
+
+
+AB_TRANSACTION *abTestTransaction(const char *date, const char *value)
+{
+  AB_TRANSACTION *t;
+  AB_VALUE *v;
+  GWEN_DATE *dt;
+
+  t = AB_Transaction_new();
+  v = AB_Value_fromString(value);
+  AB_Transaction_SetValue(t, v);
+  AB_Value_free(v);
+  dt = GWEN_Date_fromString(date);
+  AB_Transaction_SetDate(t, dt);
+  GWEN_Date_free(dt);
+  return t;
+}
+
+
+int abTestReport(const char *testName, int result)
+{
+  if (result == 0)
+    printf("%s: ok\n", testName);
+  return result;
+}
@@ -0,0 +1,19 @@
+#ifndef AB_TEST_UTIL_H
+#define AB_TEST_UTIL_H
+
+#include <aqbanking/banking.h>
+
+
+/* init GWEN with a console GUI and AqBanking using a temporary config dir, returns NULL on error */
+AB_BANKING *abTestSetup(const char *appName);
+
+/* deinit AqBanking and GWEN and remove the temporary config dir */
+void abTestTeardown(AB_BANKING *ab);
+
+/* transaction with the given date (YYYYMMDD) and value */
+AB_TRANSACTION *abTestTransaction(const char *date, const char *value);
+
+/* print "<testName>: ok" if result is 0, returns result */
+int abTestReport(const char *testName, int result);
+
+#endif
@@ -0,0 +1,92 @@
+#include <gwenhywfar/buffer.h>
+#include <aqbanking/banking.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* Compares the fixed-point representation of AB_VALUE against the GMP-only mode
+ * by parsing, summing, comparing and serializing a set of typical booking amounts. */
+
+
+#define BENCH_DEFAULT_COUNT 1000000
+
+
+static double runBench(int useFixedPoint, int count, GWEN_BUFFER *resultBuf)
+{
+  AB_VALUE *sum;
+  GWEN_BUFFER *buf;
+  clock_t startTime;
+  char amount[64];
+  int i;
+
+  AB_Value_SetFixedPointEnabled(useFixedPoint);
+  srand(1);
+  startTime=clock();
+
+  sum=AB_Value_new();
+  buf=GWEN_Buffer_new(0, 256, 0, 1);
+  for (i=0; i<count; i++) {
+    AB_VALUE *v;
+
+    snprintf(amount, sizeof(amount), "%s%d.%02d:EUR", (rand() % 3)?"":"-", rand() % 100000, rand() % 100);
+    v=AB_Value_fromString(amount);
+    if (v==NULL) {
+      fprintf(stderr, "ERROR: Could not parse [%s]\n", amount);
+      exit(2);
+    }
+    if (AB_Value_Compare(v, sum)>0)
+      AB_Value_AddValue(sum, v);
+    else
+      AB_Value_SubValue(sum, v);
+    GWEN_Buffer_Reset(buf);
+    AB_Value_toString(v, buf);
+    AB_Value_free(v);
+  }
+  GWEN_Buffer_free(buf);
+
+  AB_Value_toHumanReadableString(sum, resultBuf, 2, 0);
+  AB_Value_free(sum);
+
+  return ((double)(clock()-startTime))/CLOCKS_PER_SEC;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  GWEN_BUFFER *bufFixed;
+  GWEN_BUFFER *bufGmp;
+  double timeFixed;
+  double timeGmp;
+  int count=BENCH_DEFAULT_COUNT;
+  int result=0;
+
+  if (argc>1)
+    count=atoi(argv[1]);
+
+  bufFixed=GWEN_Buffer_new(0, 64, 0, 1);
+  bufGmp=GWEN_Buffer_new(0, 64, 0, 1);
+
+  timeGmp=runBench(0, count, bufGmp);
+  timeFixed=runBench(1, count, bufFixed);
+
+  printf("%d values\n", count);
+  printf("  GMP only   : %8.3f s (result %s)\n", timeGmp, GWEN_Buffer_GetStart(bufGmp));
+  printf("  fixed-point: %8.3f s (result %s)\n", timeFixed, GWEN_Buffer_GetStart(bufFixed));
+  if (timeFixed>0.0)
+    printf("  speedup    : %8.2fx\n", timeGmp/timeFixed);
+
+  if (strcmp(GWEN_Buffer_GetStart(bufFixed), GWEN_Buffer_GetStart(bufGmp))!=0) {
+    fprintf(stderr, "ERROR: Results differ\n");
+    result=1;
+  }
+
+  GWEN_Buffer_free(bufGmp);
+  GWEN_Buffer_free(bufFixed);
+  AB_Value_SetFixedPointEnabled(1);
+
+  return result;
+}
@@ -31,5 +31,27 @@ int main(int argc, char *argv[])
   GWEN_Buffer_free(buf2);
   AB_Value_free(value);
 
+  /* 3-letter codes are interned, other currency strings are stored with the value */
+  {
+    AB_VALUE *v1, *v2, *v3;
+
+    v1 = AB_Value_fromString("1.5:EUR");
+    v2 = AB_Value_fromString("2:EUR");
+    v3 = AB_Value_fromString("3");
+    AB_Value_SetCurrency(v3, "Bonus points");
+    AB_Value_free(v2);
+    v2 = AB_Value_dup(v3);
+    AB_Value_SetCurrency(v3, NULL);
+    if (v1 == NULL || strcmp(AB_Value_GetCurrency(v1), "EUR") != 0
+        || AB_Value_GetCurrency(v2) == NULL || strcmp(AB_Value_GetCurrency(v2), "Bonus points") != 0
+        || AB_Value_GetCurrency(v3) != NULL) {
+      printf("Unexpected currency\n");
+      result = -1;
+    }
+    AB_Value_free(v3);
+    AB_Value_free(v2);
+    AB_Value_free(v1);
+  }
+
   return result;
 }
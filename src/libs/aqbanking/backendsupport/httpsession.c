@@ -15,12 +15,20 @@
 #include "httpsession_p.h"
 
 #include "aqbanking/i18n_l.h"
+#include "aqbanking/banking_l.h"
 #include "aqbanking/backendsupport/siotlsext.h"
+#include "aqbanking/backendsupport/provider_l.h"
 
 #include <gwenhywfar/misc.h>
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/syncio_tls.h>
+#include <gwenhywfar/syncio_http.h>
+#include <gwenhywfar/url.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef OS_WIN32
 # define DIRSEP "\\"
@@ -176,3 +184,423 @@ int GWENHYWFAR_CB AB_HttpSession_InitSyncIo(GWEN_HTTP_SESSION *sess, GWEN_SYNCIO
 
 
 
+int AB_HttpSession_SendPooledRequest(AB_PROVIDER *pro, AB_USER *u,
+                                     const char *url,
+                                     const char *defaultProto,
+                                     int defaultPort,
+                                     int httpVMajor, int httpVMinor,
+                                     const char *httpCommand,
+                                     GWEN_DB_NODE *dbHeader,
+                                     const uint8_t *buf, uint32_t blen,
+                                     GWEN_BUFFER *recvBuf)
+{
+  AB_BANKING *ab;
+  AB_HTTP_POOL *pool;
+  AB_HTTP_POOL_CONN *conn;
+  AB_HTTP_POOL_CONN *closedConns;
+  GWEN_URL *gurl;
+  GWEN_BUFFER *keyBuf;
+  char protocol[32];
+  uint32_t startPos;
+  int canKeepAlive;
+  int keepAlive=0;
+  int requestSent=0;
+  int rv;
+
+  assert(pro);
+  assert(url);
+  assert(httpCommand);
+  assert(recvBuf);
+
+  gurl=GWEN_Url_fromString(url);
+  if (gurl==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid URL [%s]", url);
+    return GWEN_ERROR_INVALID;
+  }
+
+  keyBuf=GWEN_Buffer_new(0, 128, 0, 1);
+  rv=AB_HttpPool__MakeKey(u, gurl, defaultProto, defaultPort, keyBuf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_Buffer_free(keyBuf);
+    GWEN_Url_free(gurl);
+    return rv;
+  }
+
+  /* only HTTP/1.1 and newer keep connections alive by default, older versions use a new connection per request */
+  snprintf(protocol, sizeof(protocol)-1, "HTTP/%d.%d", httpVMajor, httpVMinor);
+  protocol[sizeof(protocol)-1]=0;
+  canKeepAlive=(httpVMajor>1 || (httpVMajor==1 && httpVMinor>=1))?1:0;
+
+  ab=AB_Provider_GetBanking(pro);
+  pool=AB_Provider_GetHttpPool(pro);
+  startPos=GWEN_Buffer_GetUsedBytes(recvBuf);
+
+  /* connections are only unlinked while locked, closing them (e.g. TLS shutdown) happens after unlocking */
+  AB_Banking_Lock(ab);
+  pool->requestCount++;
+  closedConns=AB_HttpPool__UnlinkIdleConnections(pool, time(NULL));
+  conn=canKeepAlive?AB_HttpPool__TakeConnection(pool, GWEN_Buffer_GetStart(keyBuf)):NULL;
+  AB_Banking_Unlock(ab);
+  AB_HttpPool__FreeConnectionList(closedConns);
+
+  if (conn) {
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "Reusing connection to [%s]", GWEN_Buffer_GetStart(keyBuf));
+    rv=AB_HttpPool__SendAndRecv(conn, gurl, protocol, canKeepAlive, httpCommand, dbHeader, buf, blen, recvBuf,
+                                &requestSent, &keepAlive);
+    if (rv<0) {
+      AB_Banking_Lock(ab);
+      conn=AB_HttpPool__ReleaseConnection(pool, conn, 0);
+      AB_Banking_Unlock(ab);
+      AB_HttpPool__FreeConnection(conn);
+      conn=NULL;
+
+      /* The server might have closed the connection in the meantime. Only retry if the request can't have reached
+       * the server or if repeating it is harmless, otherwise e.g. a payment might be submitted twice */
+      if (requestSent && !AB_HttpPool__IsIdempotent(httpCommand)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Error on reused connection after sending %s request (%d), not retrying",
+                 httpCommand, rv);
+        GWEN_Buffer_free(keyBuf);
+        GWEN_Url_free(gurl);
+        return rv;
+      }
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Error on reused connection (%d), retrying with new connection", rv);
+      GWEN_Buffer_Crop(recvBuf, 0, startPos);
+      GWEN_Buffer_SetPos(recvBuf, startPos);
+    }
+  }
+
+  if (conn==NULL) {
+    conn=AB_HttpPool__OpenConnection(u, GWEN_Buffer_GetStart(keyBuf), url, defaultProto, defaultPort);
+    if (conn==NULL) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Could not connect to [%s]", GWEN_Buffer_GetStart(keyBuf));
+      GWEN_Buffer_free(keyBuf);
+      GWEN_Url_free(gurl);
+      return GWEN_ERROR_IO;
+    }
+    AB_Banking_Lock(ab);
+    AB_HttpPool__AddConnection(pool, conn, canKeepAlive);
+    AB_Banking_Unlock(ab);
+
+    rv=AB_HttpPool__SendAndRecv(conn, gurl, protocol, canKeepAlive, httpCommand, dbHeader, buf, blen, recvBuf,
+                                &requestSent, &keepAlive);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    }
+  }
+
+  AB_Banking_Lock(ab);
+  conn=AB_HttpPool__ReleaseConnection(pool, conn, (rv>=0 && keepAlive)?1:0);
+  AB_Banking_Unlock(ab);
+  AB_HttpPool__FreeConnection(conn);
+
+  GWEN_Buffer_free(keyBuf);
+  GWEN_Url_free(gurl);
+  return rv;
+}
+
+
+
+int AB_HttpPool__IsIdempotent(const char *httpCommand)
+{
+  return (strcasecmp(httpCommand, "GET")==0 ||
+          strcasecmp(httpCommand, "HEAD")==0 ||
+          strcasecmp(httpCommand, "OPTIONS")==0)?1:0;
+}
+
+
+
+int AB_HttpPool__MakeKey(AB_USER *u, const GWEN_URL *url, const char *defaultProto, int defaultPort,
+                         GWEN_BUFFER *keyBuf)
+{
+  const char *proto;
+  const char *server;
+  int port;
+
+  proto=GWEN_Url_GetProtocol(url);
+  if (!(proto && *proto))
+    proto=defaultProto;
+  server=GWEN_Url_GetServer(url);
+  if (!(server && *server)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No server in URL");
+    return GWEN_ERROR_INVALID;
+  }
+  port=GWEN_Url_GetPort(url);
+  if (port<1)
+    port=defaultPort;
+
+  GWEN_Buffer_AppendArgs(keyBuf, "%s://%s:%d#%lu",
+                         proto?proto:"http", server, port,
+                         (unsigned long int) (u?AB_User_GetUniqueId(u):0));
+  return 0;
+}
+
+
+
+AB_HTTP_POOL_CONN *AB_HttpPool__OpenConnection(AB_USER *u, const char *key, const char *url,
+                                               const char *defaultProto, int defaultPort)
+{
+  AB_HTTP_POOL_CONN *conn;
+  GWEN_SYNCIO *sio=NULL;
+  GWEN_SYNCIO *sioTls;
+  int rv;
+
+  rv=GWEN_Gui_GetSyncIo(url, defaultProto, defaultPort, &sio);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return NULL;
+  }
+
+  sioTls=GWEN_SyncIo_GetBaseIoByTypeName(sio, GWEN_SYNCIO_TLS_TYPE);
+  if (sioTls && u)
+    AB_SioTlsExt_Extend(sioTls, u);
+
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not connect (%d)", rv);
+    GWEN_SyncIo_free(sio);
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AB_HTTP_POOL_CONN, conn);
+  conn->key=strdup(key);
+  conn->syncIo=sio;
+  conn->dbHeaderOut=GWEN_DB_Group_dup(GWEN_SyncIo_Http_GetDbHeaderOut(sio));
+  conn->busy=1;
+
+  return conn;
+}
+
+
+
+void AB_HttpPool__AddConnection(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn, int canKeepAlive)
+{
+  pool->openCount++;
+  if (canKeepAlive && pool->idleTimeout>0 && AB_HttpPool__CountConnections(pool, conn->key)<pool->maxPerHost) {
+    conn->pooled=1;
+    conn->next=pool->connections;
+    pool->connections=conn;
+  }
+}
+
+
+
+AB_HTTP_POOL_CONN *AB_HttpPool__TakeConnection(AB_HTTP_POOL *pool, const char *key)
+{
+  AB_HTTP_POOL_CONN *conn;
+
+  conn=pool->connections;
+  while (conn) {
+    if (!conn->busy && strcmp(conn->key, key)==0) {
+      conn->busy=1;
+      pool->reuseCount++;
+      return conn;
+    }
+    conn=conn->next;
+  }
+
+  return NULL;
+}
+
+
+
+AB_HTTP_POOL_CONN *AB_HttpPool__ReleaseConnection(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn, int keep)
+{
+  conn->busy=0;
+  if (keep && conn->pooled) {
+    conn->lastUsed=time(NULL);
+    return NULL;
+  }
+
+  if (conn->pooled)
+    AB_HttpPool__Unlink(pool, conn);
+  return conn;
+}
+
+
+
+AB_HTTP_POOL_CONN *AB_HttpPool__UnlinkIdleConnections(AB_HTTP_POOL *pool, time_t now)
+{
+  AB_HTTP_POOL_CONN *conn;
+  AB_HTTP_POOL_CONN *closedConns=NULL;
+
+  conn=pool->connections;
+  while (conn) {
+    AB_HTTP_POOL_CONN *next;
+
+    next=conn->next;
+    if (!conn->busy && difftime(now, conn->lastUsed)>(double) pool->idleTimeout) {
+      DBG_DEBUG(AQBANKING_LOGDOMAIN, "Closing idle connection to [%s]", conn->key);
+      AB_HttpPool__Unlink(pool, conn);
+      conn->next=closedConns;
+      closedConns=conn;
+    }
+    conn=next;
+  }
+
+  return closedConns;
+}
+
+
+
+int AB_HttpPool__CountConnections(const AB_HTTP_POOL *pool, const char *key)
+{
+  const AB_HTTP_POOL_CONN *conn;
+  int count=0;
+
+  conn=pool->connections;
+  while (conn) {
+    if (strcmp(conn->key, key)==0)
+      count++;
+    conn=conn->next;
+  }
+
+  return count;
+}
+
+
+
+void AB_HttpPool__Unlink(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn)
+{
+  AB_HTTP_POOL_CONN **pConn;
+
+  pConn=&(pool->connections);
+  while (*pConn) {
+    if (*pConn==conn) {
+      *pConn=conn->next;
+      conn->next=NULL;
+      conn->pooled=0;
+      return;
+    }
+    pConn=&((*pConn)->next);
+  }
+}
+
+
+
+void AB_HttpPool__FreeConnection(AB_HTTP_POOL_CONN *conn)
+{
+  if (conn) {
+    GWEN_SyncIo_Disconnect(conn->syncIo);
+    GWEN_SyncIo_free(conn->syncIo);
+    GWEN_DB_Group_free(conn->dbHeaderOut);
+    free(conn->key);
+    GWEN_FREE_OBJECT(conn);
+  }
+}
+
+
+
+void AB_HttpPool__FreeConnectionList(AB_HTTP_POOL_CONN *conn)
+{
+  while (conn) {
+    AB_HTTP_POOL_CONN *next;
+
+    next=conn->next;
+    AB_HttpPool__FreeConnection(conn);
+    conn=next;
+  }
+}
+
+
+
+int AB_HttpPool__SendAndRecv(AB_HTTP_POOL_CONN *conn, const GWEN_URL *url, const char *protocol, int canKeepAlive,
+                             const char *httpCommand, GWEN_DB_NODE *dbHeader, const uint8_t *buf, uint32_t blen,
+                             GWEN_BUFFER *recvBuf, int *pRequestSent, int *pKeepAlive)
+{
+  GWEN_DB_NODE *db;
+  GWEN_BUFFER *tbuf;
+  const char *s;
+  int rv;
+
+  *pRequestSent=0;
+  *pKeepAlive=0;
+
+  /* setup command */
+  db=GWEN_SyncIo_Http_GetDbCommandOut(conn->syncIo);
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "command", httpCommand);
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "protocol", protocol);
+  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  rv=GWEN_Url_toCommandString(url, tbuf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_Buffer_free(tbuf);
+    return rv;
+  }
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "url", GWEN_Buffer_GetStart(tbuf));
+  GWEN_Buffer_free(tbuf);
+
+  /* setup header (starting with the header of a new connection) */
+  db=GWEN_SyncIo_Http_GetDbHeaderOut(conn->syncIo);
+  GWEN_DB_ClearGroup(db, NULL);
+  if (conn->dbHeaderOut)
+    GWEN_DB_AddGroupChildren(db, conn->dbHeaderOut);
+  GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "Connection", canKeepAlive?"keep-alive":"close");
+  GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, "Content-length", blen);
+  if (dbHeader) {
+    GWEN_DB_NODE *dbVar;
+
+    dbVar=GWEN_DB_GetFirstVar(dbHeader);
+    while (dbVar) {
+      s=GWEN_DB_GetCharValueFromNode(GWEN_DB_GetFirstValue(dbVar));
+      if (s)
+        GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_DB_VariableName(dbVar), s);
+      dbVar=GWEN_DB_GetNextVar(dbVar);
+    }
+  }
+
+  /* send request (if this fails the server never got the complete request, so it can't have processed it) */
+  rv=GWEN_SyncIo_WriteForced(conn->syncIo, buf, blen);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  *pRequestSent=1;
+
+  /* receive response */
+  rv=GWEN_SyncIo_Http_RecvBody(conn->syncIo, recvBuf);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  s=GWEN_DB_GetCharValue(GWEN_SyncIo_Http_GetDbHeaderIn(conn->syncIo), "Connection", 0, NULL);
+  *pKeepAlive=(canKeepAlive && !(s && strcasecmp(s, "close")==0))?1:0;
+
+  return rv;
+}
+
+
+
+AB_HTTP_POOL *AB_HttpPool_new(int idleTimeout, int maxPerHost)
+{
+  AB_HTTP_POOL *pool;
+
+  GWEN_NEW_OBJECT(AB_HTTP_POOL, pool);
+  pool->idleTimeout=idleTimeout;
+  pool->maxPerHost=(maxPerHost<1)?1:maxPerHost;
+
+  return pool;
+}
+
+
+
+void AB_HttpPool_free(AB_HTTP_POOL *pool)
+{
+  if (pool) {
+    AB_HTTP_POOL_CONN *conn;
+
+    if (pool->requestCount)
+      DBG_NOTICE(AQBANKING_LOGDOMAIN, "HTTP connection pool: %d requests, %d connections opened, %d reused",
+                 pool->requestCount, pool->openCount, pool->reuseCount);
+
+    while ((conn=pool->connections)) {
+      pool->connections=conn->next;
+      AB_HttpPool__FreeConnection(conn);
+    }
+    GWEN_FREE_OBJECT(pool);
+  }
+}
+
+
+
@@ -66,6 +66,54 @@ void AB_HttpSession_ClearLog(GWEN_HTTP_SESSION *sess);
 /*@}*/
 
 
+
+/** @name Pooled Requests
+ *
+ * Requests sent via @ref AB_HttpSession_SendPooledRequest use kept-alive connections which are shared by all
+ * requests of a provider to the same server (same protocol, host, port and user) as long as the provider is in use
+ * (e.g. during @ref AB_Banking_SendCommands). So only the first request to a server needs to establish the TCP and
+ * TLS connection.
+ *
+ * Connections idle for longer than the runtime config variable "httpPoolIdleTimeout" (in seconds, default 30) are
+ * closed, a value of 0 disables keeping connections. At most "httpPoolMaxPerHost" connections (default 4) are kept
+ * per server. Requests using HTTP versions older than 1.1 always use a new connection.
+ *
+ * If a request fails on a reused connection it is repeated on a new connection only if the request could not be
+ * sent completely or if the HTTP method is idempotent (GET, HEAD, OPTIONS), so e.g. a POST is never submitted twice.
+ */
+/*@{*/
+
+/**
+ * Send a HTTP request and receive the response using a pooled connection.
+ *
+ * @return HTTP status code of the response (e.g. 200), error code otherwise
+ * @param pro provider whose connection pool is to be used
+ * @param u user (used for certificate handling, may be NULL)
+ * @param url complete URL of the request (including path and query)
+ * @param defaultProto protocol to use if the URL doesn't contain one (e.g. "https")
+ * @param defaultPort port to use if the URL doesn't contain one
+ * @param httpVMajor major HTTP version (e.g. 1)
+ * @param httpVMinor minor HTTP version (e.g. 1 for HTTP/1.1, connections are not kept for HTTP/1.0)
+ * @param httpCommand HTTP method (e.g. "GET" or "POST")
+ * @param dbHeader additional header fields to send (may be NULL)
+ * @param buf body of the request (may be NULL)
+ * @param blen size of the body
+ * @param recvBuf buffer to receive the body of the response
+ */
+AQBANKING_API
+int AB_HttpSession_SendPooledRequest(AB_PROVIDER *pro, AB_USER *u,
+                                     const char *url,
+                                     const char *defaultProto,
+                                     int defaultPort,
+                                     int httpVMajor, int httpVMinor,
+                                     const char *httpCommand,
+                                     GWEN_DB_NODE *dbHeader,
+                                     const uint8_t *buf, uint32_t blen,
+                                     GWEN_BUFFER *recvBuf);
+
+/*@}*/
+
+
 /*@}*/ /* defgroup */
 
 
@@ -0,0 +1,35 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_HTTPSESS_L_H
+#define AB_HTTPSESS_L_H
+
+#include "aqbanking/backendsupport/httpsession.h"
+
+
+/* defaults, can be changed via runtime config variables "httpPoolIdleTimeout" and "httpPoolMaxPerHost" */
+#define AB_HTTP_POOL_IDLE_TIMEOUT 30
+#define AB_HTTP_POOL_MAX_PER_HOST 4
+
+
+/**
+ * Pool of kept-alive connections used by @ref AB_HttpSession_SendPooledRequest.
+ * Every provider has its own pool which lives as long as the provider itself.
+ */
+typedef struct AB_HTTP_POOL AB_HTTP_POOL;
+
+
+AB_HTTP_POOL *AB_HttpPool_new(int idleTimeout, int maxPerHost);
+
+/**
+ * Closes all connections of the pool and logs its statistics.
+ */
+void AB_HttpPool_free(AB_HTTP_POOL *pool);
+
+
+#endif
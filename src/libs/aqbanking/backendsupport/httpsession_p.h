@@ -13,9 +13,12 @@
 #define AB_HTTPSESS_P_H
 
 #include "httpsession.h"
+#include "httpsession_l.h"
 
 #include "aqbanking/backendsupport/user.h"
 
+#include <time.h>
+
 
 
 typedef struct AB_HTTP_SESSION AB_HTTP_SESSION;
@@ -26,9 +29,50 @@ struct AB_HTTP_SESSION {
 };
 
 
+typedef struct AB_HTTP_POOL_CONN AB_HTTP_POOL_CONN;
+struct AB_HTTP_POOL_CONN {
+  AB_HTTP_POOL_CONN *next;
+  char *key;                /* protocol, server, port and user */
+  GWEN_SYNCIO *syncIo;
+  GWEN_DB_NODE *dbHeaderOut; /* initial outgoing header (restored before every request) */
+  time_t lastUsed;
+  int busy;
+  int pooled;               /* 0 if this connection is closed after use */
+};
+
+
+struct AB_HTTP_POOL {
+  AB_HTTP_POOL_CONN *connections;
+  int idleTimeout;
+  int maxPerHost;
+
+  int requestCount;
+  int openCount;
+  int reuseCount;
+};
+
+
 static void GWENHYWFAR_CB AB_HttpSession_FreeData(void *bp, void *p);
 static int GWENHYWFAR_CB AB_HttpSession_InitSyncIo(GWEN_HTTP_SESSION *sess, GWEN_SYNCIO *sio);
 
+static AB_HTTP_POOL_CONN *AB_HttpPool__TakeConnection(AB_HTTP_POOL *pool, const char *key);
+static AB_HTTP_POOL_CONN *AB_HttpPool__OpenConnection(AB_USER *u, const char *key, const char *url,
+                                                      const char *defaultProto, int defaultPort);
+static void AB_HttpPool__AddConnection(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn, int canKeepAlive);
+static AB_HTTP_POOL_CONN *AB_HttpPool__ReleaseConnection(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn, int keep);
+static AB_HTTP_POOL_CONN *AB_HttpPool__UnlinkIdleConnections(AB_HTTP_POOL *pool, time_t now);
+static int AB_HttpPool__CountConnections(const AB_HTTP_POOL *pool, const char *key);
+static void AB_HttpPool__Unlink(AB_HTTP_POOL *pool, AB_HTTP_POOL_CONN *conn);
+static void AB_HttpPool__FreeConnection(AB_HTTP_POOL_CONN *conn);
+static void AB_HttpPool__FreeConnectionList(AB_HTTP_POOL_CONN *conn);
+static int AB_HttpPool__IsIdempotent(const char *httpCommand);
+static int AB_HttpPool__MakeKey(AB_USER *u, const GWEN_URL *url, const char *defaultProto, int defaultPort,
+                                GWEN_BUFFER *keyBuf);
+static int AB_HttpPool__SendAndRecv(AB_HTTP_POOL_CONN *conn, const GWEN_URL *url, const char *protocol,
+                                    int canKeepAlive, const char *httpCommand, GWEN_DB_NODE *dbHeader,
+                                    const uint8_t *buf, uint32_t blen, GWEN_BUFFER *recvBuf,
+                                    int *pRequestSent, int *pKeepAlive);
+
 
 
 
@@ -0,0 +1,93 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "mutex_l.h"
+
+#include <aqbanking/error.h>
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/memory.h>
+
+#if defined(HAVE_PTHREAD_H) && !defined(OS_WIN32)
+# define AB_MUTEX_USE_PTHREADS
+# include <pthread.h>
+#endif
+
+#include <stdlib.h>
+
+
+
+struct AB_MUTEX {
+#ifdef AB_MUTEX_USE_PTHREADS
+  pthread_mutex_t mutex;
+#else
+  int dummy;
+#endif
+};
+
+
+
+AB_MUTEX *AB_Mutex_new(void)
+{
+  AB_MUTEX *m;
+#ifdef AB_MUTEX_USE_PTHREADS
+  pthread_mutexattr_t attr;
+#endif
+
+  GWEN_NEW_OBJECT(AB_MUTEX, m);
+#ifdef AB_MUTEX_USE_PTHREADS
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  if (pthread_mutex_init(&(m->mutex), &attr)!=0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not create mutex");
+    pthread_mutexattr_destroy(&attr);
+    GWEN_FREE_OBJECT(m);
+    return NULL;
+  }
+  pthread_mutexattr_destroy(&attr);
+#endif
+  return m;
+}
+
+
+
+void AB_Mutex_free(AB_MUTEX *m)
+{
+  if (m) {
+#ifdef AB_MUTEX_USE_PTHREADS
+    pthread_mutex_destroy(&(m->mutex));
+#endif
+    GWEN_FREE_OBJECT(m);
+  }
+}
+
+
+
+void AB_Mutex_Lock(AB_MUTEX *m)
+{
+#ifdef AB_MUTEX_USE_PTHREADS
+  if (m)
+    pthread_mutex_lock(&(m->mutex));
+#endif
+}
+
+
+
+void AB_Mutex_Unlock(AB_MUTEX *m)
+{
+#ifdef AB_MUTEX_USE_PTHREADS
+  if (m)
+    pthread_mutex_unlock(&(m->mutex));
+#endif
+}
+
+
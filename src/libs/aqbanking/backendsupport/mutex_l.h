@@ -0,0 +1,47 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_MUTEX_L_H
+#define AQBANKING_MUTEX_L_H
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Recursive mutex used to serialize access to shared objects while jobs run in worker threads
+ * (see @ref AB_WorkerPool_Run). Without thread support all functions are no-ops.
+ */
+typedef struct AB_MUTEX AB_MUTEX;
+
+
+AB_MUTEX *AB_Mutex_new(void);
+void AB_Mutex_free(AB_MUTEX *m);
+
+/**
+ * Lock the given mutex. The same thread may lock a mutex multiple times, it has to unlock it
+ * as many times. Does nothing if m is NULL.
+ */
+void AB_Mutex_Lock(AB_MUTEX *m);
+
+/**
+ * Unlock the given mutex. Does nothing if m is NULL.
+ */
+void AB_Mutex_Unlock(AB_MUTEX *m);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif /* AQBANKING_MUTEX_L_H */
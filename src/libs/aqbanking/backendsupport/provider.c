@@ -81,6 +81,7 @@ void AB_Provider_free(AB_PROVIDER *pro)
       DBG_VERBOUS(AQBANKING_LOGDOMAIN, "Destroying AB_PROVIDER (%s)",
                   pro->name);
       GWEN_INHERIT_FINI(AB_PROVIDER, pro);
+      AB_HttpPool_free(pro->httpPool);
       GWEN_Plugin_free(pro->plugin);
       free(pro->name);
       free(pro->escName);
@@ -92,6 +93,28 @@ void AB_Provider_free(AB_PROVIDER *pro)
 
 
 
+AB_HTTP_POOL *AB_Provider_GetHttpPool(AB_PROVIDER *pro)
+{
+  AB_HTTP_POOL *pool;
+
+  assert(pro);
+  AB_Banking_Lock(pro->banking);
+  if (pro->httpPool==NULL) {
+    int idleTimeout;
+    int maxPerHost;
+
+    idleTimeout=AB_Banking_RuntimeConfig_GetIntValue(pro->banking, "httpPoolIdleTimeout", AB_HTTP_POOL_IDLE_TIMEOUT);
+    maxPerHost=AB_Banking_RuntimeConfig_GetIntValue(pro->banking, "httpPoolMaxPerHost", AB_HTTP_POOL_MAX_PER_HOST);
+    pro->httpPool=AB_HttpPool_new(idleTimeout, maxPerHost);
+  }
+  pool=pro->httpPool;
+  AB_Banking_Unlock(pro->banking);
+
+  return pool;
+}
+
+
+
 void AB_Provider_AddFlags(AB_PROVIDER *pro, uint32_t fl)
 {
   assert(pro);
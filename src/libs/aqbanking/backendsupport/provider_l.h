@@ -17,6 +17,7 @@
 
 #include <aqbanking/backendsupport/provider.h>
 #include <aqbanking/backendsupport/provider_be.h>
+#include "aqbanking/backendsupport/httpsession_l.h"
 
 #include <gwenhywfar/plugin.h>
 
@@ -26,6 +27,11 @@ GWEN_LIST_FUNCTION_DEFS(AB_PROVIDER, AB_Provider)
 void AB_Provider_SetPlugin(AB_PROVIDER *pro, GWEN_PLUGIN *pl);
 void AB_Provider_free(AB_PROVIDER *pro);
 
+/**
+ * Returns the pool of kept-alive HTTP connections of the given provider (created on first use).
+ */
+AB_HTTP_POOL *AB_Provider_GetHttpPool(AB_PROVIDER *pro);
+
 
 #endif /* AQBANKING_PROVIDER_L_H */
 
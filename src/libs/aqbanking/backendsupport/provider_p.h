@@ -53,6 +53,8 @@ struct AB_PROVIDER {
 
   GWEN_PLUGIN *plugin;
 
+  AB_HTTP_POOL *httpPool;
+
   uint32_t usage;
   uint32_t flags;
   int initCounter;
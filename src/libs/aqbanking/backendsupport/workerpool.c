@@ -0,0 +1,172 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "workerpool_l.h"
+
+#include <aqbanking/error.h>
+
+#include <gwenhywfar/debug.h>
+
+#if defined(HAVE_PTHREAD_H) && !defined(OS_WIN32)
+# define AB_WORKERPOOL_USE_PTHREADS
+# include <pthread.h>
+#endif
+
+#include <stdlib.h>
+
+
+
+#define AB_WORKERPOOL_MAXTHREADS 64
+
+
+
+typedef struct AB_WORKERPOOL_CTX AB_WORKERPOOL_CTX;
+struct AB_WORKERPOOL_CTX {
+  AB_WORKERPOOL_RUN_FN fn;
+  void *userData;
+  int numJobs;
+  int nextJob;
+  int result;
+#ifdef AB_WORKERPOOL_USE_PTHREADS
+  pthread_mutex_t mutex;
+#endif
+};
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _runSequentially(AB_WORKERPOOL_CTX *ctx);
+#ifdef AB_WORKERPOOL_USE_PTHREADS
+static void *_threadMain(void *p);
+#endif
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+int AB_WorkerPool_HasThreads(void)
+{
+#ifdef AB_WORKERPOOL_USE_PTHREADS
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+
+
+int AB_WorkerPool_Run(int numJobs, int numThreads, AB_WORKERPOOL_RUN_FN fn, void *userData)
+{
+  AB_WORKERPOOL_CTX ctx;
+
+  if (numJobs<1)
+    return 0;
+
+  ctx.fn=fn;
+  ctx.userData=userData;
+  ctx.numJobs=numJobs;
+  ctx.nextJob=0;
+  ctx.result=0;
+
+  if (numThreads>numJobs)
+    numThreads=numJobs;
+  if (numThreads>AB_WORKERPOOL_MAXTHREADS)
+    numThreads=AB_WORKERPOOL_MAXTHREADS;
+
+#ifdef AB_WORKERPOOL_USE_PTHREADS
+  if (numThreads>1) {
+    pthread_t threads[AB_WORKERPOOL_MAXTHREADS];
+    int started=0;
+    int i;
+
+    if (pthread_mutex_init(&ctx.mutex, NULL)!=0) {
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Could not create mutex, running jobs sequentially");
+      return _runSequentially(&ctx);
+    }
+
+    /* the calling thread is one of the workers */
+    for (i=1; i<numThreads; i++) {
+      if (pthread_create(&threads[started], NULL, _threadMain, &ctx)!=0) {
+        DBG_WARN(AQBANKING_LOGDOMAIN, "Could only start %d of %d threads", started+1, numThreads);
+        break;
+      }
+      started++;
+    }
+
+    _threadMain(&ctx);
+
+    for (i=0; i<started; i++)
+      pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&ctx.mutex);
+    return ctx.result;
+  }
+#endif
+
+  return _runSequentially(&ctx);
+}
+
+
+
+int _runSequentially(AB_WORKERPOOL_CTX *ctx)
+{
+  int i;
+
+  for (i=0; i<ctx->numJobs; i++) {
+    int rv;
+
+    rv=ctx->fn(ctx->userData, i);
+    if (rv<0 && ctx->result==0)
+      ctx->result=rv;
+  }
+  return ctx->result;
+}
+
+
+
+#ifdef AB_WORKERPOOL_USE_PTHREADS
+void *_threadMain(void *p)
+{
+  AB_WORKERPOOL_CTX *ctx;
+
+  ctx=(AB_WORKERPOOL_CTX *) p;
+  for (;;) {
+    int idx;
+    int rv;
+
+    pthread_mutex_lock(&ctx->mutex);
+    idx=ctx->nextJob;
+    if (idx<ctx->numJobs)
+      ctx->nextJob++;
+    pthread_mutex_unlock(&ctx->mutex);
+    if (idx>=ctx->numJobs)
+      break;
+
+    rv=ctx->fn(ctx->userData, idx);
+    if (rv<0) {
+      pthread_mutex_lock(&ctx->mutex);
+      if (ctx->result==0)
+        ctx->result=rv;
+      pthread_mutex_unlock(&ctx->mutex);
+    }
+  }
+  return NULL;
+}
+#endif
+
+
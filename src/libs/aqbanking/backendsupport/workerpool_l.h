@@ -0,0 +1,54 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_WORKERPOOL_L_H
+#define AQBANKING_WORKERPOOL_L_H
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Function called for every job of @ref AB_WorkerPool_Run.
+ * May be called from different threads concurrently, so it must only access data belonging to the job
+ * with the given index (or protect shared data itself).
+ * @return 0 if ok, error code otherwise
+ * @param userData pointer given to @ref AB_WorkerPool_Run
+ * @param idx index of the job to run (0..numJobs-1)
+ */
+typedef int (*AB_WORKERPOOL_RUN_FN)(void *userData, int idx);
+
+
+/**
+ * Runs the given function for every job index using up to numThreads threads.
+ * If threads are not available or numThreads is less than 2 all jobs are run sequentially in
+ * the calling thread. All jobs are run even if some of them fail.
+ * @return 0 if ok, the first error code returned by any job otherwise
+ * @param numJobs number of jobs to run
+ * @param numThreads maximum number of threads to use
+ * @param fn function to call for every job
+ * @param userData pointer handed to fn
+ */
+int AB_WorkerPool_Run(int numJobs, int numThreads, AB_WORKERPOOL_RUN_FN fn, void *userData);
+
+/**
+ * Returns !=0 if AB_WorkerPool_Run() is able to run jobs in parallel.
+ */
+int AB_WorkerPool_HasThreads(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif /* AQBANKING_WORKERPOOL_L_H */
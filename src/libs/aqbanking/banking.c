@@ -20,6 +20,7 @@
 #include "backendsupport/provider_l.h"
 #include "backendsupport/imexporter_l.h"
 #include "backendsupport/bankinfoplugin_l.h"
+#include "gui/serialgui_l.h"
 #include "i18n_l.h"
 #include "banking_dialogs.h"
 
@@ -77,6 +78,7 @@ GWEN_INHERIT_FUNCTIONS(AB_BANKING)
 
 
 static void _logMsgForJobId(const AB_BANKING *ab, uint32_t jobId, const char *msg);
+static int _getNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtStdUniqueId);
 
 
 
@@ -123,6 +125,7 @@ AB_BANKING *AB_Banking_new(const char *appName,
   ab->appName=strdup(appName);
   ab->cryptTokenList=GWEN_Crypt_Token_List2_new();
   ab->dbRuntimeConfig=GWEN_DB_Group_new("runtimeConfig");
+  ab->imExporterProfilesList=AB_Banking_Profiles_List_new();
 
   GWEN_Buffer_free(nbuf);
 
@@ -168,6 +171,9 @@ void AB_Banking_free(AB_BANKING *ab)
     GWEN_INHERIT_FINI(AB_BANKING, ab);
 
     GWEN_DB_Group_free(ab->dbRuntimeConfig);
+    AB_Banking_Profiles_List_Clear(ab->imExporterProfilesList);
+    AB_Banking_Profiles_List_free(ab->imExporterProfilesList);
+    AB_Banking_Profiles_free(ab->profileFiles);
     AB_Banking_ClearCryptTokenList(ab);
     GWEN_Crypt_Token_List2_free(ab->cryptTokenList);
     GWEN_ConfigMgr_free(ab->configMgr);
@@ -182,7 +188,89 @@ void AB_Banking_free(AB_BANKING *ab)
 
 
 
+int AB_Banking_BeginThreadedUse(AB_BANKING *ab)
+{
+  assert(ab);
+  if (ab->mutex) {
+    GWEN_GUI *gui;
+
+    /* nested call, also serialize GUI callbacks which have been set since the outermost call */
+    AB_Banking_Lock(ab);
+    ab->threadedUseCount++;
+    gui=GWEN_Gui_GetGui();
+    if (gui)
+      AB_SerialGui_Extend(gui, ab->mutex);
+    AB_Banking_Unlock(ab);
+  }
+  else {
+    GWEN_GUI *gui;
+
+    ab->mutex=AB_Mutex_new();
+    if (ab->mutex==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not create mutex, threads must not be used");
+      return GWEN_ERROR_GENERIC;
+    }
+    ab->threadedUseCount=1;
+    gui=GWEN_Gui_GetGui();
+    if (gui)
+      AB_SerialGui_Extend(gui, ab->mutex);
+  }
+  return 0;
+}
+
+
+
+void AB_Banking_EndThreadedUse(AB_BANKING *ab)
+{
+  assert(ab);
+  if (ab->mutex) {
+    AB_Banking_Lock(ab);
+    if (--(ab->threadedUseCount)<1) {
+      AB_MUTEX *mutex;
+      GWEN_GUI *gui;
+
+      gui=GWEN_Gui_GetGui();
+      if (gui)
+        AB_SerialGui_Unextend(gui);
+      mutex=ab->mutex;
+      ab->mutex=NULL;
+      AB_Mutex_Unlock(mutex);
+      AB_Mutex_free(mutex);
+    }
+    else
+      AB_Banking_Unlock(ab);
+  }
+}
+
+
+
+void AB_Banking_Lock(const AB_BANKING *ab)
+{
+  AB_Mutex_Lock(ab->mutex);
+}
+
+
+
+void AB_Banking_Unlock(const AB_BANKING *ab)
+{
+  AB_Mutex_Unlock(ab->mutex);
+}
+
+
+
 int AB_Banking_GetNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtStdUniqueId)
+{
+  int rv;
+
+  AB_Banking_Lock(ab);
+  rv=_getNamedUniqueId(ab, idName, startAtStdUniqueId);
+  AB_Banking_Unlock(ab);
+  return rv;
+}
+
+
+
+int _getNamedUniqueId(AB_BANKING *ab, const char *idName, int startAtStdUniqueId)
 {
   int rv;
   int uid=0;
@@ -406,7 +494,9 @@ void AB_Banking_LogMsgForJobId(const AB_BANKING *ab, uint32_t jobId, const char
     if (rv>0) {
       GWEN_Buffer_IncrementPos(bf, rv);
       GWEN_Buffer_AdjustUsedBytes(bf);
+      AB_Banking_Lock(ab);
       _logMsgForJobId(ab, jobId, GWEN_Buffer_GetStart(bf));
+      AB_Banking_Unlock(ab);
     }
     GWEN_Buffer_free(bf);
     va_end(list);
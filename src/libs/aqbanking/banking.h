@@ -333,6 +333,24 @@ int AB_Banking_UnlockSharedConfig(AB_BANKING *ab, const char *name);
  *       (see https://www.hbci-zka.de/register/prod_register.htm)</li>
  *   <li>fintsApplicationVersionString (char): string containing the version of the application
  *       (major and minor version only, e.g. "1.2")</li>
+ *   <li>sendCommandsThreads (int): maximum number of threads used by @ref AB_Banking_SendCommands to send the
+ *       commands for different backends in parallel (0 or 1 to send them one after the other, which is the default).
+ *       While the backends run in parallel calls to the GUI are serialized but may come from other threads.</li>
+ *   <li>hbciOutboxThreads (int): maximum number of HBCI dialogs run in parallel for different customers by the AqHBCI
+ *       backend (0 or 1 to run them one after the other, which is the default)</li>
+ *   <li>hbciOutboxThreadsPerHost (int): maximum number of parallel HBCI dialogs with the same bank server
+ *       (default 1). Customers using the same security medium are never served in parallel.</li>
+ *   <li>httpPoolIdleTimeout (int): number of seconds an idle HTTP connection of a backend is kept open for
+ *       further requests to the same server (default 30, 0 to close the connection after every request)</li>
+ *   <li>httpPoolMaxPerHost (int): maximum number of idle HTTP connections kept open per server and user
+ *       (default 4)</li>
+ *   <li>paypalDetailsThreads (int): maximum number of transaction details requested in parallel by the AqPayPal
+ *       backend (0 or 1 to request them one after the other, which is the default)</li>
+ *   <li>paypalDetailsRequestsPerSecond (int): maximum number of transaction detail requests per second sent by the
+ *       AqPayPal backend (default 4, 0 for no limit)</li>
+ *   <li>givveRequestThreads (int): maximum number of requests sent in parallel by the AqGivve backend (default 4, 1
+ *       to request everything one after the other). Vouchers of a user are handled in parallel; with only one
+ *       voucher the pages of its listings are requested in parallel instead, never both at once.</li>
  * </ul>
  */
 /*@{*/
@@ -53,12 +53,15 @@ AB_BANKINFO_PLUGIN *AB_Banking_GetBankInfoPlugin(AB_BANKING *ab, const char *cou
   assert(ab);
   assert(country);
 
+  /* plugins are created on demand, so lookup and creation must not race */
+  AB_Banking_Lock(ab);
   bip=AB_Banking_FindBankInfoPlugin(ab, country);
-  if (bip)
-    return bip;
-  bip=AB_Banking_CreateImBankInfoPlugin(ab, country);
-  if (bip)
-    AB_BankInfoPlugin_List_Add(bip, ab_bankInfoPlugins);
+  if (bip==NULL) {
+    bip=AB_Banking_CreateImBankInfoPlugin(ab, country);
+    if (bip)
+      AB_BankInfoPlugin_List_Add(bip, ab_bankInfoPlugins);
+  }
+  AB_Banking_Unlock(ab);
 
   return bip;
 }
@@ -71,6 +74,7 @@ AB_BANKINFO *AB_Banking_GetBankInfo(AB_BANKING *ab,
                                     const char *bankId)
 {
   AB_BANKINFO_PLUGIN *bip;
+  AB_BANKINFO *bi;
 
   assert(ab);
   assert(country);
@@ -80,7 +84,11 @@ AB_BANKINFO *AB_Banking_GetBankInfo(AB_BANKING *ab,
     return 0;
   }
 
-  return AB_BankInfoPlugin_GetBankInfo(bip, branchId, bankId);
+  /* plugins are shared by all threads (see AB_Banking_BeginThreadedUse) */
+  AB_Banking_Lock(ab);
+  bi=AB_BankInfoPlugin_GetBankInfo(bip, branchId, bankId);
+  AB_Banking_Unlock(ab);
+  return bi;
 }
 
 
@@ -91,6 +99,7 @@ int AB_Banking_GetBankInfoByTemplate(AB_BANKING *ab,
                                      AB_BANKINFO_LIST2 *bl)
 {
   AB_BANKINFO_PLUGIN *bip;
+  int rv;
 
   assert(ab);
   assert(country);
@@ -102,7 +111,10 @@ int AB_Banking_GetBankInfoByTemplate(AB_BANKING *ab,
     return 0;
   }
 
-  return AB_BankInfoPlugin_GetBankInfoByTemplate(bip, tbi, bl);
+  AB_Banking_Lock(ab);
+  rv=AB_BankInfoPlugin_GetBankInfoByTemplate(bip, tbi, bl);
+  AB_Banking_Unlock(ab);
+  return rv;
 }
 
 
@@ -114,6 +126,7 @@ AB_BANKINFO_CHECKRESULT AB_Banking_CheckAccount(AB_BANKING *ab,
                                                 const char *accountId)
 {
   AB_BANKINFO_PLUGIN *bip;
+  AB_BANKINFO_CHECKRESULT res;
 
   assert(ab);
   assert(country);
@@ -123,208 +136,250 @@ AB_BANKINFO_CHECKRESULT AB_Banking_CheckAccount(AB_BANKING *ab,
     return AB_BankInfoCheckResult_UnknownResult;
   }
 
-  return AB_BankInfoPlugin_CheckAccount(bip, branchId, bankId, accountId);
+  AB_Banking_Lock(ab);
+  res=AB_BankInfoPlugin_CheckAccount(bip, branchId, bankId, accountId);
+  AB_Banking_Unlock(ab);
+  return res;
 }
 
 
 
-int AB_Banking__TransformIban(const char *iban, int len, char *newIban, int maxLen)
+/* IBAN length per country (ISO 13616 registry), sorted by country code */
+static const struct {
+  char country[3];
+  int length;
+} ab_banking_iban_lengths[]= {
+  {"AD", 24}, {"AE", 23}, {"AL", 28}, {"AT", 20}, {"AZ", 28}, {"BA", 20}, {"BE", 16}, {"BG", 22},
+  {"BH", 22}, {"BR", 29}, {"BY", 28}, {"CH", 21}, {"CR", 22}, {"CY", 28}, {"CZ", 24}, {"DE", 22},
+  {"DK", 18}, {"DO", 28}, {"EE", 20}, {"EG", 29}, {"ES", 24}, {"FI", 18}, {"FO", 18}, {"FR", 27},
+  {"GB", 22}, {"GE", 22}, {"GI", 23}, {"GL", 18}, {"GR", 27}, {"GT", 28}, {"HR", 21}, {"HU", 28},
+  {"IE", 22}, {"IL", 23}, {"IQ", 23}, {"IS", 26}, {"IT", 27}, {"JO", 30}, {"KW", 30}, {"KZ", 20},
+  {"LB", 28}, {"LC", 32}, {"LI", 21}, {"LT", 20}, {"LU", 20}, {"LV", 21}, {"LY", 25}, {"MC", 27},
+  {"MD", 24}, {"ME", 22}, {"MK", 19}, {"MR", 27}, {"MT", 31}, {"MU", 30}, {"NL", 18}, {"NO", 15},
+  {"PK", 24}, {"PL", 28}, {"PS", 29}, {"PT", 25}, {"QA", 29}, {"RO", 24}, {"RS", 22}, {"SA", 24},
+  {"SC", 31}, {"SE", 24}, {"SI", 19}, {"SK", 24}, {"SM", 27}, {"ST", 25}, {"SV", 28}, {"TL", 23},
+  {"TN", 24}, {"TR", 26}, {"UA", 29}, {"VA", 22}, {"VG", 24}, {"XK", 20}
+};
+
+
+
+int AB_Banking__IbanMod97(const char *s, int len, int rem)
 {
-  int i, j;
-  const char *p;
-  char *s;
-
-  assert(iban);
-  /* format IBAN */
-  i=0;
-  j=0;
-  p=iban;
-  s=newIban;
-  while (j<len && i<maxLen) {
+  /* letters count as two digits (A=10 ... Z=35), spaces are ignored */
+  while (len>0 && *s) {
     int c;
 
-    c=toupper(*p);
-    if (c!=' ') {
-      if (c>='A' && c<='Z') {
-        c=10+(c-'A');
-        *s='0'+(c/10);
-        s++;
-        i++;
-        if (i>=maxLen) {
-          DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad IBAN (too long)");
-          return -1;
-        }
-        *s='0'+(c%10);
-        s++;
-        i++;
-      }
-      else if (isdigit(c)) {
-        *s=c;
-        s++;
-        i++;
-      }
-      else {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad IBAN (bad char)");
-        return -1;
-      }
-    }
-    p++;
-    j++;
-  } /* while */
-  if (j<len) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad IBAN (too long)");
-    return -1;
+    c=toupper(*s);
+    if (c>='0' && c<='9')
+      rem=(rem*10+(c-'0'))%97;
+    else if (c>='A' && c<='Z')
+      rem=(rem*100+(10+(c-'A')))%97;
+    else if (c!=' ')
+      return -1;
+    s++;
+    len--;
+  }
+
+  return rem;
+}
+
+
+
+int AB_Banking__GetIbanLength(const char *country)
+{
+  int lo, hi;
+
+  lo=0;
+  hi=(sizeof(ab_banking_iban_lengths)/sizeof(ab_banking_iban_lengths[0]))-1;
+  while (lo<=hi) {
+    int mid;
+    int cmp;
+
+    mid=(lo+hi)/2;
+    cmp=strncmp(country, ab_banking_iban_lengths[mid].country, 2);
+    if (cmp==0)
+      return ab_banking_iban_lengths[mid].length;
+    else if (cmp<0)
+      hi=mid-1;
+    else
+      lo=mid+1;
   }
-  *s=0;
 
   return 0;
 }
 
 
 
-int AB_Banking_CheckIban(const char *iban)
+int AB_Banking__CheckIban(const char *iban, const char **pErrMsg)
 {
-  char newIban[256];
-  char tmp[10];
-  int i;
-  unsigned int j;
   const char *p;
-  char *s;
+  int len;
+  int expectedLen;
+  int rem;
 
-  if (strlen(iban)<5) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad IBAN (too short) [%s]", iban);
+  if (!(iban[0]>='A' && iban[0]<='Z' && iban[1]>='A' && iban[1]<='Z')) {
+    *pErrMsg="country code not in upper case";
     return -1;
   }
-  p=iban;
-  if (!(*p >= 'A' && *p++ <= 'Z' && *p >= 'A' && *p++ <= 'Z')) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad IBAN (country code not in upper case) [%s]", iban);
+  if (!iban[2] || !iban[3] || !iban[4]) {
+    *pErrMsg="too short";
     return -1;
   }
-  p+=2;
 
-  /* convert IBAN+4 to buffer */
-  if (AB_Banking__TransformIban(p, strlen(p),
-                                newIban, sizeof(newIban)-1)) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
-    return -1;
+  /* count characters without spaces */
+  len=0;
+  for (p=iban; *p; p++) {
+    if (*p!=' ')
+      len++;
   }
 
-  /* append country and checksum */
-  p=iban;
-  s=newIban+strlen(newIban);
-  if (AB_Banking__TransformIban(p, 4, s, sizeof(newIban)-strlen(newIban)-1)) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+  /* BBAN first, then country code and checksum */
+  rem=AB_Banking__IbanMod97(iban+4, (p-iban)-4, 0);
+  if (rem>=0)
+    rem=AB_Banking__IbanMod97(iban, 4, rem);
+  if (rem<0) {
+    *pErrMsg="bad char";
     return -1;
   }
 
-  /* calculate checksum in 9er steps */
-  p=newIban;
-  tmp[0]=0;
-  j=0;
-  while (*p) {
-    for (i=strlen(tmp); i<9;  i++) {
-      if (!*p)
-        break;
-      tmp[i]=*(p++);
-    }
-    tmp[i]=0;
-    if (1!=sscanf(tmp, "%u", &j)) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "Bad IBAN (bad char) [%s]", iban);
-      return -1;
-    }
-    j=j%97; /* modulo 97 */
-    snprintf(tmp, sizeof(tmp), "%u", j);
-  } /* while */
+  expectedLen=AB_Banking__GetIbanLength(iban);
+  if (expectedLen && len!=expectedLen) {
+    *pErrMsg="bad length for country";
+    return 1;
+  }
 
-  if (j!=1) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad IBAN (bad checksum) [%s]", iban);
+  if (rem!=1) {
+    *pErrMsg="bad checksum";
     return 1;
   }
 
+  return 0;
+}
+
+
+
+int AB_Banking_CheckIban(const char *iban)
+{
+  const char *errMsg=NULL;
+  int rv;
+
+  rv=AB_Banking__CheckIban(iban, &errMsg);
+  if (rv!=0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad IBAN (%s) [%s]", errMsg?errMsg:"unknown", iban);
+    return rv;
+  }
+
   DBG_DEBUG(AQBANKING_LOGDOMAIN, "IBAN is valid [%s]", iban);
   return 0;
 }
 
 
 
-int AB_Banking_MakeGermanIban(const char *bankCode, const char *accountNumber, GWEN_BUFFER *ibanBuf)
+int AB_Banking__CheckIbanListJob(void *userData, int idx)
 {
-  GWEN_BUFFER *tbuf;
+  AB_BANKING_IBANLIST *il;
   int i;
-  char numbuf[32];
-  char tmp[10];
+  int last;
+
+  il=(AB_BANKING_IBANLIST *) userData;
+  i=idx*AB_BANKING_IBANLIST_JOBSIZE;
+  last=i+AB_BANKING_IBANLIST_JOBSIZE;
+  if (last>il->count)
+    last=il->count;
+
+  for (; i<last; i++) {
+    const char *errMsg=NULL;
+
+    /* no logging here, this might run in a worker thread */
+    if (il->ibans[i])
+      il->results[i]=AB_Banking__CheckIban(il->ibans[i], &errMsg);
+    else
+      il->results[i]=-1;
+  }
+
+  return 0;
+}
+
+
+
+int AB_Banking_CheckIbanList(const char **ibans, int count, int *results, int numThreads)
+{
+  AB_BANKING_IBANLIST il;
+  int numJobs;
+  int numInvalid=0;
   int rv;
-  unsigned int j;
-  const char *p;
+  int i;
 
-  /* create BBAN */
-  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  if (count<0 || (count>0 && (ibans==NULL || results==NULL))) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid arguments");
+    return GWEN_ERROR_INVALID;
+  }
+
+  il.ibans=ibans;
+  il.count=count;
+  il.results=results;
+  numJobs=(count+AB_BANKING_IBANLIST_JOBSIZE-1)/AB_BANKING_IBANLIST_JOBSIZE;
 
-  /* bank code */
-  i=strlen(bankCode);
-  if (i<8)
-    GWEN_Buffer_FillWithBytes(tbuf, '0', 8-i);
-  rv=AB_Banking__TransformIban(bankCode, strlen(bankCode), numbuf, sizeof(numbuf)-1);
+  rv=AB_WorkerPool_Run(numJobs, numThreads, AB_Banking__CheckIbanListJob, &il);
   if (rv<0) {
-    GWEN_Buffer_free(tbuf);
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad bank code (bad char) (%d)", rv);
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
     return rv;
   }
-  GWEN_Buffer_AppendString(tbuf, numbuf);
 
-  /* account number */
-  i=strlen(accountNumber);
-  if (i<10)
-    GWEN_Buffer_FillWithBytes(tbuf, '0', 10-i);
-  rv=AB_Banking__TransformIban(accountNumber, strlen(accountNumber), numbuf, sizeof(numbuf)-1);
-  if (rv<0) {
-    GWEN_Buffer_free(tbuf);
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account number (bad char) (%d)", rv);
-    return rv;
+  for (i=0; i<count; i++) {
+    if (results[i]!=0)
+      numInvalid++;
   }
-  GWEN_Buffer_AppendString(tbuf, numbuf);
-
-  /* add "DE00" */
-  GWEN_Buffer_AppendString(tbuf, "131400");
-
-  /* calculate checksum in 9er steps */
-  p=GWEN_Buffer_GetStart(tbuf);
-  tmp[0]=0;
-  j=0;
-  while (*p) {
-    for (i=strlen(tmp); i<9;  i++) {
-      if (!*p)
-        break;
-      tmp[i]=*(p++);
-    }
-    tmp[i]=0;
-    if (1!=sscanf(tmp, "%u", &j)) {
-      GWEN_Buffer_free(tbuf);
-      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad IBAN (bad char)");
-      return -1;
-    }
-    j=j%97; /* modulo 97 */
-    snprintf(tmp, sizeof(tmp), "%u", j);
-  } /* while */
-
-  /* j contains the modulus */
-  snprintf(tmp, sizeof(tmp), "%02u", 98-j);
-
-  GWEN_Buffer_AppendString(ibanBuf, "DE"); /* DE */
-  GWEN_Buffer_AppendString(ibanBuf, tmp);  /* checksum */
-  i=strlen(bankCode);                      /* bank code */
-  if (i<8)
-    GWEN_Buffer_FillWithBytes(ibanBuf, '0', 8-i);
+
+  return numInvalid;
+}
+
+
+
+int AB_Banking_MakeGermanIban(const char *bankCode, const char *accountNumber, GWEN_BUFFER *ibanBuf)
+{
+  int lenBankCode;
+  int lenAccountNumber;
+  int rem;
+  int i;
+  char checkSum[3];
+
+  lenBankCode=strlen(bankCode);
+  lenAccountNumber=strlen(accountNumber);
+
+  /* BBAN (bank code and account number padded with zeros) followed by "DE00",
+   * leading zeros of the bank code don't change the remainder */
+  rem=AB_Banking__IbanMod97(bankCode, lenBankCode, 0);
+  if (rem<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad bank code (bad char) (%d)", rem);
+    return rem;
+  }
+  for (i=lenAccountNumber; i<10; i++)
+    rem=(rem*10)%97;
+  rem=AB_Banking__IbanMod97(accountNumber, lenAccountNumber, rem);
+  if (rem<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account number (bad char) (%d)", rem);
+    return rem;
+  }
+  rem=AB_Banking__IbanMod97("131400", 6, rem);
+
+  rem=98-rem;
+  checkSum[0]='0'+(rem/10);
+  checkSum[1]='0'+(rem%10);
+  checkSum[2]=0;
+
+  GWEN_Buffer_AppendString(ibanBuf, "DE");     /* DE */
+  GWEN_Buffer_AppendString(ibanBuf, checkSum); /* checksum */
+  if (lenBankCode<8)                           /* bank code */
+    GWEN_Buffer_FillWithBytes(ibanBuf, '0', 8-lenBankCode);
   GWEN_Buffer_AppendString(ibanBuf, bankCode);
 
-  i=strlen(accountNumber);                  /* account number */
-  if (i<10)
-    GWEN_Buffer_FillWithBytes(ibanBuf, '0', 10-i);
+  if (lenAccountNumber<10)                     /* account number */
+    GWEN_Buffer_FillWithBytes(ibanBuf, '0', 10-lenAccountNumber);
   GWEN_Buffer_AppendString(ibanBuf, accountNumber);
 
 
   DBG_INFO(AQBANKING_LOGDOMAIN, "IBAN is %s", GWEN_Buffer_GetStart(ibanBuf));
-  GWEN_Buffer_free(tbuf);
   return 0;
 }
 
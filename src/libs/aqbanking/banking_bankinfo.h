@@ -105,6 +105,20 @@ AQBANKING_API AB_BANKINFO_CHECKRESULT AB_Banking_CheckAccount(AB_BANKING *ab,
 AQBANKING_API int AB_Banking_CheckIban(const char *iban);
 
 
+/**
+ * Checks a list of IBANs (see @ref AB_Banking_CheckIban).
+ * The checks can optionally be distributed over multiple threads. This function doesn't
+ * log anything about the IBANs checked.
+ * @return number of invalid IBANs (0 if all are valid), negative error code on error
+ * @param ibans array of IBANs to check
+ * @param count number of entries in ibans and results
+ * @param results array receiving the result for every IBAN (same values as returned by
+ *   @ref AB_Banking_CheckIban, a NULL entry results in -1)
+ * @param numThreads maximum number of threads to use (0 or 1 to check in the calling thread)
+ */
+AQBANKING_API int AB_Banking_CheckIbanList(const char **ibans, int count, int *results, int numThreads);
+
+
 /**
  * Create an IBAN from German bank code and account number.
  */
@@ -265,6 +265,34 @@ void AB_Banking_AddJobInfoToBuffer(const AB_TRANSACTION *t, GWEN_BUFFER *buf);
  */
 void AB_Banking_LogCmdInfoMsgForJob(const AB_BANKING *ab, const AB_TRANSACTION *t, uint32_t jid, const char *msg);
 
+/*@}*/
+
+
+
+/** @name Using AqBanking From Multiple Threads
+ *
+ */
+/*@{*/
+
+/**
+ * Prepare AqBanking for being used by multiple threads: Until the matching call to @ref AB_Banking_EndThreadedUse
+ * access to the configuration, bank info plugins and the GUI (including its log hook) is serialized. Calls may be
+ * nested (also from within the threads started), the outermost call must be made while no other thread uses AqBanking.
+ * If this function fails threads must not be used (and @ref AB_Banking_EndThreadedUse must not be called).
+ * @return 0 if ok, error code otherwise
+ */
+int AB_Banking_BeginThreadedUse(AB_BANKING *ab);
+void AB_Banking_EndThreadedUse(AB_BANKING *ab);
+
+/**
+ * Lock/unlock the recursive mutex used between @ref AB_Banking_BeginThreadedUse and @ref AB_Banking_EndThreadedUse
+ * (does nothing outside of such a section).
+ */
+void AB_Banking_Lock(const AB_BANKING *ab);
+void AB_Banking_Unlock(const AB_BANKING *ab);
+
+/*@}*/
+
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,24 @@
 
 
 
+static int _readNamedConfigGroup(const AB_BANKING *ab,
+                                 const char *groupName,
+                                 const char *subGroupName,
+                                 int doLock,
+                                 int doUnlock,
+                                 GWEN_DB_NODE **pDb);
+static int _writeNamedConfigGroup(AB_BANKING *ab,
+                                  const char *groupName,
+                                  const char *subGroupName,
+                                  int doLock,
+                                  int doUnlock,
+                                  GWEN_DB_NODE *db);
+static int _readConfigGroups(const AB_BANKING *ab,
+                             const char *groupName,
+                             const char *uidField,
+                             const char *matchVar,
+                             const char *matchVal,
+                             GWEN_DB_NODE **pDb);
 static int _readGroupsFromStringList(GWEN_CONFIGMGR *configMgr,
 				     const GWEN_STRINGLIST *sl,
 				     const char *groupName,
@@ -110,7 +128,9 @@ int AB_Banking_LoadSharedConfig(AB_BANKING *ab, const char *name, GWEN_DB_NODE *
   if (name) {
     int rv;
 
+    AB_Banking_Lock(ab);
     rv=GWEN_ConfigMgr_GetGroup(ab->configMgr, AB_CFG_GROUP_SHARED, name, pDb);
+    AB_Banking_Unlock(ab);
     if (rv<0) {
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Could not load shared group [%s] (%d)",
@@ -134,7 +154,9 @@ int AB_Banking_SaveSharedConfig(AB_BANKING *ab, const char *name, GWEN_DB_NODE *
   if (name) {
     int rv;
 
+    AB_Banking_Lock(ab);
     rv=GWEN_ConfigMgr_SetGroup(ab->configMgr, AB_CFG_GROUP_SHARED, name, db);
+    AB_Banking_Unlock(ab);
     if (rv<0) {
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Could not save shared group [%s] (%d)",
@@ -158,7 +180,9 @@ int AB_Banking_LockSharedConfig(AB_BANKING *ab, const char *name)
   if (name) {
     int rv;
 
+    AB_Banking_Lock(ab);
     rv=GWEN_ConfigMgr_LockGroup(ab->configMgr, AB_CFG_GROUP_SHARED, name);
+    AB_Banking_Unlock(ab);
     if (rv<0) {
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Could not lock shared group [%s] (%d)",
@@ -182,7 +206,9 @@ int AB_Banking_UnlockSharedConfig(AB_BANKING *ab, const char *name)
   if (name) {
     int rv;
 
+    AB_Banking_Lock(ab);
     rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, AB_CFG_GROUP_SHARED, name);
+    AB_Banking_Unlock(ab);
     if (rv<0) {
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Could not unlock shared group [%s] (%d)",
@@ -307,6 +333,23 @@ int AB_Banking_ReadNamedConfigGroup(const AB_BANKING *ab,
                                     int doLock,
                                     int doUnlock,
                                     GWEN_DB_NODE **pDb)
+{
+  int rv;
+
+  AB_Banking_Lock(ab);
+  rv=_readNamedConfigGroup(ab, groupName, subGroupName, doLock, doUnlock, pDb);
+  AB_Banking_Unlock(ab);
+  return rv;
+}
+
+
+
+int _readNamedConfigGroup(const AB_BANKING *ab,
+                          const char *groupName,
+                          const char *subGroupName,
+                          int doLock,
+                          int doUnlock,
+                          GWEN_DB_NODE **pDb)
 {
   GWEN_DB_NODE *db=NULL;
   int rv;
@@ -364,6 +407,23 @@ int AB_Banking_WriteNamedConfigGroup(AB_BANKING *ab,
 {
   int rv;
 
+  AB_Banking_Lock(ab);
+  rv=_writeNamedConfigGroup(ab, groupName, subGroupName, doLock, doUnlock, db);
+  AB_Banking_Unlock(ab);
+  return rv;
+}
+
+
+
+int _writeNamedConfigGroup(AB_BANKING *ab,
+                           const char *groupName,
+                           const char *subGroupName,
+                           int doLock,
+                           int doUnlock,
+                           GWEN_DB_NODE *db)
+{
+  int rv;
+
   assert(ab);
   assert(db);
 
@@ -448,7 +508,9 @@ int AB_Banking_HasConfigGroup(const AB_BANKING *ab,
     return rv;
   }
 
+  AB_Banking_Lock(ab);
   rv=GWEN_ConfigMgr_HasGroup(ab->configMgr, groupName, idBuf);
+  AB_Banking_Unlock(ab);
   if (rv<0) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
     return rv;
@@ -503,7 +565,9 @@ int AB_Banking_DeleteConfigGroup(AB_BANKING *ab, const char *groupName, uint32_t
   }
 
   /* unlock group */
+  AB_Banking_Lock(ab);
   rv=GWEN_ConfigMgr_DeleteGroup(ab->configMgr, groupName, idBuf);
+  AB_Banking_Unlock(ab);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to delete config group (%d)", rv);
     return rv;
@@ -528,7 +592,9 @@ int AB_Banking_UnlockConfigGroup(AB_BANKING *ab, const char *groupName, uint32_t
   }
 
   /* unlock group */
+  AB_Banking_Lock(ab);
   rv=GWEN_ConfigMgr_UnlockGroup(ab->configMgr, groupName, idBuf);
+  AB_Banking_Unlock(ab);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unable to unlock config group (%d)", rv);
     return rv;
@@ -545,6 +611,23 @@ int AB_Banking_ReadConfigGroups(const AB_BANKING *ab,
                                 const char *matchVar,
                                 const char *matchVal,
                                 GWEN_DB_NODE **pDb)
+{
+  int rv;
+
+  AB_Banking_Lock(ab);
+  rv=_readConfigGroups(ab, groupName, uidField, matchVar, matchVal, pDb);
+  AB_Banking_Unlock(ab);
+  return rv;
+}
+
+
+
+int _readConfigGroups(const AB_BANKING *ab,
+                      const char *groupName,
+                      const char *uidField,
+                      const char *matchVar,
+                      const char *matchVal,
+                      GWEN_DB_NODE **pDb)
 {
   GWEN_STRINGLIST *sl;
   int rv;
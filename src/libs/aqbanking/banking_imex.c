@@ -63,10 +63,26 @@
 
 
 
-static int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name, const char *path, GWEN_DB_NODE *dbRoot);
-static int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name, GWEN_DB_NODE *dbRoot);
-static int _readImExporterProfiles(AB_BANKING *ab, const char *path, GWEN_DB_NODE *dbRoot, int isGlobal);
-static int _readAndAddProfileFile(const char *fname, GWEN_DB_NODE *dbRoot, int isGlobal);
+static int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name, const char *path,
+                                                      AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles);
+static int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name,
+                                          AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles);
+static int _readImExporterProfiles(AB_BANKING *ab, const char *path,
+                                   AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles,
+                                   int isGlobal);
+static int _readAndAddProfileFile(const char *fname, AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles,
+                                  int isGlobal);
+static GWEN_DB_NODE *_readProfileFile(const char *fname, uint32_t dbFlags);
+static GWEN_DB_NODE *_getImExporterProfiles(AB_BANKING *ab, const char *name);
+static void _buildProfilesDb(AB_BANKING_PROFILES *profiles);
+static void _dropImExporterProfiles(AB_BANKING *ab, const char *name);
+static const GWEN_DB_NODE *_getProfileFromFile(AB_BANKING *ab, const char *fname);
+static AB_BANKING_PROFILES *AB_Banking_Profiles_new(const char *imExporterName);
+static void AB_Banking_Profiles_free(AB_BANKING_PROFILES *profiles);
+static AB_BANKING_PROFILEFILE *_addProfileFile(AB_BANKING_PROFILES *profiles, const char *fname, int isGlobal,
+                                               int64_t modTime, uint64_t fileSize);
+static int _findProfileFile(const AB_BANKING_PROFILES *profiles, const char *fname, int hint);
+static int _getProfileFileStat(const char *fname, int64_t *pModTime, uint64_t *pFileSize);
 static GWEN_DB_NODE *_getProfileFromFileOrSystem(AB_BANKING *ab,
                                                  const char *importerName,
                                                  const char *profileName,
@@ -74,6 +90,10 @@ static GWEN_DB_NODE *_getProfileFromFileOrSystem(AB_BANKING *ab,
 
 
 
+GWEN_LIST_FUNCTIONS(AB_BANKING_PROFILES, AB_Banking_Profiles)
+
+
+
 AB_IMEXPORTER *AB_Banking__CreateImExporterPlugin(AB_BANKING *ab, const char *modname)
 {
   if (modname && *modname) {
@@ -646,7 +666,8 @@ GWEN_PLUGIN_DESCRIPTION_LIST2 *AB_Banking_GetImExporterDescrs(AB_BANKING *ab)
 
 
 
-int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name, const char *path, GWEN_DB_NODE *dbRoot)
+int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name, const char *path,
+                                               AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles)
 {
   GWEN_BUFFER *buf;
   int rv;
@@ -661,7 +682,7 @@ int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name,
     return rv;
   }
   GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
-  rv=_readImExporterProfiles(ab, GWEN_Buffer_GetStart(buf), dbRoot, 1);
+  rv=_readImExporterProfiles(ab, GWEN_Buffer_GetStart(buf), profiles, oldProfiles, 1);
   if (rv && rv!=GWEN_ERROR_NOT_FOUND) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading profiles for \"%s\" from \"%s\" (%d)", name, path, rv);
     GWEN_Buffer_free(buf);
@@ -673,7 +694,8 @@ int _readGlobalProfilesForImExporterFromFolder(AB_BANKING *ab, const char *name,
 
 
 
-int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name, GWEN_DB_NODE *dbRoot)
+int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name,
+                                   AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles)
 {
   GWEN_BUFFER *buf;
   int rv;
@@ -694,7 +716,7 @@ int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name, GWEN_DB_NOD
   }
   GWEN_Buffer_AppendString(buf, DIRSEP "profiles");
 
-  rv=_readImExporterProfiles(ab, GWEN_Buffer_GetStart(buf), dbRoot, 0);
+  rv=_readImExporterProfiles(ab, GWEN_Buffer_GetStart(buf), profiles, oldProfiles, 0);
   if (rv && rv!=GWEN_ERROR_NOT_FOUND) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading users profiles");
     GWEN_Buffer_free(buf);
@@ -706,7 +728,9 @@ int _readUserProfilesForImExporter(AB_BANKING *ab, const char *name, GWEN_DB_NOD
 
 
 
-int _readImExporterProfiles(AB_BANKING *ab, const char *path, GWEN_DB_NODE *dbRoot, int isGlobal)
+int _readImExporterProfiles(AB_BANKING *ab, const char *path,
+                            AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles,
+                            int isGlobal)
 {
   GWEN_STRINGLIST *slFiles;
   int rv;
@@ -732,7 +756,7 @@ int _readImExporterProfiles(AB_BANKING *ab, const char *path, GWEN_DB_NODE *dbRo
 
       t=GWEN_StringListEntry_Data(se);
       if (t) {
-        rv=_readAndAddProfileFile(t, dbRoot, isGlobal);
+        rv=_readAndAddProfileFile(t, profiles, oldProfiles, isGlobal);
         if (rv<0) {
           DBG_INFO(AQBANKING_LOGDOMAIN, "Error reading profile file \"%s\" (%d), ignoring.", t, rv);
         }
@@ -746,50 +770,95 @@ int _readImExporterProfiles(AB_BANKING *ab, const char *path, GWEN_DB_NODE *dbRo
 
 
 
-int _readAndAddProfileFile(const char *fname, GWEN_DB_NODE *dbRoot, int isGlobal)
+int _readAndAddProfileFile(const char *fname, AB_BANKING_PROFILES *profiles, AB_BANKING_PROFILES *oldProfiles,
+                           int isGlobal)
+{
+  AB_BANKING_PROFILEFILE *pf;
+  int64_t modTime;
+  uint64_t fileSize;
+  int idx;
+  int rv;
+
+  rv=_getProfileFileStat(fname, &modTime, &fileSize);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not stat file \"%s\" (%d)", fname, rv);
+    return rv;
+  }
+
+  /* reuse the profile from the previous run if the file is unchanged */
+  idx=oldProfiles?_findProfileFile(oldProfiles, fname, profiles->fileCount):-1;
+  if (idx>=0) {
+    AB_BANKING_PROFILEFILE *oldPf;
+
+    oldPf=&(oldProfiles->files[idx]);
+    if (oldPf->isGlobal==isGlobal && oldPf->modTime==modTime && oldPf->fileSize==fileSize) {
+      pf=_addProfileFile(profiles, fname, isGlobal, modTime, fileSize);
+      pf->dbProfile=oldPf->dbProfile;
+      oldPf->dbProfile=NULL;
+      /* a file at another position might change which of two profiles with the same name wins */
+      if (idx!=profiles->fileCount-1)
+        profiles->changedFiles++;
+      return 0;
+    }
+  }
+
+  pf=_addProfileFile(profiles, fname, isGlobal, modTime, fileSize);
+  profiles->changedFiles++;
+
+  pf->dbProfile=_readProfileFile(fname, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (pf->dbProfile==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return GWEN_ERROR_GENERIC;
+  }
+  if (GWEN_DB_GetCharValue(pf->dbProfile, "name", 0, 0)==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad file \"%s\" (no profile name)", fname);
+    GWEN_DB_Group_free(pf->dbProfile);
+    pf->dbProfile=NULL;
+  }
+  else {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "File \"%s\" contains profile \"%s\"", fname,
+             GWEN_DB_GetCharValue(pf->dbProfile, "name", 0, 0));
+  }
+  return 0;
+}
+
+
+
+GWEN_DB_NODE *_readProfileFile(const char *fname, uint32_t dbFlags)
 {
   GWEN_DB_NODE *dbT;
   int rv;
-  
+
   dbT=GWEN_DB_Group_new("profile");
-  rv=GWEN_DB_ReadFile(dbT, fname, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  rv=GWEN_DB_ReadFile(dbT, fname, dbFlags);
   if (rv<0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not read file \"%s\" (%d)", fname, rv);
     GWEN_DB_Group_free(dbT);
-    return rv;
+    return NULL;
   }
-  else {
-    const char *s;
-  
-    s=GWEN_DB_GetCharValue(dbT, "name", 0, 0);
-    if (!s) {
-      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad file \"%s\" (no profile name)", fname);
-    }
-    else {
-      GWEN_DB_NODE *dbTarget;
-      DBG_INFO(AQBANKING_LOGDOMAIN, "File \"%s\" contains profile \"%s\"", fname, s);
-  
-      dbTarget=GWEN_DB_GetGroup(dbRoot, GWEN_DB_FLAGS_OVERWRITE_GROUPS, s);
-      assert(dbTarget);
-      GWEN_DB_AddGroupChildren(dbTarget, dbT);
-      GWEN_DB_SetIntValue(dbTarget, GWEN_DB_FLAGS_OVERWRITE_VARS, "isGlobal", isGlobal);
-      GWEN_DB_SetCharValue(dbTarget, GWEN_DB_FLAGS_OVERWRITE_VARS, "fileName", fname);
-    } /* if name */
-  } /* if file successfully read */
-  GWEN_DB_Group_free(dbT);
-  return 0;
+
+  return dbT;
 }
 
 
 
-GWEN_DB_NODE *AB_Banking_GetImExporterProfiles(AB_BANKING *ab, const char *name)
+GWEN_DB_NODE *_getImExporterProfiles(AB_BANKING *ab, const char *name)
 {
-  GWEN_DB_NODE *dbRoot;
+  AB_BANKING_PROFILES *oldProfiles;
+  AB_BANKING_PROFILES *profiles;
   int rv;
   GWEN_STRINGLIST *sl;
   GWEN_STRINGLISTENTRY *sentry;
 
-  dbRoot=GWEN_DB_Group_new("profiles");
+  oldProfiles=AB_Banking_Profiles_List_First(ab->imExporterProfilesList);
+  while (oldProfiles) {
+    if (strcasecmp(oldProfiles->imExporterName, name)==0)
+      break;
+    oldProfiles=AB_Banking_Profiles_List_Next(oldProfiles);
+  }
+
+  /* directories are listed again each time, but only new or modified files are read */
+  profiles=AB_Banking_Profiles_new(name);
 
   sl=AB_Banking_GetGlobalDataDirs();
   assert(sl);
@@ -803,25 +872,238 @@ GWEN_DB_NODE *AB_Banking_GetImExporterProfiles(AB_BANKING *ab, const char *name)
     pkgdatadir=GWEN_StringListEntry_Data(sentry);
     assert(pkgdatadir);
 
-    rv=_readGlobalProfilesForImExporterFromFolder(ab, name, pkgdatadir, dbRoot);
+    rv=_readGlobalProfilesForImExporterFromFolder(ab, name, pkgdatadir, profiles, oldProfiles);
     if (rv<0 && rv!=GWEN_ERROR_NOT_FOUND) {
       DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
       GWEN_StringList_free(sl);
-      GWEN_DB_Group_free(dbRoot);
-      return 0;
+      AB_Banking_Profiles_free(profiles);
+      return NULL;
     }
     sentry=GWEN_StringListEntry_Next(sentry);
   }
   GWEN_StringList_free(sl);
 
-  rv=_readUserProfilesForImExporter(ab, name, dbRoot);
+  rv=_readUserProfilesForImExporter(ab, name, profiles, oldProfiles);
   if (rv<0 && rv!=GWEN_ERROR_NOT_FOUND) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-    GWEN_DB_Group_free(dbRoot);
-    return 0;
+    AB_Banking_Profiles_free(profiles);
+    return NULL;
+  }
+
+  if (oldProfiles && oldProfiles->dbProfiles &&
+      profiles->changedFiles==0 && profiles->fileCount==oldProfiles->fileCount) {
+    /* nothing changed */
+    profiles->dbProfiles=oldProfiles->dbProfiles;
+    oldProfiles->dbProfiles=NULL;
+  }
+  else {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Profiles for \"%s\" changed (%d files read)", name, profiles->changedFiles);
+    _buildProfilesDb(profiles);
+  }
+
+  if (oldProfiles) {
+    AB_Banking_Profiles_List_Del(oldProfiles);
+    AB_Banking_Profiles_free(oldProfiles);
+  }
+  AB_Banking_Profiles_List_Add(profiles, ab->imExporterProfilesList);
+
+  return profiles->dbProfiles;
+}
+
+
+
+void _buildProfilesDb(AB_BANKING_PROFILES *profiles)
+{
+  GWEN_DB_NODE *dbRoot;
+  int idx;
+
+  dbRoot=GWEN_DB_Group_new("profiles");
+  for (idx=0; idx<profiles->fileCount; idx++) {
+    const AB_BANKING_PROFILEFILE *pf;
+
+    pf=&(profiles->files[idx]);
+    if (pf->dbProfile) {
+      GWEN_DB_NODE *dbTarget;
+
+      /* later files overwrite profiles of the same name from earlier files */
+      dbTarget=GWEN_DB_GetGroup(dbRoot, GWEN_DB_FLAGS_OVERWRITE_GROUPS, GWEN_DB_GetCharValue(pf->dbProfile, "name", 0, 0));
+      assert(dbTarget);
+      GWEN_DB_AddGroupChildren(dbTarget, pf->dbProfile);
+      GWEN_DB_SetIntValue(dbTarget, GWEN_DB_FLAGS_OVERWRITE_VARS, "isGlobal", pf->isGlobal);
+      GWEN_DB_SetCharValue(dbTarget, GWEN_DB_FLAGS_OVERWRITE_VARS, "fileName", pf->fileName);
+    }
+  }
+
+  GWEN_DB_Group_free(profiles->dbProfiles);
+  profiles->dbProfiles=dbRoot;
+}
+
+
+
+void _dropImExporterProfiles(AB_BANKING *ab, const char *name)
+{
+  AB_BANKING_PROFILES *profiles;
+
+  profiles=AB_Banking_Profiles_List_First(ab->imExporterProfilesList);
+  while (profiles) {
+    if (strcasecmp(profiles->imExporterName, name)==0) {
+      AB_Banking_Profiles_List_Del(profiles);
+      AB_Banking_Profiles_free(profiles);
+      break;
+    }
+    profiles=AB_Banking_Profiles_List_Next(profiles);
+  }
+}
+
+
+
+const GWEN_DB_NODE *_getProfileFromFile(AB_BANKING *ab, const char *fname)
+{
+  AB_BANKING_PROFILEFILE *pf;
+  int64_t modTime;
+  uint64_t fileSize;
+  GWEN_DB_NODE *dbProfile;
+  int idx;
+  int rv;
+
+  rv=_getProfileFileStat(fname, &modTime, &fileSize);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not stat file \"%s\" (%d)", fname, rv);
+    return NULL;
+  }
+
+  if (ab->profileFiles==NULL)
+    ab->profileFiles=AB_Banking_Profiles_new(NULL);
+
+  idx=_findProfileFile(ab->profileFiles, fname, 0);
+  if (idx>=0) {
+    pf=&(ab->profileFiles->files[idx]);
+    if (pf->modTime==modTime && pf->fileSize==fileSize)
+      return pf->dbProfile;
+  }
+
+  dbProfile=_readProfileFile(fname, GWEN_DB_FLAGS_DEFAULT);
+  if (dbProfile==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here");
+    return NULL;
+  }
+
+  if (idx>=0) {
+    pf=&(ab->profileFiles->files[idx]);
+    GWEN_DB_Group_free(pf->dbProfile);
+    pf->modTime=modTime;
+    pf->fileSize=fileSize;
+  }
+  else
+    pf=_addProfileFile(ab->profileFiles, fname, 0, modTime, fileSize);
+  pf->dbProfile=dbProfile;
+
+  return dbProfile;
+}
+
+
+
+AB_BANKING_PROFILES *AB_Banking_Profiles_new(const char *imExporterName)
+{
+  AB_BANKING_PROFILES *profiles;
+
+  GWEN_NEW_OBJECT(AB_BANKING_PROFILES, profiles);
+  GWEN_LIST_INIT(AB_BANKING_PROFILES, profiles);
+  if (imExporterName)
+    profiles->imExporterName=strdup(imExporterName);
+
+  return profiles;
+}
+
+
+
+void AB_Banking_Profiles_free(AB_BANKING_PROFILES *profiles)
+{
+  if (profiles) {
+    int idx;
+
+    for (idx=0; idx<profiles->fileCount; idx++) {
+      free(profiles->files[idx].fileName);
+      GWEN_DB_Group_free(profiles->files[idx].dbProfile);
+    }
+    free(profiles->files);
+    GWEN_DB_Group_free(profiles->dbProfiles);
+    free(profiles->imExporterName);
+    GWEN_LIST_FINI(AB_BANKING_PROFILES, profiles);
+    GWEN_FREE_OBJECT(profiles);
+  }
+}
+
+
+
+AB_BANKING_PROFILEFILE *_addProfileFile(AB_BANKING_PROFILES *profiles, const char *fname, int isGlobal,
+                                        int64_t modTime, uint64_t fileSize)
+{
+  AB_BANKING_PROFILEFILE *pf;
+
+  if (profiles->fileCount>=profiles->fileSlots) {
+    profiles->fileSlots=profiles->fileSlots?(profiles->fileSlots*2):16;
+    profiles->files=(AB_BANKING_PROFILEFILE *) realloc(profiles->files,
+                                                       profiles->fileSlots*sizeof(AB_BANKING_PROFILEFILE));
+    assert(profiles->files);
+  }
+
+  pf=&(profiles->files[profiles->fileCount++]);
+  memset(pf, 0, sizeof(AB_BANKING_PROFILEFILE));
+  pf->fileName=strdup(fname);
+  pf->isGlobal=isGlobal;
+  pf->modTime=modTime;
+  pf->fileSize=fileSize;
+
+  return pf;
+}
+
+
+
+int _findProfileFile(const AB_BANKING_PROFILES *profiles, const char *fname, int hint)
+{
+  int idx;
+
+  /* usually files are listed in the same order as before */
+  if (hint<profiles->fileCount && strcmp(profiles->files[hint].fileName, fname)==0)
+    return hint;
+
+  for (idx=0; idx<profiles->fileCount; idx++) {
+    if (strcmp(profiles->files[idx].fileName, fname)==0)
+      return idx;
+  }
+
+  return -1;
+}
+
+
+
+int _getProfileFileStat(const char *fname, int64_t *pModTime, uint64_t *pFileSize)
+{
+  struct stat st;
+
+  if (stat(fname, &st)!=0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "stat(%s): %s", fname, strerror(errno));
+    return GWEN_ERROR_IO;
   }
+  *pModTime=(int64_t) st.st_mtime;
+  *pFileSize=(uint64_t) st.st_size;
+  return 0;
+}
+
 
-  return dbRoot;
+
+GWEN_DB_NODE *AB_Banking_GetImExporterProfiles(AB_BANKING *ab, const char *name)
+{
+  GWEN_DB_NODE *dbProfiles;
+
+  AB_Banking_Lock(ab);
+  dbProfiles=_getImExporterProfiles(ab, name);
+  if (dbProfiles)
+    dbProfiles=GWEN_DB_Group_dup(dbProfiles);
+  AB_Banking_Unlock(ab);
+
+  return dbProfiles;
 }
 
 
@@ -908,6 +1190,11 @@ int AB_Banking_SaveLocalImExporterProfile(AB_BANKING *ab,
   }
   GWEN_Buffer_free(buf);
 
+  /* the file might have been rewritten within the resolution of its mtime, so don't rely on it here */
+  AB_Banking_Lock(ab);
+  _dropImExporterProfiles(ab, imexporterName);
+  AB_Banking_Unlock(ab);
+
   return 0;
 }
 
@@ -1021,11 +1308,11 @@ GWEN_DB_NODE *AB_Banking_GetImExporterProfile(AB_BANKING *ab,
                                               const char *profileName)
 {
   GWEN_DB_NODE *dbProfiles;
+  GWEN_DB_NODE *dbProfile=NULL;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  AB_Banking_Lock(ab);
+  dbProfiles=_getImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
-    GWEN_DB_NODE *dbProfile;
-
     dbProfile=GWEN_DB_GetFirstGroup(dbProfiles);
     while (dbProfile) {
       const char *name;
@@ -1040,22 +1327,18 @@ GWEN_DB_NODE *AB_Banking_GetImExporterProfile(AB_BANKING *ab,
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Profile \"%s\" for exporter \"%s\" not found",
                 profileName, imExporterName);
-      GWEN_DB_Group_free(dbProfiles);
-      return NULL;
     }
-
-    GWEN_DB_UnlinkGroup(dbProfile);
-    GWEN_DB_Group_free(dbProfiles);
-    return dbProfile;
+    else
+      dbProfile=GWEN_DB_Group_dup(dbProfile);
   }
   else {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "No profiles found for exporter \"%s\"",
               imExporterName);
-    return NULL;
   }
+  AB_Banking_Unlock(ab);
 
-  return NULL;
+  return dbProfile;
 }
 
 
@@ -1068,11 +1351,11 @@ GWEN_DB_NODE *AB_Banking_FindMatchingSwiftImExporterProfile(AB_BANKING *ab,
                                                             int version3)
 {
   GWEN_DB_NODE *dbProfiles;
+  GWEN_DB_NODE *dbProfile=NULL;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  AB_Banking_Lock(ab);
+  dbProfiles=_getImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
-    GWEN_DB_NODE *dbProfile;
-
     dbProfile=GWEN_DB_GetFirstGroup(dbProfiles);
     while (dbProfile) {
       const char *name;
@@ -1097,22 +1380,18 @@ GWEN_DB_NODE *AB_Banking_FindMatchingSwiftImExporterProfile(AB_BANKING *ab,
                 "Profile \"%s.%03d.%03d.%02d\" for exporter \"%s\" not found",
                 family, version1, version2, version3,
                 imExporterName);
-      GWEN_DB_Group_free(dbProfiles);
-      return NULL;
     }
-
-    GWEN_DB_UnlinkGroup(dbProfile);
-    GWEN_DB_Group_free(dbProfiles);
-    return dbProfile;
+    else
+      dbProfile=GWEN_DB_Group_dup(dbProfile);
   }
   else {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "No profiles found for exporter \"%s\"",
               imExporterName);
-    return NULL;
   }
+  AB_Banking_Unlock(ab);
 
-  return NULL;
+  return dbProfile;
 }
 
 
@@ -1120,11 +1399,12 @@ GWEN_DB_NODE *AB_Banking_FindMatchingSwiftImExporterProfile(AB_BANKING *ab,
 AB_SWIFT_DESCR_LIST *AB_Banking_GetSwiftDescriptorsForImExporter(AB_BANKING *ab, const char *imExporterName)
 {
   GWEN_DB_NODE *dbProfiles;
+  AB_SWIFT_DESCR_LIST *descrList=NULL;
 
-  dbProfiles=AB_Banking_GetImExporterProfiles(ab, imExporterName);
+  AB_Banking_Lock(ab);
+  dbProfiles=_getImExporterProfiles(ab, imExporterName);
   if (dbProfiles) {
     GWEN_DB_NODE *dbProfile;
-    AB_SWIFT_DESCR_LIST *descrList;
 
     descrList=AB_SwiftDescr_List_new();
     dbProfile=GWEN_DB_GetFirstGroup(dbProfiles);
@@ -1144,23 +1424,20 @@ AB_SWIFT_DESCR_LIST *AB_Banking_GetSwiftDescriptorsForImExporter(AB_BANKING *ab,
 
       dbProfile=GWEN_DB_GetNextGroup(dbProfile);
     }
-    GWEN_DB_Group_free(dbProfiles);
 
     if (AB_SwiftDescr_List_GetCount(descrList)==0) {
       AB_SwiftDescr_List_free(descrList);
-      return NULL;
+      descrList=NULL;
     }
-
-    return descrList;
   }
   else {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "No profiles found for exporter \"%s\"",
               imExporterName);
-    return NULL;
   }
+  AB_Banking_Unlock(ab);
 
-  return NULL;
+  return descrList;
 }
 
 
@@ -1173,13 +1450,15 @@ GWEN_DB_NODE *_getProfileFromFileOrSystem(AB_BANKING *ab,
   GWEN_DB_NODE *dbProfile=NULL;
 
   if (profileFile && *profileFile) {
-    int rv;
-
-    dbProfile=GWEN_DB_Group_new("profile");
-    rv=GWEN_DB_ReadFile(dbProfile, profileFile, GWEN_DB_FLAGS_DEFAULT);
-    if (rv<0) {
-      DBG_INFO(GWEN_LOGDOMAIN, "here (%d)", rv);
-      GWEN_DB_Group_free(dbProfile);
+    const GWEN_DB_NODE *dbCachedProfile;
+
+    AB_Banking_Lock(ab);
+    dbCachedProfile=_getProfileFromFile(ab, profileFile);
+    if (dbCachedProfile)
+      dbProfile=GWEN_DB_Group_dup(dbCachedProfile);
+    AB_Banking_Unlock(ab);
+    if (dbProfile==NULL) {
+      DBG_INFO(GWEN_LOGDOMAIN, "here");
       return NULL;
     }
   }
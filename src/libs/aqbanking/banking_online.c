@@ -66,6 +66,12 @@ static int _sendProviderQueues(AB_BANKING *ab,
                                AB_PROVIDERQUEUE_LIST *pql,
                                AB_IMEXPORTER_CONTEXT *ctx,
                                uint32_t pid);
+static int _sendProviderQueuesParallel(AB_BANKING *ab,
+                                       AB_PROVIDERQUEUE_LIST *pql,
+                                       AB_IMEXPORTER_CONTEXT *ctx,
+                                       int numThreads,
+                                       uint32_t pid);
+static int _sendProviderQueueJob(void *userData, int idx);
 static GWEN_CRYPT_TOKEN *_findCryptToken(AB_BANKING *ab, const char *tname, const char *cname);
 static GWEN_CRYPT_TOKEN *_createCryptTokenObject(AB_BANKING *ab, const char *tname, const char *cname);
 
@@ -330,11 +336,13 @@ int AB_Banking_GetCryptToken(AB_BANKING *ab, const char *tname, const char *cnam
     return GWEN_ERROR_GENERIC;
   }
 
+  AB_Banking_Lock(ab);
   ct=_findCryptToken(ab, tname, cname);
   if (ct==NULL) {
     ct=_createCryptTokenObject(ab, tname, cname);
     if (ct==0) {
       DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not create crypt token");
+      AB_Banking_Unlock(ab);
       return GWEN_ERROR_IO;
     }
 
@@ -348,6 +356,7 @@ int AB_Banking_GetCryptToken(AB_BANKING *ab, const char *tname, const char *cnam
     /* add to internal list */
     GWEN_Crypt_Token_List2_PushBack(ab->cryptTokenList, ct);
   }
+  AB_Banking_Unlock(ab);
 
   *pCt=ct;
   return 0;
@@ -723,8 +732,13 @@ int _sendProviderQueues(AB_BANKING *ab,
                         uint32_t pid)
 {
   AB_PROVIDERQUEUE *pq;
+  int numThreads;
   int rv;
 
+  numThreads=AB_Banking_RuntimeConfig_GetIntValue(ab, "sendCommandsThreads", 0);
+  if (numThreads>1 && AB_WorkerPool_HasThreads() && AB_ProviderQueue_List_GetCount(pql)>1)
+    return _sendProviderQueuesParallel(ab, pql, ctx, numThreads, pid);
+
   pq=AB_ProviderQueue_List_First(pql);
   while (pq) {
     AB_PROVIDERQUEUE *pqNext;
@@ -766,6 +780,97 @@ int _sendProviderQueues(AB_BANKING *ab,
 
 
 
+int _sendProviderQueuesParallel(AB_BANKING *ab,
+                                AB_PROVIDERQUEUE_LIST *pql,
+                                AB_IMEXPORTER_CONTEXT *ctx,
+                                int numThreads,
+                                uint32_t pid)
+{
+  AB_BANKING_SENDJOB *jobs;
+  AB_PROVIDERQUEUE *pq;
+  int numJobs=0;
+  int threaded;
+  int i;
+  int rv;
+
+  jobs=(AB_BANKING_SENDJOB *) calloc(AB_ProviderQueue_List_GetCount(pql), sizeof(AB_BANKING_SENDJOB));
+  assert(jobs);
+
+  /* start using providers (reading their config is not done in parallel) */
+  while ((pq=AB_ProviderQueue_List_First(pql))) {
+    const char *providerName;
+
+    AB_ProviderQueue_List_Del(pq);
+    providerName=AB_ProviderQueue_GetProviderName(pq);
+    if (providerName && *providerName) {
+      AB_PROVIDER *pro;
+
+      pro=AB_Banking_BeginUseProvider(ab, providerName);
+      if (pro) {
+        jobs[numJobs].providerQueue=pq;
+        jobs[numJobs].provider=pro;
+        jobs[numJobs].context=AB_ImExporterContext_new();
+        jobs[numJobs].pid=pid;
+        numJobs++;
+        continue;
+      }
+      GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Info, I18N("Provider \"%s\" is not available."), providerName);
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Could not start using provider \"%s\"", providerName);
+    }
+    AB_ProviderQueue_free(pq);
+  }
+
+  /* send commands, serialize access to GUI and configuration while jobs are running */
+  rv=AB_Banking_BeginThreadedUse(ab);
+  threaded=(rv==0);
+  if (!threaded) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Threads not available, sending provider queues one after the other (%d)", rv);
+    numThreads=1;
+  }
+  if (numThreads>numJobs)
+    numThreads=numJobs;
+  DBG_INFO(AQBANKING_LOGDOMAIN, "Sending %d provider queues using %d threads", numJobs, numThreads);
+  rv=AB_WorkerPool_Run(numJobs, numThreads, _sendProviderQueueJob, jobs);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+  }
+  if (threaded)
+    AB_Banking_EndThreadedUse(ab);
+
+  /* collect results in the order of the provider queues */
+  for (i=0; i<numJobs; i++) {
+    const char *providerName;
+
+    providerName=AB_Provider_GetName(jobs[i].provider);
+    if (jobs[i].result<0) {
+      GWEN_Gui_ProgressLog2(pid, GWEN_LoggerLevel_Error, I18N("Error sending commands to provider \"%s\":%d"), providerName,
+                            jobs[i].result);
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Error sending commands to provider \"%s\" (%d)", providerName, jobs[i].result);
+    }
+    AB_ImExporterContext_AddContext(ctx, jobs[i].context);
+    AB_Banking_EndUseProvider(ab, jobs[i].provider);
+    AB_ProviderQueue_free(jobs[i].providerQueue);
+  }
+  free(jobs);
+
+  return 0;
+}
+
+
+
+int _sendProviderQueueJob(void *userData, int idx)
+{
+  AB_BANKING_SENDJOB *job;
+
+  job=((AB_BANKING_SENDJOB *) userData)+idx;
+  GWEN_Gui_ProgressLog2(job->pid, GWEN_LoggerLevel_Info, I18N("Send commands to provider \"%s\""),
+                        AB_Provider_GetName(job->provider));
+  job->result=AB_Provider_SendCommands(job->provider, job->providerQueue, job->context);
+  return 0;
+}
+
+
+
 
 uint32_t AB_Banking_ReserveJobId(AB_BANKING *ab)
 {
@@ -14,6 +14,9 @@
 
 #define AB_BANKING_MAX_PIN_TRY 10
 
+/* number of IBANs checked by a single job in AB_Banking_CheckIbanList() */
+#define AB_BANKING_IBANLIST_JOBSIZE 256
+
 #define AB_BANKING_REGKEY_PATHS       "Software\\AqBanking\\Paths"
 #define AB_BANKING_REGKEY_DATADIR     "pkgdatadir"
 #define AB_BANKING_REGKEY_BANKINFODIR "bankinfodir"
@@ -51,12 +54,40 @@
 #include "backendsupport/provider_l.h"
 #include "backendsupport/imexporter_l.h"
 #include "backendsupport/bankinfoplugin_l.h"
+#include "backendsupport/workerpool_l.h"
+#include "backendsupport/mutex_l.h"
 
 #include <gwenhywfar/plugin.h>
 #include <gwenhywfar/syncio_memory.h>
 
 
 
+/* a parsed imexporter profile file, used to skip reading files which didn't change */
+typedef struct AB_BANKING_PROFILEFILE AB_BANKING_PROFILEFILE;
+struct AB_BANKING_PROFILEFILE {
+  char *fileName;
+  int isGlobal;
+  int64_t modTime;
+  uint64_t fileSize;
+  GWEN_DB_NODE *dbProfile;  /* NULL if the file could not be read or contains no profile name */
+};
+
+
+/* cached profiles of an imexporter (see banking_imex.c) */
+typedef struct AB_BANKING_PROFILES AB_BANKING_PROFILES;
+GWEN_LIST_FUNCTION_DEFS(AB_BANKING_PROFILES, AB_Banking_Profiles)
+struct AB_BANKING_PROFILES {
+  GWEN_LIST_ELEMENT(AB_BANKING_PROFILES)
+  char *imExporterName;
+  AB_BANKING_PROFILEFILE *files;  /* in reading order */
+  int fileCount;
+  int fileSlots;
+  int changedFiles;               /* files read or moved while revalidating */
+  GWEN_DB_NODE *dbProfiles;       /* profiles of all files, as returned by AB_Banking_GetImExporterProfiles() */
+};
+
+
+
 struct AB_BANKING {
   GWEN_INHERIT_ELEMENT(AB_BANKING)
   int initCount;
@@ -76,6 +107,12 @@ struct AB_BANKING {
   GWEN_CONFIGMGR *configMgr;
 
   GWEN_DB_NODE *dbRuntimeConfig;
+
+  AB_BANKING_PROFILES_LIST *imExporterProfilesList;
+  AB_BANKING_PROFILES *profileFiles; /* profile files given by path (imExporterName is NULL) */
+
+  AB_MUTEX *mutex; /* only set while threads are used (see AB_Banking_BeginThreadedUse) */
+  int threadedUseCount;
 };
 
 
@@ -93,7 +130,27 @@ static AB_BANKINFO_PLUGIN *AB_Banking_FindBankInfoPlugin(AB_BANKING *ab, const c
 static AB_BANKINFO_PLUGIN *AB_Banking_GetBankInfoPlugin(AB_BANKING *ab, const char *country);
 
 
-static int AB_Banking__TransformIban(const char *iban, int len, char *newIban, int maxLen);
+typedef struct AB_BANKING_IBANLIST AB_BANKING_IBANLIST;
+struct AB_BANKING_IBANLIST {
+  const char **ibans;
+  int count;
+  int *results;
+};
+
+static int AB_Banking__IbanMod97(const char *s, int len, int rem);
+static int AB_Banking__GetIbanLength(const char *country);
+static int AB_Banking__CheckIban(const char *iban, const char **pErrMsg);
+static int AB_Banking__CheckIbanListJob(void *userData, int idx);
+
+
+typedef struct AB_BANKING_SENDJOB AB_BANKING_SENDJOB;
+struct AB_BANKING_SENDJOB {
+  AB_PROVIDERQUEUE *providerQueue;
+  AB_PROVIDER *provider;
+  AB_IMEXPORTER_CONTEXT *context;
+  uint32_t pid;
+  int result;
+};
 
 
 
@@ -0,0 +1,550 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "serialgui_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/error.h>
+#include <gwenhywfar/inherit.h>
+#include <gwenhywfar/memory.h>
+
+
+
+GWEN_INHERIT(GWEN_GUI, AB_SERIALGUI)
+
+
+
+/* install wrapperFn, remember the callback it replaces unless that is the wrapper itself (i.e. already wrapped) */
+#define AB_SERIALGUI_WRAP(fnType, setFn, wrapperFn, origFn) { \
+    fnType fn; \
+    fn=setFn(gui, wrapperFn); \
+    if (fn!=wrapperFn) \
+      xgui->origFn=fn; \
+  }
+
+/* restore the original callback unless the wrapper has been replaced in the meantime (keep the new callback then) */
+#define AB_SERIALGUI_RESTORE(fnType, setFn, wrapperFn, origFn) { \
+    fnType fn; \
+    fn=setFn(gui, xgui->origFn); \
+    if (fn!=wrapperFn) \
+      setFn(gui, fn); \
+  }
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void GWENHYWFAR_CB _freeData(void *bp, void *p);
+static void _wrapCallbacks(GWEN_GUI *gui, AB_SERIALGUI *xgui);
+
+static int GWENHYWFAR_CB _messageBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text,
+                                     const char *b1, const char *b2, const char *b3, uint32_t guiid);
+static int GWENHYWFAR_CB _inputBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text,
+                                   char *buffer, int minLen, int maxLen, uint32_t guiid);
+static uint32_t GWENHYWFAR_CB _showBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text, uint32_t guiid);
+static void GWENHYWFAR_CB _hideBox(GWEN_GUI *gui, uint32_t id);
+static uint32_t GWENHYWFAR_CB _progressStart(GWEN_GUI *gui, uint32_t progressFlags, const char *title, const char *text,
+                                             uint64_t total, uint32_t guiid);
+static int GWENHYWFAR_CB _progressAdvance(GWEN_GUI *gui, uint32_t id, uint64_t progress);
+static int GWENHYWFAR_CB _progressSetTotal(GWEN_GUI *gui, uint32_t id, uint64_t total);
+static int GWENHYWFAR_CB _progressLog(GWEN_GUI *gui, uint32_t id, GWEN_LOGGER_LEVEL level, const char *text);
+static int GWENHYWFAR_CB _progressEnd(GWEN_GUI *gui, uint32_t id);
+static int GWENHYWFAR_CB _print(GWEN_GUI *gui, const char *docTitle, const char *docType, const char *descr,
+                                const char *text, uint32_t guiid);
+static int GWENHYWFAR_CB _getPassword(GWEN_GUI *gui, uint32_t flags, const char *token, const char *title,
+                                      const char *text, char *buffer, int minLen, int maxLen,
+                                      GWEN_GUI_PASSWORD_METHOD methodId, GWEN_DB_NODE *methodParams, uint32_t guiid);
+static int GWENHYWFAR_CB _setPasswordStatus(GWEN_GUI *gui, const char *token, const char *pin,
+                                            GWEN_GUI_PASSWORD_STATUS status, uint32_t guiid);
+static int GWENHYWFAR_CB _checkCert(GWEN_GUI *gui, const GWEN_SSLCERTDESCR *cd, GWEN_SYNCIO *sio, uint32_t guiid);
+static int GWENHYWFAR_CB _execDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid);
+static int GWENHYWFAR_CB _openDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid);
+static int GWENHYWFAR_CB _closeDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg);
+static int GWENHYWFAR_CB _runDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, int untilEnd);
+static int GWENHYWFAR_CB _readDialogPrefs(GWEN_GUI *gui, const char *groupName, const char *altName, GWEN_DB_NODE **pDb);
+static int GWENHYWFAR_CB _writeDialogPrefs(GWEN_GUI *gui, const char *groupName, GWEN_DB_NODE *db);
+static int GWENHYWFAR_CB _getFileName(GWEN_GUI *gui, const char *caption, GWEN_GUI_FILENAME_TYPE fnt, uint32_t flags,
+                                      const char *patterns, GWEN_BUFFER *pathBuffer, uint32_t guiid);
+static int GWENHYWFAR_CB _getSyncIo(GWEN_GUI *gui, const char *url, const char *defaultProto, int defaultPort, GWEN_SYNCIO **pSio);
+static int GWENHYWFAR_CB _logHook(GWEN_GUI *gui, const char *logDomain, GWEN_LOGGER_LEVEL priority, const char *s);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+void AB_SerialGui_Extend(GWEN_GUI *gui, AB_MUTEX *mutex)
+{
+  AB_SERIALGUI *xgui;
+
+  assert(gui);
+  if (GWEN_INHERIT_ISOFTYPE(GWEN_GUI, AB_SERIALGUI, gui)) {
+    /* already extended: only wrap callbacks which have been set since */
+    xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+    AB_Mutex_Lock(xgui->mutex);
+    _wrapCallbacks(gui, xgui);
+    AB_Mutex_Unlock(xgui->mutex);
+    return;
+  }
+
+  GWEN_NEW_OBJECT(AB_SERIALGUI, xgui);
+  GWEN_INHERIT_SETDATA(GWEN_GUI, AB_SERIALGUI, gui, xgui, _freeData);
+  xgui->mutex=mutex;
+  _wrapCallbacks(gui, xgui);
+}
+
+
+
+void AB_SerialGui_Unextend(GWEN_GUI *gui)
+{
+  AB_SERIALGUI *xgui;
+
+  assert(gui);
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+
+  AB_SERIALGUI_RESTORE(GWEN_GUI_MESSAGEBOX_FN, GWEN_Gui_SetMessageBoxFn, _messageBox, messageBoxFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_INPUTBOX_FN, GWEN_Gui_SetInputBoxFn, _inputBox, inputBoxFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_SHOWBOX_FN, GWEN_Gui_SetShowBoxFn, _showBox, showBoxFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_HIDEBOX_FN, GWEN_Gui_SetHideBoxFn, _hideBox, hideBoxFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PROGRESS_START_FN, GWEN_Gui_SetProgressStartFn, _progressStart, progressStartFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PROGRESS_ADVANCE_FN, GWEN_Gui_SetProgressAdvanceFn, _progressAdvance, progressAdvanceFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PROGRESS_SETTOTAL_FN, GWEN_Gui_SetProgressSetTotalFn, _progressSetTotal, progressSetTotalFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PROGRESS_LOG_FN, GWEN_Gui_SetProgressLogFn, _progressLog, progressLogFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PROGRESS_END_FN, GWEN_Gui_SetProgressEndFn, _progressEnd, progressEndFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_PRINT_FN, GWEN_Gui_SetPrintFn, _print, printFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_GETPASSWORD_FN, GWEN_Gui_SetGetPasswordFn, _getPassword, getPasswordFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_SETPASSWORDSTATUS_FN, GWEN_Gui_SetSetPasswordStatusFn, _setPasswordStatus, setPasswordStatusFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_CHECKCERT_FN, GWEN_Gui_SetCheckCertFn, _checkCert, checkCertFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_EXEC_DIALOG_FN, GWEN_Gui_SetExecDialogFn, _execDialog, execDialogFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_OPEN_DIALOG_FN, GWEN_Gui_SetOpenDialogFn, _openDialog, openDialogFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_CLOSE_DIALOG_FN, GWEN_Gui_SetCloseDialogFn, _closeDialog, closeDialogFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_RUN_DIALOG_FN, GWEN_Gui_SetRunDialogFn, _runDialog, runDialogFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_READ_DIALOG_PREFS_FN, GWEN_Gui_SetReadDialogPrefsFn, _readDialogPrefs, readDialogPrefsFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_WRITE_DIALOG_PREFS_FN, GWEN_Gui_SetWriteDialogPrefsFn, _writeDialogPrefs, writeDialogPrefsFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_GET_FILENAME_FN, GWEN_Gui_SetGetFileNameFn, _getFileName, getFileNameFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_GETSYNCIO_FN, GWEN_Gui_SetGetSyncIoFn, _getSyncIo, getSyncIoFn);
+  AB_SERIALGUI_RESTORE(GWEN_GUI_LOG_HOOK_FN, GWEN_Gui_SetLogHookFn, _logHook, logHookFn);
+
+  GWEN_INHERIT_UNLINK(GWEN_GUI, AB_SERIALGUI, gui);
+  GWEN_FREE_OBJECT(xgui);
+}
+
+
+
+void GWENHYWFAR_CB _freeData(void *bp, void *p)
+{
+  AB_SERIALGUI *xgui;
+
+  xgui=(AB_SERIALGUI *) p;
+  GWEN_FREE_OBJECT(xgui);
+}
+
+
+
+/* Unset callbacks are wrapped as well, their wrappers return what GWEN_GUI returns without a callback.
+ * Not wrapped is the socket wait callback (it blocks while waiting for the network io which the jobs are supposed
+ * to do in parallel).
+ * GWEN_GUI skips the log hook while it is already running (recursion guard), so a message logged by another thread
+ * while the hook holds the lock goes to the default logger instead of being handed to the hook.
+ */
+void _wrapCallbacks(GWEN_GUI *gui, AB_SERIALGUI *xgui)
+{
+  AB_SERIALGUI_WRAP(GWEN_GUI_MESSAGEBOX_FN, GWEN_Gui_SetMessageBoxFn, _messageBox, messageBoxFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_INPUTBOX_FN, GWEN_Gui_SetInputBoxFn, _inputBox, inputBoxFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_SHOWBOX_FN, GWEN_Gui_SetShowBoxFn, _showBox, showBoxFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_HIDEBOX_FN, GWEN_Gui_SetHideBoxFn, _hideBox, hideBoxFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PROGRESS_START_FN, GWEN_Gui_SetProgressStartFn, _progressStart, progressStartFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PROGRESS_ADVANCE_FN, GWEN_Gui_SetProgressAdvanceFn, _progressAdvance, progressAdvanceFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PROGRESS_SETTOTAL_FN, GWEN_Gui_SetProgressSetTotalFn, _progressSetTotal, progressSetTotalFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PROGRESS_LOG_FN, GWEN_Gui_SetProgressLogFn, _progressLog, progressLogFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PROGRESS_END_FN, GWEN_Gui_SetProgressEndFn, _progressEnd, progressEndFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_PRINT_FN, GWEN_Gui_SetPrintFn, _print, printFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_GETPASSWORD_FN, GWEN_Gui_SetGetPasswordFn, _getPassword, getPasswordFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_SETPASSWORDSTATUS_FN, GWEN_Gui_SetSetPasswordStatusFn, _setPasswordStatus, setPasswordStatusFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_CHECKCERT_FN, GWEN_Gui_SetCheckCertFn, _checkCert, checkCertFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_EXEC_DIALOG_FN, GWEN_Gui_SetExecDialogFn, _execDialog, execDialogFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_OPEN_DIALOG_FN, GWEN_Gui_SetOpenDialogFn, _openDialog, openDialogFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_CLOSE_DIALOG_FN, GWEN_Gui_SetCloseDialogFn, _closeDialog, closeDialogFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_RUN_DIALOG_FN, GWEN_Gui_SetRunDialogFn, _runDialog, runDialogFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_READ_DIALOG_PREFS_FN, GWEN_Gui_SetReadDialogPrefsFn, _readDialogPrefs, readDialogPrefsFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_WRITE_DIALOG_PREFS_FN, GWEN_Gui_SetWriteDialogPrefsFn, _writeDialogPrefs, writeDialogPrefsFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_GET_FILENAME_FN, GWEN_Gui_SetGetFileNameFn, _getFileName, getFileNameFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_GETSYNCIO_FN, GWEN_Gui_SetGetSyncIoFn, _getSyncIo, getSyncIoFn);
+  AB_SERIALGUI_WRAP(GWEN_GUI_LOG_HOOK_FN, GWEN_Gui_SetLogHookFn, _logHook, logHookFn);
+}
+
+
+
+int GWENHYWFAR_CB _messageBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text,
+                              const char *b1, const char *b2, const char *b3, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->messageBoxFn)
+    rv=xgui->messageBoxFn(gui, flags, title, text, b1, b2, b3, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _inputBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text,
+                            char *buffer, int minLen, int maxLen, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->inputBoxFn)
+    rv=xgui->inputBoxFn(gui, flags, title, text, buffer, minLen, maxLen, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+uint32_t GWENHYWFAR_CB _showBox(GWEN_GUI *gui, uint32_t flags, const char *title, const char *text, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  uint32_t id=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->showBoxFn)
+    id=xgui->showBoxFn(gui, flags, title, text, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return id;
+}
+
+
+
+void GWENHYWFAR_CB _hideBox(GWEN_GUI *gui, uint32_t id)
+{
+  AB_SERIALGUI *xgui;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->hideBoxFn)
+    xgui->hideBoxFn(gui, id);
+  AB_Mutex_Unlock(xgui->mutex);
+}
+
+
+
+uint32_t GWENHYWFAR_CB _progressStart(GWEN_GUI *gui, uint32_t progressFlags, const char *title, const char *text,
+                                      uint64_t total, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  uint32_t id=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->progressStartFn)
+    id=xgui->progressStartFn(gui, progressFlags, title, text, total, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return id;
+}
+
+
+
+int GWENHYWFAR_CB _progressAdvance(GWEN_GUI *gui, uint32_t id, uint64_t progress)
+{
+  AB_SERIALGUI *xgui;
+  int rv=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->progressAdvanceFn)
+    rv=xgui->progressAdvanceFn(gui, id, progress);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _progressSetTotal(GWEN_GUI *gui, uint32_t id, uint64_t total)
+{
+  AB_SERIALGUI *xgui;
+  int rv=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->progressSetTotalFn)
+    rv=xgui->progressSetTotalFn(gui, id, total);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _progressLog(GWEN_GUI *gui, uint32_t id, GWEN_LOGGER_LEVEL level, const char *text)
+{
+  AB_SERIALGUI *xgui;
+  int rv=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->progressLogFn)
+    rv=xgui->progressLogFn(gui, id, level, text);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _progressEnd(GWEN_GUI *gui, uint32_t id)
+{
+  AB_SERIALGUI *xgui;
+  int rv=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->progressEndFn)
+    rv=xgui->progressEndFn(gui, id);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _print(GWEN_GUI *gui, const char *docTitle, const char *docType, const char *descr,
+                         const char *text, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->printFn)
+    rv=xgui->printFn(gui, docTitle, docType, descr, text, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _getPassword(GWEN_GUI *gui, uint32_t flags, const char *token, const char *title,
+                               const char *text, char *buffer, int minLen, int maxLen,
+                               GWEN_GUI_PASSWORD_METHOD methodId, GWEN_DB_NODE *methodParams, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->getPasswordFn)
+    rv=xgui->getPasswordFn(gui, flags, token, title, text, buffer, minLen, maxLen, methodId, methodParams, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _setPasswordStatus(GWEN_GUI *gui, const char *token, const char *pin,
+                                     GWEN_GUI_PASSWORD_STATUS status, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->setPasswordStatusFn)
+    rv=xgui->setPasswordStatusFn(gui, token, pin, status, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _checkCert(GWEN_GUI *gui, const GWEN_SSLCERTDESCR *cd, GWEN_SYNCIO *sio, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->checkCertFn)
+    rv=xgui->checkCertFn(gui, cd, sio, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _execDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->execDialogFn)
+    rv=xgui->execDialogFn(gui, dlg, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _openDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->openDialogFn)
+    rv=xgui->openDialogFn(gui, dlg, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _closeDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->closeDialogFn)
+    rv=xgui->closeDialogFn(gui, dlg);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _runDialog(GWEN_GUI *gui, GWEN_DIALOG *dlg, int untilEnd)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->runDialogFn)
+    rv=xgui->runDialogFn(gui, dlg, untilEnd);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _readDialogPrefs(GWEN_GUI *gui, const char *groupName, const char *altName, GWEN_DB_NODE **pDb)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->readDialogPrefsFn)
+    rv=xgui->readDialogPrefsFn(gui, groupName, altName, pDb);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _writeDialogPrefs(GWEN_GUI *gui, const char *groupName, GWEN_DB_NODE *db)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->writeDialogPrefsFn)
+    rv=xgui->writeDialogPrefsFn(gui, groupName, db);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _getFileName(GWEN_GUI *gui, const char *caption, GWEN_GUI_FILENAME_TYPE fnt, uint32_t flags,
+                               const char *patterns, GWEN_BUFFER *pathBuffer, uint32_t guiid)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->getFileNameFn)
+    rv=xgui->getFileNameFn(gui, caption, fnt, flags, patterns, pathBuffer, guiid);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+int GWENHYWFAR_CB _getSyncIo(GWEN_GUI *gui, const char *url, const char *defaultProto, int defaultPort, GWEN_SYNCIO **pSio)
+{
+  AB_SERIALGUI *xgui;
+  int rv=GWEN_ERROR_NOT_IMPLEMENTED;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->getSyncIoFn)
+    rv=xgui->getSyncIoFn(gui, url, defaultProto, defaultPort, pSio);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
+
+
+
+/* returns 0 without a hook, so GWEN_GUI logs the message itself */
+int GWENHYWFAR_CB _logHook(GWEN_GUI *gui, const char *logDomain, GWEN_LOGGER_LEVEL priority, const char *s)
+{
+  AB_SERIALGUI *xgui;
+  int rv=0;
+
+  xgui=GWEN_INHERIT_GETDATA(GWEN_GUI, AB_SERIALGUI, gui);
+  assert(xgui);
+  AB_Mutex_Lock(xgui->mutex);
+  if (xgui->logHookFn)
+    rv=xgui->logHookFn(gui, logDomain, priority, s);
+  AB_Mutex_Unlock(xgui->mutex);
+  return rv;
+}
@@ -0,0 +1,32 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AQBANKING_SERIALGUI_L_H
+#define AQBANKING_SERIALGUI_L_H
+
+
+#include "aqbanking/backendsupport/mutex_l.h"
+
+#include <gwenhywfar/gui_be.h>
+
+
+/**
+ * Temporarily extend the given GUI so that calls to its callbacks (boxes, progress, passwords, certificates,
+ * dialogs, dialog preferences, file names, io layers and the log hook) are serialized using the given mutex. This allows jobs
+ * running in worker threads to use the GUI.
+ * Calling this again for an extended GUI wraps the callbacks set in the meantime.
+ */
+void AB_SerialGui_Extend(GWEN_GUI *gui, AB_MUTEX *mutex);
+
+/**
+ * Restore the original callbacks of a GUI extended by @ref AB_SerialGui_Extend.
+ */
+void AB_SerialGui_Unextend(GWEN_GUI *gui);
+
+
+#endif
@@ -0,0 +1,408 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "imexporter_accountinfo_index_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/memory.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _addEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai);
+static void _setHashes(AB_ACCOUNTINFO_INDEXENTRY *e);
+static int _isInList(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_ACCOUNTINFO_INDEXENTRY *e);
+static void _linkEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int i);
+static void _appendToChain(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int *slots, int *(*nextFn)(AB_ACCOUNTINFO_INDEXENTRY *e),
+                           uint32_t hash, int i);
+static int *_nextById(AB_ACCOUNTINFO_INDEXENTRY *e);
+static int *_nextByIban(AB_ACCOUNTINFO_INDEXENTRY *e);
+static int *_nextByBank(AB_ACCOUNTINFO_INDEXENTRY *e);
+static void _resizeSlots(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t slotCount);
+static uint32_t _hashString(uint32_t hash, const char *s);
+static uint32_t _hashBankCodeAndAccountNumber(const char *bankCode, const char *accountNumber);
+static uint32_t _hashUint32(uint32_t v);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO_INDEX *AB_ImExporterAccountInfoIndex_new(void)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx;
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_ACCOUNTINFO_INDEX, idx);
+  _resizeSlots(idx, AB_IMEXPORTER_ACCOUNTINFO_INDEX_SLOTS);
+  return idx;
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_free(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx)
+{
+  if (idx) {
+    AB_ImExporterAccountInfoIndex_Clear(idx);
+    free(idx->entries);
+    free(idx->idSlots);
+    free(idx->ibanSlots);
+    free(idx->bankSlots);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Clear(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx)
+{
+  uint32_t i;
+
+  assert(idx);
+  for (i=0; i<idx->entryCount; i++)
+    AB_ImExporterAccountInfo_free(idx->entries[i].accountInfo);
+  idx->entryCount=0;
+  idx->accountInfoCount=0;
+  idx->stale=0;
+  idx->list=NULL;
+  for (i=0; i<idx->slotCount; i++) {
+    idx->idSlots[i]=-1;
+    idx->ibanSlots[i]=-1;
+    idx->bankSlots[i]=-1;
+  }
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Sync(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l)
+{
+  assert(idx);
+  if (l==NULL) {
+    if (idx->list)
+      AB_ImExporterAccountInfoIndex_Clear(idx);
+  }
+  else if (idx->list!=l || idx->stale || idx->accountInfoCount!=(uint32_t) AB_ImExporterAccountInfo_List_GetCount(l)) {
+    AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "Rebuilding account info index");
+    AB_ImExporterAccountInfoIndex_Clear(idx);
+    idx->list=l;
+    ai=AB_ImExporterAccountInfo_List_First(l);
+    while (ai) {
+      AB_ImExporterAccountInfoIndex_Add(idx, ai);
+      ai=AB_ImExporterAccountInfo_List_Next(ai);
+    }
+  }
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Add(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  assert(idx);
+  assert(ai);
+  _addEntry(idx, ai);
+  idx->accountInfoCount++;
+}
+
+
+
+void AB_ImExporterAccountInfoIndex_Reindex(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  uint32_t i;
+
+  assert(idx);
+  assert(ai);
+  for (i=0; i<idx->entryCount; i++) {
+    if (idx->entries[i].accountInfo==ai) {
+      _setHashes(&(idx->entries[i]));
+      /* relink all entries to move this one to the chains for its new ids */
+      _resizeSlots(idx, idx->slotCount);
+      return;
+    }
+  }
+  _addEntry(idx, ai);
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByAccountId(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                        uint32_t uniqueId)
+{
+  uint32_t hash;
+  int i;
+
+  assert(idx);
+  hash=_hashUint32(uniqueId);
+  i=idx->idSlots[hash & (idx->slotCount-1)];
+  while (i>=0) {
+    const AB_ACCOUNTINFO_INDEXENTRY *e;
+
+    e=&(idx->entries[i]);
+    /* ids might have changed since the entry was added, so always compare the current values */
+    if (e->idHash==hash && AB_ImExporterAccountInfo_GetAccountId(e->accountInfo)==uniqueId && _isInList(idx, e))
+      return e->accountInfo;
+    i=e->nextById;
+  }
+  return NULL;
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByIban(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                   const char *iban)
+{
+  uint32_t hash;
+  int i;
+
+  assert(idx);
+  if (iban==NULL)
+    iban="";
+  hash=_hashString(AB_IMEXPORTER_ACCOUNTINFO_INDEX_HASH_INIT, iban);
+  i=idx->ibanSlots[hash & (idx->slotCount-1)];
+  while (i>=0) {
+    const AB_ACCOUNTINFO_INDEXENTRY *e;
+    const char *s;
+
+    e=&(idx->entries[i]);
+    s=AB_ImExporterAccountInfo_GetIban(e->accountInfo);
+    if (e->ibanHash==hash && strcasecmp(s?s:"", iban)==0 && _isInList(idx, e))
+      return e->accountInfo;
+    i=e->nextByIban;
+  }
+  return NULL;
+}
+
+
+
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByBankCodeAndAccountNumber(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+    const char *bankCode,
+    const char *accountNumber,
+    int accountType)
+{
+  uint32_t hash;
+  int i;
+
+  assert(idx);
+  if (bankCode==NULL)
+    bankCode="";
+  if (accountNumber==NULL)
+    accountNumber="";
+  hash=_hashBankCodeAndAccountNumber(bankCode, accountNumber);
+  i=idx->bankSlots[hash & (idx->slotCount-1)];
+  while (i>=0) {
+    const AB_ACCOUNTINFO_INDEXENTRY *e;
+
+    e=&(idx->entries[i]);
+    if (e->bankHash==hash) {
+      const char *sBankCode;
+      const char *sAccountNumber;
+
+      sBankCode=AB_ImExporterAccountInfo_GetBankCode(e->accountInfo);
+      sAccountNumber=AB_ImExporterAccountInfo_GetAccountNumber(e->accountInfo);
+      if (strcasecmp(sBankCode?sBankCode:"", bankCode)==0 &&
+          strcasecmp(sAccountNumber?sAccountNumber:"", accountNumber)==0 &&
+          (accountType<=AB_AccountType_Unknown || accountType==AB_ImExporterAccountInfo_GetAccountType(e->accountInfo)) &&
+          _isInList(idx, e))
+        return e->accountInfo;
+    }
+    i=e->nextByBank;
+  }
+  return NULL;
+}
+
+
+
+void _addEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai)
+{
+  AB_ACCOUNTINFO_INDEXENTRY *e;
+
+  if (idx->entryCount>=idx->entrySize) {
+    uint32_t newSize;
+
+    newSize=idx->entrySize?(idx->entrySize*2):AB_IMEXPORTER_ACCOUNTINFO_INDEX_SLOTS;
+    idx->entries=(AB_ACCOUNTINFO_INDEXENTRY *) realloc(idx->entries, newSize*sizeof(AB_ACCOUNTINFO_INDEXENTRY));
+    assert(idx->entries);
+    idx->entrySize=newSize;
+  }
+
+  AB_ImExporterAccountInfo_Attach(ai);
+  e=&(idx->entries[idx->entryCount]);
+  e->accountInfo=ai;
+  _setHashes(e);
+  idx->entryCount++;
+
+  /* keep the load factor below 1 */
+  if (idx->entryCount>idx->slotCount)
+    _resizeSlots(idx, idx->slotCount*2);
+  else
+    _linkEntry(idx, idx->entryCount-1);
+}
+
+
+
+
+void _setHashes(AB_ACCOUNTINFO_INDEXENTRY *e)
+{
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+
+  ai=e->accountInfo;
+  e->idHash=_hashUint32(AB_ImExporterAccountInfo_GetAccountId(ai));
+  e->ibanHash=_hashString(AB_IMEXPORTER_ACCOUNTINFO_INDEX_HASH_INIT, AB_ImExporterAccountInfo_GetIban(ai));
+  e->bankHash=_hashBankCodeAndAccountNumber(AB_ImExporterAccountInfo_GetBankCode(ai),
+                                            AB_ImExporterAccountInfo_GetAccountNumber(ai));
+}
+
+
+
+/*
+ * Account infos might have been removed from the list directly, those have no predecessor and are not the first
+ * element of the list. Such a hit marks the index stale so that the next sync rebuilds it.
+ */
+int _isInList(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_ACCOUNTINFO_INDEXENTRY *e)
+{
+  if (AB_ImExporterAccountInfo_List_Previous(e->accountInfo) ||
+      (idx->list && AB_ImExporterAccountInfo_List_First(idx->list)==e->accountInfo))
+    return 1;
+  DBG_DEBUG(AQBANKING_LOGDOMAIN, "Account info no longer in the indexed list");
+  idx->stale=1;
+  return 0;
+}
+
+
+void _linkEntry(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int i)
+{
+  AB_ACCOUNTINFO_INDEXENTRY *e;
+  const char *s;
+
+  e=&(idx->entries[i]);
+  e->nextById=-1;
+  e->nextByIban=-1;
+  e->nextByBank=-1;
+
+  /* don't index empty ids, those are never looked up */
+  if (AB_ImExporterAccountInfo_GetAccountId(e->accountInfo))
+    _appendToChain(idx, idx->idSlots, _nextById, e->idHash, i);
+  s=AB_ImExporterAccountInfo_GetIban(e->accountInfo);
+  if (s && *s)
+    _appendToChain(idx, idx->ibanSlots, _nextByIban, e->ibanHash, i);
+  _appendToChain(idx, idx->bankSlots, _nextByBank, e->bankHash, i);
+}
+
+
+
+/* append to the end of the chain so that lookups find the account info added first (like a list search would) */
+void _appendToChain(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, int *slots, int *(*nextFn)(AB_ACCOUNTINFO_INDEXENTRY *e),
+                    uint32_t hash, int i)
+{
+  int *pNext;
+
+  pNext=&(slots[hash & (idx->slotCount-1)]);
+  while (*pNext>=0)
+    pNext=nextFn(&(idx->entries[*pNext]));
+  *pNext=i;
+}
+
+
+
+int *_nextById(AB_ACCOUNTINFO_INDEXENTRY *e)
+{
+  return &(e->nextById);
+}
+
+
+
+int *_nextByIban(AB_ACCOUNTINFO_INDEXENTRY *e)
+{
+  return &(e->nextByIban);
+}
+
+
+
+int *_nextByBank(AB_ACCOUNTINFO_INDEXENTRY *e)
+{
+  return &(e->nextByBank);
+}
+
+
+
+void _resizeSlots(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, uint32_t slotCount)
+{
+  uint32_t i;
+
+  idx->idSlots=(int *) realloc(idx->idSlots, slotCount*sizeof(int));
+  idx->ibanSlots=(int *) realloc(idx->ibanSlots, slotCount*sizeof(int));
+  idx->bankSlots=(int *) realloc(idx->bankSlots, slotCount*sizeof(int));
+  assert(idx->idSlots && idx->ibanSlots && idx->bankSlots);
+  idx->slotCount=slotCount;
+  for (i=0; i<slotCount; i++) {
+    idx->idSlots[i]=-1;
+    idx->ibanSlots[i]=-1;
+    idx->bankSlots[i]=-1;
+  }
+
+  /* relink all entries in their original order */
+  for (i=0; i<idx->entryCount; i++)
+    _linkEntry(idx, i);
+}
+
+
+
+/* FNV-1a, case-insensitive since ids are compared using strcasecmp() */
+uint32_t _hashString(uint32_t hash, const char *s)
+{
+  if (s) {
+    while (*s) {
+      hash^=(uint32_t) tolower((unsigned char) *(s++));
+      hash*=16777619u;
+    }
+  }
+  return hash;
+}
+
+
+
+uint32_t _hashBankCodeAndAccountNumber(const char *bankCode, const char *accountNumber)
+{
+  uint32_t hash;
+
+  hash=_hashString(AB_IMEXPORTER_ACCOUNTINFO_INDEX_HASH_INIT, bankCode);
+  hash^=0xff; /* separator */
+  hash*=16777619u;
+  return _hashString(hash, accountNumber);
+}
+
+
+
+uint32_t _hashUint32(uint32_t v)
+{
+  v^=v>>16;
+  v*=0x7feb352du;
+  v^=v>>15;
+  v*=0x846ca68bu;
+  v^=v>>16;
+  return v;
+}
+
+
+
@@ -0,0 +1,21 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_ACCOUNTINFO_INDEX_H
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_H
+
+
+/**
+ * Lookup index over the account infos of an AB_IMEXPORTER_CONTEXT (by unique account id, IBAN and
+ * bank code/account number). This is used internally by the context, there is no public API for it.
+ */
+typedef struct AB_IMEXPORTER_ACCOUNTINFO_INDEX AB_IMEXPORTER_ACCOUNTINFO_INDEX;
+
+
+#endif
+
@@ -0,0 +1,54 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_ACCOUNTINFO_INDEX_L_H
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_L_H
+
+#include <aqbanking/types/imexporter_accountinfo_index.h>
+#include <aqbanking/types/imexporter_accountinfo.h>
+
+
+AB_IMEXPORTER_ACCOUNTINFO_INDEX *AB_ImExporterAccountInfoIndex_new(void);
+void AB_ImExporterAccountInfoIndex_free(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx);
+
+/**
+ * Make sure the index is built for the given list. The index is rebuilt if the list has been replaced, the index has
+ * been cleared, the number of elements of the list changed behind the back of the index or a lookup found an
+ * account info which has been removed from the list.
+ * Lookups never return account infos removed from the list, so removing an account info and adding another one
+ * directly on the list (leaving the number unchanged) can't make the index return a wrong result.
+ */
+void AB_ImExporterAccountInfoIndex_Sync(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, const AB_IMEXPORTER_ACCOUNTINFO_LIST *l);
+
+void AB_ImExporterAccountInfoIndex_Clear(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx);
+
+/**
+ * Add an account info which has just been added to the indexed list. The index keeps a reference to the object
+ * (see @ref AB_ImExporterAccountInfo_Attach).
+ */
+void AB_ImExporterAccountInfoIndex_Add(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai);
+
+/**
+ * Register an account info which is already in the indexed list under its current ids (used when the ids of an
+ * account info have changed since it was added). An existing entry for the account info is updated, otherwise a new
+ * one is added.
+ */
+void AB_ImExporterAccountInfoIndex_Reindex(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx, AB_IMEXPORTER_ACCOUNTINFO *ai);
+
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByAccountId(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                        uint32_t uniqueId);
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByIban(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+                                                                   const char *iban);
+AB_IMEXPORTER_ACCOUNTINFO *AB_ImExporterAccountInfoIndex_GetByBankCodeAndAccountNumber(AB_IMEXPORTER_ACCOUNTINFO_INDEX *idx,
+    const char *bankCode,
+    const char *accountNumber,
+    int accountType);
+
+
+#endif
+
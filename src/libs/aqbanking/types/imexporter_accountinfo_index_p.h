@@ -0,0 +1,53 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_ACCOUNTINFO_INDEX_P_H
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_P_H
+
+#include "imexporter_accountinfo_index_l.h"
+
+
+/* initial number of slots of the hash tables (must be a power of 2) */
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_SLOTS 64
+
+/* start value for string hashes (FNV-1a offset basis) */
+#define AB_IMEXPORTER_ACCOUNTINFO_INDEX_HASH_INIT 2166136261u
+
+
+/** index entry for an account info under the ids it had when added */
+typedef struct AB_ACCOUNTINFO_INDEXENTRY AB_ACCOUNTINFO_INDEXENTRY;
+struct AB_ACCOUNTINFO_INDEXENTRY {
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;
+  uint32_t idHash;
+  uint32_t ibanHash;
+  uint32_t bankHash;
+  int nextById;                            /* next entry in the same slot (-1 for end of chain) */
+  int nextByIban;
+  int nextByBank;
+};
+
+
+struct AB_IMEXPORTER_ACCOUNTINFO_INDEX {
+  const AB_IMEXPORTER_ACCOUNTINFO_LIST *list; /* list the index has been built for */
+  uint32_t accountInfoCount;                  /* number of account infos of that list in the index */
+  int stale;                                  /* a lookup hit an account info no longer in the list */
+
+  AB_ACCOUNTINFO_INDEXENTRY *entries;
+  uint32_t entryCount;
+  uint32_t entrySize;
+
+  /* hash tables: first entry per slot (-1 if none) */
+  int *idSlots;
+  int *ibanSlots;
+  int *bankSlots;
+  uint32_t slotCount;
+};
+
+
+#endif
+
@@ -0,0 +1,1430 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "imexporter_context_bin_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/db.h>
+
+#include <assert.h>
+#include <string.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _appendUint32(GWEN_BUFFER *buf, uint32_t v);
+static void _setUint32At(GWEN_BUFFER *buf, uint32_t pos, uint32_t v);
+static uint32_t _peekUint32(const uint8_t *p);
+
+static AB_CTXBIN_NAMETABLE *_nameTableNew(void);
+static void _nameTableFree(AB_CTXBIN_NAMETABLE *nt);
+static uint32_t _nameTableGetIndex(AB_CTXBIN_NAMETABLE *nt, const char *name);
+static void _nameTableGrow(AB_CTXBIN_NAMETABLE *nt);
+static uint32_t _hashName(const char *s);
+
+static int _writeGroup(GWEN_DB_NODE *db, AB_CTXBIN_NAMETABLE *nt, GWEN_BUFFER *buf, int level);
+static void _writeVar(GWEN_DB_NODE *dbVar, AB_CTXBIN_NAMETABLE *nt, GWEN_BUFFER *buf);
+
+static int _readChunk(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len, uint32_t *pUsed);
+static int _openChunk(AB_CTXBIN_READER *rd, const uint8_t *ptr, uint32_t len, uint32_t *pUsed);
+static int _readGroup(AB_CTXBIN_READER *rd, GWEN_DB_NODE *db, int level);
+static int _readVar(AB_CTXBIN_READER *rd, GWEN_DB_NODE *db);
+static int _readUint32(AB_CTXBIN_READER *rd, uint32_t *pValue);
+static int _readName(AB_CTXBIN_READER *rd, const char **pName);
+static int _skipGroup(AB_CTXBIN_READER *rd, int level);
+static int _skipVar(AB_CTXBIN_READER *rd, const char **pName, const char **pFirstCharValue);
+static int _scanTransaction(AB_CTXBIN_READER *rd, int level, char *dateBuf);
+
+static int _indexChunk(AB_IMEXPORTER_CONTEXT_INDEX *idx, AB_CTXBIN_READER *rd, uint32_t chunk);
+static int _indexAccountInfo(AB_IMEXPORTER_CONTEXT_INDEX *idx, AB_CTXBIN_READER *rd, uint32_t chunk);
+static int _indexTransactionList(AB_CTXBIN_INDEXENTRY *entry, AB_CTXBIN_READER *rd);
+static int _readIndexEntry(const AB_IMEXPORTER_CONTEXT_INDEX *idx,
+                           const AB_CTXBIN_INDEXENTRY *entry,
+                           const char *fromDate,
+                           const char *toDate,
+                           AB_IMEXPORTER_ACCOUNTINFO **pAi);
+static int _readTransactionListInRange(AB_CTXBIN_READER *rd, GWEN_DB_NODE *dbList, const char *fromDate, const char *toDate);
+static void _dateRangeToStrings(const GWEN_DATE *fromDate, const GWEN_DATE *toDate, char *fromBuf, char *toBuf);
+
+static int _readTextAccountInfos(AB_IMEXPORTER_CONTEXT *ctx,
+                                 const uint8_t *ptr,
+                                 uint32_t len,
+                                 uint32_t uniqueId,
+                                 const char *country,
+                                 const char *bankId,
+                                 const char *accountNumber,
+                                 const char *subAccountId,
+                                 const char *iban,
+                                 const char *currency,
+                                 int ty,
+                                 const char *fromDate,
+                                 const char *toDate);
+static void _dropTransactionsOutOfRange(AB_IMEXPORTER_ACCOUNTINFO *ai, const char *fromDate, const char *toDate);
+
+static void _mergeContext(AB_IMEXPORTER_CONTEXT *ctx, AB_IMEXPORTER_CONTEXT *ctxSrc);
+static void _mergeAccountInfo(AB_IMEXPORTER_ACCOUNTINFO *ai, AB_IMEXPORTER_ACCOUNTINFO *aiSrc);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+int AB_ImExporterContext_IsBinary(const uint8_t *ptr, uint32_t len)
+{
+  if (ptr && len>=AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE &&
+      memcmp(ptr, AB_IMEXPORTER_CONTEXT_BIN_MAGIC, 4)==0)
+    return 1;
+  return 0;
+}
+
+
+
+int AB_ImExporterContext_WriteBinary(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_BUFFER *destBuf)
+{
+  GWEN_DB_NODE *dbCtx;
+  AB_CTXBIN_NAMETABLE *nt;
+  GWEN_BUFFER *bodyBuf;
+  uint32_t headerPos;
+  int rv;
+
+  assert(ctx);
+  assert(destBuf);
+
+  dbCtx=GWEN_DB_Group_new("context");
+  rv=AB_ImExporterContext_toDb(ctx, dbCtx);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_DB_Group_free(dbCtx);
+    return rv;
+  }
+
+  nt=_nameTableNew();
+  bodyBuf=GWEN_Buffer_new(0, 64*1024, 0, 1);
+  rv=_writeGroup(dbCtx, nt, bodyBuf, 0);
+  GWEN_DB_Group_free(dbCtx);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_Buffer_free(bodyBuf);
+    _nameTableFree(nt);
+    return rv;
+  }
+
+  /* header */
+  headerPos=GWEN_Buffer_GetUsedBytes(destBuf);
+  GWEN_Buffer_AppendBytes(destBuf, AB_IMEXPORTER_CONTEXT_BIN_MAGIC, 4);
+  GWEN_Buffer_AppendByte(destBuf, AB_IMEXPORTER_CONTEXT_BIN_VERSION);
+  GWEN_Buffer_AppendByte(destBuf, 0);
+  GWEN_Buffer_AppendByte(destBuf, 0);
+  GWEN_Buffer_AppendByte(destBuf, 0);
+  _appendUint32(destBuf, nt->nameCount);
+  _appendUint32(destBuf, GWEN_Buffer_GetUsedBytes(nt->tableBuffer));
+  _appendUint32(destBuf, GWEN_Buffer_GetUsedBytes(bodyBuf));
+  assert(GWEN_Buffer_GetUsedBytes(destBuf)-headerPos==AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE);
+
+  /* string table and body */
+  GWEN_Buffer_AppendBytes(destBuf, GWEN_Buffer_GetStart(nt->tableBuffer), GWEN_Buffer_GetUsedBytes(nt->tableBuffer));
+  GWEN_Buffer_AppendBytes(destBuf, GWEN_Buffer_GetStart(bodyBuf), GWEN_Buffer_GetUsedBytes(bodyBuf));
+
+  GWEN_Buffer_free(bodyBuf);
+  _nameTableFree(nt);
+  return 0;
+}
+
+
+
+int AB_ImExporterContext_ReadBinary(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len)
+{
+  assert(ctx);
+
+  if (!AB_ImExporterContext_IsBinary(ptr, len)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Not a binary context");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  while (len) {
+    uint32_t used=0;
+    int rv;
+
+    rv=_readChunk(ctx, ptr, len, &used);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    ptr+=used;
+    len-=used;
+  }
+
+  return 0;
+}
+
+
+
+int AB_ImExporterContext_ReadAll(GWEN_SYNCIO *sio, GWEN_BUFFER *destBuf)
+{
+  for (;;) {
+    int rv;
+
+    GWEN_Buffer_AllocRoom(destBuf, 4096);
+    rv=GWEN_SyncIo_Read(sio,
+                        (uint8_t *) GWEN_Buffer_GetPosPointer(destBuf),
+                        GWEN_Buffer_GetMaxUnsegmentedWrite(destBuf));
+    if (rv==0 || rv==GWEN_ERROR_EOF)
+      break;
+    else if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    GWEN_Buffer_IncrementPos(destBuf, rv);
+    GWEN_Buffer_AdjustUsedBytes(destBuf);
+  }
+
+  return 0;
+}
+
+
+
+int _writeGroup(GWEN_DB_NODE *db, AB_CTXBIN_NAMETABLE *nt, GWEN_BUFFER *buf, int level)
+{
+  GWEN_DB_NODE *dbC;
+  uint32_t countPos;
+  uint32_t varCount=0;
+  uint32_t groupCount=0;
+
+  if (level>AB_IMEXPORTER_CONTEXT_BIN_MAXLEVEL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "DB too deep (%d)", level);
+    return GWEN_ERROR_INVALID;
+  }
+
+  /* counts are filled in when known */
+  countPos=GWEN_Buffer_GetUsedBytes(buf);
+  _appendUint32(buf, 0);
+  _appendUint32(buf, 0);
+
+  dbC=GWEN_DB_GetFirstVar(db);
+  while (dbC) {
+    _writeVar(dbC, nt, buf);
+    varCount++;
+    dbC=GWEN_DB_GetNextVar(dbC);
+  }
+
+  dbC=GWEN_DB_GetFirstGroup(db);
+  while (dbC) {
+    int rv;
+
+    _appendUint32(buf, _nameTableGetIndex(nt, GWEN_DB_GroupName(dbC)));
+    rv=_writeGroup(dbC, nt, buf, level+1);
+    if (rv<0)
+      return rv;
+    groupCount++;
+    dbC=GWEN_DB_GetNextGroup(dbC);
+  }
+
+  _setUint32At(buf, countPos, varCount);
+  _setUint32At(buf, countPos+4, groupCount);
+  return 0;
+}
+
+
+
+void _writeVar(GWEN_DB_NODE *dbVar, AB_CTXBIN_NAMETABLE *nt, GWEN_BUFFER *buf)
+{
+  GWEN_DB_NODE *dbV;
+  uint32_t countPos;
+  uint32_t valueCount=0;
+
+  _appendUint32(buf, _nameTableGetIndex(nt, GWEN_DB_VariableName(dbVar)));
+  countPos=GWEN_Buffer_GetUsedBytes(buf);
+  _appendUint32(buf, 0);
+
+  dbV=GWEN_DB_GetFirstValue(dbVar);
+  while (dbV) {
+    switch (GWEN_DB_GetValueType(dbV)) {
+    case GWEN_DB_NodeType_ValueChar: {
+      const char *s;
+      uint32_t len;
+
+      s=GWEN_DB_GetCharValueFromNode(dbV);
+      len=s?strlen(s):0;
+      GWEN_Buffer_AppendByte(buf, AB_IMEXPORTER_CONTEXT_BIN_VALUE_CHAR);
+      _appendUint32(buf, len);
+      if (len)
+        GWEN_Buffer_AppendBytes(buf, s, len);
+      GWEN_Buffer_AppendByte(buf, 0);
+      valueCount++;
+      break;
+    }
+
+    case GWEN_DB_NodeType_ValueInt:
+      GWEN_Buffer_AppendByte(buf, AB_IMEXPORTER_CONTEXT_BIN_VALUE_INT);
+      _appendUint32(buf, (uint32_t) GWEN_DB_GetIntValueFromNode(dbV));
+      valueCount++;
+      break;
+
+    case GWEN_DB_NodeType_ValueBin: {
+      const void *p;
+      unsigned int len=0;
+
+      p=GWEN_DB_GetBinValueFromNode(dbV, &len);
+      GWEN_Buffer_AppendByte(buf, AB_IMEXPORTER_CONTEXT_BIN_VALUE_BIN);
+      _appendUint32(buf, len);
+      if (p && len)
+        GWEN_Buffer_AppendBytes(buf, (const char *) p, len);
+      valueCount++;
+      break;
+    }
+
+    default:
+      /* pointers can't be stored */
+      break;
+    }
+    dbV=GWEN_DB_GetNextValue(dbV);
+  }
+
+  _setUint32At(buf, countPos, valueCount);
+}
+
+
+
+int _readChunk(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len, uint32_t *pUsed)
+{
+  AB_CTXBIN_READER rd;
+  AB_IMEXPORTER_CONTEXT *ctxChunk;
+  GWEN_DB_NODE *dbCtx;
+  int rv;
+
+  rv=_openChunk(&rd, ptr, len, pUsed);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  dbCtx=GWEN_DB_Group_new("context");
+  rv=_readGroup(&rd, dbCtx, 0);
+  free(rd.names);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_DB_Group_free(dbCtx);
+    return rv;
+  }
+
+  ctxChunk=AB_ImExporterContext_fromDb(dbCtx);
+  GWEN_DB_Group_free(dbCtx);
+  if (ctxChunk==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "No context in binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  _mergeContext(ctx, ctxChunk);
+  AB_ImExporterContext_free(ctxChunk);
+
+  return 0;
+}
+
+
+
+/* checks the chunk header and prepares the reader for the body, the caller must free rd->names */
+int _openChunk(AB_CTXBIN_READER *rd, const uint8_t *ptr, uint32_t len, uint32_t *pUsed)
+{
+  const char *s;
+  uint32_t nameCount;
+  uint32_t tableSize;
+  uint32_t bodySize;
+  uint32_t i;
+
+  if (!AB_ImExporterContext_IsBinary(ptr, len)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad chunk in binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (ptr[4]!=AB_IMEXPORTER_CONTEXT_BIN_VERSION) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Unsupported version %d of binary context data", ptr[4]);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  nameCount=_peekUint32(ptr+8);
+  tableSize=_peekUint32(ptr+12);
+  bodySize=_peekUint32(ptr+16);
+  if (tableSize>len-AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE ||
+      bodySize>len-AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE-tableSize ||
+      nameCount>tableSize ||
+      (tableSize && ptr[AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE+tableSize-1]!=0)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad chunk header in binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  /* the names are used directly from the string table */
+  rd->names=(const char **) malloc((nameCount?nameCount:1)*sizeof(const char *));
+  rd->nameCount=nameCount;
+  s=(const char *)(ptr+AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE);
+  for (i=0; i<nameCount; i++) {
+    if (s>=(const char *)(ptr+AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE+tableSize)) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad string table in binary context data");
+      free(rd->names);
+      rd->names=NULL;
+      return GWEN_ERROR_BAD_DATA;
+    }
+    rd->names[i]=s;
+    s+=strlen(s)+1;
+  }
+
+  rd->pos=ptr+AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE+tableSize;
+  rd->end=rd->pos+bodySize;
+  *pUsed=AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE+tableSize+bodySize;
+  return 0;
+}
+
+
+
+int _readGroup(AB_CTXBIN_READER *rd, GWEN_DB_NODE *db, int level)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+
+  if (level>AB_IMEXPORTER_CONTEXT_BIN_MAXLEVEL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "DB too deep (%d)", level);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  for (i=0; i<varCount; i++) {
+    int rv;
+
+    rv=_readVar(rd, db);
+    if (rv<0)
+      return rv;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    GWEN_DB_NODE *dbGroup;
+    const char *name;
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    dbGroup=GWEN_DB_Group_new(name);
+    GWEN_DB_AddGroup(db, dbGroup);
+    rv=_readGroup(rd, dbGroup, level+1);
+    if (rv<0)
+      return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _readVar(AB_CTXBIN_READER *rd, GWEN_DB_NODE *db)
+{
+  const char *name;
+  uint32_t valueCount;
+  uint32_t i;
+
+  if (_readName(rd, &name)<0 || _readUint32(rd, &valueCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  for (i=0; i<valueCount; i++) {
+    uint8_t valueType;
+    uint32_t v;
+
+    if (rd->pos>=rd->end)
+      return GWEN_ERROR_BAD_DATA;
+    valueType=*(rd->pos++);
+    if (_readUint32(rd, &v)<0)
+      return GWEN_ERROR_BAD_DATA;
+
+    switch (valueType) {
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_CHAR:
+      /* the string is followed by a 0 byte so it can be used in place */
+      if (v>=(uint32_t)(rd->end-rd->pos) || rd->pos[v]!=0)
+        return GWEN_ERROR_BAD_DATA;
+      GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_DEFAULT, name, (const char *) rd->pos);
+      rd->pos+=v+1;
+      break;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_INT:
+      GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_DEFAULT, name, (int)((int32_t) v));
+      break;
+
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_BIN:
+      if (v>(uint32_t)(rd->end-rd->pos))
+        return GWEN_ERROR_BAD_DATA;
+      GWEN_DB_SetBinValue(db, GWEN_DB_FLAGS_DEFAULT, name, rd->pos, v);
+      rd->pos+=v;
+      break;
+
+    default:
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown value type %d in binary context data", valueType);
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
+  return 0;
+}
+
+
+
+int _readUint32(AB_CTXBIN_READER *rd, uint32_t *pValue)
+{
+  if (rd->end-rd->pos<4)
+    return GWEN_ERROR_BAD_DATA;
+  *pValue=_peekUint32(rd->pos);
+  rd->pos+=4;
+  return 0;
+}
+
+
+
+int _readName(AB_CTXBIN_READER *rd, const char **pName)
+{
+  uint32_t idx;
+
+  if (_readUint32(rd, &idx)<0 || idx>=rd->nameCount)
+    return GWEN_ERROR_BAD_DATA;
+  *pName=rd->names[idx];
+  return 0;
+}
+
+
+
+/* skips the content of a group */
+int _skipGroup(AB_CTXBIN_READER *rd, int level)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+
+  if (level>AB_IMEXPORTER_CONTEXT_BIN_MAXLEVEL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "DB too deep (%d)", level);
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  for (i=0; i<varCount; i++) {
+    if (_skipVar(rd, NULL, NULL)<0)
+      return GWEN_ERROR_BAD_DATA;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    rv=_skipGroup(rd, level+1);
+    if (rv<0)
+      return rv;
+  }
+
+  return 0;
+}
+
+
+
+/* skips a variable, returns its name and its first char value (both point into the data) */
+int _skipVar(AB_CTXBIN_READER *rd, const char **pName, const char **pFirstCharValue)
+{
+  const char *name;
+  uint32_t valueCount;
+  uint32_t i;
+
+  if (_readName(rd, &name)<0 || _readUint32(rd, &valueCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+  if (pName)
+    *pName=name;
+  if (pFirstCharValue)
+    *pFirstCharValue=NULL;
+
+  for (i=0; i<valueCount; i++) {
+    uint8_t valueType;
+    uint32_t v;
+
+    if (rd->pos>=rd->end)
+      return GWEN_ERROR_BAD_DATA;
+    valueType=*(rd->pos++);
+    if (_readUint32(rd, &v)<0)
+      return GWEN_ERROR_BAD_DATA;
+
+    switch (valueType) {
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_CHAR:
+      if (v>=(uint32_t)(rd->end-rd->pos) || rd->pos[v]!=0)
+        return GWEN_ERROR_BAD_DATA;
+      if (pFirstCharValue && *pFirstCharValue==NULL)
+        *pFirstCharValue=(const char *) rd->pos;
+      rd->pos+=v+1;
+      break;
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_INT:
+      break;
+    case AB_IMEXPORTER_CONTEXT_BIN_VALUE_BIN:
+      if (v>(uint32_t)(rd->end-rd->pos))
+        return GWEN_ERROR_BAD_DATA;
+      rd->pos+=v;
+      break;
+    default:
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown value type %d in binary context data", valueType);
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* skips a transaction group, returns its date (booking date or valuta date) in dateBuf (empty if none) */
+int _scanTransaction(AB_CTXBIN_READER *rd, int level, char *dateBuf)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+  const char *sDate=NULL;
+  const char *sValutaDate=NULL;
+
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  for (i=0; i<varCount; i++) {
+    const char *name;
+    const char *value;
+
+    if (_skipVar(rd, &name, &value)<0)
+      return GWEN_ERROR_BAD_DATA;
+    if (strcmp(name, "date")==0)
+      sDate=value;
+    else if (strcmp(name, "valutaDate")==0)
+      sValutaDate=value;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    rv=_skipGroup(rd, level+1);
+    if (rv<0)
+      return rv;
+  }
+
+  if (sDate==NULL || *sDate==0)
+    sDate=sValutaDate;
+  if (sDate && strlen(sDate)==8)
+    memcpy(dateBuf, sDate, 9);
+  else
+    *dateBuf=0;
+  return 0;
+}
+
+
+
+AB_IMEXPORTER_CONTEXT_INDEX *AB_ImExporterContextIndex_fromBinary(const uint8_t *ptr, uint32_t len)
+{
+  AB_IMEXPORTER_CONTEXT_INDEX *idx;
+
+  if (!AB_ImExporterContext_IsBinary(ptr, len)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Not a binary context");
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AB_IMEXPORTER_CONTEXT_INDEX, idx);
+  while (len) {
+    AB_CTXBIN_READER rd;
+    uint32_t used=0;
+    int rv;
+
+    rv=_openChunk(&rd, ptr, len, &used);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      AB_ImExporterContextIndex_free(idx);
+      return NULL;
+    }
+
+    /* the index keeps the names of every chunk */
+    idx->chunks=(AB_CTXBIN_CHUNK *) realloc(idx->chunks, (idx->chunkCount+1)*sizeof(AB_CTXBIN_CHUNK));
+    idx->chunks[idx->chunkCount].names=rd.names;
+    idx->chunks[idx->chunkCount].nameCount=rd.nameCount;
+    idx->chunkCount++;
+
+    rv=_indexChunk(idx, &rd, idx->chunkCount-1);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      AB_ImExporterContextIndex_free(idx);
+      return NULL;
+    }
+    ptr+=used;
+    len-=used;
+  }
+
+  return idx;
+}
+
+
+
+void AB_ImExporterContextIndex_free(AB_IMEXPORTER_CONTEXT_INDEX *idx)
+{
+  if (idx) {
+    uint32_t i;
+
+    for (i=0; i<idx->entryCount; i++)
+      AB_ImExporterAccountInfo_free(idx->entries[i].accountInfo);
+    free(idx->entries);
+    for (i=0; i<idx->chunkCount; i++)
+      free(idx->chunks[i].names);
+    free(idx->chunks);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+int AB_ImExporterContextIndex_ReadAccountInfos(const AB_IMEXPORTER_CONTEXT_INDEX *idx,
+                                               AB_IMEXPORTER_CONTEXT *ctx,
+                                               uint32_t uniqueId,
+                                               const char *country,
+                                               const char *bankId,
+                                               const char *accountNumber,
+                                               const char *subAccountId,
+                                               const char *iban,
+                                               const char *currency,
+                                               int ty,
+                                               const GWEN_DATE *fromDate,
+                                               const GWEN_DATE *toDate)
+{
+  char fromBuf[9];
+  char toBuf[9];
+  uint32_t i;
+  int count=0;
+
+  assert(idx);
+  assert(ctx);
+
+  _dateRangeToStrings(fromDate, toDate, fromBuf, toBuf);
+
+  for (i=0; i<idx->entryCount; i++) {
+    const AB_CTXBIN_INDEXENTRY *entry;
+
+    entry=&(idx->entries[i]);
+    if (AB_ImExporterAccountInfo_Matches(entry->accountInfo, uniqueId, country, bankId, accountNumber, subAccountId,
+                                         iban, currency, ty)) {
+      AB_IMEXPORTER_ACCOUNTINFO *ai=NULL;
+      AB_IMEXPORTER_ACCOUNTINFO *aiDest=NULL;
+      int rv;
+
+      rv=_readIndexEntry(idx, entry, fromBuf, toBuf, &ai);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+
+      /* account infos of different chunks are merged like in AB_ImExporterContext_ReadBinary() */
+      if (AB_ImExporterContext_GetAccountInfoList(ctx))
+        aiDest=AB_ImExporterAccountInfo_List_Find(AB_ImExporterContext_GetAccountInfoList(ctx),
+                                                  AB_ImExporterAccountInfo_GetAccountId(ai),
+                                                  AB_ImExporterAccountInfo_GetIban(ai),
+                                                  AB_ImExporterAccountInfo_GetBankCode(ai),
+                                                  AB_ImExporterAccountInfo_GetAccountNumber(ai),
+                                                  AB_ImExporterAccountInfo_GetAccountType(ai));
+      if (aiDest) {
+        _mergeAccountInfo(aiDest, ai);
+        AB_ImExporterAccountInfo_free(ai);
+      }
+      else
+        AB_ImExporterContext_AddAccountInfo(ctx, ai);
+      count++;
+    }
+  }
+
+  return count;
+}
+
+
+
+int AB_ImExporterContext_ReadAccountInfos(AB_IMEXPORTER_CONTEXT *ctx,
+                                          const uint8_t *ptr,
+                                          uint32_t len,
+                                          uint32_t uniqueId,
+                                          const char *country,
+                                          const char *bankId,
+                                          const char *accountNumber,
+                                          const char *subAccountId,
+                                          const char *iban,
+                                          const char *currency,
+                                          int ty,
+                                          const GWEN_DATE *fromDate,
+                                          const GWEN_DATE *toDate)
+{
+  AB_IMEXPORTER_CONTEXT_INDEX *idx;
+  char fromBuf[9];
+  char toBuf[9];
+  int rv;
+
+  assert(ctx);
+
+  if (!AB_ImExporterContext_IsBinary(ptr, len)) {
+    /* text data can only be decoded completely */
+    _dateRangeToStrings(fromDate, toDate, fromBuf, toBuf);
+    rv=_readTextAccountInfos(ctx, ptr, len,
+                             uniqueId, country, bankId, accountNumber, subAccountId, iban, currency, ty,
+                             fromBuf, toBuf);
+    if (rv<0)
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  idx=AB_ImExporterContextIndex_fromBinary(ptr, len);
+  if (idx==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Error indexing binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  rv=AB_ImExporterContextIndex_ReadAccountInfos(idx, ctx,
+                                                uniqueId, country, bankId, accountNumber, subAccountId, iban, currency, ty,
+                                                fromDate, toDate);
+  AB_ImExporterContextIndex_free(idx);
+  if (rv<0)
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+  return rv;
+}
+
+
+
+int _readTextAccountInfos(AB_IMEXPORTER_CONTEXT *ctx,
+                          const uint8_t *ptr,
+                          uint32_t len,
+                          uint32_t uniqueId,
+                          const char *country,
+                          const char *bankId,
+                          const char *accountNumber,
+                          const char *subAccountId,
+                          const char *iban,
+                          const char *currency,
+                          int ty,
+                          const char *fromDate,
+                          const char *toDate)
+{
+  AB_IMEXPORTER_CONTEXT *ctxSrc;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  GWEN_DB_NODE *dbCtx;
+  int count=0;
+  int rv;
+
+  dbCtx=GWEN_DB_Group_new("context");
+  rv=GWEN_DB_ReadFromString(dbCtx, (const char *) ptr, len, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    GWEN_DB_Group_free(dbCtx);
+    return rv;
+  }
+  ctxSrc=AB_ImExporterContext_fromDb(dbCtx);
+  GWEN_DB_Group_free(dbCtx);
+  if (ctxSrc==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No context in input data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  /* drop everything not wanted, then merge the rest like binary chunks */
+  ai=AB_ImExporterContext_GetFirstAccountInfo(ctxSrc);
+  while (ai) {
+    AB_IMEXPORTER_ACCOUNTINFO *aiNext;
+
+    aiNext=AB_ImExporterAccountInfo_List_Next(ai);
+    if (AB_ImExporterAccountInfo_Matches(ai, uniqueId, country, bankId, accountNumber, subAccountId,
+                                         iban, currency, ty)) {
+      _dropTransactionsOutOfRange(ai, fromDate, toDate);
+      count++;
+    }
+    else {
+      AB_ImExporterContext_RemoveAccountInfo(ctxSrc, ai);
+      AB_ImExporterAccountInfo_free(ai);
+    }
+    ai=aiNext;
+  }
+
+  _mergeContext(ctx, ctxSrc);
+  AB_ImExporterContext_free(ctxSrc);
+
+  return count;
+}
+
+
+
+/* uses the booking date or the valuta date if the former is missing, undated transactions are kept */
+void _dropTransactionsOutOfRange(AB_IMEXPORTER_ACCOUNTINFO *ai, const char *fromDate, const char *toDate)
+{
+  AB_TRANSACTION_LIST *tl;
+  AB_TRANSACTION *t;
+
+  tl=AB_ImExporterAccountInfo_GetTransactionList(ai);
+  if (tl==NULL || (*fromDate==0 && *toDate==0))
+    return;
+
+  t=AB_Transaction_List_First(tl);
+  while (t) {
+    AB_TRANSACTION *tNext;
+    const GWEN_DATE *dt;
+
+    tNext=AB_Transaction_List_Next(t);
+    dt=AB_Transaction_GetDate(t);
+    if (dt==NULL)
+      dt=AB_Transaction_GetValutaDate(t);
+    if (dt) {
+      const char *s;
+
+      s=GWEN_Date_GetString(dt);
+      if ((*fromDate && strcmp(s, fromDate)<0) || (*toDate && strcmp(s, toDate)>0)) {
+        AB_Transaction_List_Del(t);
+        AB_Transaction_free(t);
+      }
+    }
+    t=tNext;
+  }
+}
+
+
+
+/* dates are compared in their string representation (YYYYMMDD), buffers must hold 9 bytes */
+void _dateRangeToStrings(const GWEN_DATE *fromDate, const GWEN_DATE *toDate, char *fromBuf, char *toBuf)
+{
+  *fromBuf=0;
+  *toBuf=0;
+  if (fromDate)
+    strncpy(fromBuf, GWEN_Date_GetString(fromDate), 8);
+  if (toDate)
+    strncpy(toBuf, GWEN_Date_GetString(toDate), 8);
+  fromBuf[8]=0;
+  toBuf[8]=0;
+}
+
+
+/* creates index entries for all account infos of a chunk */
+int _indexChunk(AB_IMEXPORTER_CONTEXT_INDEX *idx, AB_CTXBIN_READER *rd, uint32_t chunk)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+
+  /* context group */
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+  for (i=0; i<varCount; i++) {
+    if (_skipVar(rd, NULL, NULL)<0)
+      return GWEN_ERROR_BAD_DATA;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    if (strcmp(name, "accountInfoList")==0) {
+      uint32_t aiVarCount;
+      uint32_t aiGroupCount;
+      uint32_t j;
+
+      if (_readUint32(rd, &aiVarCount)<0 || _readUint32(rd, &aiGroupCount)<0)
+        return GWEN_ERROR_BAD_DATA;
+      for (j=0; j<aiVarCount; j++) {
+        if (_skipVar(rd, NULL, NULL)<0)
+          return GWEN_ERROR_BAD_DATA;
+      }
+      for (j=0; j<aiGroupCount; j++) {
+        if (_readName(rd, &name)<0)
+          return GWEN_ERROR_BAD_DATA;
+        rv=_indexAccountInfo(idx, rd, chunk);
+        if (rv<0)
+          return rv;
+      }
+    }
+    else {
+      /* securities, messages */
+      rv=_skipGroup(rd, 1);
+      if (rv<0)
+        return rv;
+    }
+  }
+
+  return 0;
+}
+
+
+
+int _indexAccountInfo(AB_IMEXPORTER_CONTEXT_INDEX *idx, AB_CTXBIN_READER *rd, uint32_t chunk)
+{
+  AB_CTXBIN_INDEXENTRY *entry;
+  GWEN_DB_NODE *dbHeader;
+  const uint8_t *pos;
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+  int rv;
+
+  if (idx->entryCount>=idx->entrySize) {
+    idx->entrySize=idx->entrySize?(idx->entrySize*2):16;
+    idx->entries=(AB_CTXBIN_INDEXENTRY *) realloc(idx->entries, idx->entrySize*sizeof(AB_CTXBIN_INDEXENTRY));
+  }
+  entry=&(idx->entries[idx->entryCount]);
+  memset(entry, 0, sizeof(AB_CTXBIN_INDEXENTRY));
+  entry->chunk=chunk;
+
+  pos=rd->pos;
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  /* only the variables are decoded, they identify the account */
+  dbHeader=GWEN_DB_Group_new("accountInfo");
+  for (i=0; i<varCount; i++) {
+    rv=_readVar(rd, dbHeader);
+    if (rv<0) {
+      GWEN_DB_Group_free(dbHeader);
+      return rv;
+    }
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+
+    if (_readName(rd, &name)<0) {
+      GWEN_DB_Group_free(dbHeader);
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (strcmp(name, "transactionList")==0)
+      rv=_indexTransactionList(entry, rd);
+    else
+      rv=_skipGroup(rd, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST);
+    if (rv<0) {
+      GWEN_DB_Group_free(dbHeader);
+      return rv;
+    }
+  }
+
+  entry->pos=pos;
+  entry->end=rd->pos;
+  entry->accountInfo=AB_ImExporterAccountInfo_fromDb(dbHeader);
+  GWEN_DB_Group_free(dbHeader);
+  if (entry->accountInfo==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account info in binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  idx->entryCount++;
+  return 0;
+}
+
+
+
+/* determines the date range of the transactions of an account info */
+int _indexTransactionList(AB_CTXBIN_INDEXENTRY *entry, AB_CTXBIN_READER *rd)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+  for (i=0; i<varCount; i++) {
+    if (_skipVar(rd, NULL, NULL)<0)
+      return GWEN_ERROR_BAD_DATA;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+    char dateBuf[9];
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    rv=_scanTransaction(rd, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST+1, dateBuf);
+    if (rv<0)
+      return rv;
+    if (*dateBuf==0)
+      entry->hasUndatedTransactions=1;
+    else {
+      if (*(entry->firstDate)==0 || strcmp(dateBuf, entry->firstDate)<0)
+        memcpy(entry->firstDate, dateBuf, 9);
+      if (*(entry->lastDate)==0 || strcmp(dateBuf, entry->lastDate)>0)
+        memcpy(entry->lastDate, dateBuf, 9);
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* decodes the account info of an index entry, transactions outside the given date range are skipped */
+int _readIndexEntry(const AB_IMEXPORTER_CONTEXT_INDEX *idx,
+                    const AB_CTXBIN_INDEXENTRY *entry,
+                    const char *fromDate,
+                    const char *toDate,
+                    AB_IMEXPORTER_ACCOUNTINFO **pAi)
+{
+  AB_CTXBIN_READER rd;
+  GWEN_DB_NODE *dbAi;
+  int filterTransactions=0;
+  int skipTransactions=0;
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+  int rv;
+
+  rd.names=idx->chunks[entry->chunk].names;
+  rd.nameCount=idx->chunks[entry->chunk].nameCount;
+  rd.pos=entry->pos;
+  rd.end=entry->end;
+
+  /* use the date range of the entry to avoid looking at every transaction if possible */
+  if (*(entry->firstDate)) {
+    if ((*fromDate && strcmp(entry->lastDate, fromDate)<0) ||
+        (*toDate && strcmp(entry->firstDate, toDate)>0))
+      /* all dated transactions are out of range */
+      skipTransactions=!entry->hasUndatedTransactions;
+    if ((*fromDate && strcmp(entry->firstDate, fromDate)<0) ||
+        (*toDate && strcmp(entry->lastDate, toDate)>0))
+      filterTransactions=1;
+  }
+
+  dbAi=GWEN_DB_Group_new("accountInfo");
+  if (_readUint32(&rd, &varCount)<0 || _readUint32(&rd, &groupCount)<0) {
+    GWEN_DB_Group_free(dbAi);
+    return GWEN_ERROR_BAD_DATA;
+  }
+  for (i=0; i<varCount; i++) {
+    rv=_readVar(&rd, dbAi);
+    if (rv<0) {
+      GWEN_DB_Group_free(dbAi);
+      return rv;
+    }
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const char *name;
+
+    if (_readName(&rd, &name)<0) {
+      GWEN_DB_Group_free(dbAi);
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (strcmp(name, "transactionList")==0 && skipTransactions)
+      rv=_skipGroup(&rd, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST);
+    else {
+      GWEN_DB_NODE *dbGroup;
+
+      dbGroup=GWEN_DB_Group_new(name);
+      GWEN_DB_AddGroup(dbAi, dbGroup);
+      if (strcmp(name, "transactionList")==0 && filterTransactions)
+        rv=_readTransactionListInRange(&rd, dbGroup, fromDate, toDate);
+      else
+        rv=_readGroup(&rd, dbGroup, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST);
+    }
+    if (rv<0) {
+      GWEN_DB_Group_free(dbAi);
+      return rv;
+    }
+  }
+
+  *pAi=AB_ImExporterAccountInfo_fromDb(dbAi);
+  GWEN_DB_Group_free(dbAi);
+  if (*pAi==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad account info in binary context data");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  return 0;
+}
+
+
+
+int _readTransactionListInRange(AB_CTXBIN_READER *rd, GWEN_DB_NODE *dbList, const char *fromDate, const char *toDate)
+{
+  uint32_t varCount;
+  uint32_t groupCount;
+  uint32_t i;
+
+  if (_readUint32(rd, &varCount)<0 || _readUint32(rd, &groupCount)<0)
+    return GWEN_ERROR_BAD_DATA;
+  for (i=0; i<varCount; i++) {
+    int rv;
+
+    rv=_readVar(rd, dbList);
+    if (rv<0)
+      return rv;
+  }
+
+  for (i=0; i<groupCount; i++) {
+    const uint8_t *pos;
+    const char *name;
+    char dateBuf[9];
+    int rv;
+
+    if (_readName(rd, &name)<0)
+      return GWEN_ERROR_BAD_DATA;
+    pos=rd->pos;
+    rv=_scanTransaction(rd, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST+1, dateBuf);
+    if (rv<0)
+      return rv;
+    if (*dateBuf==0 ||
+        ((*fromDate==0 || strcmp(dateBuf, fromDate)>=0) && (*toDate==0 || strcmp(dateBuf, toDate)<=0))) {
+      GWEN_DB_NODE *dbT;
+
+      /* in range, go back and decode it */
+      rd->pos=pos;
+      dbT=GWEN_DB_Group_new(name);
+      GWEN_DB_AddGroup(dbList, dbT);
+      rv=_readGroup(rd, dbT, AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST+1);
+      if (rv<0)
+        return rv;
+    }
+  }
+
+  return 0;
+}
+
+
+
+/* adds the content of a chunk to the context like AB_ImExporterContext_AddTransaction() etc would do */
+void _mergeContext(AB_IMEXPORTER_CONTEXT *ctx, AB_IMEXPORTER_CONTEXT *ctxSrc)
+{
+  AB_IMEXPORTER_ACCOUNTINFO_LIST *aiListNew;
+  AB_IMEXPORTER_ACCOUNTINFO *ai;
+  AB_SECURITY *sec;
+  AB_MESSAGE *msg;
+
+  /* account infos of a chunk are only merged with those of previous chunks, not with each other */
+  aiListNew=AB_ImExporterAccountInfo_List_new();
+  ai=AB_ImExporterContext_GetFirstAccountInfo(ctxSrc);
+  while (ai) {
+    AB_IMEXPORTER_ACCOUNTINFO *aiNext;
+    AB_IMEXPORTER_ACCOUNTINFO *aiDest=NULL;
+
+    aiNext=AB_ImExporterAccountInfo_List_Next(ai);
+    if (AB_ImExporterContext_GetAccountInfoList(ctx))
+      aiDest=AB_ImExporterAccountInfo_List_Find(AB_ImExporterContext_GetAccountInfoList(ctx),
+                                                AB_ImExporterAccountInfo_GetAccountId(ai),
+                                                AB_ImExporterAccountInfo_GetIban(ai),
+                                                AB_ImExporterAccountInfo_GetBankCode(ai),
+                                                AB_ImExporterAccountInfo_GetAccountNumber(ai),
+                                                AB_ImExporterAccountInfo_GetAccountType(ai));
+    if (aiDest)
+      _mergeAccountInfo(aiDest, ai);
+    else {
+      AB_ImExporterContext_RemoveAccountInfo(ctxSrc, ai);
+      AB_ImExporterAccountInfo_List_Add(ai, aiListNew);
+    }
+    ai=aiNext;
+  }
+
+  ai=AB_ImExporterAccountInfo_List_First(aiListNew);
+  while (ai) {
+    AB_IMEXPORTER_ACCOUNTINFO *aiNext;
+
+    aiNext=AB_ImExporterAccountInfo_List_Next(ai);
+    AB_ImExporterAccountInfo_List_Del(ai);
+    AB_ImExporterContext_AddAccountInfo(ctx, ai);
+    ai=aiNext;
+  }
+  AB_ImExporterAccountInfo_List_free(aiListNew);
+
+  sec=AB_ImExporterContext_GetFirstSecurity(ctxSrc);
+  while (sec) {
+    AB_SECURITY *secNext;
+
+    secNext=AB_Security_List_Next(sec);
+    AB_Security_List_Del(sec);
+    AB_ImExporterContext_AddSecurity(ctx, sec);
+    sec=secNext;
+  }
+
+  msg=AB_ImExporterContext_GetFirstMessage(ctxSrc);
+  while (msg) {
+    AB_MESSAGE *msgNext;
+
+    msgNext=AB_Message_List_Next(msg);
+    AB_Message_List_Del(msg);
+    AB_ImExporterContext_AddMessage(ctx, msg);
+    msg=msgNext;
+  }
+}
+
+
+
+void _mergeAccountInfo(AB_IMEXPORTER_ACCOUNTINFO *ai, AB_IMEXPORTER_ACCOUNTINFO *aiSrc)
+{
+  AB_TRANSACTION_LIST *tl;
+  AB_BALANCE_LIST *bl;
+  AB_DOCUMENT_LIST *dl;
+
+  tl=AB_ImExporterAccountInfo_GetTransactionList(aiSrc);
+  if (tl) {
+    AB_TRANSACTION *t;
+
+    while ((t=AB_Transaction_List_First(tl))) {
+      AB_Transaction_List_Del(t);
+      AB_ImExporterAccountInfo_AddTransaction(ai, t);
+    }
+  }
+
+  bl=AB_ImExporterAccountInfo_GetBalanceList(aiSrc);
+  if (bl) {
+    AB_BALANCE *bal;
+
+    while ((bal=AB_Balance_List_First(bl))) {
+      AB_Balance_List_Del(bal);
+      AB_ImExporterAccountInfo_AddBalance(ai, bal);
+    }
+  }
+
+  dl=AB_ImExporterAccountInfo_GetEStatementList(aiSrc);
+  if (dl) {
+    AB_DOCUMENT *doc;
+
+    while ((doc=AB_Document_List_First(dl))) {
+      AB_Document_List_Del(doc);
+      AB_ImExporterAccountInfo_AddEStatement(ai, doc);
+    }
+  }
+}
+
+
+
+AB_CTXBIN_NAMETABLE *_nameTableNew(void)
+{
+  AB_CTXBIN_NAMETABLE *nt;
+
+  GWEN_NEW_OBJECT(AB_CTXBIN_NAMETABLE, nt);
+  nt->slotCount=AB_IMEXPORTER_CONTEXT_BIN_NAME_SLOTS;
+  nt->slotNames=(const char **) calloc(nt->slotCount, sizeof(const char *));
+  nt->slotIndexes=(uint32_t *) calloc(nt->slotCount, sizeof(uint32_t));
+  nt->tableBuffer=GWEN_Buffer_new(0, 2048, 0, 1);
+  return nt;
+}
+
+
+
+void _nameTableFree(AB_CTXBIN_NAMETABLE *nt)
+{
+  if (nt) {
+    GWEN_Buffer_free(nt->tableBuffer);
+    free(nt->slotIndexes);
+    free(nt->slotNames);
+    GWEN_FREE_OBJECT(nt);
+  }
+}
+
+
+
+/* returns the index of the given name in the string table, adds the name if necessary */
+uint32_t _nameTableGetIndex(AB_CTXBIN_NAMETABLE *nt, const char *name)
+{
+  uint32_t slot;
+
+  /* keep the table at most half full */
+  if (nt->nameCount*2>=nt->slotCount)
+    _nameTableGrow(nt);
+
+  slot=_hashName(name) & (nt->slotCount-1);
+  while (nt->slotNames[slot]) {
+    if (strcmp(nt->slotNames[slot], name)==0)
+      return nt->slotIndexes[slot];
+    slot=(slot+1) & (nt->slotCount-1);
+  }
+
+  /* names are valid as long as the DB exists, which outlives the table */
+  nt->slotNames[slot]=name;
+  nt->slotIndexes[slot]=nt->nameCount;
+  GWEN_Buffer_AppendBytes(nt->tableBuffer, name, strlen(name)+1);
+  return nt->nameCount++;
+}
+
+
+
+void _nameTableGrow(AB_CTXBIN_NAMETABLE *nt)
+{
+  const char **oldNames;
+  uint32_t *oldIndexes;
+  uint32_t oldCount;
+  uint32_t i;
+
+  oldNames=nt->slotNames;
+  oldIndexes=nt->slotIndexes;
+  oldCount=nt->slotCount;
+
+  nt->slotCount=oldCount*2;
+  nt->slotNames=(const char **) calloc(nt->slotCount, sizeof(const char *));
+  nt->slotIndexes=(uint32_t *) calloc(nt->slotCount, sizeof(uint32_t));
+  for (i=0; i<oldCount; i++) {
+    if (oldNames[i]) {
+      uint32_t slot;
+
+      slot=_hashName(oldNames[i]) & (nt->slotCount-1);
+      while (nt->slotNames[slot])
+        slot=(slot+1) & (nt->slotCount-1);
+      nt->slotNames[slot]=oldNames[i];
+      nt->slotIndexes[slot]=oldIndexes[i];
+    }
+  }
+  free(oldIndexes);
+  free(oldNames);
+}
+
+
+
+/* FNV-1a */
+uint32_t _hashName(const char *s)
+{
+  uint32_t h=2166136261u;
+
+  while (*s) {
+    h^=(uint8_t)(*(s++));
+    h*=16777619u;
+  }
+  return h;
+}
+
+
+
+void _appendUint32(GWEN_BUFFER *buf, uint32_t v)
+{
+  char b[4];
+
+  b[0]=(char)(v & 0xff);
+  b[1]=(char)((v>>8) & 0xff);
+  b[2]=(char)((v>>16) & 0xff);
+  b[3]=(char)((v>>24) & 0xff);
+  GWEN_Buffer_AppendBytes(buf, b, 4);
+}
+
+
+
+void _setUint32At(GWEN_BUFFER *buf, uint32_t pos, uint32_t v)
+{
+  uint8_t *p;
+
+  p=(uint8_t *)GWEN_Buffer_GetStart(buf)+pos;
+  p[0]=(uint8_t)(v & 0xff);
+  p[1]=(uint8_t)((v>>8) & 0xff);
+  p[2]=(uint8_t)((v>>16) & 0xff);
+  p[3]=(uint8_t)((v>>24) & 0xff);
+}
+
+
+
+uint32_t _peekUint32(const uint8_t *p)
+{
+  return ((uint32_t)p[0]) | (((uint32_t)p[1])<<8) | (((uint32_t)p[2])<<16) | (((uint32_t)p[3])<<24);
+}
+
+
@@ -0,0 +1,159 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_H
+#define AB_IMEXPORTER_CONTEXT_BIN_H
+
+#include <aqbanking/error.h>
+#include <aqbanking/types/imexporter_context.h>
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/gwendate.h>
+#include <gwenhywfar/types.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** @name Binary Context Files
+ *
+ * Besides the textual GWEN_DB format context files can be stored in a binary format which can be
+ * read much faster. A binary context file consists of one or more chunks, each of them starting with
+ * the magic bytes "ABCX" followed by a version number. Every chunk contains a string table with the
+ * names of all groups and variables followed by the data in which numbers are stored as fixed-width
+ * little endian fields and strings are stored with their length.
+ *
+ * Since every chunk is complete in itself data can be added to a file by just appending a new chunk.
+ * When reading the content of all chunks is merged into a single context.
+ */
+/*@{*/
+
+/**
+ * Size of the header of a binary chunk (magic, version, reserved bytes, number of strings, size of the string table
+ * and size of the body). This is the minimum number of bytes needed by @ref AB_ImExporterContext_IsBinary.
+ */
+#define AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE (4+1+3+4+4+4)
+
+
+/**
+ * Check whether the given data starts with a binary context chunk.
+ * @return 1 if binary, 0 otherwise
+ * @param ptr pointer to the beginning of the data
+ * @param len length of the data
+ */
+AQBANKING_API int AB_ImExporterContext_IsBinary(const uint8_t *ptr, uint32_t len);
+
+
+/**
+ * Append a binary chunk containing the given context to the given buffer.
+ * @return 0 if ok, error code otherwise
+ * @param ctx context to write
+ * @param destBuf buffer to append the chunk to
+ */
+AQBANKING_API int AB_ImExporterContext_WriteBinary(const AB_IMEXPORTER_CONTEXT *ctx, GWEN_BUFFER *destBuf);
+
+
+/**
+ * Read all chunks of the given binary data and add their content to the given context.
+ * @return 0 if ok, error code otherwise
+ * @param ctx context to add the data to
+ * @param ptr pointer to the binary data (starting with a chunk)
+ * @param len length of the binary data
+ */
+AQBANKING_API int AB_ImExporterContext_ReadBinary(AB_IMEXPORTER_CONTEXT *ctx, const uint8_t *ptr, uint32_t len);
+
+
+/*@}*/
+
+
+
+/** @name Indexed Access to Binary Context Files
+ *
+ * An index over binary context data allows reading only the account infos (and transactions within a given
+ * date range) which are actually needed. Building the index only walks the data without decoding it, for
+ * every account info it records its position and identification and the date range of its transactions.
+ */
+/*@{*/
+
+typedef struct AB_IMEXPORTER_CONTEXT_INDEX AB_IMEXPORTER_CONTEXT_INDEX;
+
+
+/**
+ * Create an index for the given binary context data.
+ * The data is not copied, so it must remain valid as long as the index is used.
+ * @return index (NULL on error)
+ * @param ptr pointer to the binary data (starting with a chunk)
+ * @param len length of the binary data
+ */
+AQBANKING_API AB_IMEXPORTER_CONTEXT_INDEX *AB_ImExporterContextIndex_fromBinary(const uint8_t *ptr, uint32_t len);
+
+AQBANKING_API void AB_ImExporterContextIndex_free(AB_IMEXPORTER_CONTEXT_INDEX *idx);
+
+
+/**
+ * Read all account infos matching the given parameters (see @ref AB_ImExporterAccountInfo_Matches) and add them to
+ * the given context. Only transactions within the given date range are read (using the booking date or the valuta
+ * date if the former is missing), balances and electronic statements are always read.
+ * @return number of account infos read, error code otherwise
+ * @param idx index of the binary data
+ * @param ctx context to add the account infos to
+ * @param fromDate first date for transactions (NULL for no limit)
+ * @param toDate last date for transactions (NULL for no limit)
+ */
+AQBANKING_API int AB_ImExporterContextIndex_ReadAccountInfos(const AB_IMEXPORTER_CONTEXT_INDEX *idx,
+                                                             AB_IMEXPORTER_CONTEXT *ctx,
+                                                             uint32_t uniqueId,
+                                                             const char *country,
+                                                             const char *bankId,
+                                                             const char *accountNumber,
+                                                             const char *subAccountId,
+                                                             const char *iban,
+                                                             const char *currency,
+                                                             int ty,
+                                                             const GWEN_DATE *fromDate,
+                                                             const GWEN_DATE *toDate);
+
+
+/**
+ * Read all account infos matching the given parameters from context data in either format and add them to the
+ * given context, filtering transactions by date like @ref AB_ImExporterContextIndex_ReadAccountInfos.
+ * Binary data is read via a temporary index so only the wanted account infos are decoded, textual data is
+ * decoded completely and filtered afterwards. The index is not kept, the data given must contain the whole file.
+ * @return number of account infos read, error code otherwise
+ * @param ctx context to add the account infos to
+ * @param ptr pointer to the context data (binary or textual)
+ * @param len length of the context data
+ * @param fromDate first date for transactions (NULL for no limit)
+ * @param toDate last date for transactions (NULL for no limit)
+ */
+AQBANKING_API int AB_ImExporterContext_ReadAccountInfos(AB_IMEXPORTER_CONTEXT *ctx,
+                                                        const uint8_t *ptr,
+                                                        uint32_t len,
+                                                        uint32_t uniqueId,
+                                                        const char *country,
+                                                        const char *bankId,
+                                                        const char *accountNumber,
+                                                        const char *subAccountId,
+                                                        const char *iban,
+                                                        const char *currency,
+                                                        int ty,
+                                                        const GWEN_DATE *fromDate,
+                                                        const GWEN_DATE *toDate);
+
+/*@}*/
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
+
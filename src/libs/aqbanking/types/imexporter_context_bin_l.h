@@ -0,0 +1,25 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_L_H
+#define AB_IMEXPORTER_CONTEXT_BIN_L_H
+
+#include <aqbanking/types/imexporter_context_bin.h>
+
+
+/**
+ * Read everything from the given io layer until EOF and append it to the given buffer (e.g. to check the data with
+ * @ref AB_ImExporterContext_IsBinary and read it with @ref AB_ImExporterContext_ReadBinary afterwards).
+ * @return 0 if ok, error code otherwise
+ * @param sio io layer to read from
+ * @param destBuf buffer to append the data to
+ */
+int AB_ImExporterContext_ReadAll(GWEN_SYNCIO *sio, GWEN_BUFFER *destBuf);
+
+
+#endif
@@ -0,0 +1,109 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+
+#ifndef AB_IMEXPORTER_CONTEXT_BIN_P_H
+#define AB_IMEXPORTER_CONTEXT_BIN_P_H
+
+#include "imexporter_context_bin_l.h"
+
+
+/*
+ * Layout of a chunk (all numbers are little endian):
+ *
+ * header:
+ *   4 bytes  magic "ABCX"
+ *   1 byte   version
+ *   3 bytes  reserved (0)
+ *   4 bytes  number of strings in the string table
+ *   4 bytes  size of the string table
+ *   4 bytes  size of the body
+ *
+ * string table: names of groups and variables, each terminated by a 0 byte
+ *
+ * body: content of the context group
+ *   group content:
+ *     4 bytes number of variables, 4 bytes number of subgroups
+ *     variables: 4 bytes name index, 4 bytes number of values, values
+ *     subgroups: 4 bytes name index, group content
+ *   value:
+ *     1 byte type
+ *     type "c": 4 bytes length, string, 0 byte
+ *     type "i": 4 bytes signed integer
+ *     type "b": 4 bytes length, data
+ */
+
+#define AB_IMEXPORTER_CONTEXT_BIN_MAGIC       "ABCX"
+#define AB_IMEXPORTER_CONTEXT_BIN_VERSION     1
+
+#define AB_IMEXPORTER_CONTEXT_BIN_VALUE_CHAR 'c'
+#define AB_IMEXPORTER_CONTEXT_BIN_VALUE_INT  'i'
+#define AB_IMEXPORTER_CONTEXT_BIN_VALUE_BIN  'b'
+
+#define AB_IMEXPORTER_CONTEXT_BIN_MAXLEVEL   32
+
+/* levels of the groups in the context DB */
+#define AB_IMEXPORTER_CONTEXT_BIN_LEVEL_ACCOUNTINFO     2
+#define AB_IMEXPORTER_CONTEXT_BIN_LEVEL_TRANSACTIONLIST 3
+
+/* initial number of slots of the name hash table (must be a power of 2) */
+#define AB_IMEXPORTER_CONTEXT_BIN_NAME_SLOTS 256
+
+
+/** string table used while writing a chunk */
+typedef struct AB_CTXBIN_NAMETABLE AB_CTXBIN_NAMETABLE;
+struct AB_CTXBIN_NAMETABLE {
+  const char **slotNames;      /* hash table: name per slot (NULL if unused) */
+  uint32_t *slotIndexes;       /* hash table: index of the name in the string table */
+  uint32_t slotCount;
+  uint32_t nameCount;
+  GWEN_BUFFER *tableBuffer;    /* names in order of their indexes */
+};
+
+
+/** state while reading a chunk */
+typedef struct AB_CTXBIN_READER AB_CTXBIN_READER;
+struct AB_CTXBIN_READER {
+  const uint8_t *pos;
+  const uint8_t *end;
+  const char **names;
+  uint32_t nameCount;
+};
+
+
+/** names of a chunk, used by the index */
+typedef struct AB_CTXBIN_CHUNK AB_CTXBIN_CHUNK;
+struct AB_CTXBIN_CHUNK {
+  const char **names;
+  uint32_t nameCount;
+};
+
+
+/** index entry for an account info */
+typedef struct AB_CTXBIN_INDEXENTRY AB_CTXBIN_INDEXENTRY;
+struct AB_CTXBIN_INDEXENTRY {
+  uint32_t chunk;
+  const uint8_t *pos;                      /* begin of the group content */
+  const uint8_t *end;
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;  /* account info without lists (for matching) */
+  char firstDate[9];                       /* date range of the transactions (YYYYMMDD, empty if none) */
+  char lastDate[9];
+  int hasUndatedTransactions;
+};
+
+
+struct AB_IMEXPORTER_CONTEXT_INDEX {
+  AB_CTXBIN_CHUNK *chunks;
+  uint32_t chunkCount;
+  AB_CTXBIN_INDEXENTRY *entries;
+  uint32_t entryCount;
+  uint32_t entrySize;
+};
+
+
+#endif
+
@@ -20,12 +20,19 @@
 #include <gwenhywfar/buffer.h>
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 #ifdef HAVE_LOCALE_H
 # include <locale.h>
 #endif
 
 #include <ctype.h>
 
+#if defined(HAVE_PTHREAD_H) && !defined(OS_WIN32)
+# define AB_VALUE_USE_PTHREADS
+# include <pthread.h>
+#endif
+
 
 #define AB_VALUE_STRSIZE 256
 
@@ -35,6 +42,60 @@ GWEN_LIST_FUNCTIONS(AB_VALUE, AB_Value)
 
 
 
+/* only changed by AB_Value_SetFixedPointEnabled() before any threads are started, so no lock */
+static int ab_value_fixed_point_enabled=1;
+
+static const int64_t ab_value_pow10[AB_VALUE_FIXED_MAXSCALE+1]= {
+  1LL,
+  10LL,
+  100LL,
+  1000LL,
+  10000LL,
+  100000LL,
+  1000000LL,
+  10000000LL,
+  100000000LL,
+  1000000000LL,
+  10000000000LL,
+  100000000000LL,
+  1000000000000LL,
+  10000000000000LL,
+  100000000000000LL,
+  1000000000000000LL,
+  10000000000000000LL,
+  100000000000000000LL,
+  1000000000000000000LL
+};
+
+
+/* Process-wide table of interned 3-letter currency codes. The table is allocated statically and
+ * entries are never changed once added, so the pointers returned by AB_Value_GetCurrency() stay
+ * valid and reading an entry by id needs no lock. Adding entries is serialized by a mutex since values
+ * are also created in worker threads. Other currency strings and codes beyond the table size are
+ * stored with the value itself, so the table can't grow without bounds. */
+static char ab_value_currency_table[AB_VALUE_CURRENCY_TABLE_SIZE][4];
+static uint32_t ab_value_currency_count=0;
+static uint16_t ab_value_currency_slots[AB_VALUE_CURRENCY_SLOTS]; /* id of the code, 0 if free */
+#ifdef AB_VALUE_USE_PTHREADS
+static pthread_mutex_t ab_value_currency_mutex=PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+
+
+void AB_Value_SetFixedPointEnabled(int b)
+{
+  ab_value_fixed_point_enabled=b?1:0;
+}
+
+
+
+int AB_Value_GetFixedPointEnabled(void)
+{
+  return ab_value_fixed_point_enabled;
+}
+
+
 
 AB_VALUE *AB_Value_new(void)
 {
@@ -42,7 +103,13 @@ AB_VALUE *AB_Value_new(void)
 
   GWEN_NEW_OBJECT(AB_VALUE, v);
   GWEN_LIST_INIT(AB_VALUE, v);
-  mpq_init(v->value);
+  if (ab_value_fixed_point_enabled) {
+    v->isFixed=1;
+    v->fixedNum=0;
+    v->fixedScale=0;
+  }
+  else
+    mpq_init(v->value);
   return v;
 }
 
@@ -52,8 +119,9 @@ void AB_Value_free(AB_VALUE *v)
 {
   if (v) {
     GWEN_LIST_FINI(AB_VALUE, v);
-    mpq_clear(v->value);
     free(v->currency);
+    if (!v->isFixed)
+      mpq_clear(v->value);
     GWEN_FREE_OBJECT(v);
   }
 }
@@ -66,7 +134,13 @@ AB_VALUE *AB_Value_dup(const AB_VALUE *ov)
 
   assert(ov);
   v=AB_Value_new();
-  mpq_set(v->value, ov->value);
+  if (ov->isFixed)
+    AB_Value__SetFixed(v, ov->fixedNum, ov->fixedScale);
+  else {
+    AB_Value__MakeRational(v);
+    mpq_set(v->value, ov->value);
+  }
+  v->currencyId=ov->currencyId;
   if (ov->currency)
     v->currency=strdup(ov->currency);
 
@@ -75,6 +149,228 @@ AB_VALUE *AB_Value_dup(const AB_VALUE *ov)
 
 
 
+void AB_Value__SetFixed(AB_VALUE *v, int64_t num, int scale)
+{
+  assert(scale>=0 && scale<=AB_VALUE_FIXED_MAXSCALE);
+  if (!v->isFixed) {
+    mpq_clear(v->value);
+    v->isFixed=1;
+  }
+  v->fixedNum=num;
+  v->fixedScale=scale;
+}
+
+
+
+void AB_Value__MakeRational(AB_VALUE *v)
+{
+  if (v->isFixed) {
+    mpq_init(v->value);
+    AB_Value__GetRational(v, v->value);
+    v->isFixed=0;
+  }
+}
+
+
+
+void AB_Value__GetRational(const AB_VALUE *v, mpq_t q)
+{
+  if (v->isFixed) {
+    AB_Value__MpzSetInt64(mpq_numref(q), v->fixedNum);
+    AB_Value__MpzSetInt64(mpq_denref(q), ab_value_pow10[v->fixedScale]);
+    mpq_canonicalize(q);
+  }
+  else
+    mpq_set(q, v->value);
+}
+
+
+
+void AB_Value__TryMakeFixed(AB_VALUE *v)
+{
+  int64_t num;
+  int64_t denom;
+  int scale;
+
+  if (v->isFixed || !ab_value_fixed_point_enabled)
+    return;
+
+  if (AB_Value__MpzGetInt64(mpq_numref(v->value), &num)<0 ||
+      AB_Value__MpzGetInt64(mpq_denref(v->value), &denom)<0 ||
+      denom<1)
+    return;
+
+  /* find the smallest power of ten which is a multiple of the denominator */
+  for (scale=0; scale<=AB_VALUE_FIXED_MAXSCALE; scale++) {
+    if ((ab_value_pow10[scale] % denom)==0) {
+      int64_t scaledNum;
+
+      if (AB_Value__Int64Mul(num, ab_value_pow10[scale]/denom, &scaledNum)==0)
+        AB_Value__SetFixed(v, scaledNum, scale);
+      return;
+    }
+  }
+}
+
+
+
+int AB_Value__ParseFixed(const char *s, int64_t *pNum, int *pScale)
+{
+  int64_t num=0;
+  int scale=0;
+  int digits=0;
+  int afterComma=0;
+
+  while (*s && *s!='/') {
+    if (*s>='0' && *s<='9') {
+      if (AB_Value__Int64Mul(num, 10, &num)<0 || AB_Value__Int64Add(num, (int64_t)(*s-'0'), &num)<0)
+        return GWEN_ERROR_BUFFER_OVERFLOW;
+      digits++;
+      if (afterComma) {
+        scale++;
+        if (scale>AB_VALUE_FIXED_MAXSCALE)
+          return GWEN_ERROR_BUFFER_OVERFLOW;
+      }
+    }
+    else if (*s=='.' && !afterComma)
+      afterComma=1;
+    else
+      return GWEN_ERROR_BAD_DATA;
+    s++;
+  }
+
+  if (digits<1)
+    return GWEN_ERROR_BAD_DATA;
+
+  if (*s=='/') {
+    /* only accept a denominator of the form "10...0" */
+    if (afterComma)
+      return GWEN_ERROR_BAD_DATA;
+    s++;
+    if (*s!='1')
+      return GWEN_ERROR_BAD_DATA;
+    s++;
+    while (*s=='0') {
+      scale++;
+      if (scale>AB_VALUE_FIXED_MAXSCALE)
+        return GWEN_ERROR_BUFFER_OVERFLOW;
+      s++;
+    }
+    if (*s)
+      return GWEN_ERROR_BAD_DATA;
+  }
+
+  *pNum=num;
+  *pScale=scale;
+  return 0;
+}
+
+
+
+int AB_Value__Int64Add(int64_t a, int64_t b, int64_t *pResult)
+{
+  /* INT64_MIN is never used so that negating a fixed-point value is always safe */
+  if ((b>0 && a>INT64_MAX-b) || (b<0 && a<-INT64_MAX-b))
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+  *pResult=a+b;
+  return 0;
+}
+
+
+
+int AB_Value__Int64Mul(int64_t a, int64_t b, int64_t *pResult)
+{
+  uint64_t ua;
+  uint64_t ub;
+
+  if (a==0 || b==0) {
+    *pResult=0;
+    return 0;
+  }
+  if (a==INT64_MIN || b==INT64_MIN)
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+
+  ua=(a<0)?(uint64_t)(-a):(uint64_t)a;
+  ub=(b<0)?(uint64_t)(-b):(uint64_t)b;
+  if (ua>((uint64_t)INT64_MAX)/ub)
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+  *pResult=a*b;
+  return 0;
+}
+
+
+
+void AB_Value__MpzSetInt64(mpz_t z, int64_t i)
+{
+  uint64_t u;
+
+  /* mpz_set_si() only takes a long which is 32 bit on some platforms */
+  u=(i<0)?(((uint64_t)(-(i+1)))+1):((uint64_t)i);
+  mpz_set_ui(z, (unsigned long)(u>>32));
+  mpz_mul_2exp(z, z, 32);
+  mpz_add_ui(z, z, (unsigned long)(u & 0xffffffffUL));
+  if (i<0)
+    mpz_neg(z, z);
+}
+
+
+
+int AB_Value__MpzGetInt64(const mpz_t z, int64_t *pResult)
+{
+  uint32_t words[2]= {0, 0};
+  size_t count=0;
+  uint64_t u;
+
+  if (mpz_sizeinbase(z, 2)>62)
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+  mpz_export(words, &count, -1, sizeof(uint32_t), 0, 0, z);
+  u=(((uint64_t)words[1])<<32) | ((uint64_t)words[0]);
+  *pResult=(mpz_sgn(z)<0)?(-((int64_t)u)):((int64_t)u);
+  return 0;
+}
+
+
+
+int AB_Value__Int64ToString(int64_t i, char *buffer, uint32_t buflen)
+{
+  char tmp[24];
+  char *p;
+  uint64_t u;
+  uint32_t len;
+
+  u=(i<0)?(((uint64_t)(-(i+1)))+1):((uint64_t)i);
+  p=tmp+sizeof(tmp);
+  do {
+    *(--p)='0'+(char)(u % 10);
+    u/=10;
+  } while (u);
+  if (i<0)
+    *(--p)='-';
+
+  len=(uint32_t)((tmp+sizeof(tmp))-p);
+  if (len>=buflen)
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+  memmove(buffer, p, len);
+  buffer[len]=0;
+  return (int)len;
+}
+
+
+
+int AB_Value__AlignFixed(const AB_VALUE *v1, const AB_VALUE *v2, int64_t *pNum1, int64_t *pNum2, int *pScale)
+{
+  int scale;
+
+  scale=(v1->fixedScale>v2->fixedScale)?v1->fixedScale:v2->fixedScale;
+  if (AB_Value__Int64Mul(v1->fixedNum, ab_value_pow10[scale-v1->fixedScale], pNum1)<0 ||
+      AB_Value__Int64Mul(v2->fixedNum, ab_value_pow10[scale-v2->fixedScale], pNum2)<0)
+    return GWEN_ERROR_BUFFER_OVERFLOW;
+  *pScale=scale;
+  return 0;
+}
+
+
+
 AB_VALUE *AB_Value_fromDouble(double i)
 {
   GWEN_BUFFER *nbuf;
@@ -94,6 +390,18 @@ AB_VALUE *AB_Value_fromInt(long int num, long int denom)
   AB_VALUE *v;
 
   v=AB_Value_new();
+  if (ab_value_fixed_point_enabled && denom>0) {
+    int scale;
+
+    for (scale=0; scale<=AB_VALUE_FIXED_MAXSCALE; scale++) {
+      if (ab_value_pow10[scale]==(int64_t) denom) {
+        AB_Value__SetFixed(v, (int64_t) num, scale);
+        return v;
+      }
+    }
+  }
+
+  AB_Value__MakeRational(v);
   mpq_set_si(v->value, num, denom);
 
   return v;
@@ -174,6 +482,19 @@ AB_VALUE *AB_Value_fromString(const char *s)
 
   v=AB_Value_new();
 
+  if (ab_value_fixed_point_enabled) {
+    int64_t num;
+    int scale;
+
+    if (AB_Value__ParseFixed(p, &num, &scale)==0) {
+      AB_Value__SetFixed(v, isNeg?-num:num, scale);
+      AB_Value__SetCurrency(v, currency);
+      free(tmpString);
+      return v;
+    }
+  }
+
+  AB_Value__MakeRational(v);
   t=strchr(p, '.');
   if (t) {
     // remove comma and calculate denominator
@@ -202,8 +523,7 @@ AB_VALUE *AB_Value_fromString(const char *s)
   }
 
   /* set currency (if any) */
-  if (currency)
-    v->currency=strdup(currency);
+  AB_Value__SetCurrency(v, currency);
 
   /* temporary string no longer needed */
   free(tmpString);
@@ -226,6 +546,8 @@ AB_VALUE *AB_Value_fromString(const char *s)
 const char *AB_Value_GetCurrency(const AB_VALUE *v)
 {
   assert(v);
+  if (v->currencyId)
+    return AB_Value__GetCurrencyById(v->currencyId);
   return v->currency;
 }
 
@@ -234,11 +556,69 @@ const char *AB_Value_GetCurrency(const AB_VALUE *v)
 void AB_Value_SetCurrency(AB_VALUE *v, const char *s)
 {
   assert(v);
+  AB_Value__SetCurrency(v, s);
+}
+
+
+
+void AB_Value__SetCurrency(AB_VALUE *v, const char *s)
+{
   free(v->currency);
-  if (s)
+  v->currency=NULL;
+  v->currencyId=AB_Value__InternCurrency(s);
+  if (v->currencyId==0 && s)
     v->currency=strdup(s);
-  else
-    v->currency=0;
+}
+
+
+
+uint32_t AB_Value__InternCurrency(const char *s)
+{
+  uint32_t key;
+  uint32_t pos;
+  uint32_t id=0;
+
+  /* only 3-letter codes are interned */
+  if (!(s && isalpha((unsigned char) s[0]) && isalpha((unsigned char) s[1]) && isalpha((unsigned char) s[2]) && s[3]==0))
+    return 0;
+
+  key=(((uint32_t)(unsigned char) s[0])<<16) | (((uint32_t)(unsigned char) s[1])<<8) | ((uint32_t)(unsigned char) s[2]);
+  pos=((key*2654435761u)>>16) & (AB_VALUE_CURRENCY_SLOTS-1);
+
+#ifdef AB_VALUE_USE_PTHREADS
+  pthread_mutex_lock(&ab_value_currency_mutex);
+#endif
+  while (ab_value_currency_slots[pos]) {
+    const char *t;
+
+    t=ab_value_currency_table[ab_value_currency_slots[pos]-1];
+    if (t[0]==s[0] && t[1]==s[1] && t[2]==s[2]) {
+      id=ab_value_currency_slots[pos];
+      break;
+    }
+    pos=(pos+1) & (AB_VALUE_CURRENCY_SLOTS-1);
+  }
+  if (id==0 && ab_value_currency_count<AB_VALUE_CURRENCY_TABLE_SIZE) {
+    /* table is at most half full, so there always is a free slot */
+    memmove(ab_value_currency_table[ab_value_currency_count], s, 4);
+    id=++ab_value_currency_count;
+    ab_value_currency_slots[pos]=(uint16_t) id;
+  }
+#ifdef AB_VALUE_USE_PTHREADS
+  pthread_mutex_unlock(&ab_value_currency_mutex);
+#endif
+
+  /* id is 0 if the table is full, the caller then stores the code with the value */
+  return id;
+}
+
+
+
+const char *AB_Value__GetCurrencyById(uint32_t id)
+{
+  if (id==0 || id>AB_VALUE_CURRENCY_TABLE_SIZE)
+    return NULL;
+  return ab_value_currency_table[id-1];
 }
 
 
@@ -274,9 +654,9 @@ int AB_Value_toDb(const AB_VALUE *v, GWEN_DB_NODE *db)
   GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS,
                        "value", GWEN_Buffer_GetStart(buf));
   GWEN_Buffer_free(buf);
-  if (v->currency)
+  if (AB_Value_GetCurrency(v))
     GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS,
-                         "currency", v->currency);
+                         "currency", AB_Value_GetCurrency(v));
   return 0;
 }
 
@@ -291,9 +671,9 @@ int AB_Value_toDbFloat(const AB_VALUE *v, GWEN_DB_NODE *db)
   GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS,
                        "value", GWEN_Buffer_GetStart(buf));
   GWEN_Buffer_free(buf);
-  if (v->currency)
+  if (AB_Value_GetCurrency(v))
     GWEN_DB_SetCharValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS,
-                         "currency", v->currency);
+                         "currency", AB_Value_GetCurrency(v));
   return 0;
 }
 
@@ -306,6 +686,20 @@ void AB_Value__toString(const AB_VALUE *v, GWEN_BUFFER *buf)
   char *p;
 
   assert(v);
+  if (v->isFixed) {
+    char numbuf[48];
+
+    rv=AB_Value__Int64ToString(v->fixedNum, numbuf, sizeof(numbuf));
+    assert(rv>0);
+    if (v->fixedScale) {
+      numbuf[rv++]='/';
+      rv=AB_Value__Int64ToString(ab_value_pow10[v->fixedScale], numbuf+rv, sizeof(numbuf)-rv);
+      assert(rv>0);
+    }
+    GWEN_Buffer_AppendString(buf, numbuf);
+    return;
+  }
+
   GWEN_Buffer_AllocRoom(buf, AB_VALUE_STRSIZE);
   p=GWEN_Buffer_GetPosPointer(buf);
   size=GWEN_Buffer_GetMaxUnsegmentedWrite(buf);
@@ -341,6 +735,24 @@ int AB_Value_GetNumDenomString(const AB_VALUE *v,
 
   assert(v);
 
+  if (v->isFixed) {
+    char numbuf[48];
+
+    rv=AB_Value__Int64ToString(v->fixedNum, numbuf, sizeof(numbuf));
+    assert(rv>0);
+    if (v->fixedScale) {
+      numbuf[rv++]='/';
+      rv=AB_Value__Int64ToString(ab_value_pow10[v->fixedScale], numbuf+rv, sizeof(numbuf)-rv);
+      assert(rv>0);
+    }
+    if (strlen(numbuf)>=buflen) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Buffer too small");
+      return GWEN_ERROR_BUFFER_OVERFLOW;
+    }
+    strcpy(buffer, numbuf);
+    return 0;
+  }
+
   rv=gmp_snprintf(buffer, buflen, "%Qu", v->value);
   if (rv<0 || rv>=buflen) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Buffer too small");
@@ -355,9 +767,9 @@ void AB_Value_toString(const AB_VALUE *v, GWEN_BUFFER *buf)
 {
   assert(v);
   AB_Value__toString(v, buf);
-  if (v->currency) {
+  if (AB_Value_GetCurrency(v)) {
     GWEN_Buffer_AppendString(buf, ":");
-    GWEN_Buffer_AppendString(buf, v->currency);
+    GWEN_Buffer_AppendString(buf, AB_Value_GetCurrency(v));
   }
 }
 
@@ -391,9 +803,9 @@ void AB_Value_toHumanReadableString(const AB_VALUE *v,
   }
   GWEN_Buffer_AppendString(buf, numbuf);
 
-  if (v->currency && withCurrency) {
+  if (AB_Value_GetCurrency(v) && withCurrency) {
     GWEN_Buffer_AppendString(buf, " ");
-    GWEN_Buffer_AppendString(buf, v->currency);
+    GWEN_Buffer_AppendString(buf, AB_Value_GetCurrency(v));
   }
 }
 
@@ -402,6 +814,8 @@ void AB_Value_toHumanReadableString(const AB_VALUE *v,
 double AB_Value_GetValueAsDouble(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed)
+    return ((double) v->fixedNum)/((double) ab_value_pow10[v->fixedScale]);
   if (mpz_fits_slong_p(mpq_numref(v->value)) && mpz_fits_slong_p(mpq_denref(v->value))) {
     return (double)(mpz_get_d(mpq_numref(v->value)) / mpz_get_d(mpq_denref(v->value)));
   }
@@ -415,6 +829,7 @@ double AB_Value_GetValueAsDouble(const AB_VALUE *v)
 void AB_Value_SetValueFromDouble(AB_VALUE *v, double i)
 {
   assert(v);
+  AB_Value__MakeRational(v);
   mpq_set_d(v->value, i);
 }
 
@@ -423,8 +838,12 @@ void AB_Value_SetValueFromDouble(AB_VALUE *v, double i)
 void AB_Value_SetZero(AB_VALUE *v)
 {
   assert(v);
-  mpq_clear(v->value);
-  mpq_init(v->value);
+  if (ab_value_fixed_point_enabled)
+    AB_Value__SetFixed(v, 0, 0);
+  else {
+    AB_Value__MakeRational(v);
+    mpq_set_ui(v->value, 0, 1);
+  }
 }
 
 
@@ -432,6 +851,8 @@ void AB_Value_SetZero(AB_VALUE *v)
 int AB_Value_IsZero(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed)
+    return (v->fixedNum==0);
   return (mpq_sgn(v->value)==0);
 }
 
@@ -440,6 +861,8 @@ int AB_Value_IsZero(const AB_VALUE *v)
 int AB_Value_IsNegative(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed)
+    return (v->fixedNum<0);
   return (mpq_sgn(v->value)<0);
 }
 
@@ -448,6 +871,8 @@ int AB_Value_IsNegative(const AB_VALUE *v)
 int AB_Value_IsPositive(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed)
+    return (v->fixedNum>=0);
   return (mpq_sgn(v->value)>=0);
 }
 
@@ -455,10 +880,31 @@ int AB_Value_IsPositive(const AB_VALUE *v)
 
 int AB_Value_Compare(const AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q1;
+  mpq_t q2;
+  int rv;
+
   assert(v1);
   assert(v2);
 
-  return mpq_cmp(v1->value, v2->value);
+  if (v1->isFixed && v2->isFixed) {
+    int64_t n1, n2;
+    int scale;
+
+    if (AB_Value__AlignFixed(v1, v2, &n1, &n2, &scale)==0)
+      return (n1<n2)?-1:((n1>n2)?1:0);
+  }
+  else if (!v1->isFixed && !v2->isFixed)
+    return mpq_cmp(v1->value, v2->value);
+
+  mpq_init(q1);
+  mpq_init(q2);
+  AB_Value__GetRational(v1, q1);
+  AB_Value__GetRational(v2, q2);
+  rv=mpq_cmp(q1, q2);
+  mpq_clear(q2);
+  mpq_clear(q1);
+  return rv;
 }
 
 int AB_Value_Equal(const AB_VALUE *v1, const AB_VALUE *v2)
@@ -466,17 +912,41 @@ int AB_Value_Equal(const AB_VALUE *v1, const AB_VALUE *v2)
   assert(v1);
   assert(v2);
 
-  return mpq_equal(v1->value, v2->value);
+  if (!v1->isFixed && !v2->isFixed)
+    return mpq_equal(v1->value, v2->value);
+  return (AB_Value_Compare(v1, v2)==0);
 }
 
 
 
 int AB_Value_AddValue(AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q2;
+
   assert(v1);
   assert(v2);
 
-  mpq_add(v1->value, v1->value, v2->value);
+  if (v1->isFixed && v2->isFixed) {
+    int64_t n1, n2;
+    int scale;
+
+    if (AB_Value__AlignFixed(v1, v2, &n1, &n2, &scale)==0 &&
+        AB_Value__Int64Add(n1, n2, &n1)==0) {
+      AB_Value__SetFixed(v1, n1, scale);
+      return 0;
+    }
+  }
+
+  AB_Value__MakeRational(v1);
+  if (v2->isFixed) {
+    mpq_init(q2);
+    AB_Value__GetRational(v2, q2);
+    mpq_add(v1->value, v1->value, q2);
+    mpq_clear(q2);
+  }
+  else
+    mpq_add(v1->value, v1->value, v2->value);
+  AB_Value__TryMakeFixed(v1);
   return 0;
 }
 
@@ -484,9 +954,32 @@ int AB_Value_AddValue(AB_VALUE *v1, const AB_VALUE *v2)
 
 int AB_Value_SubValue(AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q2;
+
   assert(v1);
   assert(v2);
-  mpq_sub(v1->value, v1->value, v2->value);
+
+  if (v1->isFixed && v2->isFixed) {
+    int64_t n1, n2;
+    int scale;
+
+    if (AB_Value__AlignFixed(v1, v2, &n1, &n2, &scale)==0 &&
+        AB_Value__Int64Add(n1, -n2, &n1)==0) {
+      AB_Value__SetFixed(v1, n1, scale);
+      return 0;
+    }
+  }
+
+  AB_Value__MakeRational(v1);
+  if (v2->isFixed) {
+    mpq_init(q2);
+    AB_Value__GetRational(v2, q2);
+    mpq_sub(v1->value, v1->value, q2);
+    mpq_clear(q2);
+  }
+  else
+    mpq_sub(v1->value, v1->value, v2->value);
+  AB_Value__TryMakeFixed(v1);
   return 0;
 }
 
@@ -494,10 +987,30 @@ int AB_Value_SubValue(AB_VALUE *v1, const AB_VALUE *v2)
 
 int AB_Value_MultValue(AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q2;
+
   assert(v1);
   assert(v2);
 
-  mpq_mul(v1->value, v1->value, v2->value);
+  if (v1->isFixed && v2->isFixed && (v1->fixedScale+v2->fixedScale)<=AB_VALUE_FIXED_MAXSCALE) {
+    int64_t n;
+
+    if (AB_Value__Int64Mul(v1->fixedNum, v2->fixedNum, &n)==0) {
+      AB_Value__SetFixed(v1, n, v1->fixedScale+v2->fixedScale);
+      return 0;
+    }
+  }
+
+  AB_Value__MakeRational(v1);
+  if (v2->isFixed) {
+    mpq_init(q2);
+    AB_Value__GetRational(v2, q2);
+    mpq_mul(v1->value, v1->value, q2);
+    mpq_clear(q2);
+  }
+  else
+    mpq_mul(v1->value, v1->value, v2->value);
+  AB_Value__TryMakeFixed(v1);
   return 0;
 }
 
@@ -505,10 +1018,21 @@ int AB_Value_MultValue(AB_VALUE *v1, const AB_VALUE *v2)
 
 int AB_Value_DivValue(AB_VALUE *v1, const AB_VALUE *v2)
 {
+  mpq_t q2;
+
   assert(v1);
   assert(v2);
 
-  mpq_div(v1->value, v1->value, v2->value);
+  AB_Value__MakeRational(v1);
+  if (v2->isFixed) {
+    mpq_init(q2);
+    AB_Value__GetRational(v2, q2);
+    mpq_div(v1->value, v1->value, q2);
+    mpq_clear(q2);
+  }
+  else
+    mpq_div(v1->value, v1->value, v2->value);
+  AB_Value__TryMakeFixed(v1);
   return 0;
 }
 
@@ -517,7 +1041,10 @@ int AB_Value_DivValue(AB_VALUE *v1, const AB_VALUE *v2)
 int AB_Value_Negate(AB_VALUE *v)
 {
   assert(v);
-  mpq_neg(v->value, v->value);
+  if (v->isFixed)
+    v->fixedNum=-v->fixedNum;
+  else
+    mpq_neg(v->value, v->value);
   return 0;
 }
 
@@ -534,8 +1061,11 @@ void AB_Value_Dump(const AB_VALUE *v, FILE *f, unsigned int indent)
     GWEN_BUFFER *nbuf;
 
     nbuf=GWEN_Buffer_new(0, 128, 0, 1);
+    AB_Value__toString(v, nbuf);
+    GWEN_Buffer_AppendString(nbuf, " (");
     AB_Value_toHumanReadableString(v, nbuf, 2, 1);
-    gmp_fprintf(f, "%Qi (%s)\n", v->value, GWEN_Buffer_GetStart(nbuf));
+    GWEN_Buffer_AppendString(nbuf, ")");
+    fprintf(f, "%s\n", GWEN_Buffer_GetStart(nbuf));
     GWEN_Buffer_free(nbuf);
   }
   else
@@ -571,6 +1101,17 @@ AB_VALUE_LIST *AB_Value_List_dup(const AB_VALUE_LIST *stl)
 long int AB_Value_Num(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed) {
+    mpq_t q;
+    long int l;
+
+    /* use the reduced fraction like for GMP values, 10^fixedScale might not even fit into a long */
+    mpq_init(q);
+    AB_Value__GetRational(v, q);
+    l=mpz_get_si(mpq_numref(q));
+    mpq_clear(q);
+    return l;
+  }
   return mpz_get_si(mpq_numref(v->value));
 }
 
@@ -579,6 +1120,17 @@ long int AB_Value_Num(const AB_VALUE *v)
 long int AB_Value_Denom(const AB_VALUE *v)
 {
   assert(v);
+  if (v->isFixed) {
+    mpq_t q;
+    long int l;
+
+    /* use the reduced fraction like for GMP values, 10^fixedScale might not even fit into a long */
+    mpq_init(q);
+    AB_Value__GetRational(v, q);
+    l=mpz_get_si(mpq_denref(q));
+    mpq_clear(q);
+    return l;
+  }
   return mpz_get_si(mpq_denref(v->value));
 }
 
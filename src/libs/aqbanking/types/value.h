@@ -134,6 +134,18 @@ AQBANKING_API long int AB_Value_Denom(const AB_VALUE *v);
 AQBANKING_API void AB_Value_toHbciString(const AB_VALUE *v, GWEN_BUFFER *buf);
 
 
+/**
+ * Enable or disable the internal fixed-point representation for values created afterwards (enabled by default).
+ * With fixed-point enabled decimal amounts are stored as scaled 64-bit integers, GMP rational numbers are
+ * only used when an amount doesn't fit. This is mainly meant for testing and benchmarking, existing values
+ * keep their representation.
+ * The setting is process-wide and not protected by a lock: Only call this during initialisation before any
+ * other threads are started which might create or modify values.
+ */
+AQBANKING_API void AB_Value_SetFixedPointEnabled(int b);
+AQBANKING_API int AB_Value_GetFixedPointEnabled(void);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,24 +17,53 @@
 #include <gmp.h>
 
 
-/** Internal structure of AB_VALUE -- do not access this directly! */
-struct AB_VALUE {
-  GWEN_LIST_ELEMENT(AB_VALUE)
+/** Maximum number of decimal places of the fixed-point representation (10^18 still fits into int64_t) */
+#define AB_VALUE_FIXED_MAXSCALE 18
 
-  mpq_t value;
-  char *currency;
-};
 
+/** Maximum number of 3-letter currency codes in the process-wide table (ISO 4217 has less than 200) */
+#define AB_VALUE_CURRENCY_TABLE_SIZE 256
 
-static void AB_Value__toString(const AB_VALUE *v, GWEN_BUFFER *buf);
+/** Number of hash slots for the currency table (power of two, at least twice the table size) */
+#define AB_VALUE_CURRENCY_SLOTS 512
 
 
-#endif /* AB_VALUE_P_H */
+/** Internal structure of AB_VALUE -- do not access this directly!
+ *
+ * Most values are decimal amounts like "12.34", those are stored as a scaled 64-bit integer
+ * (fixedNum/10^fixedScale) without touching GMP. Only if an amount doesn't fit into that
+ * representation (overflow, non-decimal denominator) the rational number in "value" is used.
+ */
+struct AB_VALUE {
+  GWEN_LIST_ELEMENT(AB_VALUE)
 
+  int isFixed;         /* if !=0: fixedNum/fixedScale are valid, "value" is not initialized */
+  int64_t fixedNum;
+  int fixedScale;
 
+  mpq_t value;
+  uint32_t currencyId; /* index+1 into the process-wide table of 3-letter codes, 0 if not interned */
+  char *currency;      /* other currency strings are stored with the value (then currencyId is 0) */
+};
 
 
+static void AB_Value__toString(const AB_VALUE *v, GWEN_BUFFER *buf);
 
+static void AB_Value__SetCurrency(AB_VALUE *v, const char *s);
+static uint32_t AB_Value__InternCurrency(const char *s);
+static const char *AB_Value__GetCurrencyById(uint32_t id);
 
+static void AB_Value__SetFixed(AB_VALUE *v, int64_t num, int scale);
+static void AB_Value__MakeRational(AB_VALUE *v);
+static void AB_Value__GetRational(const AB_VALUE *v, mpq_t q);
+static void AB_Value__TryMakeFixed(AB_VALUE *v);
+static int AB_Value__ParseFixed(const char *s, int64_t *pNum, int *pScale);
+static int AB_Value__Int64Add(int64_t a, int64_t b, int64_t *pResult);
+static int AB_Value__Int64Mul(int64_t a, int64_t b, int64_t *pResult);
+static void AB_Value__MpzSetInt64(mpz_t z, int64_t i);
+static int AB_Value__MpzGetInt64(const mpz_t z, int64_t *pResult);
+static int AB_Value__Int64ToString(int64_t i, char *buffer, uint32_t buflen);
+static int AB_Value__AlignFixed(const AB_VALUE *v1, const AB_VALUE *v2, int64_t *pNum1, int64_t *pNum2, int *pScale);
 
 
+#endif /* AB_VALUE_P_H */
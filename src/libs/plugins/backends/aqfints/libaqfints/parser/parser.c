@@ -49,6 +49,8 @@ void AQFINTS_Parser_free(AQFINTS_PARSER *parser)
 {
   if (parser) {
     GWEN_StringList_free(parser->pathList);
+    AQFINTS_SegmentIndex_free(parser->segmentsById);
+    AQFINTS_SegmentIndex_free(parser->segmentsByCode);
     AQFINTS_Segment_List_free(parser->segmentList);
     AQFINTS_JobDef_List_free(parser->jobDefList);
 
@@ -132,6 +134,12 @@ int AQFINTS_Parser_ReadFiles(AQFINTS_PARSER *parser)
   AQFINTS_Parser_SegmentList_ResolveGroups(parser->segmentList, groupTree);
   AQFINTS_Parser_SegmentList_Normalize(parser->segmentList);
 
+  /* index segment definitions for lookups by code and id */
+  AQFINTS_SegmentIndex_free(parser->segmentsByCode);
+  parser->segmentsByCode=AQFINTS_SegmentIndex_fromList(parser->segmentList, AQFINTS_SEGMENT_INDEX_KEY_CODE);
+  AQFINTS_SegmentIndex_free(parser->segmentsById);
+  parser->segmentsById=AQFINTS_SegmentIndex_fromList(parser->segmentList, AQFINTS_SEGMENT_INDEX_KEY_ID);
+
   /* cleanup */
   GWEN_StringList_free(slFiles);
   AQFINTS_Element_free(groupTree);
@@ -146,6 +154,9 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentByCode(const AQFINTS_PARSER *parser,
 {
   AQFINTS_SEGMENT *segment;
 
+  if (parser->segmentsByCode && id && *id)
+    return AQFINTS_SegmentIndex_FindSegment(parser->segmentsByCode, id, segmentVersion, protocolVersion);
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
     if ((segmentVersion==0 || segmentVersion==AQFINTS_Segment_GetSegmentVersion(segment)) &&
@@ -173,6 +184,9 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentById(const AQFINTS_PARSER *parser, co
 {
   AQFINTS_SEGMENT *segment;
 
+  if (parser->segmentsById && id && *id)
+    return AQFINTS_SegmentIndex_FindSegment(parser->segmentsById, id, segmentVersion, protocolVersion);
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
     if ((segmentVersion==0 || segmentVersion==AQFINTS_Segment_GetSegmentVersion(segment)) &&
@@ -203,6 +217,9 @@ AQFINTS_SEGMENT *AQFINTS_Parser_FindSegmentHighestVersionForProto(const AQFINTS_
   AQFINTS_SEGMENT *bestMatchSoFar=NULL;
 
   assert((id && *id));
+  if (parser->segmentsByCode)
+    return AQFINTS_SegmentIndex_FindHighestVersionForProto(parser->segmentsByCode, id, protocolVersion);
+
   segment=AQFINTS_Segment_List_First(parser->segmentList);
   while (segment) {
     int possibleMatch=0;
@@ -20,6 +20,8 @@
 #include <gwenhywfar/debug.h>
 
 #include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 
@@ -347,44 +349,56 @@ int readDe(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBu
 
 int readString(AQFINTS_ELEMENT *targetElement, const uint8_t *ptrBuf, uint32_t lenBuf)
 {
-  uint32_t origLenBuf;
-  GWEN_BUFFER *destBuf;
+  uint32_t i=0;
+  uint32_t escapeCount=0;
 
-  origLenBuf=lenBuf;
-  destBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  /* find end of DE in the buffer, count escape characters */
+  while (i<lenBuf && ptrBuf[i]) {
+    uint8_t c;
 
-  while (*ptrBuf && lenBuf) {
-    switch (*ptrBuf) {
-    case '\'':
-    case '+':
-    case ':':
+    c=ptrBuf[i];
+    if (c=='\'' || c=='+' || c==':') {
       /* end of segment, DEG or DE reached */
-      if (GWEN_Buffer_GetUsedBytes(destBuf))
-        AQFINTS_Element_SetTextDataCopy(targetElement, GWEN_Buffer_GetStart(destBuf));
-      GWEN_Buffer_free(destBuf);
-      return (int)(origLenBuf-lenBuf);
-    case '?':
+      if (i>escapeCount) {
+        uint32_t lenString;
+        uint8_t *ptrString;
+
+        /* create data of the element with a single allocation (element takes over the pointer) */
+        lenString=i-escapeCount;
+        ptrString=(uint8_t *) malloc(lenString+1);
+        assert(ptrString);
+        if (escapeCount==0)
+          memmove(ptrString, ptrBuf, lenString);
+        else {
+          const uint8_t *src;
+          uint8_t *dst;
+
+          src=ptrBuf;
+          dst=ptrString;
+          while (src<ptrBuf+i) {
+            if (*src=='?')
+              src++;
+            *(dst++)=*(src++);
+          }
+        }
+        ptrString[lenString]=0;
+        AQFINTS_Element_SetData(targetElement, ptrString, lenString+1);
+      }
+      return (int) i;
+    }
+    else if (c=='?') {
       /* escape character */
-      ptrBuf++;
-      lenBuf--;
-      if (lenBuf && *ptrBuf)
-        GWEN_Buffer_AppendByte(destBuf, *ptrBuf);
-      else {
+      i++;
+      if (!(i<lenBuf && ptrBuf[i])) {
         DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "Premature end of data (question mark was last character)");
-        GWEN_Buffer_free(destBuf);
         return GWEN_ERROR_BAD_DATA;
       }
-      break;
-    default:
-      GWEN_Buffer_AppendByte(destBuf, *ptrBuf);
-    } /* switch */
-
-    ptrBuf++;
-    lenBuf--;
+      escapeCount++;
+    }
+    i++;
   } /* while */
 
   DBG_ERROR(AQFINTS_PARSER_LOGDOMAIN, "No delimiter at end of data");
-  GWEN_Buffer_free(destBuf);
   return GWEN_ERROR_BAD_DATA;
 }
 
@@ -0,0 +1,237 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "libaqfints/parser/parser_index_p.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+static uint32_t _hashKey(const char *key);
+static int _compareRefs(const void *a, const void *b);
+static const AQFINTS_SEGMENT_INDEX_SLOT *_findSlot(const AQFINTS_SEGMENT_INDEX *idx, const char *key);
+
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AQFINTS_SEGMENT_INDEX *AQFINTS_SegmentIndex_fromList(const AQFINTS_SEGMENT_LIST *segmentList, int keyType)
+{
+  AQFINTS_SEGMENT_INDEX *idx;
+  AQFINTS_SEGMENT *segment;
+  int listPos=0;
+  int i;
+
+  GWEN_NEW_OBJECT(AQFINTS_SEGMENT_INDEX, idx);
+
+  /* collect segments */
+  idx->refs=(AQFINTS_SEGMENT_INDEX_REF *) malloc((AQFINTS_Segment_List_GetCount(segmentList)+1)*
+                                                 sizeof(AQFINTS_SEGMENT_INDEX_REF));
+  assert(idx->refs);
+  segment=AQFINTS_Segment_List_First(segmentList);
+  while (segment) {
+    const char *s;
+
+    s=(keyType==AQFINTS_SEGMENT_INDEX_KEY_ID)?AQFINTS_Segment_GetId(segment):AQFINTS_Segment_GetCode(segment);
+    if (s && *s) {
+      AQFINTS_SEGMENT_INDEX_REF *ref;
+
+      ref=&(idx->refs[idx->refCount++]);
+      ref->key=s;
+      ref->hash=_hashKey(s);
+      ref->segmentVersion=AQFINTS_Segment_GetSegmentVersion(segment);
+      ref->protocolVersion=AQFINTS_Segment_GetProtocolVersion(segment);
+      ref->listPos=listPos;
+      ref->segment=segment;
+    }
+    listPos++;
+    segment=AQFINTS_Segment_List_Next(segment);
+  }
+
+  /* sort by key, descending version and list position */
+  if (idx->refCount>1)
+    qsort(idx->refs, idx->refCount, sizeof(AQFINTS_SEGMENT_INDEX_REF), _compareRefs);
+
+  /* create hash table with one slot per key */
+  idx->slotCount=16;
+  while (idx->slotCount<((uint32_t) idx->refCount)*2)
+    idx->slotCount*=2;
+  idx->slots=(AQFINTS_SEGMENT_INDEX_SLOT *) calloc(idx->slotCount, sizeof(AQFINTS_SEGMENT_INDEX_SLOT));
+  assert(idx->slots);
+
+  i=0;
+  while (i<idx->refCount) {
+    const AQFINTS_SEGMENT_INDEX_REF *ref;
+    uint32_t pos;
+    int j;
+
+    ref=&(idx->refs[i]);
+    j=i+1;
+    while (j<idx->refCount && strcasecmp(idx->refs[j].key, ref->key)==0)
+      j++;
+
+    pos=ref->hash & (idx->slotCount-1);
+    while (idx->slots[pos].refs)
+      pos=(pos+1) & (idx->slotCount-1);
+    idx->slots[pos].refs=ref;
+    idx->slots[pos].refCount=j-i;
+    i=j;
+  }
+
+  return idx;
+}
+
+
+
+void AQFINTS_SegmentIndex_free(AQFINTS_SEGMENT_INDEX *idx)
+{
+  if (idx) {
+    free(idx->slots);
+    free(idx->refs);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+AQFINTS_SEGMENT *AQFINTS_SegmentIndex_FindSegment(const AQFINTS_SEGMENT_INDEX *idx,
+                                                  const char *key,
+                                                  int segmentVersion,
+                                                  int protocolVersion)
+{
+  const AQFINTS_SEGMENT_INDEX_SLOT *slot;
+  const AQFINTS_SEGMENT_INDEX_REF *bestMatchSoFar=NULL;
+  int i;
+
+  assert(idx);
+  slot=_findSlot(idx, key);
+  if (slot==NULL)
+    return NULL;
+
+  for (i=0; i<slot->refCount; i++) {
+    const AQFINTS_SEGMENT_INDEX_REF *ref;
+
+    ref=&(slot->refs[i]);
+    if (segmentVersion) {
+      if (ref->segmentVersion<segmentVersion)
+        /* versions are sorted in descending order, no more matches */
+        break;
+      if (ref->segmentVersion!=segmentVersion)
+        continue;
+    }
+    if (protocolVersion==0 || protocolVersion==ref->protocolVersion) {
+      if (bestMatchSoFar==NULL || ref->listPos<bestMatchSoFar->listPos)
+        bestMatchSoFar=ref;
+      if (segmentVersion)
+        /* same versions are sorted by list position, so this is the first one */
+        break;
+    }
+  }
+
+  return bestMatchSoFar?bestMatchSoFar->segment:NULL;
+}
+
+
+
+AQFINTS_SEGMENT *AQFINTS_SegmentIndex_FindHighestVersionForProto(const AQFINTS_SEGMENT_INDEX *idx,
+                                                                 const char *key,
+                                                                 int protocolVersion)
+{
+  const AQFINTS_SEGMENT_INDEX_SLOT *slot;
+  int i;
+
+  assert(idx);
+  slot=_findSlot(idx, key);
+  if (slot==NULL)
+    return NULL;
+
+  /* highest versions come first, same versions in list order */
+  for (i=0; i<slot->refCount; i++) {
+    const AQFINTS_SEGMENT_INDEX_REF *ref;
+
+    ref=&(slot->refs[i]);
+    if (protocolVersion==0 || protocolVersion>=ref->protocolVersion)
+      return ref->segment;
+  }
+
+  return NULL;
+}
+
+
+
+const AQFINTS_SEGMENT_INDEX_SLOT *_findSlot(const AQFINTS_SEGMENT_INDEX *idx, const char *key)
+{
+  uint32_t pos;
+
+  if (!(key && *key))
+    return NULL;
+
+  pos=_hashKey(key) & (idx->slotCount-1);
+  while (idx->slots[pos].refs) {
+    if (strcasecmp(idx->slots[pos].refs->key, key)==0)
+      return &(idx->slots[pos]);
+    pos=(pos+1) & (idx->slotCount-1);
+  }
+
+  return NULL;
+}
+
+
+
+uint32_t _hashKey(const char *key)
+{
+  uint32_t h=2166136261u;
+
+  while (*key) {
+    h^=(uint8_t) tolower((unsigned char) *key);
+    h*=16777619u;
+    key++;
+  }
+  return h;
+}
+
+
+
+int _compareRefs(const void *a, const void *b)
+{
+  const AQFINTS_SEGMENT_INDEX_REF *ra;
+  const AQFINTS_SEGMENT_INDEX_REF *rb;
+  int rv;
+
+  ra=(const AQFINTS_SEGMENT_INDEX_REF *) a;
+  rb=(const AQFINTS_SEGMENT_INDEX_REF *) b;
+
+  rv=strcasecmp(ra->key, rb->key);
+  if (rv)
+    return rv;
+  if (ra->segmentVersion!=rb->segmentVersion)
+    return (ra->segmentVersion>rb->segmentVersion)?-1:1;
+  return (ra->listPos<rb->listPos)?-1:((ra->listPos>rb->listPos)?1:0);
+}
+
+
@@ -0,0 +1,73 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_INDEX_H
+#define AQFINTS_PARSER_INDEX_H
+
+
+#include "libaqfints/parser/segment.h"
+
+
+/**
+ * Hash index over a list of segment definitions, keyed by segment code or id.
+ *
+ * For every key the segments are stored sorted by descending segment version (segments with the same
+ * version keep the order of the list), so lookups return the same segments as a linear search through
+ * the list would.
+ *
+ * The index only stores pointers to the segments, so the list must not be modified while the index is in use.
+ */
+typedef struct AQFINTS_SEGMENT_INDEX AQFINTS_SEGMENT_INDEX;
+
+
+#define AQFINTS_SEGMENT_INDEX_KEY_CODE 0
+#define AQFINTS_SEGMENT_INDEX_KEY_ID   1
+
+
+/**
+ * Create an index over the given list.
+ *
+ * @return index created
+ * @param segmentList list of segment definitions
+ * @param keyType key to use (AQFINTS_SEGMENT_INDEX_KEY_CODE or AQFINTS_SEGMENT_INDEX_KEY_ID)
+ */
+AQFINTS_SEGMENT_INDEX *AQFINTS_SegmentIndex_fromList(const AQFINTS_SEGMENT_LIST *segmentList, int keyType);
+
+void AQFINTS_SegmentIndex_free(AQFINTS_SEGMENT_INDEX *idx);
+
+
+/**
+ * Find the first segment (in list order) with the given key.
+ *
+ * @return segment found (NULL otherwise)
+ * @param idx index
+ * @param key code or id (depending on the key type of the index)
+ * @param segmentVersion segment version (0 matches any)
+ * @param protocolVersion protocol version (0 matches any)
+ */
+AQFINTS_SEGMENT *AQFINTS_SegmentIndex_FindSegment(const AQFINTS_SEGMENT_INDEX *idx,
+                                                  const char *key,
+                                                  int segmentVersion,
+                                                  int protocolVersion);
+
+
+/**
+ * Find the segment with the given key and the highest segment version whose protocol version is not higher
+ * than the given one.
+ *
+ * @return segment found (NULL otherwise)
+ * @param idx index
+ * @param key code or id (depending on the key type of the index)
+ * @param protocolVersion protocol version (0 matches any)
+ */
+AQFINTS_SEGMENT *AQFINTS_SegmentIndex_FindHighestVersionForProto(const AQFINTS_SEGMENT_INDEX *idx,
+                                                                 const char *key,
+                                                                 int protocolVersion);
+
+
+#endif
+
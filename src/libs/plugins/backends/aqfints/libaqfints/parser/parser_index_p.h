@@ -0,0 +1,42 @@
+/***************************************************************************
+
+ ***************************************************************************
+ * This file is part of the project "AqBanking".                           *
+ * Please see toplevel file COPYING of that project for license details.   *
+ ***************************************************************************/
+
+#ifndef AQFINTS_PARSER_INDEX_P_H
+#define AQFINTS_PARSER_INDEX_P_H
+
+
+#include "libaqfints/parser/parser_index.h"
+
+
+typedef struct AQFINTS_SEGMENT_INDEX_REF AQFINTS_SEGMENT_INDEX_REF;
+struct AQFINTS_SEGMENT_INDEX_REF {
+  const char *key;
+  uint32_t hash;
+  int segmentVersion;
+  int protocolVersion;
+  int listPos;                         /* position of the segment in the list */
+  AQFINTS_SEGMENT *segment;
+};
+
+
+typedef struct AQFINTS_SEGMENT_INDEX_SLOT AQFINTS_SEGMENT_INDEX_SLOT;
+struct AQFINTS_SEGMENT_INDEX_SLOT {
+  const AQFINTS_SEGMENT_INDEX_REF *refs;  /* first ref with this key (NULL if slot unused) */
+  int refCount;
+};
+
+
+struct AQFINTS_SEGMENT_INDEX {
+  AQFINTS_SEGMENT_INDEX_REF *refs;     /* sorted by key, descending segment version and list position */
+  int refCount;
+  AQFINTS_SEGMENT_INDEX_SLOT *slots;   /* hash table (open addressing, number of slots is a power of 2) */
+  uint32_t slotCount;
+};
+
+
+#endif
+
@@ -14,6 +14,7 @@
 
 
 #include "libaqfints/parser/parser.h"
+#include "libaqfints/parser/parser_index.h"
 
 #include <gwenhywfar/stringlist.h>
 
@@ -22,6 +23,8 @@
 struct AQFINTS_PARSER {
   AQFINTS_JOBDEF_LIST *jobDefList;
   AQFINTS_SEGMENT_LIST *segmentList;
+  AQFINTS_SEGMENT_INDEX *segmentsByCode;
+  AQFINTS_SEGMENT_INDEX *segmentsById;
   GWEN_STRINGLIST *pathList;
 };
 
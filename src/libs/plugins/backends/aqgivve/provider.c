@@ -22,6 +22,9 @@
 #include <string.h>
 #include "userdialog.h"
 #include "provider_request.h"
+#include "aqbanking/banking_be.h"
+#include "aqbanking/backendsupport/workerpool_l.h"
+#include <stdlib.h>
 
 
 
@@ -43,7 +46,9 @@ static AB_USER *AG_Provider_CreateUserObject(AB_PROVIDER *pro);
 
 static void AG_Provider_AddTransactionLimit(int limit, AB_TRANSACTION_LIMITS_LIST *tll);
 static int AG_Provider_ExecGetBal(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, char *token);
-static int AG_Provider_ExecGetTrans(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, AB_TRANSACTION *j, char *token);
+static int AG_Provider_ExecGetTrans(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, AB_TRANSACTION *j, char *token,
+                                    int page_threads);
+static int AG_Provider_ExecAccountJob(void *user_data, int idx);
 
 
 
@@ -91,6 +96,7 @@ int AG_Provider_SendCommands(AB_PROVIDER *pro, AB_PROVIDERQUEUE *pq, AB_IMEXPORT
   AB_USERQUEUE_LIST *uql;
   AB_USERQUEUE *uq;
   AB_ACCOUNTQUEUE *aq;
+  int result = 0;
 
   uql=AB_UserQueue_List_new();
   AB_Provider_SortProviderQueueIntoUserQueueList(pro, pq, uql);
@@ -105,13 +111,24 @@ int AG_Provider_SendCommands(AB_PROVIDER *pro, AB_PROVIDERQUEUE *pq, AB_IMEXPORT
 
     char *token;
 
-    token = AG_Provider_Request_GetToken(u);
+    token = AG_Provider_Request_GetToken(pro, u);
 
     if (token) {
+      AG_ACCOUNT_JOB *jobs;
+      int job_count;
+      int max_threads;
+      int num_threads;
+      int page_threads;
+      int rv;
+      int i;
 
       aql=AB_UserQueue_GetAccountQueueList(uq);
+      job_count = AB_AccountQueue_List_GetCount(aql);
+      jobs = (AG_ACCOUNT_JOB *) calloc(job_count ? job_count : 1, sizeof(AG_ACCOUNT_JOB));
+      assert(jobs);
 
-
+      /* account infos are added to the context before the vouchers are handled in parallel */
+      i = 0;
       aq=AB_AccountQueue_List_First(aql);
       while (aq) {
 
@@ -123,46 +140,96 @@ int AG_Provider_SendCommands(AB_PROVIDER *pro, AB_PROVIDERQUEUE *pq, AB_IMEXPORT
                                                                                AB_Account_GetBankCode(a),
                                                                                AB_Account_GetAccountNumber(a),
                                                                                AB_Account_GetAccountType(a));
+        jobs[i].provider = pro;
+        jobs[i].account_queue = aq;
+        jobs[i].account_info = ai;
+        jobs[i].token = token;
+        i++;
 
-        AB_TRANSACTION_LIST2 *tl2 = AB_AccountQueue_GetTransactionList(aq);
+        aq = AB_AccountQueue_List_Next(aq);
+      }
+
+      max_threads = AB_Banking_RuntimeConfig_GetIntValue(AB_Provider_GetBanking(pro), "givveRequestThreads",
+                                                         AG_REQUEST_THREADS);
+      num_threads = max_threads;
+      if (num_threads > job_count)
+        num_threads = job_count;
+      if (num_threads > 1 && !AB_WorkerPool_HasThreads())
+        num_threads = 1;
+
+      if (num_threads > 1 && AB_Banking_BeginThreadedUse(AB_Provider_GetBanking(pro)) < 0)
+        num_threads = 1;
+
+      /* "givveRequestThreads" limits all parallel requests: when vouchers are handled in parallel their pages are
+       * requested one after the other, otherwise the pages of each voucher may be requested in parallel */
+      page_threads = (num_threads > 1) ? 1 : max_threads;
+      for (i = 0; i < job_count; i++)
+        jobs[i].page_threads = page_threads;
+
+      rv = AB_WorkerPool_Run(job_count, num_threads, AG_Provider_ExecAccountJob, jobs);
+      if (num_threads > 1)
+        AB_Banking_EndThreadedUse(AB_Provider_GetBanking(pro));
+      if (rv < 0) {
+        DBG_INFO(AQGIVVE_LOGDOMAIN, "Error handling vouchers of user \"%s\" (%d)", AB_User_GetUserId(u), rv);
+        if (result == 0)
+          result = rv;
+      }
 
-        AB_TRANSACTION_LIST2_ITERATOR *it;
+      free(jobs);
+      free(token);
+    }
+    uq=AB_UserQueue_List_Next(uq);
+  }
 
-        it=AB_Transaction_List2_First(tl2);
+  return result;
+}
 
-        AB_TRANSACTION *t;
 
-        t=AB_Transaction_List2Iterator_Data(it);
-        while (t) {
-          int command = AB_Transaction_GetCommand(t);
-          DBG_INFO(AQGIVVE_LOGDOMAIN, "command: %d", command);
-          switch (command) {
-          case AB_Transaction_CommandGetBalance:
-            AG_Provider_ExecGetBal(pro, ai, a, token);
-            break;
-          case AB_Transaction_CommandGetTransactions:
-            AG_Provider_ExecGetTrans(pro, ai, a, t, token);
-            break;
-          default:
-            break;
-          }
-          AB_Transaction_SetStatus(t, AB_Transaction_StatusAccepted);
-          t=AB_Transaction_List2Iterator_Next(it);
-        }
 
-        AB_Transaction_List2Iterator_free(it);
+/* handles all commands for one voucher, may run in parallel with other vouchers */
+int AG_Provider_ExecAccountJob(void *user_data, int idx)
+{
+  AG_ACCOUNT_JOB *job = ((AG_ACCOUNT_JOB *) user_data) + idx;
+  AB_ACCOUNT *a = AB_AccountQueue_GetAccount(job->account_queue);
 
+  AB_TRANSACTION_LIST2 *tl2 = AB_AccountQueue_GetTransactionList(job->account_queue);
 
-        aq = AB_AccountQueue_List_Next(aq);
-      }
+  AB_TRANSACTION_LIST2_ITERATOR *it;
 
+  it=AB_Transaction_List2_First(tl2);
 
-      free(token);
+  AB_TRANSACTION *t;
+  int result = 0;
+
+  t=AB_Transaction_List2Iterator_Data(it);
+  while (t) {
+    int command = AB_Transaction_GetCommand(t);
+    int rv = 0;
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "command: %d", command);
+    switch (command) {
+    case AB_Transaction_CommandGetBalance:
+      rv = AG_Provider_ExecGetBal(job->provider, job->account_info, a, job->token);
+      break;
+    case AB_Transaction_CommandGetTransactions:
+      rv = AG_Provider_ExecGetTrans(job->provider, job->account_info, a, t, job->token, job->page_threads);
+      break;
+    default:
+      break;
     }
-    uq=AB_UserQueue_List_Next(uq);
+    if (rv < 0) {
+      DBG_INFO(AQGIVVE_LOGDOMAIN, "here (%d)", rv);
+      AB_Transaction_SetStatus(t, AB_Transaction_StatusError);
+      if (result == 0)
+        result = rv;
+    }
+    else
+      AB_Transaction_SetStatus(t, AB_Transaction_StatusAccepted);
+    t=AB_Transaction_List2Iterator_Next(it);
   }
 
-  return 0;
+  AB_Transaction_List2Iterator_free(it);
+
+  return result;
 }
 
 
@@ -252,7 +319,7 @@ int AG_Provider_UpdateAccountSpec(AB_PROVIDER *pro, AB_ACCOUNT_SPEC *as, int doL
 
 int AG_Provider_ExecGetBal(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, char *token)
 {
-  AB_BALANCE *bal = AG_Provider_Request_GetBalance(account, token);
+  AB_BALANCE *bal = AG_Provider_Request_GetBalance(pro, account, token);
   if (bal) {
     AB_ImExporterAccountInfo_AddBalance(ai, bal);
   }
@@ -263,13 +330,18 @@ int AG_Provider_ExecGetBal(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_A
 
 
 
-int AG_Provider_ExecGetTrans(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, AB_TRANSACTION *j, char *token)
+int AG_Provider_ExecGetTrans(AB_PROVIDER *pro, AB_IMEXPORTER_ACCOUNTINFO *ai, AB_ACCOUNT *account, AB_TRANSACTION *j, char *token,
+                             int page_threads)
 {
 
-  AB_TRANSACTION_LIST *list = AG_Provider_Request_GetTransactions(account, AB_Transaction_GetFirstDate(j),
-                                                                  AB_Transaction_GetLastDate(j), token);
+  AB_TRANSACTION_LIST *list = AG_Provider_Request_GetTransactions(pro, account, AB_Transaction_GetFirstDate(j),
+                                                                  AB_Transaction_GetLastDate(j), token, page_threads);
   AB_TRANSACTION *t;
-  if (list) {
+  if (list == NULL) {
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "Could not get transactions");
+    return GWEN_ERROR_GENERIC;
+  }
+  else {
     DBG_INFO(AQGIVVE_LOGDOMAIN, "trans count: %d", AB_Transaction_List_GetCount(list));
     t = AB_Transaction_List_First(list);
     while (t) {
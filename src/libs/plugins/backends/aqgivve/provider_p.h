@@ -23,6 +23,17 @@ struct AG_PROVIDER {
 };
 
 
+/* commands of one voucher (account) */
+typedef struct AG_ACCOUNT_JOB AG_ACCOUNT_JOB;
+struct AG_ACCOUNT_JOB {
+  AB_PROVIDER *provider;
+  AB_ACCOUNTQUEUE *account_queue;
+  AB_IMEXPORTER_ACCOUNTINFO *account_info;
+  char *token;
+  int page_threads;          /* number of pages of a listing requested in parallel */
+};
+
+
 
 #endif
 
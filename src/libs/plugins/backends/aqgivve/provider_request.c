@@ -16,9 +16,15 @@
 #include "gwenhywfar/json_read.h"
 #include "meta.h"
 #include "merchant.h"
-#include <gwenhywfar/syncio_http.h>
+#include <aqbanking/backendsupport/httpsession.h>
+#include "aqbanking/banking_be.h"
+#include "aqbanking/backendsupport/workerpool_l.h"
+
 #include <gwenhywfar/gui.h>
+#include <assert.h>
 #include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 /* ------------------------------------------------------------------------------------------------
@@ -26,10 +32,14 @@
  * ------------------------------------------------------------------------------------------------
  */
 
-static void GWENHYWFAR_CB _freeData(void *bp, void *p);
-static GWEN_JSON_ELEM *_sendRequest(char *method, char *url, GWEN_DB_NODE *header_params, char *send_data_buf);
+static GWEN_JSON_ELEM *_sendRequest(AB_PROVIDER *pro, const char *method, const char *path,
+                                    GWEN_DB_NODE *header_params, const char *send_data_buf);
+static int _fetchPages(AB_PROVIDER *pro, GWEN_DB_NODE *header, const char *path_prefix, const char *path_suffix,
+                       int max_threads, GWEN_JSON_ELEM ***p_pages, int *p_page_count);
+static int _fetchPageJob(void *user_data, int idx);
+static GWEN_JSON_ELEM *_fetchPage(const AG_PAGE_FETCH *fetch, int page);
+static void _freePages(GWEN_JSON_ELEM **pages, int page_count);
 
-static int GWENHYWFAR_CB _cbInitSyncIo(GWEN_HTTP_SESSION *sess, GWEN_SYNCIO *sio);
 static GWEN_DATE *_parseDate(const char *date_str);
 static AB_VALUE *_parseMoney(GWEN_JSON_ELEM *value_elem);
 static AB_BALANCE *_parseBalance(GWEN_JSON_ELEM *balance_elem);
@@ -44,115 +54,146 @@ static GWEN_JSON_ELEM *_getElement(GWEN_JSON_ELEM *parent, const char *key);
  * ------------------------------------------------------------------------------------------------
  */
 
-GWEN_INHERIT(GWEN_HTTP_SESSION, AG_HTTP_SESSION_HEADER);
-
-
-
-void GWENHYWFAR_CB _freeData(void *bp, void *p)
+GWEN_JSON_ELEM *_sendRequest(AB_PROVIDER *pro, const char *method, const char *path, GWEN_DB_NODE *header_params,
+                             const char *send_data_buf)
 {
-  free(p);
-}
-
+  GWEN_BUFFER *urlBuf;
+  GWEN_BUFFER *tbuf;
+  GWEN_JSON_ELEM *root_elem;
+  size_t send_data_len = 0;
+  int rv;
 
+  if (send_data_buf) {
+    send_data_len = strlen(send_data_buf);
+  }
 
-int GWENHYWFAR_CB _cbInitSyncIo(GWEN_HTTP_SESSION *sess, GWEN_SYNCIO *sio)
-{
-  AG_HTTP_SESSION_HEADER *xsess;
+  urlBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendString(urlBuf, "https://www.givve.com");
+  GWEN_Buffer_AppendString(urlBuf, path);
 
+  /* connections to the server are kept alive by the provider between requests */
+  tbuf=GWEN_Buffer_new(0, 50000, 0, 1);
+  rv=AB_HttpSession_SendPooledRequest(pro, NULL, GWEN_Buffer_GetStart(urlBuf), "https", 443, 1, 1, method,
+                                      header_params,
+                                      (const uint8_t *) send_data_buf, send_data_len,
+                                      tbuf);
+  GWEN_Buffer_free(urlBuf);
+  if (rv < 0) {
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "Request failed: %d", rv);
+    GWEN_Buffer_free(tbuf);
+    return NULL;
+  }
 
-  xsess = GWEN_INHERIT_GETDATA(GWEN_HTTP_SESSION, AG_HTTP_SESSION_HEADER, sess);
+  root_elem = GWEN_JsonElement_fromString(GWEN_Buffer_GetStart(tbuf));
 
-  GWEN_DB_NODE *header = GWEN_SyncIo_Http_GetDbHeaderOut(sio);
+  GWEN_Buffer_free(tbuf);
+  return root_elem;
+}
 
-  if (xsess->url) {
-    GWEN_DB_NODE *command = GWEN_SyncIo_Http_GetDbCommandOut(sio);
-    GWEN_DB_SetCharValue(command, GWEN_DB_FLAGS_OVERWRITE_VARS, "url", xsess->url);
-  }
 
 
-  GWEN_DB_NODE *var = GWEN_DB_GetFirstVar(xsess->header);
+/* Requests all pages of a listing. The first page tells the number of pages, the remaining pages are
+ * requested in parallel (up to max_threads at a time) and returned in page order. The pages are always returned
+ * (missing pages are NULL) and must be freed with _freePages(), an error is returned if any page is missing.
+ */
+int _fetchPages(AB_PROVIDER *pro, GWEN_DB_NODE *header, const char *path_prefix, const char *path_suffix,
+                int max_threads, GWEN_JSON_ELEM ***p_pages, int *p_page_count)
+{
+  AG_PAGE_FETCH fetch;
+  GWEN_JSON_ELEM *first_page;
+  int rv = 0;
+
+  memset(&fetch, 0, sizeof(fetch));
+  fetch.provider = pro;
+  fetch.header = header;
+  fetch.path_prefix = path_prefix;
+  fetch.path_suffix = path_suffix;
+  fetch.page_count = 1;
+
+  first_page = _fetchPage(&fetch, 1);
+  if (first_page) {
+    AG_META *meta = AG_META_FromJsonElem(_getElement(first_page, "meta"));
+
+    if (meta) {
+      if (AG_META_GetTotalPages(meta) > 1)
+        fetch.page_count = AG_META_GetTotalPages(meta);
+      AG_META_free(meta);
+    }
+  }
+  else {
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "First page could not be received");
+    rv = GWEN_ERROR_GENERIC;
+  }
 
-  while (var) {
-    GWEN_DB_NODE *val = GWEN_DB_GetFirstValue(var);
-    GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, GWEN_DB_VariableName(var),
-                         GWEN_DB_GetCharValueFromNode(val));
-    var = GWEN_DB_GetNextVar(var);
+  fetch.pages = (GWEN_JSON_ELEM **) calloc(fetch.page_count, sizeof(GWEN_JSON_ELEM *));
+  assert(fetch.pages);
+  fetch.pages[0] = first_page;
+
+  if (fetch.page_count > 1) {
+    AB_BANKING *ab = AB_Provider_GetBanking(pro);
+    int num_threads = max_threads;
+
+    if (num_threads > 1 && !AB_WorkerPool_HasThreads())
+      num_threads = 1;
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "Requesting %d more pages using %d threads", fetch.page_count - 1, num_threads);
+
+    if (num_threads > 1 && AB_Banking_BeginThreadedUse(ab) < 0)
+      num_threads = 1;
+    rv = AB_WorkerPool_Run(fetch.page_count - 1, num_threads, _fetchPageJob, &fetch);
+    if (num_threads > 1)
+      AB_Banking_EndThreadedUse(ab);
+    if (rv < 0) {
+      DBG_INFO(AQGIVVE_LOGDOMAIN, "Some pages could not be received: %d", rv);
+    }
   }
 
-  return 0;
+  *p_pages = fetch.pages;
+  *p_page_count = fetch.page_count;
+  return rv;
 }
 
 
 
-GWEN_JSON_ELEM *_sendRequest(char *method, char *url, GWEN_DB_NODE *header_params, char *send_data_buf)
+int _fetchPageJob(void *user_data, int idx)
 {
-  char *url_base = "https://www.givve.com";
+  AG_PAGE_FETCH *fetch = (AG_PAGE_FETCH *) user_data;
 
-  size_t send_data_len = 0;
-
-  if (send_data_buf) {
-    send_data_len = strlen(send_data_buf);
-  }
+  /* job 0 requests page 2, every job only writes its own slot */
+  fetch->pages[idx + 1] = _fetchPage(fetch, idx + 2);
+  return fetch->pages[idx + 1] ? 0 : GWEN_ERROR_GENERIC;
+}
 
 
-  GWEN_JSON_ELEM *root_elem = NULL;
 
-  GWEN_HTTP_SESSION *sess;
-  GWEN_BUFFER *tbuf;
-  int rv;
-  sess=GWEN_HttpSession_new(url_base, " https", 443);
-  if (sess==NULL) {
-    DBG_ERROR(AQGIVVE_LOGDOMAIN, "Could not create http session for ");
-    GWEN_HttpSession_free(sess);
-    return NULL;
-  }
+GWEN_JSON_ELEM *_fetchPage(const AG_PAGE_FETCH *fetch, int page)
+{
+  GWEN_BUFFER *path_buf;
+  GWEN_JSON_ELEM *json_root;
 
-  AG_HTTP_SESSION_HEADER *xsess;
-  GWEN_NEW_OBJECT(AG_HTTP_SESSION_HEADER, xsess);
-  GWEN_INHERIT_SETDATA(GWEN_HTTP_SESSION, AG_HTTP_SESSION_HEADER, sess, xsess, _freeData);
+  path_buf = GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendArgs(path_buf, "%s%d%s", fetch->path_prefix, page, fetch->path_suffix);
+  json_root = _sendRequest(fetch->provider, "GET", GWEN_Buffer_GetStart(path_buf), fetch->header, NULL);
+  GWEN_Buffer_free(path_buf);
 
-  xsess->header = header_params;
-  xsess->url = url;
+  return json_root;
+}
 
-  GWEN_HttpSession_SetInitSyncIoFn(sess, _cbInitSyncIo);
 
-  rv = GWEN_HttpSession_Init(sess);
-  if (rv < 0) {
-    DBG_INFO(AQGIVVE_LOGDOMAIN, "Session init failed: %d", rv);
-    GWEN_HttpSession_free(sess);
-    return NULL;
-  }
 
-  rv=GWEN_HttpSession_SendPacket(sess, method, (const uint8_t *) send_data_buf, send_data_len);
-  if (rv < 0) {
-    DBG_INFO(AQGIVVE_LOGDOMAIN, "Send data failed: %d", rv);
-    GWEN_HttpSession_Fini(sess);
-    GWEN_HttpSession_free(sess);
-    return NULL;
-  }
+void _freePages(GWEN_JSON_ELEM **pages, int page_count)
+{
+  if (pages) {
+    int i;
 
-  tbuf=GWEN_Buffer_new(0, 50000, 0, 1);
-  rv=GWEN_HttpSession_RecvPacket(sess, tbuf);
-  if (rv < 0) {
-    DBG_INFO(AQGIVVE_LOGDOMAIN, "Receive data failed: %d", rv);
-    GWEN_HttpSession_Fini(sess);
-    GWEN_Buffer_free(tbuf);
-    GWEN_HttpSession_free(sess);
-    return NULL;
+    for (i = 0; i < page_count; i++)
+      GWEN_JsonElement_free(pages[i]);
+    free(pages);
   }
-
-  root_elem = GWEN_JsonElement_fromString(GWEN_Buffer_GetStart(tbuf));
-
-  GWEN_HttpSession_Fini(sess);
-  GWEN_Buffer_free(tbuf);
-  GWEN_HttpSession_free(sess);
-  return root_elem;
-
 }
 
 
 
-char *AG_Provider_Request_GetToken(AB_USER *user)
+char *AG_Provider_Request_GetToken(AB_PROVIDER *pro, AB_USER *user)
 {
   char *token = NULL;
   char text[512];
@@ -177,7 +218,7 @@ char *AG_Provider_Request_GetToken(AB_USER *user)
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept", "application/json");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept-Version", "v2");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Content-Type", "application/json");
-  GWEN_JSON_ELEM *json_root = _sendRequest("POST", "/api/authorizations", header, request);
+  GWEN_JSON_ELEM *json_root = _sendRequest(pro, "POST", "/api/authorizations", header, request);
 
   if (json_root) {
     GWEN_JSON_ELEM *json_data = _getElement(json_root, "data");
@@ -220,12 +261,12 @@ char *AG_Provider_Request_GetToken(AB_USER *user)
 
 
 
-AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(char *token)
+AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(AB_PROVIDER *pro, char *token)
 {
-
-  int total_pages = 1;
-  int current_page = 1;
-  char path[512];
+  GWEN_JSON_ELEM **pages;
+  int page_count = 0;
+  int i;
+  int rv;
 
   AG_VOUCHERLIST *card_list = AG_VOUCHERLIST_new();
 
@@ -234,12 +275,17 @@ AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(char *token)
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept-Version", "v2");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Authorization", token);
 
+  rv = _fetchPages(pro, header, "/api/vouchers?page[number]=", "",
+                   AB_Banking_RuntimeConfig_GetIntValue(AB_Provider_GetBanking(pro), "givveRequestThreads",
+                                                        AG_REQUEST_THREADS),
+                   &pages, &page_count);
+  if (rv < 0) {
+    /* still show the vouchers which were received */
+    DBG_WARN(AQGIVVE_LOGDOMAIN, "Voucher list is incomplete (%d)", rv);
+  }
 
-  while (current_page <= total_pages) {
-
-    snprintf(path, sizeof(path) - 1, "/api/vouchers?page[number]=%d",  current_page);
-
-    GWEN_JSON_ELEM *json_root = _sendRequest("GET", path, header, NULL);
+  for (i = 0; i < page_count; i++) {
+    GWEN_JSON_ELEM *json_root = pages[i];
 
     if (json_root) {
 
@@ -278,17 +324,17 @@ AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(char *token)
         }
 
       }
-      GWEN_JsonElement_free(json_root);
     }
-    current_page++;
   }
+  _freePages(pages, page_count);
+  GWEN_DB_Group_free(header);
 
   return card_list;
 }
 
 
 
-AB_BALANCE *AG_Provider_Request_GetBalance(AB_ACCOUNT *account, const char *token)
+AB_BALANCE *AG_Provider_Request_GetBalance(AB_PROVIDER *pro, AB_ACCOUNT *account, const char *token)
 {
 
   const char *id = AB_Account_GetAccountNumber(account);
@@ -301,7 +347,7 @@ AB_BALANCE *AG_Provider_Request_GetBalance(AB_ACCOUNT *account, const char *toke
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept", "application/json");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept-Version", "v2");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Authorization", token);
-  GWEN_JSON_ELEM *json_root = _sendRequest("GET", path, header, NULL);
+  GWEN_JSON_ELEM *json_root = _sendRequest(pro, "GET", path, header, NULL);
 
   AB_BALANCE *bal = NULL;
 
@@ -330,14 +376,18 @@ AB_BALANCE *AG_Provider_Request_GetBalance(AB_ACCOUNT *account, const char *toke
 
 
 
-AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_ACCOUNT *account,
+AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_PROVIDER *pro, AB_ACCOUNT *account,
                                                          const GWEN_DATE *start_date,
                                                          const GWEN_DATE *end_date,
-                                                         const char *token)
+                                                         const char *token,
+                                                         int max_threads)
 {
-  int total_pages = 1;
-  int current_page = 1;
-  char path[512];
+  GWEN_JSON_ELEM **pages;
+  int page_count = 0;
+  int i;
+  int rv;
+  char path_prefix[512];
+  char path_suffix[512];
 
   AB_TRANSACTION_LIST *trans_list = AB_Transaction_List_new();
 
@@ -348,32 +398,30 @@ AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_ACCOUNT *account,
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Accept-Version", "v2");
   GWEN_DB_SetCharValue(header, GWEN_DB_FLAGS_OVERWRITE_VARS, "Authorization", token);
 
-  while (current_page <= total_pages) {
+  char *filter_start = _createDateFilter(start_date, "$gte");
+  char *filter_end = _createDateFilter(end_date, "$lte");
 
-    char *filter_start = _createDateFilter(start_date, "$gte");
-    char *filter_end = _createDateFilter(end_date, "$lte");
+  snprintf(path_prefix, sizeof(path_prefix) - 1, "/api/vouchers/%s/transactions/?page[number]=", id);
+  snprintf(path_suffix, sizeof(path_suffix) - 1, "&filter[status][$in]=Settled%s%s", filter_start, filter_end);
 
-    snprintf(path, sizeof(path) - 1, "/api/vouchers/%s/transactions/?page[number]=%d&filter[status][$in]=Settled%s%s", id,
-             current_page, filter_start, filter_end);
+  free(filter_start);
+  free(filter_end);
 
-    free(filter_start);
-    free(filter_end);
+  rv = _fetchPages(pro, header, path_prefix, path_suffix, max_threads, &pages, &page_count);
+  if (rv < 0) {
+    /* don't return an incomplete list of transactions */
+    DBG_INFO(AQGIVVE_LOGDOMAIN, "here (%d)", rv);
+    _freePages(pages, page_count);
+    GWEN_DB_Group_free(header);
+    AB_Transaction_List_free(trans_list);
+    return NULL;
+  }
 
-    GWEN_JSON_ELEM *json_root = _sendRequest("GET", path, header, NULL);
+  /* merge transactions in page order */
+  for (i = 0; i < page_count; i++) {
+    GWEN_JSON_ELEM *json_root = pages[i];
 
     if (json_root) {
-      GWEN_JSON_ELEM *json_meta = _getElement(json_root, "meta");
-      if (json_meta) {
-        AG_META *meta = AG_META_FromJsonElem(json_meta);
-
-        if (meta) {
-          total_pages =  AG_META_GetTotalPages(meta);
-          AG_META_free(meta);
-        }
-        GWEN_JsonElement_free(json_meta);
-
-      }
-
       GWEN_JSON_ELEM *json_data = _getElement(json_root, "data");
 
       if (json_data) {
@@ -388,12 +436,11 @@ AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_ACCOUNT *account,
           }
           json_transaction = GWEN_JsonElement_Tree2_GetNext(json_transaction);
         }
-        GWEN_JsonElement_free(json_data);
       }
-      GWEN_JsonElement_free(json_root);
     }
-    current_page++;
   }
+  _freePages(pages, page_count);
+  GWEN_DB_Group_free(header);
 
   return trans_list;
 }
@@ -12,16 +12,25 @@
 
 #include <aqbanking/banking.h>
 #include <aqbanking/backendsupport/user.h>
+#include <aqbanking/backendsupport/provider.h>
 #include <gwenhywfar/httpsession.h>
 #include "voucherlist.h"
 #include "gwenhywfar/json.h"
 
-char *AG_Provider_Request_GetToken(AB_USER *user);
-AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(char *token);
-AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_ACCOUNT *account,
+
+/* default for runtime variable "givveRequestThreads" (maximum number of requests running in parallel, either for
+ * different vouchers or for pages of one listing) */
+#define AG_REQUEST_THREADS 4
+
+
+char *AG_Provider_Request_GetToken(AB_PROVIDER *pro, AB_USER *user);
+AG_VOUCHERLIST *AG_Provider_Request_GetVoucherList(AB_PROVIDER *pro, char *token);
+AB_TRANSACTION_LIST *AG_Provider_Request_GetTransactions(AB_PROVIDER *pro,
+                                                         AB_ACCOUNT *account,
                                                          const GWEN_DATE *start_date,
                                                          const GWEN_DATE *end_date,
-                                                         const char *token);
-AB_BALANCE *AG_Provider_Request_GetBalance(AB_ACCOUNT *account, const char* token );
+                                                         const char *token,
+                                                         int max_threads);
+AB_BALANCE *AG_Provider_Request_GetBalance(AB_PROVIDER *pro, AB_ACCOUNT *account, const char* token );
 
 #endif
@@ -14,12 +14,16 @@
 #include "gwenhywfar/json.h"
 
 
-typedef struct AG_HTTP_SESSION_HEADER AG_HTTP_SESSION_HEADER;
-struct AG_HTTP_SESSION_HEADER {
+/* pages of a listing requested in parallel */
+typedef struct AG_PAGE_FETCH AG_PAGE_FETCH;
+struct AG_PAGE_FETCH {
+  AB_PROVIDER *provider;
   GWEN_DB_NODE *header;
-  char *url;
+  const char *path_prefix;   /* path up to the page number */
+  const char *path_suffix;   /* path after the page number */
+  GWEN_JSON_ELEM **pages;    /* JSON root of every page in page order (NULL if request failed) */
+  int page_count;
 };
 
 
-
 #endif
@@ -133,7 +133,7 @@ int _addUser(GWEN_DIALOG *dlg)
     AB_User_SetCustomerId(user, u_id);
     AB_Provider_WriteUser(xdlg->provider, AB_User_GetUniqueId(user), 1, 1, user);
 
-    char *token = AG_Provider_Request_GetToken(user);
+    char *token = AG_Provider_Request_GetToken(xdlg->provider, user);
 
     if (!token) {
       return GWEN_DialogEvent_ResultNotHandled;
@@ -141,7 +141,7 @@ int _addUser(GWEN_DIALOG *dlg)
     DBG_INFO(AQGIVVE_LOGDOMAIN, "token: %s ", token);
 
     AG_VOUCHERLIST *card_list;
-    card_list = AG_Provider_Request_GetVoucherList(token);
+    card_list = AG_Provider_Request_GetVoucherList(xdlg->provider, token);
     if (AG_VOUCHERLIST_Get_TotalEntries(card_list) < 1) {
       DBG_INFO(AQGIVVE_LOGDOMAIN, "no cards found");
       GWEN_Gui_MessageBox(GWEN_GUI_MSG_FLAGS_TYPE_WARN, "Warning", "Could not find any card", "OK", NULL, NULL, 0);
@@ -16,16 +16,21 @@
 #include "outbox_p.h"
 
 #include "aqhbci/ajobs/accountjob_l.h"
+#include "aqhbci/banking/user_l.h"
 
 #include "aqhbci/applayer/cbox_prepare.h"
 #include "aqhbci/applayer/cbox_queue.h"
 
 #include "aqbanking/i18n_l.h"
+#include "aqbanking/banking_be.h"
+#include "aqbanking/backendsupport/workerpool_l.h"
 
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/gui.h>
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 /*#define EXTREME_DEBUGGING */
@@ -43,6 +48,13 @@ static AH_JOB *_findTransferJobInCheckJobList(const AH_JOB_LIST *jl, AB_USER *u,
 static int _prepare(AH_OUTBOX *ob);
 static void _finishCBox(AH_OUTBOX *ob, AH_OUTBOX_CBOX *cbox);
 static int _sendAndRecvCustomerBoxes(AH_OUTBOX *ob);
+static int _sendAndRecvCustomerBoxesSerially(AH_OUTBOX *ob);
+static int _sendAndRecvCustomerBoxesParallel(AH_OUTBOX *ob, int numThreads);
+static void _assignLanes(AH_OUTBOX_PARALLEL *par, int maxPerHost);
+static int _countHostLanes(AH_OUTBOX_PARALLEL *par, int count, const char *host, int *pLeastBusyLane);
+static int _sameToken(const AB_USER *u1, const AB_USER *u2);
+static const char *_getServerHost(const AB_USER *u);
+static int _sendLaneJob(void *userData, int idx);
 static int _lockUsers(AH_OUTBOX *ob, AB_USER_LIST2 *lockedUsers);
 static int _unlockUsers(AH_OUTBOX *ob, AB_USER_LIST2 *lockedUsers, int abandon);
 static void _finishRemainingCustomerBoxes(AH_OUTBOX *ob);
@@ -484,6 +496,28 @@ void _finishRemainingCustomerBoxes(AH_OUTBOX *ob)
 
 
 int _sendAndRecvCustomerBoxes(AH_OUTBOX *ob)
+{
+  int numThreads;
+
+  numThreads=AB_Banking_RuntimeConfig_GetIntValue(AB_Provider_GetBanking(ob->provider), "hbciOutboxThreads", 0);
+  if (numThreads>1 && AB_WorkerPool_HasThreads() && AH_OutboxCBox_List_GetCount(ob->userBoxes)>1) {
+    int rv;
+
+    rv=AB_Banking_BeginThreadedUse(AB_Provider_GetBanking(ob->provider));
+    if (rv==0) {
+      rv=_sendAndRecvCustomerBoxesParallel(ob, numThreads);
+      AB_Banking_EndThreadedUse(AB_Provider_GetBanking(ob->provider));
+      return rv;
+    }
+    DBG_WARN(AQHBCI_LOGDOMAIN, "Threads not available, sending customer boxes one after the other (%d)", rv);
+  }
+
+  return _sendAndRecvCustomerBoxesSerially(ob);
+}
+
+
+
+int _sendAndRecvCustomerBoxesSerially(AH_OUTBOX *ob)
 {
   AH_OUTBOX_CBOX *cbox;
   int rv;
@@ -509,6 +543,184 @@ int _sendAndRecvCustomerBoxes(AH_OUTBOX *ob)
 
 
 
+int _sendAndRecvCustomerBoxesParallel(AH_OUTBOX *ob, int numThreads)
+{
+  AH_OUTBOX_PARALLEL par;
+  AH_OUTBOX_CBOX *cbox;
+  int maxPerHost;
+  int i;
+  int rv;
+
+  memset(&par, 0, sizeof(par));
+  par.banking=AB_Provider_GetBanking(ob->provider);
+  par.cboxCount=AH_OutboxCBox_List_GetCount(ob->userBoxes);
+  par.cboxes=(AH_OUTBOX_CBOX **) calloc(par.cboxCount, sizeof(AH_OUTBOX_CBOX *));
+  par.lanes=(int *) calloc(par.cboxCount, sizeof(int));
+  par.laneLoads=(int *) calloc(par.cboxCount, sizeof(int));
+  par.laneMarks=(int *) calloc(par.cboxCount, sizeof(int));
+  assert(par.cboxes && par.lanes && par.laneLoads && par.laneMarks);
+
+  i=0;
+  cbox=AH_OutboxCBox_List_First(ob->userBoxes);
+  while (cbox) {
+    par.cboxes[i++]=cbox;
+    cbox=AH_OutboxCBox_List_Next(cbox);
+  }
+
+  maxPerHost=AB_Banking_RuntimeConfig_GetIntValue(par.banking, "hbciOutboxThreadsPerHost", 1);
+  _assignLanes(&par, (maxPerHost<1)?1:maxPerHost);
+  if (numThreads>par.laneCount)
+    numThreads=par.laneCount;
+  DBG_INFO(AQHBCI_LOGDOMAIN, "Sending %d customer boxes in %d lanes using %d threads",
+           par.cboxCount, par.laneCount, numThreads);
+
+  /* threaded use has been prepared by the caller */
+  rv=AB_WorkerPool_Run(par.laneCount, numThreads, _sendLaneJob, &par);
+
+  /* let jobs process their results in the order the boxes were created */
+  _finishRemainingCustomerBoxes(ob);
+
+  free(par.laneMarks);
+  free(par.laneLoads);
+  free(par.lanes);
+  free(par.cboxes);
+
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+  return 0;
+}
+
+
+
+void _assignLanes(AH_OUTBOX_PARALLEL *par, int maxPerHost)
+{
+  int i;
+
+  for (i=0; i<par->cboxCount; i++) {
+    const AB_USER *u;
+    int lane=-1;
+    int j;
+
+    u=AH_OutboxCBox_GetUser(par->cboxes[i]);
+
+    /* boxes using the same token must never be sent concurrently */
+    for (j=0; j<i; j++) {
+      if (_sameToken(u, AH_OutboxCBox_GetUser(par->cboxes[j]))) {
+        lane=par->lanes[j];
+        break;
+      }
+    }
+
+    if (lane<0) {
+      const char *host;
+      int hostLanes;
+
+      host=_getServerHost(u);
+      hostLanes=_countHostLanes(par, i, host, &lane);
+      if (hostLanes<maxPerHost)
+        lane=par->laneCount++;
+    }
+
+    par->lanes[i]=lane;
+    par->laneLoads[lane]++;
+  }
+}
+
+
+
+int _countHostLanes(AH_OUTBOX_PARALLEL *par, int count, const char *host, int *pLeastBusyLane)
+{
+  int hostLanes=0;
+  int j;
+
+  /* only look at the first <count> boxes which already have their lanes assigned, count every lane only once */
+  for (j=0; j<count; j++) {
+    int lane;
+
+    lane=par->lanes[j];
+    if (par->laneMarks[lane]!=count && strcasecmp(host, _getServerHost(AH_OutboxCBox_GetUser(par->cboxes[j])))==0) {
+      par->laneMarks[lane]=count;
+      if (hostLanes==0 || par->laneLoads[lane]<par->laneLoads[*pLeastBusyLane])
+        *pLeastBusyLane=lane;
+      hostLanes++;
+    }
+  }
+
+  return hostLanes;
+}
+
+
+
+int _sameToken(const AB_USER *u1, const AB_USER *u2)
+{
+  const char *type1;
+  const char *type2;
+  const char *name1;
+  const char *name2;
+
+  type1=AH_User_GetTokenType(u1);
+  type2=AH_User_GetTokenType(u2);
+  name1=AH_User_GetTokenName(u1);
+  name2=AH_User_GetTokenName(u2);
+  if (type1 && type2 && name1 && *name1 && name2 && *name2)
+    return (strcasecmp(type1, type2)==0 && strcmp(name1, name2)==0);
+  return 0;
+}
+
+
+
+const char *_getServerHost(const AB_USER *u)
+{
+  const GWEN_URL *url;
+  const char *s=NULL;
+
+  url=AH_User_GetServerUrl(u);
+  if (url)
+    s=GWEN_Url_GetServer(url);
+  return s?s:"";
+}
+
+
+
+int _sendLaneJob(void *userData, int idx)
+{
+  AH_OUTBOX_PARALLEL *par;
+  int i;
+
+  par=(AH_OUTBOX_PARALLEL *) userData;
+  for (i=0; i<par->cboxCount; i++) {
+    if (par->lanes[i]==idx) {
+      AH_OUTBOX_CBOX *cbox;
+      int aborted;
+      int rv;
+
+      cbox=par->cboxes[i];
+      AB_Banking_Lock(par->banking);
+      aborted=par->aborted;
+      AB_Banking_Unlock(par->banking);
+      if (aborted)
+        break;
+
+      DBG_INFO(AQHBCI_LOGDOMAIN, "Sending messages for customer \"%lu\"",
+               (unsigned long int) AB_User_GetUniqueId(AH_OutboxCBox_GetUser(cbox)));
+      rv=AH_OutboxCBox_SendAndRecvBox(cbox);
+      if (rv==GWEN_ERROR_USER_ABORTED) {
+        AB_Banking_Lock(par->banking);
+        par->aborted=1;
+        AB_Banking_Unlock(par->banking);
+        /* like when sending serially only this error aborts, other errors are reported by the jobs of the box */
+        return rv;
+      }
+    }
+  }
+
+  return 0;
+}
+
+
+
 unsigned int _countTodoJobs(AH_OUTBOX *ob)
 {
   unsigned int cnt;
@@ -31,6 +31,21 @@ struct AH_OUTBOX {
 
 
 
+/** state while sending customer boxes in parallel */
+typedef struct AH_OUTBOX_PARALLEL AH_OUTBOX_PARALLEL;
+struct AH_OUTBOX_PARALLEL {
+  AB_BANKING *banking;
+  AH_OUTBOX_CBOX **cboxes;
+  int *lanes;       /* lane of every customer box (boxes of a lane are sent one after the other) */
+  int *laneLoads;   /* number of boxes assigned to every lane */
+  int *laneMarks;   /* used by _countHostLanes() to count every lane only once */
+  int cboxCount;
+  int laneCount;
+  int aborted;      /* set by the first box aborted by the user, protected by AB_Banking_Lock() */
+};
+
+
+
 #endif /* AH_OUTBOX_P_H */
 
 
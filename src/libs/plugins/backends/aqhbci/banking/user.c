@@ -166,6 +166,7 @@ AB_USER *AH_User_new(AB_PROVIDER *pro)
   GWEN_MsgEngine_SetCharsToEscape(ue->msgEngine, ":+\'@");
   AH_MsgEngine_SetUser(ue->msgEngine, u);
   GWEN_MsgEngine_SetDefinitions(ue->msgEngine, AH_HBCI_GetDefinitions(ue->hbci), 0);
+  AH_MsgEngine_SetDefsIndex(ue->msgEngine, AH_HBCI_GetDefinitionsIndex(ue->hbci));
 
   ue->hbciVersion=210;
   ue->bpd=AH_Bpd_new();
@@ -17,6 +17,7 @@
 
 #include "aqhbci/aqhbci_l.h"
 #include "aqhbci/msglayer/hbci_l.h"
+#include "aqhbci/msglayer/msgengine_l.h"
 #include "aqhbci/banking/user_l.h"
 #include "aqhbci/banking/account_l.h"
 #include "aqhbci/banking/provider_l.h"
@@ -114,11 +115,11 @@ int AH_Job_SampleBpdVersions(const char *name,
   GWEN_MsgEngine_SetMode(e, AH_CryptMode_toString(AH_User_GetCryptMode(u)));
 
   /* first select any version, we simply need to know the BPD job name */
-  node=GWEN_MsgEngine_FindNodeByProperty(e,
-                                         "JOB",
-                                         "id",
-                                         0,
-                                         name);
+  node=AH_MsgEngine_FindNodeByProperty(e,
+                                       "JOB",
+                                       "id",
+                                       0,
+                                       name);
   if (!node) {
     DBG_INFO(AQHBCI_LOGDOMAIN,
              "Job \"%s\" not supported by local XML files", name);
@@ -163,11 +164,11 @@ int AH_Job_SampleBpdVersions(const char *name,
       version=atoi(GWEN_DB_GroupName(jobBPD));
       /* now get the correct version of the JOB */
       DBG_DEBUG(AQHBCI_LOGDOMAIN, "Checking Job %s (%d)", name, version);
-      node=GWEN_MsgEngine_FindNodeByProperty(e,
-                                             "JOB",
-                                             "id",
-                                             version,
-                                             name);
+      node=AH_MsgEngine_FindNodeByProperty(e,
+                                           "JOB",
+                                           "id",
+                                           version,
+                                           name);
       if (node) {
         GWEN_DB_NODE *cpy;
 
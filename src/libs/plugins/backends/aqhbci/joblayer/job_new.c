@@ -165,7 +165,7 @@ GWEN_XMLNODE *_jobGetJobNode(const AH_JOB *j, int jobVersion)
   int rv;
   int realJobVersion=0;
 
-  node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", 0, j->name);
+  node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", 0, j->name);
   if (!node) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "Job \"%s\" not supported by local XML files", j->name);
     return NULL;
@@ -194,7 +194,7 @@ GWEN_XMLNODE *_jobGetJobNode(const AH_JOB *j, int jobVersion)
     return NULL;
   }
 
-  node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", realJobVersion, j->name);
+  node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", realJobVersion, j->name);
   if (node==NULL) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "Job node \"%s\"[%d] not found", j->name, realJobVersion);
     return NULL;
@@ -281,7 +281,7 @@ int _jobGetBpdParamsForVersion(const AH_JOB *j, const char *paramName, int jobVe
 
         /* now get the correct version of the JOB */
         DBG_INFO(AQHBCI_LOGDOMAIN, "Checking whether job %s (%d) can be instantiated", j->name, version);
-        node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
+        node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
         if (node) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "Found BPD job");
           highestVersion=version;
@@ -303,7 +303,7 @@ int _jobGetBpdParamsForVersion(const AH_JOB *j, const char *paramName, int jobVe
 
         /* now get the correct version of the JOB */
         DBG_INFO(AQHBCI_LOGDOMAIN, "Checking whether job %s (%d) can be instantiated", j->name, version);
-        node=GWEN_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
+        node=AH_MsgEngine_FindNodeByProperty(j->msgEngine, "JOB", "id", version, j->name);
         if (node) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "Found BPD job candidate version %d", version);
           highestVersion=version;
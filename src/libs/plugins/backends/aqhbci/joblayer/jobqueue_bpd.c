@@ -14,6 +14,7 @@
 
 #include "jobqueue_bpd.h"
 #include "aqhbci/banking/user_l.h"
+#include "aqhbci/msglayer/msgengine_l.h"
 
 #include "aqbanking/i18n_l.h"
 
@@ -442,9 +443,9 @@ int _isBpdJobSegment(GWEN_MSGENGINE *msgEngine, const char *segmentName, int seg
 
   DBG_DEBUG(AQHBCI_LOGDOMAIN, "Checking whether \"%s\" version %d is a BPD job", segmentName, segmentVersion);
   /* get segment description (first try id, then code) */
-  xmlDescrForSegNameAndVer=GWEN_MsgEngine_FindNodeByProperty(msgEngine, "SEG", "id", segmentVersion, segmentName);
+  xmlDescrForSegNameAndVer=AH_MsgEngine_FindNodeByProperty(msgEngine, "SEG", "id", segmentVersion, segmentName);
   if (xmlDescrForSegNameAndVer==NULL)
-    xmlDescrForSegNameAndVer=GWEN_MsgEngine_FindNodeByProperty(msgEngine, "SEG", "code", segmentVersion, segmentName);
+    xmlDescrForSegNameAndVer=AH_MsgEngine_FindNodeByProperty(msgEngine, "SEG", "code", segmentVersion, segmentName);
   if (xmlDescrForSegNameAndVer) {
     DBG_DEBUG(AQHBCI_LOGDOMAIN, "Found a candidate");
     if (atoi(GWEN_XMLNode_GetProperty(xmlDescrForSegNameAndVer, "isbpdjob", "0"))) {
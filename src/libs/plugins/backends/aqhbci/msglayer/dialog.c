@@ -340,10 +340,24 @@ int AH_Dialog_Connect(AH_DIALOG *dlg)
 
 int AH_Dialog_Disconnect(AH_DIALOG *dlg)
 {
+  int rv;
+
   if (AH_User_GetCryptMode(dlg->dialogOwner)==AH_CryptMode_Pintan)
-    return AH_Dialog_Disconnect_Https(dlg);
+    rv=AH_Dialog_Disconnect_Https(dlg);
   else
-    return AH_Dialog_Disconnect_Hbci(dlg);
+    rv=AH_Dialog_Disconnect_Hbci(dlg);
+
+  /* make sure all messages of this dialog are logged */
+  if (dlg->logName) {
+    int rv2;
+
+    rv2=AH_MsgLog_Flush(AH_HBCI_GetMsgLog(AH_Dialog_GetHbci(dlg)), dlg->logName);
+    if (rv2<0) {
+      DBG_ERROR(AQHBCI_LOGDOMAIN, "Error writing message log \"%s\" (%d)", dlg->logName, rv2);
+    }
+  }
+
+  return rv;
 }
 
 
@@ -77,6 +77,8 @@ AH_HBCI *AH_HBCI_new(AB_PROVIDER *pro)
   hbci->transferTimeout=AH_HBCI_DEFAULT_TRANSFER_TIMEOUT;
   hbci->connectTimeout=AH_HBCI_DEFAULT_CONNECT_TIMEOUT;
 
+  hbci->msgLog=AH_MsgLog_new();
+
   return hbci;
 }
 
@@ -91,6 +93,9 @@ void AH_HBCI_free(AH_HBCI *hbci)
 
     free(hbci->productVersion);
 
+    AH_MsgLog_free(hbci->msgLog);
+
+    AH_XmlDefs_Index_free(hbci->defsIndex);
     GWEN_XMLNode_free(hbci->defs);
 
     GWEN_FREE_OBJECT(hbci);
@@ -148,6 +153,10 @@ int AH_HBCI_Init(AH_HBCI *hbci, GWEN_DB_NODE *db)
   }
   GWEN_XMLNode_free(node);
 
+  /* index definitions now, lookups must not modify the index (they might be done from multiple threads) */
+  AH_XmlDefs_Index_free(hbci->defsIndex);
+  hbci->defsIndex=AH_XmlDefs_Index_new(hbci->defs);
+
   hbci->sharedRuntimeData=GWEN_DB_Group_new("sharedRuntimeData");
 
   hbci->transferTimeout=GWEN_DB_GetIntValue(db, "transferTimeout", 0,
@@ -161,6 +170,8 @@ int AH_HBCI_Init(AH_HBCI *hbci, GWEN_DB_NODE *db)
 
 int AH_HBCI_Fini(AH_HBCI *hbci, GWEN_DB_NODE *db)
 {
+  int rv;
+
   DBG_INFO(AQHBCI_LOGDOMAIN, "Deinitializing AH_HBCI");
   assert(hbci);
 
@@ -177,9 +188,17 @@ int AH_HBCI_Fini(AH_HBCI *hbci, GWEN_DB_NODE *db)
   GWEN_PathManager_UndefinePath(AH_PM_LIBNAME, AH_PM_XMLDATADIR);
   GWEN_PathManager_RemovePaths(AH_PM_LIBNAME);
 
+  /* write pending message logs */
+  rv=AH_MsgLog_Flush(hbci->msgLog, NULL);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+  }
+
   GWEN_DB_Group_free(hbci->sharedRuntimeData);
   hbci->sharedRuntimeData=0;
 
+  AH_XmlDefs_Index_free(hbci->defsIndex);
+  hbci->defsIndex=NULL;
   GWEN_XMLNode_free(hbci->defs);
   hbci->defs=0;
 
@@ -262,6 +281,23 @@ GWEN_XMLNODE *AH_HBCI_GetDefinitions(const AH_HBCI *hbci)
 }
 
 
+
+const AH_XMLDEFS_INDEX *AH_HBCI_GetDefinitionsIndex(const AH_HBCI *hbci)
+{
+  assert(hbci);
+  return hbci->defsIndex;
+}
+
+
+
+AH_MSGLOG *AH_HBCI_GetMsgLog(const AH_HBCI *hbci)
+{
+  assert(hbci);
+  return hbci->msgLog;
+}
+
+
+
 GWEN_XMLNODE *AH_HBCI_LoadDefaultXmlFiles(const AH_HBCI *hbci)
 {
   GWEN_STRINGLIST *paths;
@@ -283,17 +319,18 @@ GWEN_XMLNODE *AH_HBCI_LoadDefaultXmlFiles(const AH_HBCI *hbci)
     }
     else {
       GWEN_XMLNODE *xmlNode;
+      GWEN_BUFFER *cbuf;
 
-      xmlNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "root");
-
-      rv=GWEN_XML_ReadFile(xmlNode,
-                           GWEN_Buffer_GetStart(fbuf),
-                           GWEN_XML_FLAGS_DEFAULT |
-                           GWEN_XML_FLAGS_HANDLE_HEADERS);
-      if (rv) {
-        DBG_ERROR(AQHBCI_LOGDOMAIN, "Could not load XML file [%s]: %d.\n",
-                  GWEN_Buffer_GetStart(fbuf), rv);
-        GWEN_XMLNode_free(xmlNode);
+      /* use compiled definitions if possible */
+      cbuf=GWEN_Buffer_new(0, 256, 0, 1);
+      rv=AH_HBCI_GetDefinitionsCacheFile(hbci, cbuf);
+      if (rv<0) {
+        DBG_INFO(AQHBCI_LOGDOMAIN, "No file for compiled definitions (%d)", rv);
+      }
+      xmlNode=AH_XmlDefs_ReadFile(GWEN_Buffer_GetStart(fbuf), (rv<0)?NULL:GWEN_Buffer_GetStart(cbuf));
+      GWEN_Buffer_free(cbuf);
+      if (xmlNode==NULL) {
+        DBG_ERROR(AQHBCI_LOGDOMAIN, "Could not load XML file [%s].\n", GWEN_Buffer_GetStart(fbuf));
         GWEN_Buffer_free(fbuf);
         return NULL;
       }
@@ -310,6 +347,28 @@ GWEN_XMLNODE *AH_HBCI_LoadDefaultXmlFiles(const AH_HBCI *hbci)
 
 
 
+int AH_HBCI_GetDefinitionsCacheFile(const AH_HBCI *hbci, GWEN_BUFFER *buf)
+{
+  int rv;
+
+  rv=AB_Provider_GetUserDataDir(hbci->provider, buf);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  rv=GWEN_Directory_GetPath(GWEN_Buffer_GetStart(buf), GWEN_PATH_FLAGS_CHECKROOT);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  GWEN_Buffer_AppendString(buf, GWEN_DIR_SEPARATOR_S AH_HBCI_DEFS_CACHEFILE);
+  return 0;
+}
+
+
+
 int AH_HBCI_AddDefinitions(AH_HBCI *hbci, GWEN_XMLNODE *node)
 {
   GWEN_XMLNODE *nsrc, *ndst;
@@ -365,7 +424,9 @@ void AH_HBCI_AppendUniqueName(AH_HBCI *hbci, GWEN_BUFFER *nbuf)
   GWEN_Time_toString(ti, "YYYYMMDD-hhmmss", nbuf);
   GWEN_Time_free(ti);
 
+  AB_Banking_Lock(hbci->banking);
   snprintf(buffer, sizeof(buffer), "%03d", ++(hbci->counter));
+  AB_Banking_Unlock(hbci->banking);
   GWEN_Buffer_AppendString(nbuf, "-");
   GWEN_Buffer_AppendString(nbuf, buffer);
 }
@@ -25,6 +25,8 @@ typedef struct AH_HBCI AH_HBCI;
 
 #include "aqhbci/banking/user.h"
 #include "aqhbci/banking/account.h"
+#include "aqhbci/msglayer/xmldefs_l.h"
+#include "aqhbci/msglayer/msglog_l.h"
 
 
 #define AH_DEFAULT_KEYLEN 768
@@ -66,6 +68,16 @@ void AH_HBCI_AppendUniqueName(AH_HBCI *hbci, GWEN_BUFFER *nbuf);
 
 GWEN_XMLNODE *AH_HBCI_GetDefinitions(const AH_HBCI *hbci);
 
+/**
+ * Index over the definitions (see @ref AH_XmlDefs_Index_FindNode).
+ */
+const AH_XMLDEFS_INDEX *AH_HBCI_GetDefinitionsIndex(const AH_HBCI *hbci);
+
+/**
+ * Writer for the message log files of all dialogs.
+ */
+AH_MSGLOG *AH_HBCI_GetMsgLog(const AH_HBCI *hbci);
+
 
 uint32_t AH_HBCI_GetLastVersion(const AH_HBCI *hbci);
 
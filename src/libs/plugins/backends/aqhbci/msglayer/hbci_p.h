@@ -26,6 +26,8 @@
 #define AH_HBCI_DEFAULT_CONNECT_TIMEOUT 30
 #define AH_HBCI_DEFAULT_TRANSFER_TIMEOUT 60
 
+#define AH_HBCI_DEFS_CACHEFILE "hbci-defs.bin"
+
 
 struct AH_HBCI {
   AB_BANKING *banking;
@@ -34,6 +36,9 @@ struct AH_HBCI {
   char *productVersion;
 
   GWEN_XMLNODE *defs;
+  AH_XMLDEFS_INDEX *defsIndex;
+
+  AH_MSGLOG *msgLog;
 
   uint32_t counter;
 
@@ -58,6 +63,7 @@ static GWEN_DB_NODE *AH_HBCI_LoadSettings(const char *path);
 
 static int AH_HBCI_AddDefinitions(AH_HBCI *hbci, GWEN_XMLNODE *node);
 static GWEN_XMLNODE *AH_HBCI_LoadDefaultXmlFiles(const AH_HBCI *hbci);
+static int AH_HBCI_GetDefinitionsCacheFile(const AH_HBCI *hbci, GWEN_BUFFER *buf);
 
 #endif /* GWHBCI_HBCI_P_H */
 
@@ -34,6 +34,7 @@
 #include <gwenhywfar/gui.h>
 
 #include <gwenhywfar/syncio_file.h>
+#include <gwenhywfar/syncio_memory.h>
 
 #include <aqbanking/banking.h>
 #include <aqbanking/banking_be.h>
@@ -776,11 +777,11 @@ int AH_Msg_ReadSegment(AH_MSG *msg,
   }
 
   /* try to find corresponding XML node */
-  node=GWEN_MsgEngine_FindNodeByProperty(e,
-                                         gtype,
-                                         "code",
-                                         segVer,
-                                         p);
+  node=AH_MsgEngine_FindNodeByProperty(e,
+                                       gtype,
+                                       "code",
+                                       segVer,
+                                       p);
   if (node==0) {
     GWEN_DB_NODE *storegrp;
     unsigned int startPos;
@@ -1658,6 +1659,7 @@ void AH_Msg_LogMessage(AH_MSG *msg,
   GWEN_DB_NODE *db;
   AB_USER *u;
   AH_HBCI *h;
+  GWEN_BUFFER *logBuf;
   GWEN_SYNCIO *sio;
   unsigned int bsize;
   const char *logFile;
@@ -1719,29 +1721,9 @@ void AH_Msg_LogMessage(AH_MSG *msg,
   GWEN_DB_SetIntValue(db, GWEN_DB_FLAGS_OVERWRITE_VARS,
                       "size",
                       GWEN_Buffer_GetUsedBytes(buf));
-  if (GWEN_Directory_GetPath(logFile,
-                             GWEN_PATH_FLAGS_VARIABLE)) {
-    DBG_ERROR(AQHBCI_LOGDOMAIN,
-              "Path \"%s\" is not available, cannot log",
-              logFile);
-    GWEN_DB_Group_free(db);
-    return;
-  }
-
-  sio=GWEN_SyncIo_File_new(logFile, GWEN_SyncIo_File_CreationMode_OpenAlways);
-  GWEN_SyncIo_AddFlags(sio,
-                       GWEN_SYNCIO_FILE_FLAGS_READ |
-                       GWEN_SYNCIO_FILE_FLAGS_WRITE |
-                       GWEN_SYNCIO_FILE_FLAGS_UREAD |
-                       GWEN_SYNCIO_FILE_FLAGS_UWRITE |
-                       GWEN_SYNCIO_FILE_FLAGS_APPEND);
-  rv=GWEN_SyncIo_Connect(sio);
-  if (rv<0) {
-    DBG_INFO(GWEN_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_free(sio);
-    GWEN_DB_Group_free(db);
-    return;
-  }
+  /* prepare record in memory, it is written to the log file by the message log writer */
+  logBuf=GWEN_Buffer_new(0, GWEN_Buffer_GetUsedBytes(buf)+1024, 0, 1);
+  sio=GWEN_SyncIo_Memory_new(logBuf, 0);
 
   /* write header */
   rv=GWEN_DB_WriteToIo(db, sio,
@@ -1751,8 +1733,8 @@ void AH_Msg_LogMessage(AH_MSG *msg,
                        GWEN_DB_FLAGS_OMIT_TYPES);
   if (rv<0) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_Disconnect(sio);
     GWEN_SyncIo_free(sio);
+    GWEN_Buffer_free(logBuf);
     GWEN_DB_Group_free(db);
     return;
   }
@@ -1761,8 +1743,8 @@ void AH_Msg_LogMessage(AH_MSG *msg,
   rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *) "\n", 1);
   if (rv<0) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_Disconnect(sio);
     GWEN_SyncIo_free(sio);
+    GWEN_Buffer_free(logBuf);
     GWEN_DB_Group_free(db);
     return;
   }
@@ -1783,8 +1765,8 @@ void AH_Msg_LogMessage(AH_MSG *msg,
         rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *) p, 1);
         if (rv<0) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-          GWEN_SyncIo_Disconnect(sio);
           GWEN_SyncIo_free(sio);
+          GWEN_Buffer_free(logBuf);
           GWEN_DB_Group_free(db);
           return;
         }
@@ -1799,8 +1781,8 @@ void AH_Msg_LogMessage(AH_MSG *msg,
           rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *)p, bleft);
           if (rv<0) {
             DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-            GWEN_SyncIo_Disconnect(sio);
             GWEN_SyncIo_free(sio);
+            GWEN_Buffer_free(logBuf);
             GWEN_DB_Group_free(db);
             return;
           }
@@ -1825,8 +1807,8 @@ void AH_Msg_LogMessage(AH_MSG *msg,
         }
         if (rv<0) {
           DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-          GWEN_SyncIo_Disconnect(sio);
           GWEN_SyncIo_free(sio);
+          GWEN_Buffer_free(logBuf);
           GWEN_DB_Group_free(db);
           return;
         }
@@ -1851,24 +1833,18 @@ void AH_Msg_LogMessage(AH_MSG *msg,
   rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *) "\n", 1);
   if (rv<0) {
     DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_Disconnect(sio);
     GWEN_SyncIo_free(sio);
+    GWEN_Buffer_free(logBuf);
     GWEN_DB_Group_free(db);
     return;
   }
 
-  /* close layer */
-  rv=GWEN_SyncIo_Disconnect(sio);
-  if (rv<0) {
-    DBG_INFO(GWEN_LOGDOMAIN, "here (%d)", rv);
-    GWEN_SyncIo_free(sio);
-    return;
-  }
-
   GWEN_SyncIo_free(sio);
-
   GWEN_DB_Group_free(db);
-  DBG_DEBUG(AQHBCI_LOGDOMAIN, "Message logged");
+
+  /* hand record over to the message log writer */
+  AH_MsgLog_AddRecord(AH_HBCI_GetMsgLog(h), logFile, logBuf);
+  DBG_DEBUG(AQHBCI_LOGDOMAIN, "Message queued for logging");
 }
 
 
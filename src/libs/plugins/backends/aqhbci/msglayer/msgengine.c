@@ -479,6 +479,45 @@ void AH_MsgEngine_SetUser(GWEN_MSGENGINE *e, AB_USER *u)
 
 
 
+void AH_MsgEngine_SetDefsIndex(GWEN_MSGENGINE *e, const AH_XMLDEFS_INDEX *idx)
+{
+  AH_MSGENGINE *x;
+
+  assert(e);
+  x=GWEN_INHERIT_GETDATA(GWEN_MSGENGINE, AH_MSGENGINE, e);
+  assert(x);
+  x->defsIndex=idx;
+}
+
+
+
+GWEN_XMLNODE *AH_MsgEngine_FindNodeByProperty(GWEN_MSGENGINE *e,
+                                              const char *t,
+                                              const char *pname,
+                                              int version,
+                                              const char *pvalue)
+{
+  AH_MSGENGINE *x;
+
+  assert(e);
+  x=GWEN_INHERIT_GETDATA(GWEN_MSGENGINE, AH_MSGENGINE, e);
+  if (x && x->defsIndex && AH_XmlDefs_Index_GetDefinitions(x->defsIndex)==GWEN_MsgEngine_GetDefinitions(e)) {
+    GWEN_XMLNODE *node;
+    int rv;
+
+    rv=AH_XmlDefs_Index_FindNode(x->defsIndex, t, pname, version, pvalue,
+                                 GWEN_MsgEngine_GetProtocolVersion(e),
+                                 GWEN_MsgEngine_GetMode(e),
+                                 &node);
+    if (rv==0)
+      return node;
+  }
+
+  return GWEN_MsgEngine_FindNodeByProperty(e, t, pname, version, pvalue);
+}
+
+
+
 GWEN_MSGENGINE *AH_MsgEngine_new()
 {
   GWEN_MSGENGINE *e;
@@ -14,8 +14,24 @@
 #define AH_MSGENGINE_L_H
 
 #include "msgengine.h"
+#include "xmldefs_l.h"
 
 void AH_MsgEngine_SetUser(GWEN_MSGENGINE *e, AB_USER *u);
 
+/**
+ * Set the index to be used by @ref AH_MsgEngine_FindNodeByProperty. It is only used as long as the
+ * definitions of the message engine are those of the index.
+ */
+void AH_MsgEngine_SetDefsIndex(GWEN_MSGENGINE *e, const AH_XMLDEFS_INDEX *idx);
+
+/**
+ * Same as @ref GWEN_MsgEngine_FindNodeByProperty but uses the index of the definitions if possible.
+ */
+GWEN_XMLNODE *AH_MsgEngine_FindNodeByProperty(GWEN_MSGENGINE *e,
+                                              const char *t,
+                                              const char *pname,
+                                              int version,
+                                              const char *pvalue);
+
 #endif /* AH_MSGENGINE_H */
 
@@ -19,6 +19,7 @@
 
 struct AH_MSGENGINE {
   AB_USER *user;
+  const AH_XMLDEFS_INDEX *defsIndex;
 };
 
 
@@ -0,0 +1,501 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "msglog_p.h"
+
+#include "aqhbci/aqhbci_l.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+#include <gwenhywfar/directory.h>
+#include <gwenhywfar/syncio_file.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _lock(AH_MSGLOG *ml);
+static void _unlock(AH_MSGLOG *ml);
+static int _startThread(AH_MSGLOG *ml);
+static void _stopThread(AH_MSGLOG *ml);
+#ifdef AH_MSGLOG_USE_PTHREADS
+static void *_threadMain(void *p);
+#endif
+static void _waitUntilIdle(AH_MSGLOG *ml);
+static void _writeRecordAndUpdateQueue(AH_MSGLOG *ml, AH_MSGLOG_RECORD *rec);
+static void _writeRecord(AH_MSGLOG *ml, const AH_MSGLOG_RECORD *rec, AH_MSGLOG_ERROR **pErrors);
+static void _freeRecord(AH_MSGLOG_RECORD *rec);
+static AH_MSGLOG_FILE *_getOpenFile(AH_MSGLOG *ml, const char *fileName, AH_MSGLOG_ERROR **pErrors);
+static void _closeFile(AH_MSGLOG *ml, AH_MSGLOG_FILE *f, AH_MSGLOG_ERROR **pErrors);
+static void _closeLeastRecentlyUsedFile(AH_MSGLOG *ml, AH_MSGLOG_ERROR **pErrors);
+static void _addError(AH_MSGLOG_ERROR **pErrors, const char *fileName, int error);
+static void _moveErrors(AH_MSGLOG_ERROR **pDest, AH_MSGLOG_ERROR *errors);
+static int _takeError(AH_MSGLOG *ml, const char *fileName);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AH_MSGLOG *AH_MsgLog_new(void)
+{
+  AH_MSGLOG *ml;
+
+  GWEN_NEW_OBJECT(AH_MSGLOG, ml);
+#ifdef AH_MSGLOG_USE_PTHREADS
+  pthread_mutex_init(&(ml->mutex), NULL);
+  pthread_cond_init(&(ml->condQueue), NULL);
+  pthread_cond_init(&(ml->condDone), NULL);
+#endif
+
+  return ml;
+}
+
+
+
+void AH_MsgLog_free(AH_MSGLOG *ml)
+{
+  if (ml) {
+    int rv;
+
+    rv=AH_MsgLog_Flush(ml, NULL);
+    if (rv<0) {
+      DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    }
+    _stopThread(ml);
+#ifdef AH_MSGLOG_USE_PTHREADS
+    pthread_cond_destroy(&(ml->condDone));
+    pthread_cond_destroy(&(ml->condQueue));
+    pthread_mutex_destroy(&(ml->mutex));
+#endif
+    GWEN_FREE_OBJECT(ml);
+  }
+}
+
+
+
+void AH_MsgLog_AddRecord(AH_MSGLOG *ml, const char *fileName, GWEN_BUFFER *buf)
+{
+  AH_MSGLOG_RECORD *rec;
+
+  assert(ml);
+  assert(fileName);
+  assert(buf);
+
+  rec=(AH_MSGLOG_RECORD *) malloc(sizeof(AH_MSGLOG_RECORD));
+  assert(rec);
+  rec->fileName=strdup(fileName);
+  rec->buffer=buf;
+  rec->next=NULL;
+
+  _lock(ml);
+  if (_startThread(ml)<0) {
+    /* no writer thread, write record directly. The mutex stays locked because other threads might add records at
+     * the same time and the open files are shared (without pthreads there are no other threads) */
+    _writeRecord(ml, rec, &(ml->errors));
+    _unlock(ml);
+    _freeRecord(rec);
+    return;
+  }
+
+#ifdef AH_MSGLOG_USE_PTHREADS
+  {
+    uint32_t size;
+
+    size=GWEN_Buffer_GetUsedBytes(buf);
+    /* wait for room in the queue (a single record is always accepted if the queue is empty) */
+    while (ml->recordCount>=AH_MSGLOG_MAXQUEUEDRECORDS ||
+           (ml->recordCount>0 && ml->queuedBytes+size>AH_MSGLOG_MAXQUEUEDBYTES))
+      pthread_cond_wait(&(ml->condDone), &(ml->mutex));
+
+    if (ml->lastRecord)
+      ml->lastRecord->next=rec;
+    else
+      ml->firstRecord=rec;
+    ml->lastRecord=rec;
+    ml->recordCount++;
+    ml->queuedBytes+=size;
+    pthread_cond_signal(&(ml->condQueue));
+  }
+#endif
+  _unlock(ml);
+}
+
+
+
+int AH_MsgLog_Flush(AH_MSGLOG *ml, const char *fileName)
+{
+  int rv;
+
+  assert(ml);
+
+  _lock(ml);
+  _waitUntilIdle(ml);
+
+  /* writer is idle now, so we can safely close files */
+  if (fileName) {
+    AH_MSGLOG_FILE *f;
+
+    f=ml->openFiles;
+    while (f) {
+      if (strcmp(f->fileName, fileName)==0) {
+        _closeFile(ml, f, &(ml->errors));
+        break;
+      }
+      f=f->next;
+    }
+  }
+  else {
+    while (ml->openFiles)
+      _closeFile(ml, ml->openFiles, &(ml->errors));
+  }
+
+  rv=_takeError(ml, fileName);
+  _unlock(ml);
+
+  return rv;
+}
+
+
+
+void _lock(AH_MSGLOG *ml)
+{
+#ifdef AH_MSGLOG_USE_PTHREADS
+  pthread_mutex_lock(&(ml->mutex));
+#endif
+}
+
+
+
+void _unlock(AH_MSGLOG *ml)
+{
+#ifdef AH_MSGLOG_USE_PTHREADS
+  pthread_mutex_unlock(&(ml->mutex));
+#endif
+}
+
+
+
+/* must be called with the mutex locked */
+int _startThread(AH_MSGLOG *ml)
+{
+#ifdef AH_MSGLOG_USE_PTHREADS
+  if (ml->threadRunning)
+    return 0;
+  ml->stopThread=0;
+  if (pthread_create(&(ml->thread), NULL, _threadMain, ml)!=0) {
+    DBG_WARN(AQHBCI_LOGDOMAIN, "Could not start log writer thread, writing messages directly");
+    return GWEN_ERROR_GENERIC;
+  }
+  ml->threadRunning=1;
+  return 0;
+#else
+  return GWEN_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+
+
+void _stopThread(AH_MSGLOG *ml)
+{
+#ifdef AH_MSGLOG_USE_PTHREADS
+  int running;
+
+  pthread_mutex_lock(&(ml->mutex));
+  running=ml->threadRunning;
+  ml->stopThread=1;
+  pthread_cond_signal(&(ml->condQueue));
+  pthread_mutex_unlock(&(ml->mutex));
+
+  if (running) {
+    pthread_join(ml->thread, NULL);
+    ml->threadRunning=0;
+  }
+#endif
+}
+
+
+
+#ifdef AH_MSGLOG_USE_PTHREADS
+void *_threadMain(void *p)
+{
+  AH_MSGLOG *ml;
+
+  ml=(AH_MSGLOG *) p;
+
+  pthread_mutex_lock(&(ml->mutex));
+  for (;;) {
+    AH_MSGLOG_RECORD *rec;
+
+    while (ml->firstRecord==NULL && !ml->stopThread)
+      pthread_cond_wait(&(ml->condQueue), &(ml->mutex));
+    rec=ml->firstRecord;
+    if (rec==NULL)
+      /* stop requested and nothing left to write */
+      break;
+
+    /* take record from queue (it is still accounted for until written) */
+    ml->firstRecord=rec->next;
+    if (ml->firstRecord==NULL)
+      ml->lastRecord=NULL;
+    ml->busy=1;
+    pthread_mutex_unlock(&(ml->mutex));
+
+    _writeRecordAndUpdateQueue(ml, rec);
+
+    pthread_mutex_lock(&(ml->mutex));
+  }
+  pthread_mutex_unlock(&(ml->mutex));
+
+  return NULL;
+}
+#endif
+
+
+
+/* must be called with the mutex locked */
+void _waitUntilIdle(AH_MSGLOG *ml)
+{
+#ifdef AH_MSGLOG_USE_PTHREADS
+  while (ml->firstRecord || ml->busy)
+    pthread_cond_wait(&(ml->condDone), &(ml->mutex));
+#endif
+}
+
+
+
+/* writes the record and removes it from the queue accounting, must be called with the mutex unlocked */
+void _writeRecordAndUpdateQueue(AH_MSGLOG *ml, AH_MSGLOG_RECORD *rec)
+{
+  AH_MSGLOG_ERROR *errors=NULL;
+  uint32_t size;
+
+  /* errors are collected locally and handed over with the mutex locked */
+  size=GWEN_Buffer_GetUsedBytes(rec->buffer);
+  _writeRecord(ml, rec, &errors);
+  _freeRecord(rec);
+
+  _lock(ml);
+  _moveErrors(&(ml->errors), errors);
+  if (ml->busy) {
+    ml->busy=0;
+    ml->recordCount--;
+    ml->queuedBytes-=size;
+  }
+#ifdef AH_MSGLOG_USE_PTHREADS
+  pthread_cond_broadcast(&(ml->condDone));
+#endif
+  _unlock(ml);
+}
+
+
+
+void _writeRecord(AH_MSGLOG *ml, const AH_MSGLOG_RECORD *rec, AH_MSGLOG_ERROR **pErrors)
+{
+  AH_MSGLOG_FILE *f;
+  int rv;
+
+  f=_getOpenFile(ml, rec->fileName, pErrors);
+  if (f==NULL) {
+    DBG_ERROR(AQHBCI_LOGDOMAIN, "Could not open log file \"%s\", message not logged", rec->fileName);
+    _addError(pErrors, rec->fileName, GWEN_ERROR_IO);
+    return;
+  }
+
+  rv=GWEN_SyncIo_WriteForced(f->sio,
+                             (const uint8_t *) GWEN_Buffer_GetStart(rec->buffer),
+                             GWEN_Buffer_GetUsedBytes(rec->buffer));
+  if (rv<0) {
+    DBG_ERROR(AQHBCI_LOGDOMAIN, "Error writing to log file \"%s\" (%d)", rec->fileName, rv);
+    _addError(pErrors, rec->fileName, rv);
+    _closeFile(ml, f, pErrors);
+  }
+}
+
+
+
+void _freeRecord(AH_MSGLOG_RECORD *rec)
+{
+  GWEN_Buffer_free(rec->buffer);
+  free(rec->fileName);
+  free(rec);
+}
+
+
+
+AH_MSGLOG_FILE *_getOpenFile(AH_MSGLOG *ml, const char *fileName, AH_MSGLOG_ERROR **pErrors)
+{
+  AH_MSGLOG_FILE *f;
+  GWEN_SYNCIO *sio;
+  int rv;
+
+  f=ml->openFiles;
+  while (f) {
+    if (strcmp(f->fileName, fileName)==0) {
+      f->lastUsed=++(ml->usageCounter);
+      return f;
+    }
+    f=f->next;
+  }
+
+  if (GWEN_Directory_GetPath(fileName, GWEN_PATH_FLAGS_VARIABLE)) {
+    DBG_ERROR(AQHBCI_LOGDOMAIN, "Path \"%s\" is not available, cannot log", fileName);
+    return NULL;
+  }
+
+  sio=GWEN_SyncIo_File_new(fileName, GWEN_SyncIo_File_CreationMode_OpenAlways);
+  GWEN_SyncIo_AddFlags(sio,
+                       GWEN_SYNCIO_FILE_FLAGS_READ |
+                       GWEN_SYNCIO_FILE_FLAGS_WRITE |
+                       GWEN_SYNCIO_FILE_FLAGS_UREAD |
+                       GWEN_SYNCIO_FILE_FLAGS_UWRITE |
+                       GWEN_SYNCIO_FILE_FLAGS_APPEND);
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    GWEN_SyncIo_free(sio);
+    return NULL;
+  }
+
+  if (ml->openFileCount>=AH_MSGLOG_MAXOPENFILES)
+    _closeLeastRecentlyUsedFile(ml, pErrors);
+
+  f=(AH_MSGLOG_FILE *) malloc(sizeof(AH_MSGLOG_FILE));
+  assert(f);
+  f->fileName=strdup(fileName);
+  f->sio=sio;
+  f->lastUsed=++(ml->usageCounter);
+  f->next=ml->openFiles;
+  ml->openFiles=f;
+  ml->openFileCount++;
+
+  return f;
+}
+
+
+
+void _closeFile(AH_MSGLOG *ml, AH_MSGLOG_FILE *f, AH_MSGLOG_ERROR **pErrors)
+{
+  AH_MSGLOG_FILE **pf;
+  int rv;
+
+  /* unlink */
+  pf=&(ml->openFiles);
+  while (*pf && *pf!=f)
+    pf=&((*pf)->next);
+  if (*pf) {
+    *pf=f->next;
+    ml->openFileCount--;
+  }
+
+  rv=GWEN_SyncIo_Disconnect(f->sio);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    _addError(pErrors, f->fileName, rv);
+  }
+  GWEN_SyncIo_free(f->sio);
+  free(f->fileName);
+  free(f);
+}
+
+
+
+void _closeLeastRecentlyUsedFile(AH_MSGLOG *ml, AH_MSGLOG_ERROR **pErrors)
+{
+  AH_MSGLOG_FILE *f;
+  AH_MSGLOG_FILE *oldest=NULL;
+
+  f=ml->openFiles;
+  while (f) {
+    if (oldest==NULL || f->lastUsed<oldest->lastUsed)
+      oldest=f;
+    f=f->next;
+  }
+  if (oldest)
+    _closeFile(ml, oldest, pErrors);
+}
+
+
+
+/* only the first error of a file is kept */
+void _addError(AH_MSGLOG_ERROR **pErrors, const char *fileName, int error)
+{
+  AH_MSGLOG_ERROR *e;
+
+  while (*pErrors) {
+    if (strcmp((*pErrors)->fileName, fileName)==0)
+      return;
+    pErrors=&((*pErrors)->next);
+  }
+
+  e=(AH_MSGLOG_ERROR *) malloc(sizeof(AH_MSGLOG_ERROR));
+  assert(e);
+  e->fileName=strdup(fileName);
+  e->error=error;
+  e->next=NULL;
+  *pErrors=e;
+}
+
+
+
+void _moveErrors(AH_MSGLOG_ERROR **pDest, AH_MSGLOG_ERROR *errors)
+{
+  while (errors) {
+    AH_MSGLOG_ERROR *next;
+
+    next=errors->next;
+    _addError(pDest, errors->fileName, errors->error);
+    free(errors->fileName);
+    free(errors);
+    errors=next;
+  }
+}
+
+
+
+/* removes the errors of the given file (of all files if NULL) and returns the first of them (0 if none),
+ * must be called with the mutex locked */
+int _takeError(AH_MSGLOG *ml, const char *fileName)
+{
+  AH_MSGLOG_ERROR **pe;
+  int rv=0;
+
+  pe=&(ml->errors);
+  while (*pe) {
+    AH_MSGLOG_ERROR *e;
+
+    e=*pe;
+    if (fileName==NULL || strcmp(e->fileName, fileName)==0) {
+      if (rv==0)
+        rv=e->error;
+      *pe=e->next;
+      free(e->fileName);
+      free(e);
+    }
+    else
+      pe=&(e->next);
+  }
+
+  return rv;
+}
+
+
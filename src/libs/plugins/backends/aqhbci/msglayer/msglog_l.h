@@ -0,0 +1,59 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AH_MSGLOG_L_H
+#define AH_MSGLOG_L_H
+
+
+#include <gwenhywfar/buffer.h>
+
+
+/**
+ * Writer for the message log files of dialogs.
+ *
+ * Records are queued and written by a background thread (if threads are available, otherwise they are
+ * written immediately). Log files stay open between records, they are closed by @ref AH_MsgLog_Flush
+ * or when too many files are open.
+ */
+typedef struct AH_MSGLOG AH_MSGLOG;
+
+
+AH_MSGLOG *AH_MsgLog_new(void);
+
+/**
+ * Writes all queued records, stops the writer thread and closes all files.
+ */
+void AH_MsgLog_free(AH_MSGLOG *ml);
+
+
+/**
+ * Queue a record to be appended to the given log file.
+ *
+ * If the queue is full this function waits until the writer thread has made room for the new record.
+ *
+ * @param ml message log writer
+ * @param fileName path of the log file (missing folders are created)
+ * @param buf data to write (taken over by this function)
+ */
+void AH_MsgLog_AddRecord(AH_MSGLOG *ml, const char *fileName, GWEN_BUFFER *buf);
+
+
+/**
+ * Wait until all queued records are written and close the given log file.
+ *
+ * Errors are kept per log file, so flushing one file only reports errors of that file.
+ *
+ * @return 0 if ok, error code of the first failed write or close of the file since its last flush otherwise
+ *   (of any file if fileName is NULL)
+ * @param ml message log writer
+ * @param fileName log file to close (NULL to close all files)
+ */
+int AH_MsgLog_Flush(AH_MSGLOG *ml, const char *fileName);
+
+
+#endif
+
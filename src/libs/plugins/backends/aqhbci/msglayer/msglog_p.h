@@ -0,0 +1,81 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AH_MSGLOG_P_H
+#define AH_MSGLOG_P_H
+
+
+#include "msglog_l.h"
+
+#include <gwenhywfar/syncio.h>
+
+#if defined(HAVE_PTHREAD_H) && !defined(OS_WIN32)
+# define AH_MSGLOG_USE_PTHREADS
+# include <pthread.h>
+#endif
+
+
+/* limits of the queue (AH_MsgLog_AddRecord waits if any of them is reached) */
+#define AH_MSGLOG_MAXQUEUEDRECORDS 64
+#define AH_MSGLOG_MAXQUEUEDBYTES   (4*1024*1024)
+
+/* maximum number of log files kept open */
+#define AH_MSGLOG_MAXOPENFILES     8
+
+
+
+typedef struct AH_MSGLOG_RECORD AH_MSGLOG_RECORD;
+struct AH_MSGLOG_RECORD {
+  char *fileName;
+  GWEN_BUFFER *buffer;
+  AH_MSGLOG_RECORD *next;
+};
+
+
+/* first error of a log file since its last flush */
+typedef struct AH_MSGLOG_ERROR AH_MSGLOG_ERROR;
+struct AH_MSGLOG_ERROR {
+  char *fileName;
+  int error;
+  AH_MSGLOG_ERROR *next;
+};
+
+
+typedef struct AH_MSGLOG_FILE AH_MSGLOG_FILE;
+struct AH_MSGLOG_FILE {
+  char *fileName;
+  GWEN_SYNCIO *sio;
+  uint32_t lastUsed;           /* value of the usage counter when the file was last written to */
+  AH_MSGLOG_FILE *next;
+};
+
+
+struct AH_MSGLOG {
+  AH_MSGLOG_RECORD *firstRecord;
+  AH_MSGLOG_RECORD *lastRecord;
+  int recordCount;
+  uint32_t queuedBytes;
+  int busy;                    /* a record is currently being written */
+  AH_MSGLOG_ERROR *errors;     /* only accessed with the mutex locked */
+
+  AH_MSGLOG_FILE *openFiles;   /* only accessed by the writer thread, otherwise only with the mutex locked */
+  int openFileCount;
+  uint32_t usageCounter;
+
+#ifdef AH_MSGLOG_USE_PTHREADS
+  pthread_mutex_t mutex;
+  pthread_cond_t condQueue;    /* signalled when a record has been queued or the writer is to stop */
+  pthread_cond_t condDone;     /* signalled when a record has been written */
+  pthread_t thread;
+  int threadRunning;
+  int stopThread;
+#endif
+};
+
+
+#endif
+
@@ -0,0 +1,1230 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "xmldefs_p.h"
+
+#include "aqhbci/aqhbci_l.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/misc.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+# include <fcntl.h>
+#endif
+
+#ifdef OS_WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static GWEN_XMLNODE *_readXmlFile(const char *fname);
+static GWEN_XMLNODE *_readCompiledFile(const char *cacheFile, const char *fname, const struct stat *st);
+static int _compileAndWriteFile(const char *fname, const struct stat *st, GWEN_XMLNODE *xmlNode, const char *cacheFile);
+static int _compileXml(const char *p, const char *e, AH_XMLDEFS_STRINGTABLE *tab, GWEN_BUFFER *body, uint32_t *pNodeCount);
+static int _writeFile(const char *fname, GWEN_BUFFER *buf);
+
+static AH_XMLDEFS_FILEDATA *_fileDataFromFile(const char *fname);
+static void _fileDataFree(AH_XMLDEFS_FILEDATA *fd);
+
+static AH_XMLDEFS_STRINGTABLE *_stringTableNew(void);
+static void _stringTableFree(AH_XMLDEFS_STRINGTABLE *tab);
+static uint32_t _stringTableAdd(AH_XMLDEFS_STRINGTABLE *tab, const char *s, uint32_t len);
+static void _stringTableGrow(AH_XMLDEFS_STRINGTABLE *tab);
+
+static int _readerSetup(AH_XMLDEFS_READER *r, const uint8_t *ptr, uint32_t len, int64_t *pMtime, uint64_t *pSize);
+static int _readU32(AH_XMLDEFS_READER *r, uint32_t *pValue);
+static int _readString(AH_XMLDEFS_READER *r, const char **pString);
+static int _buildChildren(AH_XMLDEFS_READER *r, GWEN_XMLNODE *parent, int level);
+static int _verifyChildren(AH_XMLDEFS_READER *r, GWEN_XMLNODE *parent, int level);
+static GWEN_XMLNODE *_skipComments(GWEN_XMLNODE *n);
+
+static int _startsWith(const char *p, const char *e, const char *s);
+static const char *_skipPast(const char *p, const char *e, const char *s);
+static const char *_skipBlanks(const char *p, const char *e);
+static int _isNameEnd(char c);
+
+static uint32_t _hashBytes(const char *s, uint32_t len);
+static void _appendU32(GWEN_BUFFER *buf, uint32_t v);
+static void _appendU64(GWEN_BUFFER *buf, uint64_t v);
+static void _setU32(uint8_t *p, uint32_t v);
+static uint32_t _getU32(const uint8_t *p);
+static uint64_t _getU64(const uint8_t *p);
+
+static int _pnameIndex(const char *pname);
+static int _isDefinitionName(const char *name, const char *typeName, uint32_t typeLen);
+static uint32_t _hashKey(const char *t, uint32_t tlen, int pnameIndex, const char *value);
+static void _indexAddEntry(AH_XMLDEFS_INDEX *idx, uint32_t *pEntrySize, uint32_t typeIndex, int pnameIndex,
+                           const char *value, GWEN_XMLNODE *n);
+
+
+
+static const char *_indexedPropertyNames[]= {
+  "id",
+  "code",
+  NULL
+};
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+GWEN_XMLNODE *AH_XmlDefs_ReadFile(const char *fname, const char *cacheFile)
+{
+  GWEN_XMLNODE *xmlNode;
+  struct stat st;
+  int haveStat=0;
+
+  if (cacheFile && *cacheFile && stat(fname, &st)==0) {
+    haveStat=1;
+    xmlNode=_readCompiledFile(cacheFile, fname, &st);
+    if (xmlNode) {
+      DBG_INFO(AQHBCI_LOGDOMAIN, "Using compiled definitions from \"%s\"", cacheFile);
+      return xmlNode;
+    }
+  }
+
+  xmlNode=_readXmlFile(fname);
+  if (xmlNode==NULL) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here");
+    return NULL;
+  }
+
+  if (haveStat) {
+    int rv;
+
+    rv=_compileAndWriteFile(fname, &st, xmlNode, cacheFile);
+    if (rv<0) {
+      DBG_INFO(AQHBCI_LOGDOMAIN, "Definitions not compiled (%d), using XML file", rv);
+    }
+    else {
+      DBG_INFO(AQHBCI_LOGDOMAIN, "Compiled definitions written to \"%s\"", cacheFile);
+    }
+  }
+
+  return xmlNode;
+}
+
+
+
+GWEN_XMLNODE *_readXmlFile(const char *fname)
+{
+  GWEN_XMLNODE *xmlNode;
+  int rv;
+
+  xmlNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "root");
+  rv=GWEN_XML_ReadFile(xmlNode, fname, GWEN_XML_FLAGS_DEFAULT | GWEN_XML_FLAGS_HANDLE_HEADERS);
+  if (rv) {
+    DBG_ERROR(AQHBCI_LOGDOMAIN, "Could not load XML file [%s]: %d.\n", fname, rv);
+    GWEN_XMLNode_free(xmlNode);
+    return NULL;
+  }
+
+  return xmlNode;
+}
+
+
+
+GWEN_XMLNODE *_readCompiledFile(const char *cacheFile, const char *fname, const struct stat *st)
+{
+  AH_XMLDEFS_FILEDATA *fd;
+  AH_XMLDEFS_READER r;
+  GWEN_XMLNODE *xmlNode;
+  int64_t mtime;
+  uint64_t size;
+  int rv;
+
+  fd=_fileDataFromFile(cacheFile);
+  if (fd==NULL) {
+    DBG_DEBUG(AQHBCI_LOGDOMAIN, "No compiled definitions in \"%s\"", cacheFile);
+    return NULL;
+  }
+
+  rv=_readerSetup(&r, fd->ptr, fd->size, &mtime, &size);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Invalid compiled definitions in \"%s\" (%d)", cacheFile, rv);
+    _fileDataFree(fd);
+    return NULL;
+  }
+
+  if (mtime!=(int64_t) st->st_mtime || size!=(uint64_t) st->st_size || strcmp(r.strings[0], fname)!=0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Compiled definitions in \"%s\" are outdated", cacheFile);
+    free(r.strings);
+    _fileDataFree(fd);
+    return NULL;
+  }
+
+  xmlNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "root");
+  rv=_buildChildren(&r, xmlNode, 0);
+  if (rv==0 && r.pos!=r.end)
+    rv=GWEN_ERROR_BAD_DATA;
+  free(r.strings);
+  _fileDataFree(fd);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Invalid compiled definitions in \"%s\" (%d)", cacheFile, rv);
+    GWEN_XMLNode_free(xmlNode);
+    return NULL;
+  }
+
+  return xmlNode;
+}
+
+
+
+int _compileAndWriteFile(const char *fname, const struct stat *st, GWEN_XMLNODE *xmlNode, const char *cacheFile)
+{
+  AH_XMLDEFS_FILEDATA *fd;
+  AH_XMLDEFS_STRINGTABLE *tab;
+  AH_XMLDEFS_READER r;
+  GWEN_BUFFER *body;
+  GWEN_BUFFER *fbuf;
+  uint32_t nodeCount=0;
+  int64_t mtime;
+  uint64_t size;
+  int rv;
+
+  fd=_fileDataFromFile(fname);
+  if (fd==NULL) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here");
+    return GWEN_ERROR_IO;
+  }
+  if ((uint64_t) fd->size!=(uint64_t) st->st_size) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "File \"%s\" changed while reading", fname);
+    _fileDataFree(fd);
+    return GWEN_ERROR_TRY_AGAIN;
+  }
+
+  tab=_stringTableNew();
+  _stringTableAdd(tab, fname, strlen(fname));
+  body=GWEN_Buffer_new(0, fd->size, 0, 1);
+  rv=_compileXml((const char *) fd->ptr, (const char *) (fd->ptr+fd->size), tab, body, &nodeCount);
+  _fileDataFree(fd);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    GWEN_Buffer_free(body);
+    _stringTableFree(tab);
+    return rv;
+  }
+
+  fbuf=GWEN_Buffer_new(0, AH_XMLDEFS_HEADER_SIZE+GWEN_Buffer_GetUsedBytes(tab->tableBuffer)+GWEN_Buffer_GetUsedBytes(body),
+                       0, 1);
+  GWEN_Buffer_AppendBytes(fbuf, AH_XMLDEFS_MAGIC, 4);
+  GWEN_Buffer_AppendByte(fbuf, AH_XMLDEFS_VERSION);
+  GWEN_Buffer_AppendByte(fbuf, 0);
+  GWEN_Buffer_AppendByte(fbuf, 0);
+  GWEN_Buffer_AppendByte(fbuf, 0);
+  _appendU64(fbuf, (uint64_t)((int64_t) st->st_mtime));
+  _appendU64(fbuf, (uint64_t) st->st_size);
+  _appendU32(fbuf, tab->stringCount);
+  _appendU32(fbuf, GWEN_Buffer_GetUsedBytes(tab->tableBuffer));
+  _appendU32(fbuf, GWEN_Buffer_GetUsedBytes(body));
+  _appendU32(fbuf, nodeCount);
+  GWEN_Buffer_AppendBytes(fbuf, GWEN_Buffer_GetStart(tab->tableBuffer), GWEN_Buffer_GetUsedBytes(tab->tableBuffer));
+  GWEN_Buffer_AppendBytes(fbuf, GWEN_Buffer_GetStart(body), GWEN_Buffer_GetUsedBytes(body));
+  GWEN_Buffer_free(body);
+  _stringTableFree(tab);
+
+  /* only use the compiled data if it exactly reproduces the tree read by the XML reader */
+  rv=_readerSetup(&r, (const uint8_t *) GWEN_Buffer_GetStart(fbuf), GWEN_Buffer_GetUsedBytes(fbuf), &mtime, &size);
+  if (rv==0) {
+    rv=_verifyChildren(&r, xmlNode, 0);
+    if (rv==0 && r.pos!=r.end)
+      rv=GWEN_ERROR_BAD_DATA;
+    free(r.strings);
+  }
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Compiled definitions differ from XML tree (%d)", rv);
+    GWEN_Buffer_free(fbuf);
+    return rv;
+  }
+
+  rv=_writeFile(cacheFile, fbuf);
+  GWEN_Buffer_free(fbuf);
+  if (rv<0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _compileXml(const char *p, const char *e, AH_XMLDEFS_STRINGTABLE *tab, GWEN_BUFFER *body, uint32_t *pNodeCount)
+{
+  AH_XMLDEFS_OPENTAG stack[AH_XMLDEFS_MAXLEVEL+1];
+  int level=0;
+  uint32_t nodeCount=0;
+
+  stack[0].name=NULL;
+  stack[0].nameLen=0;
+  stack[0].countPos=GWEN_Buffer_GetPos(body);
+  stack[0].count=0;
+  _appendU32(body, 0);
+
+  while (p<e) {
+    if (*p=='<') {
+      if (_startsWith(p, e, "<?")) {
+        p=_skipPast(p+2, e, "?>");
+      }
+      else if (_startsWith(p, e, "<!--")) {
+        p=_skipPast(p+4, e, "-->");
+      }
+      else if (_startsWith(p, e, "<![CDATA[")) {
+        DBG_INFO(AQHBCI_LOGDOMAIN, "CDATA not supported");
+        return GWEN_ERROR_NOT_SUPPORTED;
+      }
+      else if (_startsWith(p, e, "<!")) {
+        p=_skipPast(p+2, e, ">");
+      }
+      else if (_startsWith(p, e, "</")) {
+        const char *name;
+        uint32_t len;
+
+        p+=2;
+        name=p;
+        while (p<e && !_isNameEnd(*p))
+          p++;
+        len=p-name;
+        p=_skipBlanks(p, e);
+        if (p>=e || *p!='>' || level<1 || len!=stack[level].nameLen ||
+            strncasecmp(name, stack[level].name, len)!=0) {
+          DBG_INFO(AQHBCI_LOGDOMAIN, "Unexpected closing element");
+          return GWEN_ERROR_BAD_DATA;
+        }
+        p++;
+        _setU32((uint8_t *) GWEN_Buffer_GetStart(body)+stack[level].countPos, stack[level].count);
+        level--;
+      }
+      else {
+        const char *name;
+        uint32_t len;
+        uint32_t propCountPos;
+        uint32_t propCount=0;
+
+        p++;
+        name=p;
+        while (p<e && !_isNameEnd(*p))
+          p++;
+        len=p-name;
+        if (len<1) {
+          DBG_INFO(AQHBCI_LOGDOMAIN, "Empty element name");
+          return GWEN_ERROR_BAD_DATA;
+        }
+
+        stack[level].count++;
+        nodeCount++;
+        GWEN_Buffer_AppendByte(body, AH_XMLDEFS_NODE_TAG);
+        _appendU32(body, _stringTableAdd(tab, name, len));
+        propCountPos=GWEN_Buffer_GetPos(body);
+        _appendU32(body, 0);
+
+        for (;;) {
+          p=_skipBlanks(p, e);
+          if (p>=e) {
+            DBG_INFO(AQHBCI_LOGDOMAIN, "Unterminated element");
+            return GWEN_ERROR_BAD_DATA;
+          }
+          if (*p=='/' || *p=='>') {
+            _setU32((uint8_t *) GWEN_Buffer_GetStart(body)+propCountPos, propCount);
+            if (*p=='/') {
+              if (p+1>=e || p[1]!='>') {
+                DBG_INFO(AQHBCI_LOGDOMAIN, "Bad empty element");
+                return GWEN_ERROR_BAD_DATA;
+              }
+              p+=2;
+              _appendU32(body, 0);
+            }
+            else {
+              p++;
+              if (level>=AH_XMLDEFS_MAXLEVEL) {
+                DBG_INFO(AQHBCI_LOGDOMAIN, "Elements nested too deeply");
+                return GWEN_ERROR_BAD_DATA;
+              }
+              level++;
+              stack[level].name=name;
+              stack[level].nameLen=len;
+              stack[level].countPos=GWEN_Buffer_GetPos(body);
+              stack[level].count=0;
+              _appendU32(body, 0);
+            }
+            break;
+          }
+          else {
+            const char *aname;
+            uint32_t alen;
+            const char *value;
+            uint32_t vlen;
+            char quote;
+
+            aname=p;
+            while (p<e && !_isNameEnd(*p))
+              p++;
+            alen=p-aname;
+            p=_skipBlanks(p, e);
+            if (alen<1 || p>=e || *p!='=') {
+              DBG_INFO(AQHBCI_LOGDOMAIN, "Bad attribute");
+              return GWEN_ERROR_BAD_DATA;
+            }
+            p=_skipBlanks(p+1, e);
+            if (p<e && (*p=='"' || *p=='\'')) {
+              quote=*(p++);
+              value=p;
+              while (p<e && *p!=quote)
+                p++;
+              if (p>=e) {
+                DBG_INFO(AQHBCI_LOGDOMAIN, "Unterminated attribute value");
+                return GWEN_ERROR_BAD_DATA;
+              }
+              vlen=p-value;
+              p++;
+            }
+            else {
+              /* unquoted value */
+              value=p;
+              while (p<e && !isspace((unsigned char) *p) && *p!='>' && !_startsWith(p, e, "/>"))
+                p++;
+              vlen=p-value;
+            }
+            if (memchr(value, '&', vlen)) {
+              DBG_INFO(AQHBCI_LOGDOMAIN, "Entities not supported");
+              return GWEN_ERROR_NOT_SUPPORTED;
+            }
+            _appendU32(body, _stringTableAdd(tab, aname, alen));
+            _appendU32(body, _stringTableAdd(tab, value, vlen));
+            propCount++;
+          }
+        } /* for */
+      }
+
+      if (p==NULL) {
+        DBG_INFO(AQHBCI_LOGDOMAIN, "Unterminated markup");
+        return GWEN_ERROR_BAD_DATA;
+      }
+    }
+    else {
+      const char *s;
+      const char *t;
+
+      /* data, leading and trailing blanks removed */
+      s=p;
+      while (p<e && *p!='<')
+        p++;
+      t=p;
+      while (s<t && isspace((unsigned char) *s))
+        s++;
+      while (t>s && isspace((unsigned char) t[-1]))
+        t--;
+      if (t>s) {
+        if (memchr(s, '&', t-s)) {
+          DBG_INFO(AQHBCI_LOGDOMAIN, "Entities not supported");
+          return GWEN_ERROR_NOT_SUPPORTED;
+        }
+        stack[level].count++;
+        nodeCount++;
+        GWEN_Buffer_AppendByte(body, AH_XMLDEFS_NODE_DATA);
+        _appendU32(body, _stringTableAdd(tab, s, t-s));
+      }
+    }
+  } /* while */
+
+  if (level!=0) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Unclosed elements");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  _setU32((uint8_t *) GWEN_Buffer_GetStart(body)+stack[0].countPos, stack[0].count);
+
+  *pNodeCount=nodeCount;
+  return 0;
+}
+
+
+
+int _writeFile(const char *fname, GWEN_BUFFER *buf)
+{
+  GWEN_BUFFER *tbuf;
+  FILE *f;
+
+  /* use a unique temporary file, other processes or threads might write the same cache file at the same time */
+  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_AppendString(tbuf, fname);
+  GWEN_Buffer_AppendString(tbuf, ".XXXXXX");
+
+#ifdef OS_WIN32
+  if (mktemp(GWEN_Buffer_GetStart(tbuf))==NULL)
+    f=NULL;
+  else
+    f=fopen(GWEN_Buffer_GetStart(tbuf), "wb");
+#else
+  {
+    int fd;
+
+    fd=mkstemp(GWEN_Buffer_GetStart(tbuf));
+    if (fd<0)
+      f=NULL;
+    else {
+      f=fdopen(fd, "wb");
+      if (f==NULL) {
+        close(fd);
+        remove(GWEN_Buffer_GetStart(tbuf));
+      }
+    }
+  }
+#endif
+  if (f==NULL) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "fopen(%s): %s", GWEN_Buffer_GetStart(tbuf), strerror(errno));
+    GWEN_Buffer_free(tbuf);
+    return GWEN_ERROR_IO;
+  }
+  if (fwrite(GWEN_Buffer_GetStart(buf), GWEN_Buffer_GetUsedBytes(buf), 1, f)!=1) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "fwrite(%s): %s", GWEN_Buffer_GetStart(tbuf), strerror(errno));
+    fclose(f);
+    remove(GWEN_Buffer_GetStart(tbuf));
+    GWEN_Buffer_free(tbuf);
+    return GWEN_ERROR_IO;
+  }
+  if (fclose(f)) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "fclose(%s): %s", GWEN_Buffer_GetStart(tbuf), strerror(errno));
+    remove(GWEN_Buffer_GetStart(tbuf));
+    GWEN_Buffer_free(tbuf);
+    return GWEN_ERROR_IO;
+  }
+
+#ifdef OS_WIN32
+  remove(fname);
+#endif
+  if (rename(GWEN_Buffer_GetStart(tbuf), fname)) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "rename(%s): %s", GWEN_Buffer_GetStart(tbuf), strerror(errno));
+    remove(GWEN_Buffer_GetStart(tbuf));
+    GWEN_Buffer_free(tbuf);
+    return GWEN_ERROR_IO;
+  }
+
+  GWEN_Buffer_free(tbuf);
+  return 0;
+}
+
+
+
+AH_XMLDEFS_FILEDATA *_fileDataFromFile(const char *fname)
+{
+  AH_XMLDEFS_FILEDATA *fd;
+#ifdef HAVE_SYS_MMAN_H
+  struct stat st;
+  void *ptr;
+  int fh;
+
+  fh=open(fname, O_RDONLY);
+  if (fh<0) {
+    DBG_DEBUG(AQHBCI_LOGDOMAIN, "open(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+  if (fstat(fh, &st)<0 || st.st_size<1 || ((uint64_t) st.st_size)>0xffffffffULL) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Unusable file \"%s\"", fname);
+    close(fh);
+    return NULL;
+  }
+  ptr=mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fh, 0);
+  close(fh);
+  if (ptr==MAP_FAILED) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "mmap(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AH_XMLDEFS_FILEDATA, fd);
+  fd->ptr=(uint8_t *) ptr;
+  fd->size=(uint32_t) st.st_size;
+  fd->isMapped=1;
+#else
+  FILE *f;
+  long size;
+
+  f=fopen(fname, "rb");
+  if (!f) {
+    DBG_DEBUG(AQHBCI_LOGDOMAIN, "fopen(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+  if (fseek(f, 0, SEEK_END) || (size=ftell(f))<1 || fseek(f, 0, SEEK_SET)) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "Unusable file \"%s\"", fname);
+    fclose(f);
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AH_XMLDEFS_FILEDATA, fd);
+  fd->ptr=(uint8_t *) malloc(size);
+  assert(fd->ptr);
+  fd->size=(uint32_t) size;
+  if (fread(fd->ptr, size, 1, f)!=1) {
+    DBG_INFO(AQHBCI_LOGDOMAIN, "fread(%s): %s", fname, strerror(errno));
+    fclose(f);
+    _fileDataFree(fd);
+    return NULL;
+  }
+  fclose(f);
+#endif
+
+  return fd;
+}
+
+
+
+void _fileDataFree(AH_XMLDEFS_FILEDATA *fd)
+{
+  if (fd) {
+#ifdef HAVE_SYS_MMAN_H
+    if (fd->isMapped)
+      munmap(fd->ptr, fd->size);
+    else
+      free(fd->ptr);
+#else
+    free(fd->ptr);
+#endif
+    GWEN_FREE_OBJECT(fd);
+  }
+}
+
+
+
+AH_XMLDEFS_STRINGTABLE *_stringTableNew(void)
+{
+  AH_XMLDEFS_STRINGTABLE *tab;
+
+  GWEN_NEW_OBJECT(AH_XMLDEFS_STRINGTABLE, tab);
+  tab->slotCount=AH_XMLDEFS_STRING_SLOTS;
+  tab->slotOffsets=(uint32_t *) calloc(tab->slotCount, sizeof(uint32_t));
+  tab->slotIndexes=(uint32_t *) calloc(tab->slotCount, sizeof(uint32_t));
+  assert(tab->slotOffsets && tab->slotIndexes);
+  tab->tableBuffer=GWEN_Buffer_new(0, 16384, 0, 1);
+  return tab;
+}
+
+
+
+void _stringTableFree(AH_XMLDEFS_STRINGTABLE *tab)
+{
+  if (tab) {
+    GWEN_Buffer_free(tab->tableBuffer);
+    free(tab->slotIndexes);
+    free(tab->slotOffsets);
+    GWEN_FREE_OBJECT(tab);
+  }
+}
+
+
+
+uint32_t _stringTableAdd(AH_XMLDEFS_STRINGTABLE *tab, const char *s, uint32_t len)
+{
+  uint32_t mask;
+  uint32_t i;
+  uint32_t offset;
+  uint32_t idx;
+
+  mask=tab->slotCount-1;
+  i=_hashBytes(s, len) & mask;
+  while (tab->slotOffsets[i]) {
+    const char *t;
+
+    t=GWEN_Buffer_GetStart(tab->tableBuffer)+(tab->slotOffsets[i]-1);
+    if (strncmp(t, s, len)==0 && t[len]==0)
+      return tab->slotIndexes[i];
+    i=(i+1) & mask;
+  }
+
+  offset=GWEN_Buffer_GetUsedBytes(tab->tableBuffer);
+  GWEN_Buffer_AppendBytes(tab->tableBuffer, s, len);
+  GWEN_Buffer_AppendByte(tab->tableBuffer, 0);
+  idx=tab->stringCount++;
+  tab->slotOffsets[i]=offset+1;
+  tab->slotIndexes[i]=idx;
+
+  if (tab->stringCount*2>tab->slotCount)
+    _stringTableGrow(tab);
+
+  return idx;
+}
+
+
+
+void _stringTableGrow(AH_XMLDEFS_STRINGTABLE *tab)
+{
+  uint32_t *oldOffsets;
+  uint32_t *oldIndexes;
+  uint32_t oldCount;
+  uint32_t mask;
+  uint32_t j;
+
+  oldOffsets=tab->slotOffsets;
+  oldIndexes=tab->slotIndexes;
+  oldCount=tab->slotCount;
+
+  tab->slotCount=oldCount*2;
+  tab->slotOffsets=(uint32_t *) calloc(tab->slotCount, sizeof(uint32_t));
+  tab->slotIndexes=(uint32_t *) calloc(tab->slotCount, sizeof(uint32_t));
+  assert(tab->slotOffsets && tab->slotIndexes);
+  mask=tab->slotCount-1;
+
+  for (j=0; j<oldCount; j++) {
+    if (oldOffsets[j]) {
+      const char *t;
+      uint32_t i;
+
+      t=GWEN_Buffer_GetStart(tab->tableBuffer)+(oldOffsets[j]-1);
+      i=_hashBytes(t, strlen(t)) & mask;
+      while (tab->slotOffsets[i])
+        i=(i+1) & mask;
+      tab->slotOffsets[i]=oldOffsets[j];
+      tab->slotIndexes[i]=oldIndexes[j];
+    }
+  }
+
+  free(oldIndexes);
+  free(oldOffsets);
+}
+
+
+
+int _readerSetup(AH_XMLDEFS_READER *r, const uint8_t *ptr, uint32_t len, int64_t *pMtime, uint64_t *pSize)
+{
+  uint32_t stringCount;
+  uint32_t tableSize;
+  uint32_t bodySize;
+  const char *p;
+  const char *pEnd;
+  uint32_t i;
+
+  memset(r, 0, sizeof(AH_XMLDEFS_READER));
+  if (len<AH_XMLDEFS_HEADER_SIZE || memcmp(ptr, AH_XMLDEFS_MAGIC, 4)!=0 || ptr[4]!=AH_XMLDEFS_VERSION)
+    return GWEN_ERROR_BAD_DATA;
+
+  *pMtime=(int64_t) _getU64(ptr+8);
+  *pSize=_getU64(ptr+16);
+  stringCount=_getU32(ptr+24);
+  tableSize=_getU32(ptr+28);
+  bodySize=_getU32(ptr+32);
+  if (((uint64_t) AH_XMLDEFS_HEADER_SIZE)+tableSize+bodySize!=(uint64_t) len ||
+      stringCount<1 || stringCount>tableSize ||
+      ptr[AH_XMLDEFS_HEADER_SIZE+tableSize-1]!=0)
+    return GWEN_ERROR_BAD_DATA;
+
+  r->strings=(const char **) malloc(stringCount*sizeof(const char *));
+  assert(r->strings);
+  p=(const char *)(ptr+AH_XMLDEFS_HEADER_SIZE);
+  pEnd=p+tableSize;
+  for (i=0; i<stringCount; i++) {
+    if (p>=pEnd) {
+      free(r->strings);
+      r->strings=NULL;
+      return GWEN_ERROR_BAD_DATA;
+    }
+    r->strings[i]=p;
+    p+=strlen(p)+1;
+  }
+  if (p!=pEnd) {
+    free(r->strings);
+    r->strings=NULL;
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  r->stringCount=stringCount;
+  r->pos=(const uint8_t *) pEnd;
+  r->end=r->pos+bodySize;
+  r->nodesLeft=_getU32(ptr+36);
+  return 0;
+}
+
+
+
+int _readU32(AH_XMLDEFS_READER *r, uint32_t *pValue)
+{
+  if (r->end-r->pos<4)
+    return GWEN_ERROR_BAD_DATA;
+  *pValue=_getU32(r->pos);
+  r->pos+=4;
+  return 0;
+}
+
+
+
+int _readString(AH_XMLDEFS_READER *r, const char **pString)
+{
+  uint32_t idx;
+
+  if (_readU32(r, &idx)<0 || idx>=r->stringCount)
+    return GWEN_ERROR_BAD_DATA;
+  *pString=r->strings[idx];
+  return 0;
+}
+
+
+
+int _buildChildren(AH_XMLDEFS_READER *r, GWEN_XMLNODE *parent, int level)
+{
+  uint32_t count;
+  uint32_t i;
+
+  if (level>AH_XMLDEFS_MAXLEVEL || _readU32(r, &count)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  for (i=0; i<count; i++) {
+    GWEN_XMLNODE *n;
+    const char *s;
+    uint8_t nodeType;
+
+    if (r->pos>=r->end || r->nodesLeft<1)
+      return GWEN_ERROR_BAD_DATA;
+    r->nodesLeft--;
+    nodeType=*(r->pos++);
+    if (_readString(r, &s)<0)
+      return GWEN_ERROR_BAD_DATA;
+
+    if (nodeType==AH_XMLDEFS_NODE_TAG) {
+      uint32_t propCount;
+      uint32_t j;
+      int rv;
+
+      n=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, s);
+      GWEN_XMLNode_AddChild(parent, n);
+      if (_readU32(r, &propCount)<0)
+        return GWEN_ERROR_BAD_DATA;
+      for (j=0; j<propCount; j++) {
+        const char *name;
+        const char *value;
+
+        if (_readString(r, &name)<0 || _readString(r, &value)<0)
+          return GWEN_ERROR_BAD_DATA;
+        GWEN_XMLNode_SetProperty(n, name, value);
+      }
+      rv=_buildChildren(r, n, level+1);
+      if (rv<0)
+        return rv;
+    }
+    else if (nodeType==AH_XMLDEFS_NODE_DATA) {
+      n=GWEN_XMLNode_new(GWEN_XMLNodeTypeData, s);
+      GWEN_XMLNode_AddChild(parent, n);
+    }
+    else
+      return GWEN_ERROR_BAD_DATA;
+  }
+
+  return 0;
+}
+
+
+
+int _verifyChildren(AH_XMLDEFS_READER *r, GWEN_XMLNODE *parent, int level)
+{
+  GWEN_XMLNODE *n;
+  uint32_t count;
+  uint32_t i;
+
+  if (level>AH_XMLDEFS_MAXLEVEL || _readU32(r, &count)<0)
+    return GWEN_ERROR_BAD_DATA;
+
+  n=_skipComments(GWEN_XMLNode_GetChild(parent));
+  for (i=0; i<count; i++) {
+    const char *s;
+    const char *data;
+    uint8_t nodeType;
+
+    if (n==NULL || r->pos>=r->end || r->nodesLeft<1)
+      return GWEN_ERROR_BAD_DATA;
+    r->nodesLeft--;
+    nodeType=*(r->pos++);
+    if (_readString(r, &s)<0)
+      return GWEN_ERROR_BAD_DATA;
+    data=GWEN_XMLNode_GetData(n);
+
+    if (nodeType==AH_XMLDEFS_NODE_TAG) {
+      uint32_t propCount;
+      uint32_t j;
+      int rv;
+
+      if (GWEN_XMLNode_GetType(n)!=GWEN_XMLNodeTypeTag || data==NULL || strcmp(data, s)!=0)
+        return GWEN_ERROR_BAD_DATA;
+      if (_readU32(r, &propCount)<0)
+        return GWEN_ERROR_BAD_DATA;
+      for (j=0; j<propCount; j++) {
+        const char *name;
+        const char *value;
+        const char *v;
+
+        if (_readString(r, &name)<0 || _readString(r, &value)<0)
+          return GWEN_ERROR_BAD_DATA;
+        v=GWEN_XMLNode_GetProperty(n, name, NULL);
+        if (v==NULL || strcmp(v, value)!=0)
+          return GWEN_ERROR_BAD_DATA;
+      }
+      rv=_verifyChildren(r, n, level+1);
+      if (rv<0)
+        return rv;
+    }
+    else if (nodeType==AH_XMLDEFS_NODE_DATA) {
+      if (GWEN_XMLNode_GetType(n)!=GWEN_XMLNodeTypeData || data==NULL || strcmp(data, s)!=0)
+        return GWEN_ERROR_BAD_DATA;
+    }
+    else
+      return GWEN_ERROR_BAD_DATA;
+
+    n=_skipComments(GWEN_XMLNode_Next(n));
+  }
+
+  if (n)
+    /* XML tree has more children */
+    return GWEN_ERROR_BAD_DATA;
+
+  return 0;
+}
+
+
+
+GWEN_XMLNODE *_skipComments(GWEN_XMLNODE *n)
+{
+  while (n && GWEN_XMLNode_GetType(n)==GWEN_XMLNodeTypeComment)
+    n=GWEN_XMLNode_Next(n);
+  return n;
+}
+
+
+
+int _startsWith(const char *p, const char *e, const char *s)
+{
+  size_t len;
+
+  len=strlen(s);
+  return ((size_t)(e-p)>=len && strncmp(p, s, len)==0);
+}
+
+
+
+const char *_skipPast(const char *p, const char *e, const char *s)
+{
+  while (p<e) {
+    if (_startsWith(p, e, s))
+      return p+strlen(s);
+    p++;
+  }
+  return NULL;
+}
+
+
+
+const char *_skipBlanks(const char *p, const char *e)
+{
+  while (p<e && isspace((unsigned char) *p))
+    p++;
+  return p;
+}
+
+
+
+int _isNameEnd(char c)
+{
+  return (isspace((unsigned char) c) || c=='/' || c=='>' || c=='=' || c=='<');
+}
+
+
+
+uint32_t _hashBytes(const char *s, uint32_t len)
+{
+  uint32_t h=2166136261u;
+  uint32_t i;
+
+  for (i=0; i<len; i++) {
+    h^=(uint8_t) s[i];
+    h*=16777619u;
+  }
+  return h;
+}
+
+
+
+void _appendU32(GWEN_BUFFER *buf, uint32_t v)
+{
+  uint8_t b[4];
+
+  _setU32(b, v);
+  GWEN_Buffer_AppendBytes(buf, (const char *) b, 4);
+}
+
+
+
+void _appendU64(GWEN_BUFFER *buf, uint64_t v)
+{
+  _appendU32(buf, (uint32_t)(v & 0xffffffffULL));
+  _appendU32(buf, (uint32_t)(v>>32));
+}
+
+
+
+void _setU32(uint8_t *p, uint32_t v)
+{
+  p[0]=(uint8_t)(v & 0xff);
+  p[1]=(uint8_t)((v>>8) & 0xff);
+  p[2]=(uint8_t)((v>>16) & 0xff);
+  p[3]=(uint8_t)((v>>24) & 0xff);
+}
+
+
+
+uint32_t _getU32(const uint8_t *p)
+{
+  return ((uint32_t) p[0]) | (((uint32_t) p[1])<<8) | (((uint32_t) p[2])<<16) | (((uint32_t) p[3])<<24);
+}
+
+
+
+uint64_t _getU64(const uint8_t *p)
+{
+  return ((uint64_t) _getU32(p)) | (((uint64_t) _getU32(p+4))<<32);
+}
+
+
+
+AH_XMLDEFS_INDEX *AH_XmlDefs_Index_new(GWEN_XMLNODE *defs)
+{
+  AH_XMLDEFS_INDEX *idx;
+  GWEN_XMLNODE *nGroup;
+  uint32_t typeSize=0;
+  uint32_t entrySize=0;
+  uint32_t i;
+
+  GWEN_NEW_OBJECT(AH_XMLDEFS_INDEX, idx);
+  idx->defs=defs;
+
+  nGroup=defs?GWEN_XMLNode_GetFirstTag(defs):NULL;
+  while (nGroup) {
+    const char *groupName;
+    uint32_t len;
+
+    /* groups are named like the type followed by "S", only the first group of a type is used for lookups */
+    groupName=GWEN_XMLNode_GetData(nGroup);
+    len=groupName?strlen(groupName):0;
+    if (len>1 && toupper((unsigned char) groupName[len-1])=='S') {
+      uint32_t typeIndex;
+
+      for (typeIndex=0; typeIndex<idx->typeCount; typeIndex++) {
+        if (strcasecmp(idx->types[typeIndex].name, groupName)==0)
+          break;
+      }
+
+      if (typeIndex>=idx->typeCount) {
+        GWEN_XMLNODE *n;
+
+        if (idx->typeCount>=typeSize) {
+          typeSize=typeSize?typeSize*2:8;
+          idx->types=(AH_XMLDEFS_TYPE *) realloc(idx->types, typeSize*sizeof(AH_XMLDEFS_TYPE));
+          assert(idx->types);
+        }
+        idx->types[typeIndex].name=groupName;
+        idx->types[typeIndex].nameLen=len-1;
+        idx->typeCount++;
+
+        n=GWEN_XMLNode_GetFirstTag(nGroup);
+        while (n) {
+          if (_isDefinitionName(GWEN_XMLNode_GetData(n), groupName, len-1)) {
+            int j;
+
+            for (j=0; _indexedPropertyNames[j]; j++) {
+              const char *s;
+
+              s=GWEN_XMLNode_GetProperty(n, _indexedPropertyNames[j], NULL);
+              if (s && *s)
+                _indexAddEntry(idx, &entrySize, typeIndex, j, s, n);
+            }
+          }
+          n=GWEN_XMLNode_GetNextTag(n);
+        }
+      }
+    }
+    nGroup=GWEN_XMLNode_GetNextTag(nGroup);
+  }
+
+  idx->slotCount=16;
+  while (idx->slotCount<idx->entryCount*2)
+    idx->slotCount*=2;
+  idx->slots=(uint32_t *) calloc(idx->slotCount, sizeof(uint32_t));
+  assert(idx->slots);
+
+  /* insert in reverse order so that every slot lists its entries in document order */
+  for (i=idx->entryCount; i>0; i--) {
+    AH_XMLDEFS_ENTRY *e;
+    uint32_t slot;
+
+    e=&(idx->entries[i-1]);
+    slot=e->hash & (idx->slotCount-1);
+    e->next=idx->slots[slot];
+    idx->slots[slot]=i;
+  }
+
+  DBG_INFO(AQHBCI_LOGDOMAIN, "Indexed %u definitions of %u types", idx->entryCount, idx->typeCount);
+  return idx;
+}
+
+
+
+void AH_XmlDefs_Index_free(AH_XMLDEFS_INDEX *idx)
+{
+  if (idx) {
+    free(idx->slots);
+    free(idx->entries);
+    free(idx->types);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+GWEN_XMLNODE *AH_XmlDefs_Index_GetDefinitions(const AH_XMLDEFS_INDEX *idx)
+{
+  assert(idx);
+  return idx->defs;
+}
+
+
+
+int AH_XmlDefs_Index_FindNode(const AH_XMLDEFS_INDEX *idx,
+                              const char *t,
+                              const char *pname,
+                              int version,
+                              const char *pvalue,
+                              unsigned int protocolVersion,
+                              const char *mode,
+                              GWEN_XMLNODE **pNode)
+{
+  int pnameIndex;
+  uint32_t tlen;
+  uint32_t h;
+  uint32_t i;
+
+  assert(idx);
+  assert(t);
+  *pNode=NULL;
+
+  pnameIndex=_pnameIndex(pname);
+  if (pnameIndex<0 || pvalue==NULL || *pvalue==0)
+    return GWEN_ERROR_NOT_SUPPORTED;
+  if (mode==NULL)
+    mode="";
+
+  tlen=strlen(t);
+  h=_hashKey(t, tlen, pnameIndex, pvalue);
+  for (i=idx->slots[h & (idx->slotCount-1)]; i; i=idx->entries[i-1].next) {
+    const AH_XMLDEFS_ENTRY *e;
+
+    e=&(idx->entries[i-1]);
+    if (e->hash==h &&
+        e->pnameIndex==pnameIndex &&
+        idx->types[e->typeIndex].nameLen==tlen &&
+        strncasecmp(idx->types[e->typeIndex].name, t, tlen)==0 &&
+        strcasecmp(e->value, pvalue)==0 &&
+        (protocolVersion==0 || e->protocolVersion==(int) protocolVersion || e->protocolVersion==0) &&
+        (version==0 || e->version==version) &&
+        (*(e->mode)==0 || strcasecmp(e->mode, mode)==0)) {
+      *pNode=e->node;
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
+
+
+int _pnameIndex(const char *pname)
+{
+  int i;
+
+  if (pname) {
+    for (i=0; _indexedPropertyNames[i]; i++) {
+      if (strcasecmp(pname, _indexedPropertyNames[i])==0)
+        return i;
+    }
+  }
+  return -1;
+}
+
+
+
+int _isDefinitionName(const char *name, const char *typeName, uint32_t typeLen)
+{
+  /* same names as accepted by GWEN_MsgEngine_FindNodeByProperty: the type itself or the type followed by "def" */
+  if (name && strncasecmp(name, typeName, typeLen)==0)
+    return (name[typeLen]==0 || strcasecmp(name+typeLen, "def")==0);
+  return 0;
+}
+
+
+
+uint32_t _hashKey(const char *t, uint32_t tlen, int pnameIndex, const char *value)
+{
+  uint32_t h=2166136261u;
+  uint32_t i;
+
+  for (i=0; i<tlen; i++) {
+    h^=(uint8_t) tolower((unsigned char) t[i]);
+    h*=16777619u;
+  }
+  h^=(uint32_t)(pnameIndex+1);
+  h*=16777619u;
+  while (*value) {
+    h^=(uint8_t) tolower((unsigned char) *value);
+    h*=16777619u;
+    value++;
+  }
+  return h;
+}
+
+
+
+void _indexAddEntry(AH_XMLDEFS_INDEX *idx, uint32_t *pEntrySize, uint32_t typeIndex, int pnameIndex,
+                    const char *value, GWEN_XMLNODE *n)
+{
+  AH_XMLDEFS_ENTRY *e;
+
+  if (idx->entryCount>=*pEntrySize) {
+    *pEntrySize=(*pEntrySize)?(*pEntrySize)*2:256;
+    idx->entries=(AH_XMLDEFS_ENTRY *) realloc(idx->entries, (*pEntrySize)*sizeof(AH_XMLDEFS_ENTRY));
+    assert(idx->entries);
+  }
+
+  e=&(idx->entries[idx->entryCount++]);
+  e->typeIndex=typeIndex;
+  e->pnameIndex=pnameIndex;
+  e->value=value;
+  e->hash=_hashKey(idx->types[typeIndex].name, idx->types[typeIndex].nameLen, pnameIndex, value);
+  e->version=atoi(GWEN_XMLNode_GetProperty(n, "version", "0"));
+  e->protocolVersion=atoi(GWEN_XMLNode_GetProperty(n, "pversion", "0"));
+  e->mode=GWEN_XMLNode_GetProperty(n, "mode", "");
+  e->node=n;
+  e->next=0;
+}
+
+
@@ -0,0 +1,90 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AH_XMLDEFS_L_H
+#define AH_XMLDEFS_L_H
+
+
+#include <gwenhywfar/xml.h>
+
+
+/** @name Compiled Definitions
+ *
+ * Reading the HBCI XML definitions is a noticeable part of the startup time of short-running
+ * processes. Therefore the definitions are compiled into a binary file (containing a string table
+ * and the node tree) which can be mapped into memory and turned into an XML tree without any parsing.
+ *
+ * The compiled file is created when reading the XML file for the first time. It is only written if
+ * its content exactly reproduces the tree read by the XML reader of Gwenhywfar, otherwise the XML file
+ * is always read directly. The compiled file contains path, size and modification time of the XML file
+ * and is ignored (and replaced) when the XML file changes.
+ */
+/*@{*/
+
+/**
+ * Read the given XML file, use the compiled file if possible.
+ * @return tree (with a node "root" as returned by @ref GWEN_XML_ReadFile), NULL on error
+ * @param fname path of the XML file
+ * @param cacheFile path of the compiled file (NULL to always read the XML file)
+ */
+GWEN_XMLNODE *AH_XmlDefs_ReadFile(const char *fname, const char *cacheFile);
+
+/*@}*/
+
+
+
+/** @name Definition Index
+ *
+ * @ref GWEN_MsgEngine_FindNodeByProperty walks through all definitions of a given type for every lookup.
+ * This index maps type, property name and property value of all job, segment and group definitions
+ * to the corresponding nodes using a hash table, so a lookup only needs to check the few definitions
+ * which differ only in version, protocol version or mode.
+ *
+ * The index is never modified after creation, so it can be used by multiple threads at once.
+ */
+/*@{*/
+
+typedef struct AH_XMLDEFS_INDEX AH_XMLDEFS_INDEX;
+
+
+/**
+ * Create an index over the given definitions. The tree must not be modified or freed as long as the
+ * index is in use.
+ */
+AH_XMLDEFS_INDEX *AH_XmlDefs_Index_new(GWEN_XMLNODE *defs);
+void AH_XmlDefs_Index_free(AH_XMLDEFS_INDEX *idx);
+
+GWEN_XMLNODE *AH_XmlDefs_Index_GetDefinitions(const AH_XMLDEFS_INDEX *idx);
+
+
+/**
+ * Lookup a definition, same semantics as @ref GWEN_MsgEngine_FindNodeByProperty.
+ * @return 0 if ok (*pNode is NULL if there is no matching definition),
+ *   GWEN_ERROR_NOT_SUPPORTED if the lookup can't be done using the index
+ * @param idx index
+ * @param t type of the definition (e.g. "JOB", "SEG")
+ * @param pname name of the property (only "id" and "code" are indexed)
+ * @param version version of the definition (0 for any)
+ * @param pvalue value of the property
+ * @param protocolVersion protocol version (0 for any)
+ * @param mode mode of the definition (NULL or empty for definitions without mode only)
+ * @param pNode pointer to receive the node found
+ */
+int AH_XmlDefs_Index_FindNode(const AH_XMLDEFS_INDEX *idx,
+                              const char *t,
+                              const char *pname,
+                              int version,
+                              const char *pvalue,
+                              unsigned int protocolVersion,
+                              const char *mode,
+                              GWEN_XMLNODE **pNode);
+
+/*@}*/
+
+
+#endif
+
@@ -0,0 +1,134 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AH_XMLDEFS_P_H
+#define AH_XMLDEFS_P_H
+
+
+#include "xmldefs_l.h"
+
+#include <gwenhywfar/buffer.h>
+
+
+/*
+ * Layout of a compiled file (all numbers are little endian):
+ *
+ * header:
+ *   4 bytes  magic "AHXD"
+ *   1 byte   version
+ *   3 bytes  reserved (0)
+ *   8 bytes  modification time of the XML file (seconds since epoch)
+ *   8 bytes  size of the XML file
+ *   4 bytes  number of strings in the string table
+ *   4 bytes  size of the string table
+ *   4 bytes  size of the body
+ *   4 bytes  number of nodes in the body
+ *
+ * string table: strings, each terminated by a 0 byte (the first string is the path of the XML file)
+ *
+ * body: 4 bytes number of children of the root node, children
+ *   node:
+ *     1 byte type
+ *     type "T": 4 bytes name index, 4 bytes number of properties,
+ *               properties (4 bytes name index, 4 bytes value index),
+ *               4 bytes number of children, children
+ *     type "D": 4 bytes data index
+ */
+
+#define AH_XMLDEFS_MAGIC       "AHXD"
+#define AH_XMLDEFS_VERSION     1
+#define AH_XMLDEFS_HEADER_SIZE 40
+
+#define AH_XMLDEFS_NODE_TAG  'T'
+#define AH_XMLDEFS_NODE_DATA 'D'
+
+#define AH_XMLDEFS_MAXLEVEL  64
+
+/* initial number of slots of the string hash table (must be a power of 2) */
+#define AH_XMLDEFS_STRING_SLOTS 1024
+
+/* property names of definitions which are indexed */
+#define AH_XMLDEFS_PNAME_ID   0
+#define AH_XMLDEFS_PNAME_CODE 1
+
+
+
+/** content of a file (mapped into memory if possible) */
+typedef struct AH_XMLDEFS_FILEDATA AH_XMLDEFS_FILEDATA;
+struct AH_XMLDEFS_FILEDATA {
+  uint8_t *ptr;
+  uint32_t size;
+  int isMapped;
+};
+
+
+/** string table used while compiling */
+typedef struct AH_XMLDEFS_STRINGTABLE AH_XMLDEFS_STRINGTABLE;
+struct AH_XMLDEFS_STRINGTABLE {
+  uint32_t *slotOffsets;       /* hash table: offset of the string in tableBuffer plus 1 (0 if unused) */
+  uint32_t *slotIndexes;       /* hash table: index of the string in the string table */
+  uint32_t slotCount;
+  uint32_t stringCount;
+  GWEN_BUFFER *tableBuffer;    /* strings in order of their indexes */
+};
+
+
+/** state while reading the body of a compiled file */
+typedef struct AH_XMLDEFS_READER AH_XMLDEFS_READER;
+struct AH_XMLDEFS_READER {
+  const uint8_t *pos;
+  const uint8_t *end;
+  const char **strings;
+  uint32_t stringCount;
+  uint32_t nodesLeft;
+};
+
+
+/** open element while compiling */
+typedef struct AH_XMLDEFS_OPENTAG AH_XMLDEFS_OPENTAG;
+struct AH_XMLDEFS_OPENTAG {
+  const char *name;
+  uint32_t nameLen;
+  uint32_t countPos;           /* position of the number of children in the body buffer */
+  uint32_t count;
+};
+
+
+typedef struct AH_XMLDEFS_ENTRY AH_XMLDEFS_ENTRY;
+struct AH_XMLDEFS_ENTRY {
+  uint32_t hash;
+  uint32_t typeIndex;
+  int pnameIndex;
+  const char *value;
+  int version;
+  int protocolVersion;
+  const char *mode;
+  GWEN_XMLNODE *node;
+  uint32_t next;               /* index of the next entry in the same slot plus 1 (0 if none) */
+};
+
+
+typedef struct AH_XMLDEFS_TYPE AH_XMLDEFS_TYPE;
+struct AH_XMLDEFS_TYPE {
+  const char *name;            /* name of the group node (type followed by "S") */
+  uint32_t nameLen;            /* length of the type name */
+};
+
+
+struct AH_XMLDEFS_INDEX {
+  GWEN_XMLNODE *defs;
+  AH_XMLDEFS_TYPE *types;
+  uint32_t typeCount;
+  AH_XMLDEFS_ENTRY *entries;
+  uint32_t entryCount;
+  uint32_t *slots;             /* index of the first entry per slot plus 1 (0 if none) */
+  uint32_t slotCount;
+};
+
+
+#endif
+
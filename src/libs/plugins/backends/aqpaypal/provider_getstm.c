@@ -16,14 +16,71 @@
 
 #include "aqpaypal/provider_request.h"
 
+#include "aqbanking/banking_be.h"
+#include "aqbanking/backendsupport/workerpool_l.h"
+
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/gui.h>
 #include <gwenhywfar/i18n.h>
+#include <gwenhywfar/text.h>
+#include <gwenhywfar/directory.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef OS_WIN32
+# include <windows.h>
+#else
+# include <unistd.h>
+#endif
 
 
 #define I18N(msg) GWEN_I18N_Translate(PACKAGE, msg)
 
 
+/* defaults for runtime variables "paypalDetailsThreads" and "paypalDetailsRequestsPerSecond"
+ * (details are requested serially unless parallel requests are explicitly enabled) */
+#define APY_GETDETAILS_THREADS               0
+#define APY_GETDETAILS_REQUESTS_PER_SECOND   4
+
+/* retries on temporary errors, waiting 1, 2, 4, ... seconds between them */
+#define APY_GETDETAILS_MAX_RETRIES           5
+
+/* number of new responses after which the checkpoint file is written */
+#define APY_GETDETAILS_CHECKPOINT_INTERVAL   25
+/* checkpoint files older than this (in seconds) are ignored */
+#define APY_GETDETAILS_CHECKPOINT_MAXAGE     (24*60*60)
+
+
+
+/* state shared by the workers reading transaction details */
+typedef struct APY_GETDETAILS APY_GETDETAILS;
+struct APY_GETDETAILS {
+  AB_PROVIDER *provider;
+  AB_BANKING *banking;
+  AB_USER *user;
+
+  AB_TRANSACTION **transactions;   /* transactions which still need details */
+  int transactionCount;
+  int totalCount;                  /* including those read from the checkpoint */
+  int startedCount;
+  int aborted;
+
+  int maxRequestsPerSecond;
+  time_t rateSecond;
+  int rateCount;
+  time_t pausedUntil;
+
+  char *checkpointFile;
+  GWEN_DB_NODE *dbCheckpoint;
+  int unsavedCount;
+};
+
+
 
 
 static AB_TRANSACTION_LIST *_readTransactionsFromSearchResponse(GWEN_DB_NODE *dbResponse);
@@ -34,7 +91,19 @@ static void _setTypeFromLTYPE(const char *s, AB_TRANSACTION *t);
 static AB_VALUE *_readValueFromString(const char *s, const char *currencyCode);
 static AB_TRANSACTION_STATUS _paymentStatusFromString(const char *s);
 static void _readPurposeLinesFromDetailsResponse(GWEN_DB_NODE *dbResponse, AB_TRANSACTION *t);
-static int _requestTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION *t);
+static int _readDetailsJob(void *userData, int idx);
+static int _requestTransactionDetails(APY_GETDETAILS *gd, AB_TRANSACTION *t, GWEN_DB_NODE **pDbResponse);
+static void _applyTransactionDetails(GWEN_DB_NODE *dbResponse, AB_TRANSACTION *t);
+static GWEN_DB_NODE *_extractTransactionDetails(GWEN_DB_NODE *dbResponse);
+static void _waitForRequestSlot(APY_GETDETAILS *gd);
+static void _sleepSeconds(int secs);
+static int _compareTransactionIds(const void *a, const void *b);
+static AB_TRANSACTION *_findTransactionById(const APY_GETDETAILS *gd, const char *id);
+static int _getCheckpointFile(AB_PROVIDER *pro, AB_USER *u, GWEN_BUFFER *buf);
+static void _readCheckpoint(APY_GETDETAILS *gd);
+static void _addToCheckpoint(APY_GETDETAILS *gd, const char *id, GWEN_DB_NODE *dbResponse);
+static void _writeCheckpoint(APY_GETDETAILS *gd);
+static void _removeCheckpoint(APY_GETDETAILS *gd);
 
 
 
@@ -108,15 +177,15 @@ int APY_Provider_ExecGetTrans(AB_PROVIDER *pro,
 
 
 
-int _requestTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION *t)
+int _requestTransactionDetails(APY_GETDETAILS *gd, AB_TRANSACTION *t, GWEN_DB_NODE **pDbResponse)
 {
   GWEN_BUFFER *tbuf;
   const char *s;
+  int attempt;
   int rv;
-  GWEN_DB_NODE *dbResponse;
 
   tbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  rv=APY_Provider_SetupUrlString(pro, u, tbuf);
+  rv=APY_Provider_SetupUrlString(gd->provider, gd->user, tbuf);
   if (rv<0) {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
     GWEN_Buffer_free(tbuf);
@@ -134,17 +203,40 @@ int _requestTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION *t)
   GWEN_Buffer_AppendString(tbuf, "&transactionId=");
   GWEN_Text_EscapeToBuffer(s, tbuf);
 
-  /* send and receive */
-  dbResponse=APY_Provider_SendRequestParseResponse(pro, u, GWEN_Buffer_GetStart(tbuf), "getTransactionDetails");
-  if (dbResponse==NULL) {
-    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here");
-    GWEN_Buffer_free(tbuf);
-    return GWEN_ERROR_GENERIC;
+  /* send and receive, retry with increasing delays if the server is busy */
+  for (attempt=0;; attempt++) {
+    int delay;
+
+    _waitForRequestSlot(gd);
+    rv=APY_Provider_SendRequest(gd->provider, gd->user, GWEN_Buffer_GetStart(tbuf), "getTransactionDetails", pDbResponse);
+    if (rv!=GWEN_ERROR_TRY_AGAIN || attempt>=APY_GETDETAILS_MAX_RETRIES)
+      break;
+
+    delay=1<<attempt;
+    DBG_NOTICE(AQPAYPAL_LOGDOMAIN, "Server busy, retrying in %d seconds", delay);
+    /* let the other workers pause as well */
+    AB_Banking_Lock(gd->banking);
+    if (gd->pausedUntil<time(NULL)+delay)
+      gd->pausedUntil=time(NULL)+delay;
+    AB_Banking_Unlock(gd->banking);
+    _sleepSeconds(delay);
   }
-
   GWEN_Buffer_free(tbuf);
 
-  /* parse response */
+  if (rv<0) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+void _applyTransactionDetails(GWEN_DB_NODE *dbResponse, AB_TRANSACTION *t)
+{
+  const char *s;
+
   s=GWEN_DB_GetCharValue(dbResponse, "TRANSACTIONTYPE", 0, NULL);
   if (s && *s)
     AB_Transaction_SetTransactionText(t, s);
@@ -169,10 +261,6 @@ int _requestTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION *t)
     AB_Transaction_AddPurposeLine(t, s);
 
   _readPurposeLinesFromDetailsResponse(dbResponse, t);
-
-  GWEN_DB_Group_free(dbResponse);
-
-  return 0;
 }
 
 
@@ -328,9 +416,14 @@ AB_TRANSACTION *readOneTransactionFromSearchResponse(GWEN_DB_NODE *dbT)
 
 int _possiblyReadTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION_LIST *transactionList)
 {
+  APY_GETDETAILS gd;
   AB_TRANSACTION *transaction;
+  GWEN_BUFFER *fbuf;
   int count=0;
-  int lastError=0;
+  int numThreads;
+  int i;
+  int j;
+  int rv;
 
   transaction=AB_Transaction_List_First(transactionList);
   while (transaction) {
@@ -340,33 +433,368 @@ int _possiblyReadTransactionDetails(AB_PROVIDER *pro, AB_USER *u, AB_TRANSACTION
   }
 
   DBG_INFO(AQPAYPAL_LOGDOMAIN, "Need to read transaction details for %d transactions", count);
-  if (count) {
-    int i=1;
-
-    GWEN_Gui_ProgressLog2(0, GWEN_LoggerLevel_Notice, I18N("Need to read details for %d transactions"), count);
-    transaction=AB_Transaction_List_First(transactionList);
-    while (transaction) {
-      if (AB_Transaction_GetCommand(transaction)==AB_Transaction_CommandGetTransactions) {
-        int rv;
-
-        DBG_INFO(AQPAYPAL_LOGDOMAIN, "Reading details for transaction %d of %d", i, count);
-        GWEN_Gui_ProgressLog2(0, GWEN_LoggerLevel_Notice, I18N("Reading details for transactions %d of %d"), i, count);
-        rv=_requestTransactionDetails(pro, u, transaction);
-        if (rv<0) {
-          DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
-          lastError=rv;
-        }
-        else
-          AB_Transaction_SetCommand(transaction, AB_Transaction_CommandNone); /* remove mark */
-        i++;
-      }
-      transaction=AB_Transaction_List_Next(transaction);
+  if (count<1) {
+    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice, I18N("No transaction details needed"));
+    return 0;
+  }
+  GWEN_Gui_ProgressLog2(0, GWEN_LoggerLevel_Notice, I18N("Need to read details for %d transactions"), count);
+
+  memset(&gd, 0, sizeof(gd));
+  gd.provider=pro;
+  gd.banking=AB_Provider_GetBanking(pro);
+  gd.user=u;
+  gd.totalCount=count;
+  gd.transactions=(AB_TRANSACTION **) calloc(count, sizeof(AB_TRANSACTION *));
+  assert(gd.transactions);
+  i=0;
+  transaction=AB_Transaction_List_First(transactionList);
+  while (transaction) {
+    if (AB_Transaction_GetCommand(transaction)==AB_Transaction_CommandGetTransactions)
+      gd.transactions[i++]=transaction;
+    transaction=AB_Transaction_List_Next(transaction);
+  }
+  gd.transactionCount=count;
+  qsort(gd.transactions, count, sizeof(AB_TRANSACTION *), _compareTransactionIds);
+
+  /* use details received by a previous (aborted) run */
+  fbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  if (_getCheckpointFile(pro, u, fbuf)==0)
+    gd.checkpointFile=strdup(GWEN_Buffer_GetStart(fbuf));
+  GWEN_Buffer_free(fbuf);
+  _readCheckpoint(&gd);
+
+  /* only keep transactions which still need details */
+  for (i=0, j=0; i<gd.transactionCount; i++) {
+    if (AB_Transaction_GetCommand(gd.transactions[i])==AB_Transaction_CommandGetTransactions)
+      gd.transactions[j++]=gd.transactions[i];
+  }
+  gd.transactionCount=j;
+  if (gd.transactionCount<count)
+    GWEN_Gui_ProgressLog2(0, GWEN_LoggerLevel_Notice, I18N("Details for %d transactions taken from previous run"),
+                          count-gd.transactionCount);
+
+  rv=0;
+  if (gd.transactionCount) {
+    numThreads=AB_Banking_RuntimeConfig_GetIntValue(gd.banking, "paypalDetailsThreads", APY_GETDETAILS_THREADS);
+    gd.maxRequestsPerSecond=AB_Banking_RuntimeConfig_GetIntValue(gd.banking, "paypalDetailsRequestsPerSecond",
+                                                                 APY_GETDETAILS_REQUESTS_PER_SECOND);
+    if (numThreads>gd.transactionCount)
+      numThreads=gd.transactionCount;
+    if (numThreads>1 && !AB_WorkerPool_HasThreads())
+      numThreads=1;
+
+    if (numThreads>1 && AB_Banking_BeginThreadedUse(gd.banking)<0)
+      numThreads=1;
+    rv=AB_WorkerPool_Run(gd.transactionCount, numThreads, _readDetailsJob, &gd);
+    if (numThreads>1)
+      AB_Banking_EndThreadedUse(gd.banking);
+    if (rv<0) {
+      DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
     }
   }
+
+  /* keep checkpoint only if some details are still missing */
+  if (rv<0)
+    _writeCheckpoint(&gd);
   else
-    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice, I18N("No transaction details needed"));
+    _removeCheckpoint(&gd);
+
+  GWEN_DB_Group_free(gd.dbCheckpoint);
+  free(gd.checkpointFile);
+  free(gd.transactions);
+
+  return rv;
+}
+
+
+
+int _readDetailsJob(void *userData, int idx)
+{
+  APY_GETDETAILS *gd;
+  AB_TRANSACTION *t;
+  GWEN_DB_NODE *dbResponse=NULL;
+  int aborted;
+  int num;
+  int rv;
+
+  gd=(APY_GETDETAILS *) userData;
+  t=gd->transactions[idx];
+
+  AB_Banking_Lock(gd->banking);
+  aborted=gd->aborted;
+  num=(gd->totalCount-gd->transactionCount)+(++(gd->startedCount));
+  AB_Banking_Unlock(gd->banking);
+  if (aborted)
+    return GWEN_ERROR_USER_ABORTED;
+
+  DBG_INFO(AQPAYPAL_LOGDOMAIN, "Reading details for transaction %d of %d", num, gd->totalCount);
+  GWEN_Gui_ProgressLog2(0, GWEN_LoggerLevel_Notice, I18N("Reading details for transactions %d of %d"), num, gd->totalCount);
+  rv=_requestTransactionDetails(gd, t, &dbResponse);
+  if (rv<0) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
+    if (rv==GWEN_ERROR_USER_ABORTED) {
+      AB_Banking_Lock(gd->banking);
+      gd->aborted=1;
+      AB_Banking_Unlock(gd->banking);
+    }
+    return rv;
+  }
+
+  /* the transaction is only accessed by this job */
+  _applyTransactionDetails(dbResponse, t);
+  AB_Transaction_SetCommand(t, AB_Transaction_CommandNone); /* remove mark */
+
+  AB_Banking_Lock(gd->banking);
+  _addToCheckpoint(gd, AB_Transaction_GetFiId(t), dbResponse);
+  if (gd->unsavedCount>=APY_GETDETAILS_CHECKPOINT_INTERVAL)
+    _writeCheckpoint(gd);
+  AB_Banking_Unlock(gd->banking);
+  GWEN_DB_Group_free(dbResponse);
+
+  return 0;
+}
+
+
+
+void _waitForRequestSlot(APY_GETDETAILS *gd)
+{
+  for (;;) {
+    time_t now;
+    int wait=0;
+
+    AB_Banking_Lock(gd->banking);
+    now=time(NULL);
+    if (now<gd->pausedUntil)
+      wait=(int)(gd->pausedUntil-now);
+    else if (gd->maxRequestsPerSecond>0) {
+      if (now!=gd->rateSecond) {
+        gd->rateSecond=now;
+        gd->rateCount=0;
+      }
+      if (gd->rateCount<gd->maxRequestsPerSecond)
+        gd->rateCount++;
+      else
+        wait=1;
+    }
+    AB_Banking_Unlock(gd->banking);
+
+    if (wait<1)
+      break;
+    _sleepSeconds(wait);
+  }
+}
+
+
+
+void _sleepSeconds(int secs)
+{
+#ifdef OS_WIN32
+  Sleep(secs*1000);
+#else
+  sleep(secs);
+#endif
+}
+
+
+
+int _compareTransactionIds(const void *a, const void *b)
+{
+  const char *s1;
+  const char *s2;
+
+  s1=AB_Transaction_GetFiId(*((AB_TRANSACTION *const *) a));
+  s2=AB_Transaction_GetFiId(*((AB_TRANSACTION *const *) b));
+  return strcmp(s1?s1:"", s2?s2:"");
+}
+
+
+
+AB_TRANSACTION *_findTransactionById(const APY_GETDETAILS *gd, const char *id)
+{
+  int lo=0;
+  int hi=gd->transactionCount-1;
+
+  while (lo<=hi) {
+    int mid;
+    const char *s;
+    int cmp;
+
+    mid=(lo+hi)/2;
+    s=AB_Transaction_GetFiId(gd->transactions[mid]);
+    cmp=strcmp(s?s:"", id);
+    if (cmp==0)
+      return gd->transactions[mid];
+    else if (cmp<0)
+      lo=mid+1;
+    else
+      hi=mid-1;
+  }
+
+  return NULL;
+}
+
+
+
+int _getCheckpointFile(AB_PROVIDER *pro, AB_USER *u, GWEN_BUFFER *buf)
+{
+  const char *uid;
+  int rv;
+
+  uid=AB_User_GetUserId(u);
+  if (!(uid && *uid)) {
+    DBG_ERROR(AQPAYPAL_LOGDOMAIN, "No user id");
+    return GWEN_ERROR_INVALID;
+  }
+
+  rv=AB_Provider_GetUserDataDir(pro, buf);
+  if (rv<0) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  /* make sure the data dir exists */
+  rv=GWEN_Directory_GetPath(GWEN_Buffer_GetStart(buf), 0);
+  if (rv<0) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
+  GWEN_Buffer_AppendString(buf, GWEN_DIR_SEPARATOR_S);
+  GWEN_Text_UnescapeToBufferTolerant(uid, buf);
+  GWEN_Buffer_AppendString(buf, "-details.db");
+  return 0;
+}
+
+
+
+void _readCheckpoint(APY_GETDETAILS *gd)
+{
+  GWEN_DB_NODE *dbT;
+  int rv;
+
+  gd->dbCheckpoint=GWEN_DB_Group_new("checkpoint");
+  if (gd->checkpointFile==NULL)
+    return;
+
+  rv=GWEN_DB_ReadFile(gd->dbCheckpoint, gd->checkpointFile, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (rv<0) {
+    if (rv!=GWEN_ERROR_NOT_FOUND) {
+      DBG_INFO(AQPAYPAL_LOGDOMAIN, "Could not read checkpoint file [%s] (%d), ignoring", gd->checkpointFile, rv);
+    }
+    GWEN_DB_ClearGroup(gd->dbCheckpoint, NULL);
+    return;
+  }
+
+  /* details might have changed since then */
+  if (difftime(time(NULL), (time_t) GWEN_DB_GetIntValue(gd->dbCheckpoint, "created", 0, 0))>
+      APY_GETDETAILS_CHECKPOINT_MAXAGE) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "Checkpoint file [%s] too old, ignoring", gd->checkpointFile);
+    GWEN_DB_ClearGroup(gd->dbCheckpoint, NULL);
+    return;
+  }
+
+  dbT=GWEN_DB_FindFirstGroup(gd->dbCheckpoint, "details");
+  while (dbT) {
+    const char *id;
+    GWEN_DB_NODE *dbResponse;
+
+    id=GWEN_DB_GetCharValue(dbT, "transactionId", 0, NULL);
+    dbResponse=GWEN_DB_GetGroup(dbT, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "response");
+    if (id && *id && dbResponse) {
+      AB_TRANSACTION *t;
+
+      t=_findTransactionById(gd, id);
+      if (t && AB_Transaction_GetCommand(t)==AB_Transaction_CommandGetTransactions) {
+        _applyTransactionDetails(dbResponse, t);
+        AB_Transaction_SetCommand(t, AB_Transaction_CommandNone); /* remove mark */
+      }
+    }
+    dbT=GWEN_DB_FindNextGroup(dbT, "details");
+  }
+}
+
+
+
+/* only the variables used by _applyTransactionDetails() are kept, the full response contains much more personal data
+ * (like names and email addresses) which must not be written to disc */
+void _addToCheckpoint(APY_GETDETAILS *gd, const char *id, GWEN_DB_NODE *dbResponse)
+{
+  GWEN_DB_NODE *dbT;
+
+  dbT=GWEN_DB_GetGroup(gd->dbCheckpoint, GWEN_PATH_FLAGS_CREATE_GROUP, "details");
+  GWEN_DB_SetCharValue(dbT, GWEN_DB_FLAGS_OVERWRITE_VARS, "transactionId", id);
+  GWEN_DB_AddGroup(dbT, _extractTransactionDetails(dbResponse));
+  gd->unsavedCount++;
+}
+
+
+
+GWEN_DB_NODE *_extractTransactionDetails(GWEN_DB_NODE *dbResponse)
+{
+  static const char *responseVars[]= {
+    "TRANSACTIONTYPE", "SHIPTOSTREET", "SHIPTOCITY", "SHIPTOZIP", "PAYMENTSTATUS", "BUYERID", "NOTE", NULL
+  };
+  static const char *itemVars[]= {
+    "L_QTY", "L_NAME", "L_NUMBER", "L_AMT", "L_CURRENCYCODE", NULL
+  };
+  GWEN_DB_NODE *dbDetails;
+  GWEN_DB_NODE *dbT;
+  int i;
+
+  dbDetails=GWEN_DB_Group_new("response");
+  for (i=0; responseVars[i]; i++) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(dbResponse, responseVars[i], 0, NULL);
+    if (s && *s)
+      GWEN_DB_SetCharValue(dbDetails, GWEN_DB_FLAGS_OVERWRITE_VARS, responseVars[i], s);
+  }
+
+  /* purpose lines */
+  dbT=GWEN_DB_GetFirstGroup(dbResponse);
+  while (dbT) {
+    GWEN_DB_NODE *dbItem;
 
-  return lastError;
+    dbItem=GWEN_DB_GetGroup(dbDetails, GWEN_PATH_FLAGS_CREATE_GROUP, "item");
+    for (i=0; itemVars[i]; i++) {
+      const char *s;
+
+      s=GWEN_DB_GetCharValue(dbT, itemVars[i], 0, NULL);
+      if (s && *s)
+        GWEN_DB_SetCharValue(dbItem, GWEN_DB_FLAGS_OVERWRITE_VARS, itemVars[i], s);
+    }
+    dbT=GWEN_DB_GetNextGroup(dbT);
+  }
+
+  return dbDetails;
+}
+
+
+
+void _writeCheckpoint(APY_GETDETAILS *gd)
+{
+  if (gd->checkpointFile && gd->unsavedCount) {
+    int rv;
+
+    if (GWEN_DB_GetIntValue(gd->dbCheckpoint, "created", 0, 0)==0)
+      GWEN_DB_SetIntValue(gd->dbCheckpoint, GWEN_DB_FLAGS_OVERWRITE_VARS, "created", (int) time(NULL));
+    rv=GWEN_DB_WriteFile(gd->dbCheckpoint, gd->checkpointFile, GWEN_DB_FLAGS_DEFAULT);
+    if (rv<0) {
+      DBG_WARN(AQPAYPAL_LOGDOMAIN, "Could not write checkpoint file [%s] (%d)", gd->checkpointFile, rv);
+    }
+    gd->unsavedCount=0;
+  }
+}
+
+
+
+void _removeCheckpoint(APY_GETDETAILS *gd)
+{
+  if (gd->checkpointFile) {
+    if (remove(gd->checkpointFile) && errno!=ENOENT) {
+      DBG_INFO(AQPAYPAL_LOGDOMAIN, "Could not remove checkpoint file [%s]: %s", gd->checkpointFile, strerror(errno));
+    }
+  }
 }
 
 
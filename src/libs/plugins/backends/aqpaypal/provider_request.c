@@ -15,6 +15,7 @@
 #include "aqpaypal/user_l.h"
 
 #include <aqbanking/backendsupport/httpsession.h>
+#include <aqbanking/banking_be.h>
 
 #include <gwenhywfar/debug.h>
 
@@ -23,9 +24,10 @@
 
 
 
-static GWEN_HTTP_SESSION *_setupHttpSession(AB_PROVIDER *pro, AB_USER *u);
-static void _logToFile(const char *fileName, const char *direction, const char *jobName, const char *ptr, uint32_t len);
-static GWEN_DB_NODE *_parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData);
+static void _logToFile(AB_PROVIDER *pro, const char *fileName, const char *direction, const char *jobName,
+                       const char *ptr, uint32_t len);
+static int _parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData, GWEN_DB_NODE **pDbResponse);
+static int _isTemporaryError(GWEN_DB_NODE *dbResponse);
 static int _parseResponse(AB_PROVIDER *pro, const char *s, GWEN_DB_NODE *db);
 
 
@@ -35,64 +37,72 @@ static int _parseResponse(AB_PROVIDER *pro, const char *s, GWEN_DB_NODE *db);
 GWEN_DB_NODE *APY_Provider_SendRequestParseResponse(AB_PROVIDER *pro, AB_USER *u, const char *requestString,
                                                     const char *jobName)
 {
-  GWEN_HTTP_SESSION *sess;
-  GWEN_BUFFER *tbuf;
+  GWEN_DB_NODE *dbResponse=NULL;
   int rv;
-  GWEN_DB_NODE *dbResponse;
-
-  sess=_setupHttpSession(pro, u);
-  if (sess==NULL) {
-    DBG_ERROR(AQPAYPAL_LOGDOMAIN, "Could not create http session for user [%s]", AB_User_GetUserId(u));
-    return NULL;
-  }
 
-  /* init session */
-  rv=GWEN_HttpSession_Init(sess);
+  rv=APY_Provider_SendRequest(pro, u, requestString, jobName, &dbResponse);
   if (rv<0) {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
-    GWEN_HttpSession_free(sess);
     return NULL;
   }
 
+  return dbResponse;
+}
+
+
+
+int APY_Provider_SendRequest(AB_PROVIDER *pro, AB_USER *u, const char *requestString, const char *jobName,
+                             GWEN_DB_NODE **pDbResponse)
+{
+  GWEN_DB_NODE *dbHeader;
+  GWEN_BUFFER *tbuf;
+  int vmajor;
+  int vminor;
+  int rv;
+
   if (getenv("AQPAYPAL_LOG_COMM"))
-    _logToFile("paypal.log", "Sending", jobName, requestString, strlen(requestString));
+    _logToFile(pro, "paypal.log", "Sending", jobName, requestString, strlen(requestString));
 
-  /* send request */
-  rv=GWEN_HttpSession_SendPacket(sess, "POST", (const uint8_t *) requestString, strlen(requestString));
-  if (rv<0) {
-    DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
-    GWEN_HttpSession_Fini(sess);
-    GWEN_HttpSession_free(sess);
-    return NULL;
+  vmajor=APY_User_GetHttpVMajor(u);
+  vminor=APY_User_GetHttpVMinor(u);
+  if (vmajor==0 && vminor==0) {
+    vmajor=1;
+    vminor=0;
   }
 
-  /* get response */
+  /* send request and get response (using a kept-alive connection if possible) */
+  dbHeader=GWEN_DB_Group_new("header");
+  GWEN_DB_SetCharValue(dbHeader, GWEN_DB_FLAGS_OVERWRITE_VARS, "Content-type", "application/x-www-form-urlencoded");
   tbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  rv=GWEN_HttpSession_RecvPacket(sess, tbuf);
-  if (rv<0 || rv<200 || rv>299) {
+  rv=AB_HttpSession_SendPooledRequest(pro, u, APY_User_GetServerUrl(u), "https", 443, vmajor, vminor, "POST",
+                                      dbHeader,
+                                      (const uint8_t *) requestString, strlen(requestString),
+                                      tbuf);
+  GWEN_DB_Group_free(dbHeader);
+  if (rv<0) {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
-    GWEN_HttpSession_Fini(sess);
     GWEN_Buffer_free(tbuf);
-    GWEN_HttpSession_free(sess);
-    return NULL;
+    return rv;
+  }
+  else if (rv<200 || rv>299) {
+    DBG_INFO(AQPAYPAL_LOGDOMAIN, "HTTP error %d", rv);
+    GWEN_Buffer_free(tbuf);
+    /* too many requests or service temporarily unavailable */
+    return (rv==429 || rv==503)?GWEN_ERROR_TRY_AGAIN:GWEN_ERROR_GENERIC;
   }
 
   if (getenv("AQPAYPAL_LOG_COMM"))
-    _logToFile("paypal.log", "Received", jobName, GWEN_Buffer_GetStart(tbuf), GWEN_Buffer_GetUsedBytes(tbuf));
-
-  /* deinit (ignore result because it isn't important) */
-  GWEN_HttpSession_Fini(sess);
-  GWEN_HttpSession_free(sess);
+    _logToFile(pro, "paypal.log", "Received", jobName, GWEN_Buffer_GetStart(tbuf), GWEN_Buffer_GetUsedBytes(tbuf));
 
   /* parse response */
-  dbResponse=_parseAndCheckResponse(pro, GWEN_Buffer_GetStart(tbuf));
-  if (dbResponse==NULL) {
+  rv=_parseAndCheckResponse(pro, GWEN_Buffer_GetStart(tbuf), pDbResponse);
+  GWEN_Buffer_free(tbuf);
+  if (rv<0) {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
-    GWEN_Buffer_free(tbuf);
-    return NULL;
+    return rv;
   }
 
-  return dbResponse;
+  return 0;
 }
 
 
@@ -134,37 +144,15 @@ int APY_Provider_SetupUrlString(AB_PROVIDER *pro, AB_USER *u, GWEN_BUFFER *tbuf)
 
 
 
-GWEN_HTTP_SESSION *_setupHttpSession(AB_PROVIDER *pro, AB_USER *u)
-{
-  GWEN_HTTP_SESSION *sess;
-  int vmajor;
-  int vminor;
-
-  sess=AB_HttpSession_new(pro, u, APY_User_GetServerUrl(u), "https", 443);
-  if (sess==NULL) {
-    DBG_ERROR(AQPAYPAL_LOGDOMAIN, "Could not create http session for user [%s]", AB_User_GetUserId(u));
-    return NULL;
-  }
-
-  vmajor=APY_User_GetHttpVMajor(u);
-  vminor=APY_User_GetHttpVMinor(u);
-  if (vmajor==0 && vminor==0) {
-    vmajor=1;
-    vminor=0;
-  }
-  GWEN_HttpSession_SetHttpVMajor(sess, vmajor);
-  GWEN_HttpSession_SetHttpVMinor(sess, vminor);
-  GWEN_HttpSession_SetHttpContentType(sess, "application/x-www-form-urlencoded");
-
-  return sess;
-}
-
-
-
-void _logToFile(const char *fileName, const char *direction, const char *jobName, const char *ptr, uint32_t len)
+/* details requests might run in parallel, so entries are written under the banking lock to keep them intact */
+void _logToFile(AB_PROVIDER *pro, const char *fileName, const char *direction, const char *jobName,
+                const char *ptr, uint32_t len)
 {
+  AB_BANKING *ab;
   FILE *f;
 
+  ab=AB_Provider_GetBanking(pro);
+  AB_Banking_Lock(ab);
   f=fopen(fileName, "a+");
   if (f) {
     fprintf(f, "\n============================================\n");
@@ -187,11 +175,12 @@ void _logToFile(const char *fileName, const char *direction, const char *jobName
       }
     }
   }
+  AB_Banking_Unlock(ab);
 }
 
 
 
-GWEN_DB_NODE *_parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData)
+int _parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData, GWEN_DB_NODE **pDbResponse)
 {
   GWEN_DB_NODE *dbResponse;
   int rv;
@@ -203,17 +192,21 @@ GWEN_DB_NODE *_parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData)
 #if 1
   if (getenv("AQPAYPAL_LOG_COMM")) {
     static int debugCounter=0;
+    AB_BANKING *ab;
     char namebuf[64];
 
+    ab=AB_Provider_GetBanking(pro);
+    AB_Banking_Lock(ab);
     snprintf(namebuf, sizeof(namebuf)-1, "paypal-%02x.db", debugCounter++);
     GWEN_DB_WriteFile(dbResponse, namebuf, GWEN_DB_FLAGS_DEFAULT);
+    AB_Banking_Unlock(ab);
   }
 #endif
 
   if (rv<0) {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "here (%d)", rv);
     GWEN_DB_Group_free(dbResponse);
-    return NULL;
+    return rv;
   }
 
   /* check result */
@@ -225,17 +218,43 @@ GWEN_DB_NODE *_parseAndCheckResponse(AB_PROVIDER *pro, const char *recvdData)
     }
     else {
       DBG_INFO(AQPAYPAL_LOGDOMAIN, "No positive response from server");
+      rv=_isTemporaryError(dbResponse)?GWEN_ERROR_TRY_AGAIN:GWEN_ERROR_GENERIC;
       GWEN_DB_Group_free(dbResponse);
-      return NULL;
+      return rv;
     }
   }
   else {
     DBG_INFO(AQPAYPAL_LOGDOMAIN, "No ACK response from server");
     GWEN_DB_Group_free(dbResponse);
-    return NULL;
+    return GWEN_ERROR_BAD_DATA;
   }
 
-  return dbResponse;
+  *pDbResponse=dbResponse;
+  return 0;
+}
+
+
+
+/* errors which might go away when the request is repeated later (see PayPal NVP error codes) */
+int _isTemporaryError(GWEN_DB_NODE *dbResponse)
+{
+  int i;
+
+  /* error codes are stored as L_ERRORCODE0, L_ERRORCODE1 etc (see _parseResponse) */
+  for (i=0; i<10; i++) {
+    char varName[32];
+    const char *s;
+
+    snprintf(varName, sizeof(varName)-1, "L_ERRORCODE%d", i);
+    s=GWEN_DB_GetCharValue(dbResponse, varName, 0, NULL);
+    if (!(s && *s))
+      break;
+    if (strcmp(s, "10001")==0 ||   /* internal error */
+        strcmp(s, "10101")==0)     /* API temporarily unavailable */
+      return 1;
+  }
+
+  return 0;
 }
 
 
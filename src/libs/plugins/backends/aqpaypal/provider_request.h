@@ -20,6 +20,14 @@
 
 GWEN_DB_NODE *APY_Provider_SendRequestParseResponse(AB_PROVIDER *pro, AB_USER *u, const char *requestString, const char *jobName);
 
+/**
+ * Send a request and parse the response.
+ * @return 0 if ok, GWEN_ERROR_TRY_AGAIN if the server reported a temporary problem (e.g. too many requests),
+ *         error code otherwise
+ */
+int APY_Provider_SendRequest(AB_PROVIDER *pro, AB_USER *u, const char *requestString, const char *jobName,
+                             GWEN_DB_NODE **pDbResponse);
+
 int APY_Provider_SetupUrlString(AB_PROVIDER *pro, AB_USER *u, GWEN_BUFFER *tbuf);
 
 
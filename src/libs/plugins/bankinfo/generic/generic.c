@@ -22,6 +22,14 @@
 #include <gwenhywfar/syncio_file.h>
 
 #include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
 
 #ifdef OS_WIN32
 # define DIRSEP "\\"
@@ -30,6 +38,7 @@
 #endif
 
 
+
 GWEN_INHERIT(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC)
 
 
@@ -48,6 +57,7 @@ AB_BANKINFO_PLUGIN *AB_BankInfoPluginGENERIC_new(AB_BANKING *ab,
 
   bde->banking=ab;
   bde->country=strdup(country);
+  bde->mutex=AB_Mutex_new();
   AB_BankInfoPlugin_SetGetBankInfoFn(bip, AB_BankInfoPluginGENERIC_GetBankInfo);
   AB_BankInfoPlugin_SetGetBankInfoByTemplateFn(bip,
                                                AB_BankInfoPluginGENERIC_SearchbyTemplate);
@@ -60,11 +70,19 @@ AB_BANKINFO_PLUGIN *AB_BankInfoPluginGENERIC_new(AB_BANKING *ab,
 void GWENHYWFAR_CB AB_BankInfoPluginGENERIC_FreeData(void *bp, void *p)
 {
   AB_BANKINFO_PLUGIN_GENERIC *bde;
+  int i;
 
   bde=(AB_BANKINFO_PLUGIN_GENERIC *)p;
+  for (i=0; i<AB_BANKINFO_GENERIC_CACHE_SIZE; i++)
+    AB_BankInfo_free(bde->cache[i].bankInfo);
+  AB_BankInfoGenericIndex_free(bde->blzIndex);
+  AB_BankInfoGenericIndex_free(bde->bicIndex);
+  AB_BankInfoGenericIndex_free(bde->namLocIndex);
+  AB_BankInfoGenericFileData_free(bde->bankData);
   free(bde->country);
   if (bde->dataDir)
     free(bde->dataDir);
+  AB_Mutex_free(bde->mutex);
 
   GWEN_FREE_OBJECT(bde);
 }
@@ -84,6 +102,7 @@ void AB_BankInfoPluginGENERIC__GetDataDir(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  AB_Mutex_Lock(bde->mutex);
   if (bde->dataDir) {
     gotit=1;
     GWEN_Buffer_AppendString(pbuf, bde->dataDir);
@@ -131,6 +150,7 @@ void AB_BankInfoPluginGENERIC__GetDataDir(AB_BANKINFO_PLUGIN *bip,
       GWEN_StringList_free(sl);
     }
   }
+  AB_Mutex_Unlock(bde->mutex);
   if (gotit==0) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "No folder found for country \"%s\"", (bde->country)?(bde->country):"<no country>");
   }
@@ -141,27 +161,118 @@ void AB_BankInfoPluginGENERIC__GetDataDir(AB_BANKINFO_PLUGIN *bip,
 
 AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
                                                     const char *num)
+{
+  uint32_t pos;
+
+  /* get position */
+  assert(strlen(num)==8);
+  if (1!=sscanf(num, "%08x", &pos)) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid index");
+    return 0;
+  }
+
+  return AB_BankInfoPluginGENERIC__ReadBankInfoAtPos(bip, pos);
+}
+
+
+
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoAtPos(AB_BANKINFO_PLUGIN *bip, uint32_t pos)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  AB_BANKINFO_GENERIC_CACHEENTRY *ce;
+  AB_BANKINFO *bi;
+  int i;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  AB_Mutex_Lock(bde->mutex);
+
+  /* lookup cache, remember least recently used entry */
+  ce=&(bde->cache[0]);
+  for (i=0; i<AB_BANKINFO_GENERIC_CACHE_SIZE; i++) {
+    AB_BANKINFO_GENERIC_CACHEENTRY *e;
+
+    e=&(bde->cache[i]);
+    if (e->bankInfo && e->pos==pos) {
+      e->lastUsed=++(bde->cacheCounter);
+      bi=AB_BankInfo_dup(e->bankInfo);
+      AB_Mutex_Unlock(bde->mutex);
+      return bi;
+    }
+    if (ce->bankInfo && (e->bankInfo==NULL || e->lastUsed<ce->lastUsed))
+      ce=e;
+  }
+
+  AB_BankInfoPluginGENERIC__LoadIndexes(bip);
+  if (bde->bankData)
+    bi=AB_BankInfoPluginGENERIC__ReadBankInfoFromMemory(bip, pos);
+  else
+    bi=AB_BankInfoPluginGENERIC__ReadBankInfoFromFile(bip, pos);
+  if (bi) {
+    /* replace least recently used cache entry */
+    AB_BankInfo_free(ce->bankInfo);
+    ce->bankInfo=AB_BankInfo_dup(bi);
+    ce->pos=pos;
+    ce->lastUsed=++(bde->cacheCounter);
+  }
+
+  AB_Mutex_Unlock(bde->mutex);
+  return bi;
+}
+
+
+
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoFromMemory(AB_BANKINFO_PLUGIN *bip, uint32_t pos)
 {
   AB_BANKINFO_PLUGIN_GENERIC *bde;
-  GWEN_BUFFER *pbuf;
   AB_BANKINFO *bi;
   GWEN_DB_NODE *dbT;
-  GWEN_SYNCIO *sio;
-  uint32_t pos;
   int rv;
 
   assert(bip);
   bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
                            bip);
   assert(bde);
+  assert(bde->bankData);
 
-  /* get position */
-  assert(strlen(num)==8);
-  if (1!=sscanf(num, "%08x", &pos)) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid index");
-    return 0;
+  if (pos>=bde->bankData->size) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid position %u (data size %u)", pos, bde->bankData->size);
+    return NULL;
+  }
+
+  dbT=GWEN_DB_Group_new("bank");
+  rv=GWEN_DB_ReadFromString(dbT,
+                            (const char *)(bde->bankData->ptr+pos),
+                            bde->bankData->size-pos,
+                            GWEN_DB_FLAGS_DEFAULT |
+                            GWEN_PATH_FLAGS_CREATE_GROUP|
+                            GWEN_DB_FLAGS_UNTIL_EMPTY_LINE);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not read bank info at %u (%d)", pos, rv);
+    GWEN_DB_Group_free(dbT);
+    return NULL;
   }
 
+  bi=AB_BankInfo_fromDb(dbT);
+  assert(bi);
+  GWEN_DB_Group_free(dbT);
+
+  return bi;
+}
+
+
+
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoFromFile(AB_BANKINFO_PLUGIN *bip, uint32_t pos)
+{
+  GWEN_BUFFER *pbuf;
+  AB_BANKINFO *bi;
+  GWEN_DB_NODE *dbT;
+  GWEN_SYNCIO *sio;
+  int rv;
+
   /* get path */
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
@@ -187,6 +298,7 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfo(AB_BANKINFO_PLUGIN *bip,
               strerror(errno));
     GWEN_SyncIo_Disconnect(sio);
     GWEN_SyncIo_free(sio);
+    GWEN_Buffer_free(pbuf);
     return NULL;
   }
 
@@ -237,6 +349,21 @@ AB_BANKINFO *AB_BankInfoPluginGENERIC__SearchbyCode(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  AB_BankInfoPluginGENERIC__LoadIndexes(bip);
+  if (bde->blzIndex) {
+    AB_BANKINFO_LIST2 *bl;
+    AB_BANKINFO *bi=NULL;
+
+    bl=AB_BankInfo_List2_new();
+    if (AB_BankInfoPluginGENERIC__AddFromIndex(bip, bde->blzIndex, bankId, NULL, 1, 1, bl)>0)
+      bi=AB_BankInfo_List2_GetFront(bl);
+    AB_BankInfo_List2_free(bl);
+    if (bi==NULL) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", bankId);
+    }
+    return bi;
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "blz.idx");
@@ -302,6 +429,16 @@ int AB_BankInfoPluginGENERIC__AddById(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  AB_BankInfoPluginGENERIC__LoadIndexes(bip);
+  if (bde->blzIndex) {
+    count=AB_BankInfoPluginGENERIC__AddFromIndex(bip, bde->blzIndex, bankId, NULL, 0, 0, bl);
+    if (!count) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", bankId);
+      return GWEN_ERROR_NOT_FOUND;
+    }
+    return 0;
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "blz.idx");
@@ -371,6 +508,16 @@ int AB_BankInfoPluginGENERIC__AddByBic(AB_BANKINFO_PLUGIN *bip,
                            bip);
   assert(bde);
 
+  AB_BankInfoPluginGENERIC__LoadIndexes(bip);
+  if (bde->bicIndex) {
+    count=AB_BankInfoPluginGENERIC__AddFromIndex(bip, bde->bicIndex, bic, NULL, 0, 0, bl);
+    if (!count) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s not found", bic);
+      return GWEN_ERROR_NOT_FOUND;
+    }
+    return 0;
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "bic.idx");
@@ -445,6 +592,16 @@ int AB_BankInfoPluginGENERIC__AddByNameAndLoc(AB_BANKINFO_PLUGIN *bip,
   if (loc==0)
     loc="*";
 
+  AB_BankInfoPluginGENERIC__LoadIndexes(bip);
+  if (bde->namLocIndex) {
+    count=AB_BankInfoPluginGENERIC__AddFromIndex(bip, bde->namLocIndex, name, loc, 0, 0, bl);
+    if (!count) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Bank %s/%s not found", name, loc);
+      return GWEN_ERROR_NOT_FOUND;
+    }
+    return 0;
+  }
+
   pbuf=GWEN_Buffer_new(0, 256, 0, 1);
   AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
   GWEN_Buffer_AppendString(pbuf, DIRSEP "namloc.idx");
@@ -802,3 +959,495 @@ int AB_BankInfoPluginGENERIC_SearchbyTemplate(AB_BANKINFO_PLUGIN *bip,
 
 
 
+
+
+
+void AB_BankInfoPluginGENERIC__LoadIndexes(AB_BANKINFO_PLUGIN *bip)
+{
+  AB_BANKINFO_PLUGIN_GENERIC *bde;
+  GWEN_BUFFER *pbuf;
+
+  assert(bip);
+  bde=GWEN_INHERIT_GETDATA(AB_BANKINFO_PLUGIN, AB_BANKINFO_PLUGIN_GENERIC,
+                           bip);
+  assert(bde);
+
+  /* indexes are never changed once loaded, so callers may use them without holding the lock */
+  AB_Mutex_Lock(bde->mutex);
+  if (bde->indexesLoaded) {
+    AB_Mutex_Unlock(bde->mutex);
+    return;
+  }
+
+  bde->blzIndex=AB_BankInfoPluginGENERIC__LoadIndex(bip, "blz", 1);
+  bde->bicIndex=AB_BankInfoPluginGENERIC__LoadIndex(bip, "bic", 1);
+  bde->namLocIndex=AB_BankInfoPluginGENERIC__LoadIndex(bip, "namloc", 2);
+
+  pbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
+  GWEN_Buffer_AppendString(pbuf, DIRSEP "banks.data");
+  bde->bankData=AB_BankInfoGenericFileData_fromFile(GWEN_Buffer_GetStart(pbuf));
+  if (bde->bankData==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not map \"%s\", reading records from file", GWEN_Buffer_GetStart(pbuf));
+  }
+  GWEN_Buffer_free(pbuf);
+
+  bde->indexesLoaded=1;
+  AB_Mutex_Unlock(bde->mutex);
+}
+
+
+
+AB_BANKINFO_GENERIC_INDEX *AB_BankInfoPluginGENERIC__LoadIndex(AB_BANKINFO_PLUGIN *bip,
+                                                              const char *baseName,
+                                                              int numKeys)
+{
+  AB_BANKINFO_GENERIC_INDEX *idx=NULL;
+  AB_BANKINFO_GENERIC_FILEDATA *fd;
+  GWEN_BUFFER *pbuf;
+  uint32_t dirPos;
+  uint32_t pos;
+  int64_t dataTime;
+  int64_t textTime;
+  int64_t binTime;
+
+  pbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  AB_BankInfoPluginGENERIC__GetDataDir(bip, pbuf);
+  dirPos=GWEN_Buffer_GetPos(pbuf);
+  GWEN_Buffer_AppendString(pbuf, DIRSEP "banks.data");
+  dataTime=AB_BankInfoPluginGENERIC__GetFileTime(GWEN_Buffer_GetStart(pbuf));
+  GWEN_Buffer_Crop(pbuf, 0, dirPos);
+  GWEN_Buffer_AppendString(pbuf, DIRSEP);
+  GWEN_Buffer_AppendString(pbuf, baseName);
+  pos=GWEN_Buffer_GetPos(pbuf);
+  GWEN_Buffer_AppendString(pbuf, ".idx");
+  textTime=AB_BankInfoPluginGENERIC__GetFileTime(GWEN_Buffer_GetStart(pbuf));
+  GWEN_Buffer_Crop(pbuf, 0, pos);
+
+  /* try binary index first, unless it is older than the files it was created from */
+  GWEN_Buffer_AppendString(pbuf, ".bidx");
+  binTime=AB_BankInfoPluginGENERIC__GetFileTime(GWEN_Buffer_GetStart(pbuf));
+  if (binTime!=-1 && (binTime<dataTime || binTime<textTime)) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Binary index file \"%s\" is outdated, ignoring (run \"mkdeinfo mkbidx\")",
+             GWEN_Buffer_GetStart(pbuf));
+    fd=NULL;
+  }
+  else
+    fd=AB_BankInfoGenericFileData_fromFile(GWEN_Buffer_GetStart(pbuf));
+  if (fd) {
+    idx=AB_BankInfoGenericIndex_fromFileData(fd);
+    if (idx==NULL) {
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Invalid binary index file \"%s\", ignoring", GWEN_Buffer_GetStart(pbuf));
+      AB_BankInfoGenericFileData_free(fd);
+    }
+  }
+
+  /* fall back to text index */
+  if (idx==NULL) {
+    GWEN_Buffer_Crop(pbuf, 0, pos);
+    GWEN_Buffer_AppendString(pbuf, ".idx");
+    idx=AB_BankInfoGenericIndex_fromTextFile(GWEN_Buffer_GetStart(pbuf), numKeys);
+    if (idx==NULL) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "No usable index \"%s\"", GWEN_Buffer_GetStart(pbuf));
+    }
+  }
+  GWEN_Buffer_free(pbuf);
+
+  return idx;
+}
+
+
+
+int64_t AB_BankInfoPluginGENERIC__GetFileTime(const char *fname)
+{
+  struct stat st;
+
+  if (stat(fname, &st)<0)
+    return -1;
+  return (int64_t) st.st_mtime;
+}
+
+
+
+int AB_BankInfoPluginGENERIC__AddFromIndex(AB_BANKINFO_PLUGIN *bip,
+                                           const AB_BANKINFO_GENERIC_INDEX *idx,
+                                           const char *pattern1,
+                                           const char *pattern2,
+                                           int exact,
+                                           uint32_t maxCount,
+                                           AB_BANKINFO_LIST2 *bl)
+{
+  uint32_t prefixLen;
+  uint32_t i;
+  int count=0;
+
+  assert(idx);
+
+  if (pattern1==NULL)
+    pattern1="*";
+
+  /* only records starting with the constant part of the pattern can match */
+  if (exact)
+    prefixLen=strlen(pattern1);
+  else
+    prefixLen=strcspn(pattern1, "*?");
+
+  i=AB_BankInfoGenericIndex_FindFirst(idx, pattern1, prefixLen);
+  for (; i<idx->recordCount; i++) {
+    const uint8_t *rec;
+    const char *key1;
+    int matches;
+
+    rec=idx->records+(i*idx->recordSize);
+    key1=(const char *) rec;
+    if (AB_BankInfoGenericIndex_ComparePrefix(key1, pattern1, prefixLen)!=0)
+      break;
+
+    if (exact)
+      matches=(strcasecmp(key1, pattern1)==0);
+    else
+      matches=(GWEN_Text_ComparePattern(key1, pattern1, 0)!=-1);
+    if (matches && pattern2 && idx->keySize2)
+      matches=(GWEN_Text_ComparePattern((const char *)(rec+idx->keySize1), pattern2, 0)!=-1);
+
+    if (matches) {
+      const uint8_t *p;
+      uint32_t pos;
+      AB_BANKINFO *bi;
+
+      p=rec+idx->keySize1+idx->keySize2;
+      pos=(((uint32_t)p[0])<<24) | (((uint32_t)p[1])<<16) | (((uint32_t)p[2])<<8) | ((uint32_t)p[3]);
+      bi=AB_BankInfoPluginGENERIC__ReadBankInfoAtPos(bip, pos);
+      if (bi) {
+        AB_BankInfo_List2_PushBack(bl, bi);
+        count++;
+        if (maxCount && ((uint32_t) count)>=maxCount)
+          break;
+      }
+    }
+  }
+
+  return count;
+}
+
+
+
+AB_BANKINFO_GENERIC_FILEDATA *AB_BankInfoGenericFileData_fromFile(const char *fname)
+{
+  AB_BANKINFO_GENERIC_FILEDATA *fd;
+#ifdef HAVE_SYS_MMAN_H
+  struct stat st;
+  void *ptr;
+  int fh;
+
+  fh=open(fname, O_RDONLY);
+  if (fh<0) {
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "open(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+  if (fstat(fh, &st)<0 || st.st_size<1 || ((uint64_t) st.st_size)>0xffffffffULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unusable file \"%s\"", fname);
+    close(fh);
+    return NULL;
+  }
+  ptr=mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fh, 0);
+  close(fh);
+  if (ptr==MAP_FAILED) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "mmap(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_GENERIC_FILEDATA, fd);
+  fd->ptr=(uint8_t *) ptr;
+  fd->size=(uint32_t) st.st_size;
+  fd->isMapped=1;
+#else
+  FILE *f;
+  long size;
+
+  f=fopen(fname, "rb");
+  if (!f) {
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "fopen(%s): %s", fname, strerror(errno));
+    return NULL;
+  }
+  if (fseek(f, 0, SEEK_END) || (size=ftell(f))<1 || fseek(f, 0, SEEK_SET)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unusable file \"%s\"", fname);
+    fclose(f);
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_GENERIC_FILEDATA, fd);
+  fd->ptr=(uint8_t *) malloc(size);
+  assert(fd->ptr);
+  fd->size=(uint32_t) size;
+  if (fread(fd->ptr, size, 1, f)!=1) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "fread(%s): %s", fname, strerror(errno));
+    fclose(f);
+    AB_BankInfoGenericFileData_free(fd);
+    return NULL;
+  }
+  fclose(f);
+#endif
+
+  return fd;
+}
+
+
+
+void AB_BankInfoGenericFileData_free(AB_BANKINFO_GENERIC_FILEDATA *fd)
+{
+  if (fd) {
+#ifdef HAVE_SYS_MMAN_H
+    if (fd->isMapped)
+      munmap(fd->ptr, fd->size);
+    else
+      free(fd->ptr);
+#else
+    free(fd->ptr);
+#endif
+    GWEN_FREE_OBJECT(fd);
+  }
+}
+
+
+
+AB_BANKINFO_GENERIC_INDEX *AB_BankInfoGenericIndex_fromFileData(AB_BANKINFO_GENERIC_FILEDATA *fd)
+{
+  AB_BANKINFO_GENERIC_INDEX *idx;
+  const uint8_t *p;
+  uint32_t recordCount;
+  uint32_t keySize1;
+  uint32_t keySize2;
+  uint32_t recordSize;
+  uint32_t i;
+
+  if (fd->size<AB_BANKINFO_GENERIC_BIDX_HEADERSIZE ||
+      memcmp(fd->ptr, AB_BANKINFO_GENERIC_BIDX_MAGIC, AB_BANKINFO_GENERIC_BIDX_MAGICSIZE)!=0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad header in binary index");
+    return NULL;
+  }
+
+  p=fd->ptr+AB_BANKINFO_GENERIC_BIDX_MAGICSIZE;
+  recordCount=(((uint32_t)p[0])<<24) | (((uint32_t)p[1])<<16) | (((uint32_t)p[2])<<8) | ((uint32_t)p[3]);
+  keySize1=(((uint32_t)p[4])<<8) | ((uint32_t)p[5]);
+  keySize2=(((uint32_t)p[6])<<8) | ((uint32_t)p[7]);
+  recordSize=keySize1+keySize2+4;
+  if (keySize1<1 ||
+      ((uint64_t) recordCount)*recordSize!=(uint64_t)(fd->size-AB_BANKINFO_GENERIC_BIDX_HEADERSIZE)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Bad size of binary index");
+    return NULL;
+  }
+
+  /* make sure all keys are zero-terminated */
+  p=fd->ptr+AB_BANKINFO_GENERIC_BIDX_HEADERSIZE;
+  for (i=0; i<recordCount; i++, p+=recordSize) {
+    if (p[keySize1-1]!=0 || (keySize2 && p[keySize1+keySize2-1]!=0)) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Unterminated key in record %u of binary index", i);
+      return NULL;
+    }
+  }
+
+  GWEN_NEW_OBJECT(AB_BANKINFO_GENERIC_INDEX, idx);
+  idx->fileData=fd;
+  idx->records=fd->ptr+AB_BANKINFO_GENERIC_BIDX_HEADERSIZE;
+  idx->recordCount=recordCount;
+  idx->keySize1=keySize1;
+  idx->keySize2=keySize2;
+  idx->recordSize=recordSize;
+
+  return idx;
+}
+
+
+
+AB_BANKINFO_GENERIC_INDEX *AB_BankInfoGenericIndex_fromTextFile(const char *fname, int numKeys)
+{
+  AB_BANKINFO_GENERIC_FILEDATA *fdText;
+  AB_BANKINFO_GENERIC_FILEDATA *fd;
+  AB_BANKINFO_GENERIC_INDEXENTRY *entries;
+  AB_BANKINFO_GENERIC_INDEX *idx;
+  uint32_t entryCount=0;
+  uint32_t maxEntries=0;
+  uint32_t keySize1=1;
+  uint32_t keySize2=0;
+  uint32_t recordSize;
+  uint8_t *p;
+  char *s;
+  char *sPos;
+  char *end;
+  uint32_t i;
+
+  fdText=AB_BankInfoGenericFileData_fromFile(fname);
+  if (fdText==NULL)
+    return NULL;
+
+  /* lines are parsed in place, so we need a writable copy with a trailing zero */
+  s=(char *) malloc(fdText->size+1);
+  assert(s);
+  memmove(s, fdText->ptr, fdText->size);
+  s[fdText->size]=0;
+  end=s+fdText->size;
+  for (i=0; i<fdText->size; i++)
+    if (s[i]=='\n')
+      maxEntries++;
+  maxEntries++;
+  AB_BankInfoGenericFileData_free(fdText);
+
+  entries=(AB_BANKINFO_GENERIC_INDEXENTRY *) malloc(maxEntries*sizeof(AB_BANKINFO_GENERIC_INDEXENTRY));
+  assert(entries);
+
+  sPos=s;
+  while (sPos<end) {
+    char *line;
+    char *fields[3];
+    char *t;
+    int fieldCount=0;
+
+    line=sPos;
+    t=strchr(line, '\n');
+    if (t) {
+      *t=0;
+      sPos=t+1;
+    }
+    else
+      sPos=end;
+    t=line;
+    while (fieldCount<3) {
+      fields[fieldCount++]=t;
+      t=strchr(t, '\t');
+      if (t==NULL)
+        break;
+      *(t++)=0;
+    }
+
+    if (fieldCount==numKeys+1) {
+      AB_BANKINFO_GENERIC_INDEXENTRY *e;
+      unsigned int pos;
+
+      if (1!=sscanf(fields[numKeys], "%08x", &pos)) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "Invalid position in index \"%s\"", fname);
+        continue;
+      }
+      e=&(entries[entryCount++]);
+      e->key1=fields[0];
+      e->key2=(numKeys>1)?fields[1]:NULL;
+      e->pos=pos;
+      if (strlen(e->key1)+1>keySize1)
+        keySize1=strlen(e->key1)+1;
+      if (e->key2 && strlen(e->key2)+1>keySize2)
+        keySize2=strlen(e->key2)+1;
+    }
+  }
+
+  qsort(entries, entryCount, sizeof(AB_BANKINFO_GENERIC_INDEXENTRY), AB_BankInfoGenericIndex_CompareEntries);
+
+  /* create index data in the format of a binary index file */
+  recordSize=keySize1+keySize2+4;
+  GWEN_NEW_OBJECT(AB_BANKINFO_GENERIC_FILEDATA, fd);
+  fd->size=AB_BANKINFO_GENERIC_BIDX_HEADERSIZE+(entryCount*recordSize);
+  fd->ptr=(uint8_t *) calloc(1, fd->size);
+  assert(fd->ptr);
+  memmove(fd->ptr, AB_BANKINFO_GENERIC_BIDX_MAGIC, AB_BANKINFO_GENERIC_BIDX_MAGICSIZE);
+  p=fd->ptr+AB_BANKINFO_GENERIC_BIDX_MAGICSIZE;
+  *(p++)=(entryCount>>24) & 0xff;
+  *(p++)=(entryCount>>16) & 0xff;
+  *(p++)=(entryCount>>8) & 0xff;
+  *(p++)=entryCount & 0xff;
+  *(p++)=(keySize1>>8) & 0xff;
+  *(p++)=keySize1 & 0xff;
+  *(p++)=(keySize2>>8) & 0xff;
+  *(p++)=keySize2 & 0xff;
+  for (i=0; i<entryCount; i++) {
+    const AB_BANKINFO_GENERIC_INDEXENTRY *e;
+
+    e=&(entries[i]);
+    memmove(p, e->key1, strlen(e->key1));
+    if (e->key2)
+      memmove(p+keySize1, e->key2, strlen(e->key2));
+    p+=keySize1+keySize2;
+    *(p++)=(e->pos>>24) & 0xff;
+    *(p++)=(e->pos>>16) & 0xff;
+    *(p++)=(e->pos>>8) & 0xff;
+    *(p++)=e->pos & 0xff;
+  }
+  free(entries);
+  free(s);
+
+  idx=AB_BankInfoGenericIndex_fromFileData(fd);
+  if (idx==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Could not create index from \"%s\"", fname);
+    AB_BankInfoGenericFileData_free(fd);
+    return NULL;
+  }
+
+  return idx;
+}
+
+
+
+void AB_BankInfoGenericIndex_free(AB_BANKINFO_GENERIC_INDEX *idx)
+{
+  if (idx) {
+    AB_BankInfoGenericFileData_free(idx->fileData);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+uint32_t AB_BankInfoGenericIndex_FindFirst(const AB_BANKINFO_GENERIC_INDEX *idx,
+                                           const char *prefix,
+                                           uint32_t prefixLen)
+{
+  uint32_t lo=0;
+  uint32_t hi;
+
+  /* binary search for the first record whose key1 is not less than the prefix */
+  hi=idx->recordCount;
+  while (lo<hi) {
+    uint32_t mid;
+
+    mid=lo+((hi-lo)/2);
+    if (AB_BankInfoGenericIndex_ComparePrefix((const char *)(idx->records+(mid*idx->recordSize)), prefix, prefixLen)<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+
+  return lo;
+}
+
+
+
+int AB_BankInfoGenericIndex_ComparePrefix(const char *key, const char *prefix, uint32_t prefixLen)
+{
+  uint32_t i;
+
+  for (i=0; i<prefixLen; i++) {
+    int c1, c2;
+
+    c1=AB_BANKINFO_GENERIC_UPPER((unsigned char) key[i]);
+    c2=AB_BANKINFO_GENERIC_UPPER((unsigned char) prefix[i]);
+    if (c1!=c2)
+      return c1-c2;
+  }
+  return 0;
+}
+
+
+
+int AB_BankInfoGenericIndex_CompareEntries(const void *a, const void *b)
+{
+  const AB_BANKINFO_GENERIC_INDEXENTRY *e1;
+  const AB_BANKINFO_GENERIC_INDEXENTRY *e2;
+  int rv;
+
+  e1=(const AB_BANKINFO_GENERIC_INDEXENTRY *) a;
+  e2=(const AB_BANKINFO_GENERIC_INDEXENTRY *) b;
+  rv=AB_BankInfoGenericIndex_CompareKeys(e1->key1, e2->key1);
+  if (rv==0 && e1->key2 && e2->key2)
+    rv=AB_BankInfoGenericIndex_CompareKeys(e1->key2, e2->key2);
+  if (rv==0)
+    rv=(e1->pos<e2->pos)?-1:((e1->pos>e2->pos)?1:0);
+  return rv;
+}
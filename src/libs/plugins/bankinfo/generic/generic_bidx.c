@@ -0,0 +1,32 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+
+#include "generic_bidx_l.h"
+
+
+
+int AB_BankInfoGenericIndex_CompareKeys(const char *key1, const char *key2)
+{
+  for (;;) {
+    int c1, c2;
+
+    c1=(unsigned char) *(key1++);
+    c2=(unsigned char) *(key2++);
+    c1=AB_BANKINFO_GENERIC_UPPER(c1);
+    c2=AB_BANKINFO_GENERIC_UPPER(c2);
+    if (c1!=c2)
+      return c1-c2;
+    if (c1==0)
+      return 0;
+  }
+}
+
+
@@ -0,0 +1,33 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifndef AQBANKING_BANKINFO_GENERIC_BIDX_L_H
+#define AQBANKING_BANKINFO_GENERIC_BIDX_L_H
+
+
+/*
+ * Binary index files ("blz.bidx", "bic.bidx", "namloc.bidx", created by mkdeinfo):
+ * - header: 8 bytes magic, 4 bytes number of records, 2 bytes size of key1, 2 bytes size of key2
+ * - records: key1 and key2 (zero-padded to the sizes given in the header), 4 bytes position in "banks.data"
+ * All numbers are big-endian. Records are sorted by key1 and key2 (see @ref AB_BankInfoGenericIndex_CompareKeys)
+ * and then by position. If a binary index is missing or older than its text index file ("blz.idx" etc) or
+ * than "banks.data" the same structure is built in memory from the text index file.
+ *
+ * This file is shared between the generic bankinfo plugin and mkdeinfo which both link the convenience library
+ * built from generic_bidx.c.
+ */
+#define AB_BANKINFO_GENERIC_BIDX_MAGIC      "ABBIDX01"
+#define AB_BANKINFO_GENERIC_BIDX_MAGICSIZE  8
+#define AB_BANKINFO_GENERIC_BIDX_HEADERSIZE 16
+
+/** only ASCII letters are folded when comparing keys */
+#define AB_BANKINFO_GENERIC_UPPER(c) ((((c)>='a') && ((c)<='z'))?((c)-('a'-'A')):(c))
+
+
+int AB_BankInfoGenericIndex_CompareKeys(const char *key1, const char *key2);
+
+
+#endif
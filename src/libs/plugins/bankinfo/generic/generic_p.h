@@ -14,7 +14,49 @@
 #define AQBANKING_BANKINFO_GENERIC_P_H
 
 #include "generic_l.h"
+#include "generic_bidx_l.h"
 
+#include "aqbanking/backendsupport/mutex_l.h"
+
+
+
+/** number of decoded bank infos kept in memory */
+#define AB_BANKINFO_GENERIC_CACHE_SIZE      64
+
+
+typedef struct AB_BANKINFO_GENERIC_FILEDATA AB_BANKINFO_GENERIC_FILEDATA;
+struct AB_BANKINFO_GENERIC_FILEDATA {
+  uint8_t *ptr;
+  uint32_t size;
+  int isMapped;
+};
+
+
+typedef struct AB_BANKINFO_GENERIC_INDEX AB_BANKINFO_GENERIC_INDEX;
+struct AB_BANKINFO_GENERIC_INDEX {
+  AB_BANKINFO_GENERIC_FILEDATA *fileData;
+  const uint8_t *records;
+  uint32_t recordCount;
+  uint32_t keySize1;
+  uint32_t keySize2;
+  uint32_t recordSize;
+};
+
+
+typedef struct AB_BANKINFO_GENERIC_INDEXENTRY AB_BANKINFO_GENERIC_INDEXENTRY;
+struct AB_BANKINFO_GENERIC_INDEXENTRY {
+  const char *key1;
+  const char *key2;
+  uint32_t pos;
+};
+
+
+typedef struct AB_BANKINFO_GENERIC_CACHEENTRY AB_BANKINFO_GENERIC_CACHEENTRY;
+struct AB_BANKINFO_GENERIC_CACHEENTRY {
+  AB_BANKINFO *bankInfo;
+  uint32_t pos;
+  uint32_t lastUsed;
+};
 
 
 typedef struct AB_BANKINFO_PLUGIN_GENERIC AB_BANKINFO_PLUGIN_GENERIC;
@@ -22,6 +64,18 @@ struct AB_BANKINFO_PLUGIN_GENERIC {
   AB_BANKING *banking;
   char *country;
   char *dataDir;
+
+  /** protects dataDir, the lazily loaded indexes and the cache (plugins may be used from worker threads) */
+  AB_MUTEX *mutex;
+
+  int indexesLoaded;
+  AB_BANKINFO_GENERIC_INDEX *blzIndex;
+  AB_BANKINFO_GENERIC_INDEX *bicIndex;
+  AB_BANKINFO_GENERIC_INDEX *namLocIndex;
+  AB_BANKINFO_GENERIC_FILEDATA *bankData;
+
+  AB_BANKINFO_GENERIC_CACHEENTRY cache[AB_BANKINFO_GENERIC_CACHE_SIZE];
+  uint32_t cacheCounter;
 };
 
 
@@ -55,6 +109,10 @@ int AB_BankInfoPluginGENERIC__AddByNameAndLoc(AB_BANKINFO_PLUGIN *bip,
                                               const char *loc,
                                               AB_BANKINFO_LIST2 *bl);
 
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoAtPos(AB_BANKINFO_PLUGIN *bip, uint32_t pos);
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoFromMemory(AB_BANKINFO_PLUGIN *bip, uint32_t pos);
+AB_BANKINFO *AB_BankInfoPluginGENERIC__ReadBankInfoFromFile(AB_BANKINFO_PLUGIN *bip, uint32_t pos);
+
 int AB_BankInfoPluginGENERIC__CmpTemplate(AB_BANKINFO *bi,
                                           const AB_BANKINFO *tbi,
                                           uint32_t flags);
@@ -65,6 +123,33 @@ int AB_BankInfoPluginGENERIC_AddByTemplate(AB_BANKINFO_PLUGIN *bip,
                                            AB_BANKINFO_LIST2 *bl,
                                            uint32_t flags);
 
+static void AB_BankInfoPluginGENERIC__LoadIndexes(AB_BANKINFO_PLUGIN *bip);
+static AB_BANKINFO_GENERIC_INDEX *AB_BankInfoPluginGENERIC__LoadIndex(AB_BANKINFO_PLUGIN *bip,
+                                                                     const char *baseName,
+                                                                     int numKeys);
+static int64_t AB_BankInfoPluginGENERIC__GetFileTime(const char *fname);
+static int AB_BankInfoPluginGENERIC__AddFromIndex(AB_BANKINFO_PLUGIN *bip,
+                                                  const AB_BANKINFO_GENERIC_INDEX *idx,
+                                                  const char *pattern1,
+                                                  const char *pattern2,
+                                                  int exact,
+                                                  uint32_t maxCount,
+                                                  AB_BANKINFO_LIST2 *bl);
+
+static AB_BANKINFO_GENERIC_FILEDATA *AB_BankInfoGenericFileData_fromFile(const char *fname);
+static void AB_BankInfoGenericFileData_free(AB_BANKINFO_GENERIC_FILEDATA *fd);
+
+static AB_BANKINFO_GENERIC_INDEX *AB_BankInfoGenericIndex_fromFileData(AB_BANKINFO_GENERIC_FILEDATA *fd);
+static AB_BANKINFO_GENERIC_INDEX *AB_BankInfoGenericIndex_fromTextFile(const char *fname, int numKeys);
+static void AB_BankInfoGenericIndex_free(AB_BANKINFO_GENERIC_INDEX *idx);
+static uint32_t AB_BankInfoGenericIndex_FindFirst(const AB_BANKINFO_GENERIC_INDEX *idx,
+                                                  const char *prefix,
+                                                  uint32_t prefixLen);
+static int AB_BankInfoGenericIndex_ComparePrefix(const char *key, const char *prefix, uint32_t prefixLen);
+static int AB_BankInfoGenericIndex_CompareEntries(const void *a, const void *b);
+
+
+
 #define AB_BANKINFO_GENERIC__FLAGS_COUNTRY  0x00000001
 #define AB_BANKINFO_GENERIC__FLAGS_BRANCHID 0x00000002
 #define AB_BANKINFO_GENERIC__FLAGS_BANKID   0x00000004
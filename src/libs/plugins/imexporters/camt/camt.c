@@ -66,43 +66,43 @@ int AH_ImExporterCAMT_Import(AB_IMEXPORTER *ie,
                              GWEN_DB_NODE *params)
 {
   int rv;
-  GWEN_XMLNODE *xmlRoot;
-  GWEN_XMLNODE *n;
+  AB_IMEXPORTER_CONTEXT *importCtx;
   GWEN_XML_CONTEXT *xmlCtx;
   const char *camVersionWanted;
 
-  /* read whole document into XML tree */
-  xmlRoot=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "camt52");
-  xmlCtx=GWEN_XmlCtxStore_new(xmlRoot, GWEN_XML_FLAGS_DEFAULT);
+  /* check document type */
+  camVersionWanted=GWEN_DB_GetCharValue(params, "type", 0, "052.001.02");
+  assert(camVersionWanted);
+
+  if (strcasecmp(camVersionWanted, "052.001.02")!=0 &&
+      strcasecmp(camVersionWanted, "053.001.02")!=0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Unsupported CAMT type \"%s\", nothing imported", camVersionWanted);
+    return 0;
+  }
+
+  /* read document, every entry is imported as soon as it is complete. Entries of camt.052.001.02 and
+   * camt.053.001.02 have the same layout, so both are accepted (detected by the element below <Document>).
+   * Entries go to a separate context which is only added to ctx if the whole document could be read */
+  importCtx=AB_ImExporterContext_new();
+  xmlCtx=AH_CamtXmlCtx_new(ie, importCtx);
   rv=GWEN_XMLContext_ReadFromIo(xmlCtx, sio);
   if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
     GWEN_XmlCtx_free(xmlCtx);
-    GWEN_XMLNode_free(xmlRoot);
+    AB_ImExporterContext_free(importCtx);
     return rv;
   }
-  GWEN_XmlCtx_free(xmlCtx);
 
-  n=GWEN_XMLNode_FindFirstTag(xmlRoot, "Document", NULL, NULL);
-  if (n==NULL) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "<Document> element not found");
-    GWEN_XMLNode_free(xmlRoot);
-    return GWEN_ERROR_BAD_DATA;
+  rv=AH_CamtXmlCtx_CheckDocument(xmlCtx);
+  GWEN_XmlCtx_free(xmlCtx);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AB_ImExporterContext_free(importCtx);
+    return rv;
   }
 
-  /* debug */
-  /*GWEN_XMLNode_Dump(n, 2); */
-
-  /* check document type */
-  camVersionWanted=GWEN_DB_GetCharValue(params, "type", 0, "052.001.02");
-  assert(camVersionWanted);
-
-  if (strcasecmp(camVersionWanted, "052.001.02")==0)
-    rv=AH_ImExporterCAMT_Import_052_001_02(ie, ctx, params, n);
-  else
-    rv=0;
-
-  GWEN_XMLNode_free(xmlRoot);
-  return rv;
+  AB_ImExporterContext_AddContext(ctx, importCtx);
+  return 0;
 }
 
 
@@ -126,6 +126,7 @@ int AH_ImExporterCAMT_CheckFile(AB_IMEXPORTER *ie, const char *fname)
 
 
 #include "camt52_001_02.c"
+#include "camt_xmlctx.c"
 
 
 
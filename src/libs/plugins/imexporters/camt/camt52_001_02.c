@@ -125,29 +125,6 @@ static int _import_052_001_02_read_balance(AB_IMEXPORTER *ie,
 
 
 
-static int _import_052_001_02_read_balances(AB_IMEXPORTER *ie,
-                                            GWEN_XMLNODE *xmlNode,
-                                            AB_IMEXPORTER_ACCOUNTINFO *accountInfo)
-{
-  GWEN_XMLNODE *n;
-
-  n=GWEN_XMLNode_FindFirstTag(xmlNode, "Bal", NULL, NULL);
-  while (n) {
-    int rv;
-
-    rv=_import_052_001_02_read_balance(ie, n, accountInfo);
-    if (rv<0) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-      return rv;
-    }
-    n=GWEN_XMLNode_FindNextTag(n, "Bal", NULL, NULL);
-  } /* while n */
-
-  return 0;
-}
-
-
-
 static int _import_052_001_02_read_transaction_details(AB_IMEXPORTER *ie,
                                                        GWEN_XMLNODE *xmlNode,
                                                        AB_TRANSACTION *t,
@@ -378,107 +355,25 @@ static int _import_052_001_02_read_transaction(AB_IMEXPORTER *ie,
 
 
 
-static int _import_052_001_02_read_transactions(AB_IMEXPORTER *ie,
-                                                GWEN_XMLNODE *xmlNode,
-                                                AB_IMEXPORTER_ACCOUNTINFO *accountInfo)
-{
-  GWEN_XMLNODE *n;
-
-  n=GWEN_XMLNode_FindFirstTag(xmlNode, "Ntry", NULL, NULL);
-  while (n) {
-    int rv;
-
-    rv=_import_052_001_02_read_transaction(ie, n, accountInfo);
-    if (rv<0) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-      return rv;
-    }
-    n=GWEN_XMLNode_FindNextTag(n, "Ntry", NULL, NULL);
-  } /* while n */
-
-  return 0;
-}
-
-
-
-static int _import_052_001_02_report(AB_IMEXPORTER *ie,
-                                     AB_IMEXPORTER_CONTEXT *ctx,
-                                     GWEN_DB_NODE *params,
-                                     GWEN_XMLNODE *xmlNode)
+static AB_IMEXPORTER_ACCOUNTINFO *_import_052_001_02_read_account(AB_IMEXPORTER *ie,
+                                                                AB_IMEXPORTER_CONTEXT *ctx,
+                                                                GWEN_XMLNODE *xmlNode)
 {
-  GWEN_XMLNODE *n;
-  AB_IMEXPORTER_ACCOUNTINFO *accountInfo=NULL;
-  int rv;
-
-  /* read account, set accountInfo */
-  n=GWEN_XMLNode_FindFirstTag(xmlNode, "Acct", NULL, NULL);
-  if (n) {
-    AB_ACCOUNT_SPEC *accountSpec;
-
-    accountSpec=AB_AccountSpec_new();
-    _import_052_001_02_read_account_spec(ie, n, accountSpec);
-    accountInfo=AB_ImExporterContext_GetOrAddAccountInfo(ctx,
-                                                         0,
-                                                         AB_AccountSpec_GetIban(accountSpec),
-                                                         AB_AccountSpec_GetBankCode(accountSpec),
-                                                         AB_AccountSpec_GetAccountNumber(accountSpec),
-                                                         AB_AccountType_Unknown);
-    assert(accountInfo);
-    AB_AccountSpec_free(accountSpec);
-  }
-
-  /* read balances */
-  rv=_import_052_001_02_read_balances(ie, xmlNode, accountInfo);
-  if (rv<0) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-    return rv;
-  }
-
-  /* read transactions */
-  rv=_import_052_001_02_read_transactions(ie, xmlNode, accountInfo);
-  if (rv<0) {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-    return rv;
-  }
-
-  return 0;
-}
-
-
-
-
-
-int AH_ImExporterCAMT_Import_052_001_02(AB_IMEXPORTER *ie,
-                                        AB_IMEXPORTER_CONTEXT *ctx,
-                                        GWEN_DB_NODE *params,
-                                        GWEN_XMLNODE *xmlNode)
-{
-  GWEN_XMLNODE *n;
-
-  n=GWEN_XMLNode_FindFirstTag(xmlNode, "BkToCstmrAcctRpt", NULL, NULL);
-  if (n==NULL) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "<BkToCstmrAcctRpt> element not found");
-    return GWEN_ERROR_BAD_DATA;
-  }
-
-  n=GWEN_XMLNode_FindFirstTag(n, "Rpt", NULL, NULL);
-  if (n==NULL) {
-    DBG_ERROR(AQBANKING_LOGDOMAIN, "<Rpt> element not found");
-    return GWEN_ERROR_BAD_DATA;
-  }
-
-  /* now read every report */
-  while (n) {
-    int rv;
-
-    rv=_import_052_001_02_report(ie, ctx, params, n);
-    if (rv<0) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-      return rv;
-    }
-    n=GWEN_XMLNode_FindNextTag(n, "Rpt", NULL, NULL);
-  }
-  return 0;
+  AB_ACCOUNT_SPEC *accountSpec;
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;
+
+  accountSpec=AB_AccountSpec_new();
+  _import_052_001_02_read_account_spec(ie, xmlNode, accountSpec);
+  accountInfo=AB_ImExporterContext_GetOrAddAccountInfo(ctx,
+                                                       0,
+                                                       AB_AccountSpec_GetIban(accountSpec),
+                                                       AB_AccountSpec_GetBankCode(accountSpec),
+                                                       AB_AccountSpec_GetAccountNumber(accountSpec),
+                                                       AB_AccountType_Unknown);
+  assert(accountInfo);
+  AB_AccountSpec_free(accountSpec);
+
+  return accountInfo;
 }
 
 
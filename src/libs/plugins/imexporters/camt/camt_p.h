@@ -16,6 +16,8 @@
 
 #include <aqbanking/backendsupport/imexporter_be.h>
 
+#include <gwenhywfar/xmlctx.h>
+
 
 typedef struct AH_IMEXPORTER_CAMT AH_IMEXPORTER_CAMT;
 struct AH_IMEXPORTER_CAMT {
@@ -38,10 +40,49 @@ static int AH_ImExporterCAMT_Export(AB_IMEXPORTER *ie,
 static int AH_ImExporterCAMT_CheckFile(AB_IMEXPORTER *ie, const char *fname);
 
 
-static int AH_ImExporterCAMT_Import_052_001_02(AB_IMEXPORTER *ie,
-                                               AB_IMEXPORTER_CONTEXT *ctx,
-                                               GWEN_DB_NODE *params,
-                                               GWEN_XMLNODE *xmlRoot);
+/* ------------------------------------------------------------------------------------------------
+ * streaming import (camt.052.001.02 and camt.053.001.02)
+ *
+ * The document is not read into a complete XML tree. Only the direct children <Acct>, <Bal> and <Ntry>
+ * of every report (<Rpt> or <Stmt>) are stored in a small tree while they are read. They are processed
+ * as soon as their end tag arrives and freed afterwards.
+ * ------------------------------------------------------------------------------------------------
+ */
+
+typedef struct AH_CAMT_XMLCTX AH_CAMT_XMLCTX;
+struct AH_CAMT_XMLCTX {
+  AB_IMEXPORTER *imExporter;
+  AB_IMEXPORTER_CONTEXT *ioContext;
+
+  char *currentTagName;        /* name of the tag last started (closing tags start with "/") */
+  int level;                   /* number of currently open elements */
+
+  int documentFound;           /* <Document> found at level 1 */
+  int documentOpen;
+  const char *reportTagName;   /* "Rpt" or "Stmt", set while <BkToCstmrAcctRpt> or <BkToCstmrStmt> is open */
+  int containerFound;
+  int reportLevel;             /* level of the currently open report (0 if none) */
+  int reportCount;
+  AB_IMEXPORTER_ACCOUNTINFO *accountInfo;  /* account of the current report */
+
+  GWEN_XMLNODE *subtreeRoot;   /* root of the element currently stored (NULL if none) */
+  GWEN_XML_CONTEXT *subtreeCtx;
+  int subtreeLevel;            /* level of the element currently stored */
+};
+
+
+static GWEN_XML_CONTEXT *AH_CamtXmlCtx_new(AB_IMEXPORTER *ie, AB_IMEXPORTER_CONTEXT *ioContext);
+static int AH_CamtXmlCtx_CheckDocument(const GWEN_XML_CONTEXT *ctx);
+
+static void GWENHYWFAR_CB AH_CamtXmlCtx_FreeData(void *bp, void *p);
+
+static int AH_CamtXmlCtx_StartTag(GWEN_XML_CONTEXT *ctx, const char *tagName);
+static int AH_CamtXmlCtx_EndTag(GWEN_XML_CONTEXT *ctx, int closing);
+static int AH_CamtXmlCtx_AddData(GWEN_XML_CONTEXT *ctx, const char *data);
+static int AH_CamtXmlCtx_AddComment(GWEN_XML_CONTEXT *ctx, const char *data);
+static int AH_CamtXmlCtx_AddAttr(GWEN_XML_CONTEXT *ctx,
+                                 const char *attrName,
+                                 const char *attrData);
 
 
 
@@ -0,0 +1,350 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+/* This file is included by camt.c */
+
+
+
+GWEN_INHERIT(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX)
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _xmlCtxOpenElement(AH_CAMT_XMLCTX *xctx, const char *tagName);
+static void _xmlCtxCloseElement(AH_CAMT_XMLCTX *xctx);
+static int _xmlCtxIsStoredElement(const char *tagName);
+static void _xmlCtxStartSubtree(AH_CAMT_XMLCTX *xctx);
+static int _xmlCtxFinishSubtree(AH_CAMT_XMLCTX *xctx);
+static void _xmlCtxFreeSubtree(AH_CAMT_XMLCTX *xctx);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+GWEN_XML_CONTEXT *AH_CamtXmlCtx_new(AB_IMEXPORTER *ie, AB_IMEXPORTER_CONTEXT *ioContext)
+{
+  GWEN_XML_CONTEXT *ctx;
+  AH_CAMT_XMLCTX *xctx;
+
+  /* create base object */
+  ctx=GWEN_XmlCtx_new(GWEN_XML_FLAGS_DEFAULT);
+  assert(ctx);
+
+  /* create and assign extension */
+  GWEN_NEW_OBJECT(AH_CAMT_XMLCTX, xctx);
+  GWEN_INHERIT_SETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx, xctx, AH_CamtXmlCtx_FreeData);
+  xctx->imExporter=ie;
+  xctx->ioContext=ioContext;
+
+  /* set virtual functions */
+  GWEN_XmlCtx_SetStartTagFn(ctx, AH_CamtXmlCtx_StartTag);
+  GWEN_XmlCtx_SetEndTagFn(ctx, AH_CamtXmlCtx_EndTag);
+  GWEN_XmlCtx_SetAddDataFn(ctx, AH_CamtXmlCtx_AddData);
+  GWEN_XmlCtx_SetAddCommentFn(ctx, AH_CamtXmlCtx_AddComment);
+  GWEN_XmlCtx_SetAddAttrFn(ctx, AH_CamtXmlCtx_AddAttr);
+
+  return ctx;
+}
+
+
+
+GWENHYWFAR_CB
+void AH_CamtXmlCtx_FreeData(void *bp, void *p)
+{
+  AH_CAMT_XMLCTX *xctx;
+
+  xctx=(AH_CAMT_XMLCTX *)p;
+  _xmlCtxFreeSubtree(xctx);
+  free(xctx->currentTagName);
+  GWEN_FREE_OBJECT(xctx);
+}
+
+
+
+int AH_CamtXmlCtx_CheckDocument(const GWEN_XML_CONTEXT *ctx)
+{
+  AH_CAMT_XMLCTX *xctx;
+
+  assert(ctx);
+  xctx=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx);
+  assert(xctx);
+
+  if (!xctx->documentFound) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "<Document> element not found");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (!xctx->containerFound) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Neither <BkToCstmrAcctRpt> nor <BkToCstmrStmt> element found");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (xctx->reportCount==0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Neither <Rpt> nor <Stmt> element found");
+    return GWEN_ERROR_BAD_DATA;
+  }
+  if (xctx->subtreeRoot) {
+    DBG_WARN(AQBANKING_LOGDOMAIN, "Document ends inside of an unfinished element, ignoring that element");
+  }
+
+  return 0;
+}
+
+
+
+int AH_CamtXmlCtx_StartTag(GWEN_XML_CONTEXT *ctx, const char *tagName)
+{
+  AH_CAMT_XMLCTX *xctx;
+
+  assert(ctx);
+  xctx=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx);
+  assert(xctx);
+
+  free(xctx->currentTagName);
+  xctx->currentTagName=strdup(tagName);
+
+  /* ignore XML header, DOCTYPE etc */
+  if (*tagName=='?' || *tagName=='!')
+    return 0;
+
+  /* start storing direct children of a report we are interested in */
+  if (xctx->subtreeRoot==NULL &&
+      xctx->reportLevel &&
+      xctx->level==xctx->reportLevel &&
+      _xmlCtxIsStoredElement(tagName))
+    _xmlCtxStartSubtree(xctx);
+
+  if (xctx->subtreeCtx)
+    return GWEN_XmlCtx_StartTag(xctx->subtreeCtx, tagName);
+
+  return 0;
+}
+
+
+
+int AH_CamtXmlCtx_EndTag(GWEN_XML_CONTEXT *ctx, int closing)
+{
+  AH_CAMT_XMLCTX *xctx;
+  const char *tagName;
+
+  assert(ctx);
+  xctx=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx);
+  assert(xctx);
+
+  tagName=xctx->currentTagName;
+  if (tagName==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No tag name, malformed CAMT file");
+    return GWEN_ERROR_BAD_DATA;
+  }
+
+  /* ignore XML header, DOCTYPE etc */
+  if (*tagName=='?' || *tagName=='!')
+    return 0;
+
+  if (xctx->subtreeCtx) {
+    int rv;
+
+    rv=GWEN_XmlCtx_EndTag(xctx->subtreeCtx, closing);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+  }
+
+  if (*tagName=='/') {
+    /* closing tag */
+    if (xctx->level<1) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Unexpected closing tag <%s>", tagName);
+      return GWEN_ERROR_BAD_DATA;
+    }
+    if (xctx->subtreeRoot && xctx->level==xctx->subtreeLevel) {
+      int rv;
+
+      rv=_xmlCtxFinishSubtree(xctx);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+    }
+    _xmlCtxCloseElement(xctx);
+  }
+  else if (closing) {
+    /* empty element (closed by "/>") */
+    if (xctx->subtreeRoot && xctx->level+1==xctx->subtreeLevel) {
+      int rv;
+
+      rv=_xmlCtxFinishSubtree(xctx);
+      if (rv<0) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+        return rv;
+      }
+    }
+  }
+  else
+    _xmlCtxOpenElement(xctx, tagName);
+
+  return 0;
+}
+
+
+
+int AH_CamtXmlCtx_AddData(GWEN_XML_CONTEXT *ctx, const char *data)
+{
+  AH_CAMT_XMLCTX *xctx;
+
+  assert(ctx);
+  xctx=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx);
+  assert(xctx);
+
+  /* data outside of stored elements is not needed */
+  if (xctx->subtreeCtx)
+    return GWEN_XmlCtx_AddData(xctx->subtreeCtx, data);
+  return 0;
+}
+
+
+
+int AH_CamtXmlCtx_AddComment(GWEN_XML_CONTEXT *ctx, const char *data)
+{
+  /* ignore comments */
+  return 0;
+}
+
+
+
+int AH_CamtXmlCtx_AddAttr(GWEN_XML_CONTEXT *ctx,
+                          const char *attrName,
+                          const char *attrData)
+{
+  AH_CAMT_XMLCTX *xctx;
+
+  assert(ctx);
+  xctx=GWEN_INHERIT_GETDATA(GWEN_XML_CONTEXT, AH_CAMT_XMLCTX, ctx);
+  assert(xctx);
+
+  if (xctx->subtreeCtx)
+    return GWEN_XmlCtx_AddAttr(xctx->subtreeCtx, attrName, attrData);
+  return 0;
+}
+
+
+
+void _xmlCtxOpenElement(AH_CAMT_XMLCTX *xctx, const char *tagName)
+{
+  xctx->level++;
+
+  if (xctx->level==1) {
+    if (strcasecmp(tagName, "Document")==0) {
+      xctx->documentFound=1;
+      xctx->documentOpen=1;
+    }
+  }
+  else if (xctx->level==2 && xctx->documentOpen) {
+    if (strcasecmp(tagName, "BkToCstmrAcctRpt")==0)
+      xctx->reportTagName="Rpt";        /* camt.052 */
+    else if (strcasecmp(tagName, "BkToCstmrStmt")==0)
+      xctx->reportTagName="Stmt";       /* camt.053 */
+    if (xctx->reportTagName)
+      xctx->containerFound=1;
+  }
+  else if (xctx->level==3 && xctx->reportTagName) {
+    if (strcasecmp(tagName, xctx->reportTagName)==0) {
+      xctx->reportLevel=xctx->level;
+      xctx->reportCount++;
+      xctx->accountInfo=NULL;
+    }
+  }
+}
+
+
+
+void _xmlCtxCloseElement(AH_CAMT_XMLCTX *xctx)
+{
+  if (xctx->level==xctx->reportLevel) {
+    xctx->reportLevel=0;
+    xctx->accountInfo=NULL;
+  }
+  else if (xctx->level==2)
+    xctx->reportTagName=NULL;
+  else if (xctx->level==1)
+    xctx->documentOpen=0;
+
+  xctx->level--;
+}
+
+
+
+int _xmlCtxIsStoredElement(const char *tagName)
+{
+  return (strcasecmp(tagName, "Acct")==0 ||
+          strcasecmp(tagName, "Bal")==0 ||
+          strcasecmp(tagName, "Ntry")==0);
+}
+
+
+
+void _xmlCtxStartSubtree(AH_CAMT_XMLCTX *xctx)
+{
+  xctx->subtreeRoot=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "camt");
+  xctx->subtreeCtx=GWEN_XmlCtxStore_new(xctx->subtreeRoot, GWEN_XML_FLAGS_DEFAULT);
+  xctx->subtreeLevel=xctx->level+1;
+}
+
+
+
+int _xmlCtxFinishSubtree(AH_CAMT_XMLCTX *xctx)
+{
+  GWEN_XMLNODE *n;
+  int rv=0;
+
+  n=GWEN_XMLNode_GetFirstTag(xctx->subtreeRoot);
+  if (n) {
+    const char *s;
+
+    s=GWEN_XMLNode_GetData(n);
+    if (strcasecmp(s, "Acct")==0) {
+      /* only the first account of a report is used */
+      if (xctx->accountInfo==NULL)
+        xctx->accountInfo=_import_052_001_02_read_account(xctx->imExporter, xctx->ioContext, n);
+    }
+    else if (xctx->accountInfo==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "<%s> found before <Acct> in report", s);
+      rv=GWEN_ERROR_BAD_DATA;
+    }
+    else if (strcasecmp(s, "Bal")==0)
+      rv=_import_052_001_02_read_balance(xctx->imExporter, n, xctx->accountInfo);
+    else
+      rv=_import_052_001_02_read_transaction(xctx->imExporter, n, xctx->accountInfo);
+  }
+
+  _xmlCtxFreeSubtree(xctx);
+  return rv;
+}
+
+
+
+void _xmlCtxFreeSubtree(AH_CAMT_XMLCTX *xctx)
+{
+  if (xctx->subtreeCtx) {
+    GWEN_XmlCtx_free(xctx->subtreeCtx);
+    xctx->subtreeCtx=NULL;
+  }
+  if (xctx->subtreeRoot) {
+    GWEN_XMLNode_free(xctx->subtreeRoot);
+    xctx->subtreeRoot=NULL;
+  }
+  xctx->subtreeLevel=0;
+}
+
+
@@ -13,6 +13,7 @@
 
 #include "csv_p.h"
 #include "csv_editprofile_l.h"
+#include "csv_reader_l.h"
 #include "aqbanking/i18n_l.h"
 
 #include "aqbanking/backendsupport/imexporter_be.h"
@@ -20,6 +21,7 @@
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/text.h>
 #include <gwenhywfar/gui.h>
+#include <gwenhywfar/fastbuffer.h>
 
 
 GWEN_INHERIT(AB_IMEXPORTER, AH_IMEXPORTER_CSV);
@@ -47,14 +49,20 @@ static void _unsplitInOutValue(GWEN_DB_NODE *dbT, int commaThousands, int commaD
 static void _collectPurposeStrings(AB_TRANSACTION *t, GWEN_DB_NODE *dbT);
 static void _readValues(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, int commaThousands, int commaDecimal);
 static void _readDates(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, const char *dateFormat);
-static void _translateValuesSign(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams);
-static int _mustNegate(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams);
+static void _translateValuesSign(AB_TRANSACTION *t, const char *posNeg, const AH_IMEXPORTER_CSV_POSTPROCESS *pp);
+static int _mustNegate(const char *posNeg, const AH_IMEXPORTER_CSV_POSTPROCESS *pp);
 static void _switchLocalRemoteAccordingToSign(AB_TRANSACTION *t, int switchOnNegative);
 static int _groupNameMatches(const char *groupName, GWEN_DB_NODE *dbParams);
 
 static void GWENHYWFAR_CB _freeData(void *bp, void *p);
 
-static int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE *dbParams);
+static int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE *dbParams,
+                            const AH_IMEXPORTER_CSV_POSTPROCESS *pp);
+static int _importWithReader(AB_IMEXPORTER_CONTEXT *ctx, AB_CSV_READER *rd, GWEN_SYNCIO *sio,
+                             const AH_IMEXPORTER_CSV_POSTPROCESS *pp);
+static void _readPostProcessSettings(GWEN_DB_NODE *dbParams, AH_IMEXPORTER_CSV_POSTPROCESS *pp);
+static void _postProcessTransaction(AB_TRANSACTION *t, const char *posNeg, const AH_IMEXPORTER_CSV_POSTPROCESS *pp);
+static AB_TRANSACTION_TYPE _getDefaultTransactionType(GWEN_DB_NODE *dbParams);
 
 
 
@@ -104,6 +112,7 @@ int _importCsv(AB_IMEXPORTER *ie,
                GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_CSV *ieh;
+  AH_IMEXPORTER_CSV_POSTPROCESS pp;
   GWEN_DB_NODE *dbData;
   GWEN_DB_NODE *dbSubParams;
   int rv;
@@ -113,8 +122,31 @@ int _importCsv(AB_IMEXPORTER *ie,
   assert(ieh);
   assert(ieh->dbio);
 
+  _readPostProcessSettings(params, &pp);
+
   dbSubParams=GWEN_DB_GetGroup(params, GWEN_PATH_FLAGS_NAMEMUSTEXIST,
                                "params");
+
+  /* read lines directly into transactions if the profile allows it */
+  if (dbSubParams &&
+      GWEN_DB_GetIntValue(params, "nativeReader", 0, 1) &&
+      _groupNameMatches(GWEN_DB_GetCharValue(dbSubParams, "group", 0, "line"), params)) {
+    AB_CSV_READER *rd;
+
+    rd=AB_CSV_Reader_new(params);
+    if (rd) {
+      rv=_importWithReader(ctx, rd, sio, &pp);
+      AB_CSV_Reader_free(rd);
+      if (rv<0) {
+        GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                             "Error importing data");
+        return rv;
+      }
+      return 0;
+    }
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Using GWEN DBIO plugin for this profile");
+  }
+
   dbData=GWEN_DB_Group_new("transactions");
   rv=GWEN_DBIO_Import(ieh->dbio,
                       sio,
@@ -142,7 +174,7 @@ int _importCsv(AB_IMEXPORTER *ie,
   }
   GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice,
                        "Transforming data to transactions");
-  rv=_importFromGroup(ctx, dbData, params);
+  rv=_importFromGroup(ctx, dbData, params, &pp);
   if (rv) {
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
                          "Error importing data");
@@ -156,24 +188,20 @@ int _importCsv(AB_IMEXPORTER *ie,
 
 
 
-int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE *dbParams)
+int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE *dbParams,
+                     const AH_IMEXPORTER_CSV_POSTPROCESS *pp)
 {
   GWEN_DB_NODE *dbT;
-  AB_TRANSACTION_TYPE defaultType=AB_Transaction_TypeStatement;
   const char *dateFormat;
-  int usePosNegField;
+  const char *posNegFieldName;
   int splitValueInOut;
-  int switchLocalRemote;
-  int switchOnNegative;
   int commaThousands=0;
   int commaDecimal=0;
   const char *s;
 
   dateFormat=GWEN_DB_GetCharValue(dbParams, "dateFormat", 0, "YYYY/MM/DD");
-  usePosNegField=GWEN_DB_GetIntValue(dbParams, "usePosNegField", 0, 0);
+  posNegFieldName=GWEN_DB_GetCharValue(dbParams, "posNegFieldName", 0, "posNeg");
   splitValueInOut=GWEN_DB_GetIntValue(dbParams, "splitValueInOut", 0, 0);
-  switchLocalRemote=GWEN_DB_GetIntValue(dbParams, "switchLocalRemote", 0, 0);
-  switchOnNegative=GWEN_DB_GetIntValue(dbParams, "switchOnNegative", 0, 1);
 
   s=GWEN_DB_GetCharValue(dbParams, "commaThousands", 0, 0);
   if (s)
@@ -182,15 +210,6 @@ int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE
   if (s)
     commaDecimal=*s;
 
-  s=GWEN_DB_GetCharValue(dbParams, "transactionType", 0, "statement");
-  if (s && *s) {
-    defaultType=AB_Transaction_Type_fromString(s);
-    if (defaultType==AB_Transaction_TypeUnknown) {
-      DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid default transaction type \"%s\", assuming \"statement\"", s);
-      defaultType=AB_Transaction_TypeStatement;
-    }
-  }
-
   dbT=GWEN_DB_GetFirstGroup(db);
   while (dbT) {
     if (_groupNameMatches(GWEN_DB_GroupName(dbT), dbParams)) {
@@ -211,15 +230,7 @@ int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE
         _collectPurposeStrings(t, dbT);
         _readValues(t, dbT, commaThousands, commaDecimal);
         _readDates(t, dbT, dateFormat);
-
-        if (usePosNegField)
-          _translateValuesSign(t, dbT, dbParams);
-
-        if (switchLocalRemote)
-          _switchLocalRemoteAccordingToSign(t, switchOnNegative);
-
-        if (AB_Transaction_GetType(t)<=AB_Transaction_TypeNone)
-          AB_Transaction_SetType(t, defaultType);
+        _postProcessTransaction(t, GWEN_DB_GetCharValue(dbT, posNegFieldName, 0, NULL), pp);
 
         DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
         AB_ImExporterContext_AddTransaction(ctx, t);
@@ -233,7 +244,7 @@ int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE
 
       DBG_INFO(AQBANKING_LOGDOMAIN, "Not a transaction, checking subgroups");
       /* not a transaction, check subgroups */
-      rv=_importFromGroup(ctx, dbT, dbParams);
+      rv=_importFromGroup(ctx, dbT, dbParams, pp);
       if (rv) {
         DBG_INFO(AQBANKING_LOGDOMAIN, "here");
         return rv;
@@ -248,6 +259,85 @@ int _importFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db, GWEN_DB_NODE
 
 
 
+int _importWithReader(AB_IMEXPORTER_CONTEXT *ctx, AB_CSV_READER *rd, GWEN_SYNCIO *sio,
+                      const AH_IMEXPORTER_CSV_POSTPROCESS *pp)
+{
+  GWEN_FAST_BUFFER *fb;
+  int rv;
+
+  GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Notice,
+                       "Reading transactions");
+  fb=GWEN_FastBuffer_new(4096, sio);
+  for (;;) {
+    AB_TRANSACTION *t=NULL;
+    const char *posNeg=NULL;
+
+    rv=AB_CSV_Reader_ReadTransaction(rd, fb, &t, &posNeg);
+    if (rv==GWEN_ERROR_EOF)
+      break;
+    else if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading transaction (%d)", rv);
+      GWEN_FastBuffer_free(fb);
+      return rv;
+    }
+
+    _postProcessTransaction(t, posNeg, pp);
+    DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
+    AB_ImExporterContext_AddTransaction(ctx, t);
+  }
+  GWEN_FastBuffer_free(fb);
+
+  return 0;
+}
+
+
+
+void _readPostProcessSettings(GWEN_DB_NODE *dbParams, AH_IMEXPORTER_CSV_POSTPROCESS *pp)
+{
+  pp->dbParams=dbParams;
+  pp->usePosNegField=GWEN_DB_GetIntValue(dbParams, "usePosNegField", 0, 0);
+  pp->defaultIsPositive=GWEN_DB_GetIntValue(dbParams, "defaultIsPositive", 0, 1);
+  pp->switchLocalRemote=GWEN_DB_GetIntValue(dbParams, "switchLocalRemote", 0, 0);
+  pp->switchOnNegative=GWEN_DB_GetIntValue(dbParams, "switchOnNegative", 0, 1);
+  pp->defaultType=_getDefaultTransactionType(dbParams);
+}
+
+
+
+/* profile settings which don't depend on the source of the transaction data */
+void _postProcessTransaction(AB_TRANSACTION *t, const char *posNeg, const AH_IMEXPORTER_CSV_POSTPROCESS *pp)
+{
+  if (pp->usePosNegField)
+    _translateValuesSign(t, posNeg, pp);
+
+  if (pp->switchLocalRemote)
+    _switchLocalRemoteAccordingToSign(t, pp->switchOnNegative);
+
+  if (AB_Transaction_GetType(t)<=AB_Transaction_TypeNone)
+    AB_Transaction_SetType(t, pp->defaultType);
+}
+
+
+
+AB_TRANSACTION_TYPE _getDefaultTransactionType(GWEN_DB_NODE *dbParams)
+{
+  AB_TRANSACTION_TYPE defaultType=AB_Transaction_TypeStatement;
+  const char *s;
+
+  s=GWEN_DB_GetCharValue(dbParams, "transactionType", 0, "statement");
+  if (s && *s) {
+    defaultType=AB_Transaction_Type_fromString(s);
+    if (defaultType==AB_Transaction_TypeUnknown) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Invalid default transaction type \"%s\", assuming \"statement\"", s);
+      defaultType=AB_Transaction_TypeStatement;
+    }
+  }
+
+  return defaultType;
+}
+
+
+
 void _unsplitInOutValue(GWEN_DB_NODE *dbT, int commaThousands, int commaDecimal)
 {
   AB_VALUE *tv=NULL;
@@ -431,53 +521,16 @@ void _readDates(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, const char *dateFormat)
 
 AB_VALUE *_valueFromDb(GWEN_DB_NODE *dbV, int commaThousands, int commaDecimal)
 {
-  const char *sv;
-  const char *sc;
-  char *cbuf=NULL;
-  AB_VALUE *val;
-
-  sv=GWEN_DB_GetCharValue(dbV, "value", 0, 0);
-  sc=GWEN_DB_GetCharValue(dbV, "currency", 0, "EUR");
-  if (commaThousands || commaDecimal) {
-    const char *pSrc;
-    char *pDst;
-
-    cbuf=(char *) malloc(strlen(sv)+1);
-    pSrc=sv;
-    pDst=cbuf;
-
-    /* copy all but thousands commas to new buffer */
-    while (*pSrc) {
-      if (commaThousands && *pSrc==commaThousands) {
-        /* skip thousands comma */
-      }
-      else if (commaDecimal && *pSrc==commaDecimal)
-        /* replace whatever is given by a recognizable decimal point */
-        *(pDst++)='.';
-      else
-        *(pDst++)=*pSrc;
-      pSrc++;
-    }
-    /* add trailing 0 to end the string */
-    *pDst=0;
-
-    sv=(const char *) cbuf;
-  }
-
-  val=AB_Value_fromString(sv);
-  if (cbuf)
-    free(cbuf);
-  if (val && sc)
-    AB_Value_SetCurrency(val, sc);
-
-  return val;
+  return AB_CSV_ValueFromString(GWEN_DB_GetCharValue(dbV, "value", 0, 0),
+                                GWEN_DB_GetCharValue(dbV, "currency", 0, "EUR"),
+                                commaThousands, commaDecimal);
 }
 
 
 
-void _translateValuesSign(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
+void _translateValuesSign(AB_TRANSACTION *t, const char *posNeg, const AH_IMEXPORTER_CSV_POSTPROCESS *pp)
 {
-  if (_mustNegate(dbT, dbParams)) {
+  if (_mustNegate(posNeg, pp)) {
     const AB_VALUE *pv;
 
     pv=AB_Transaction_GetValue(t);
@@ -504,17 +557,9 @@ void _translateValuesSign(AB_TRANSACTION *t, GWEN_DB_NODE *dbT, GWEN_DB_NODE *db
 
 
 
-int _mustNegate(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
+int _mustNegate(const char *s, const AH_IMEXPORTER_CSV_POSTPROCESS *pp)
 {
-  const char *posNegFieldName;
-  int defaultIsPositive;
-  const char *s;
-
-  defaultIsPositive=GWEN_DB_GetIntValue(dbParams, "defaultIsPositive", 0, 1);
-  posNegFieldName=GWEN_DB_GetCharValue(dbParams, "posNegFieldName", 0, "posNeg");
-
-  /* get positive/negative mark */
-  s=GWEN_DB_GetCharValue(dbT, posNegFieldName, 0, 0);
+  /* check positive/negative mark */
   if (s) {
     int j;
 
@@ -522,7 +567,7 @@ int _mustNegate(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
     for (j=0; ; j++) {
       const char *patt;
 
-      patt=GWEN_DB_GetCharValue(dbParams, "positiveValues", j, 0);
+      patt=GWEN_DB_GetCharValue(pp->dbParams, "positiveValues", j, 0);
       if (!patt)
         break;
       if (-1!=GWEN_Text_ComparePattern(s, patt, 0)) {
@@ -534,7 +579,7 @@ int _mustNegate(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
     for (j=0; ; j++) {
       const char *patt;
 
-      patt=GWEN_DB_GetCharValue(dbParams, "negativeValues", j, 0);
+      patt=GWEN_DB_GetCharValue(pp->dbParams, "negativeValues", j, 0);
       if (!patt)
         break;
       if (-1!=GWEN_Text_ComparePattern(s, patt, 0))
@@ -543,7 +588,7 @@ int _mustNegate(GWEN_DB_NODE *dbT, GWEN_DB_NODE *dbParams)
   }
 
   /* still undecided? */
-  if (!defaultIsPositive)
+  if (!pp->defaultIsPositive)
     return 1;
 
   return 0;
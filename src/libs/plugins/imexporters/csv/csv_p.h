@@ -23,6 +23,18 @@ struct AH_IMEXPORTER_CSV {
 };
 
 
+/** profile settings applied to every imported transaction, read once per import */
+typedef struct AH_IMEXPORTER_CSV_POSTPROCESS AH_IMEXPORTER_CSV_POSTPROCESS;
+struct AH_IMEXPORTER_CSV_POSTPROCESS {
+  GWEN_DB_NODE *dbParams; /* for "positiveValues" and "negativeValues" */
+  int usePosNegField;
+  int defaultIsPositive;
+  int switchLocalRemote;
+  int switchOnNegative;
+  AB_TRANSACTION_TYPE defaultType;
+};
+
+
 
 
 #endif /* AQHBCI_IMEX_CSV_P_H */
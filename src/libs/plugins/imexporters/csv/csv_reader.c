@@ -0,0 +1,736 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "csv_reader_p.h"
+
+#include "aqbanking/backendsupport/imexporter_be.h"
+
+#include <gwenhywfar/debug.h>
+#include <gwenhywfar/text.h>
+#include <gwenhywfar/gwendate.h>
+
+#include <string.h>
+#include <strings.h>
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _compileColumns(AB_CSV_READER *rd, GWEN_DB_NODE *dbColumns, const char *posNegFieldName);
+static int _compileColumn(const char *colName, int splitValueInOut);
+static int _findFieldDef(const char *name, int len);
+static int _readFieldsFromLine(AB_CSV_READER *rd, const char *s);
+static int _storeWord(AB_CSV_READER *rd);
+static const char *_getSlot(const AB_CSV_READER *rd, int fieldIdx, int slot);
+static int _hasTransactionData(const AB_CSV_READER *rd, const AB_VALUE *splitValue);
+static AB_VALUE *_readSplitValue(const AB_CSV_READER *rd);
+static AB_TRANSACTION *_createTransaction(const AB_CSV_READER *rd, const AB_VALUE *splitValue);
+static void _setFieldFromString(AB_TRANSACTION *t, const AB_CSV_FIELD_DEF *fd, const char *s, const char *dateFormat);
+static int _intFromString(const char *s);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * static vars
+ * ------------------------------------------------------------------------------------------------
+ */
+
+#define AB_CSV_FIELD_CHAR(n, fn)   {n, AB_CSV_FieldType_Char, fn, NULL, NULL, NULL, NULL}
+#define AB_CSV_FIELD_DATE(n, fn)   {n, AB_CSV_FieldType_Date, NULL, fn, NULL, NULL, NULL}
+#define AB_CSV_FIELD_VALUE(n, fn)  {n, AB_CSV_FieldType_Value, NULL, NULL, fn, NULL, NULL}
+#define AB_CSV_FIELD_INT(n, fn)    {n, AB_CSV_FieldType_Int, NULL, NULL, NULL, fn, NULL}
+#define AB_CSV_FIELD_UINT32(n, fn) {n, AB_CSV_FieldType_Uint32, NULL, NULL, NULL, NULL, fn}
+#define AB_CSV_FIELD_OTHER(n, tp)  {n, tp, NULL, NULL, NULL, NULL, NULL}
+
+
+/* members of AB_TRANSACTION as read by AB_Transaction_fromDb() */
+static const AB_CSV_FIELD_DEF _fieldDefs[]= {
+  AB_CSV_FIELD_OTHER("type", AB_CSV_FieldType_EnumType),
+  AB_CSV_FIELD_OTHER("subType", AB_CSV_FieldType_EnumSubType),
+  AB_CSV_FIELD_OTHER("command", AB_CSV_FieldType_EnumCommand),
+  AB_CSV_FIELD_OTHER("status", AB_CSV_FieldType_EnumStatus),
+  AB_CSV_FIELD_UINT32("uniqueAccountId", AB_Transaction_SetUniqueAccountId),
+  AB_CSV_FIELD_OTHER("acknowledge", AB_CSV_FieldType_EnumAcknowledge),
+  AB_CSV_FIELD_UINT32("uniqueId", AB_Transaction_SetUniqueId),
+  AB_CSV_FIELD_UINT32("refUniqueId", AB_Transaction_SetRefUniqueId),
+  AB_CSV_FIELD_UINT32("idForApplication", AB_Transaction_SetIdForApplication),
+  AB_CSV_FIELD_CHAR("stringIdForApplication", AB_Transaction_SetStringIdForApplication),
+  AB_CSV_FIELD_UINT32("sessionId", AB_Transaction_SetSessionId),
+  AB_CSV_FIELD_UINT32("groupId", AB_Transaction_SetGroupId),
+  AB_CSV_FIELD_CHAR("fiId", AB_Transaction_SetFiId),
+  AB_CSV_FIELD_CHAR("localIban", AB_Transaction_SetLocalIban),
+  AB_CSV_FIELD_CHAR("localBic", AB_Transaction_SetLocalBic),
+  AB_CSV_FIELD_CHAR("localCountry", AB_Transaction_SetLocalCountry),
+  AB_CSV_FIELD_CHAR("localBankCode", AB_Transaction_SetLocalBankCode),
+  AB_CSV_FIELD_CHAR("localBranchId", AB_Transaction_SetLocalBranchId),
+  AB_CSV_FIELD_CHAR("localAccountNumber", AB_Transaction_SetLocalAccountNumber),
+  AB_CSV_FIELD_CHAR("localSuffix", AB_Transaction_SetLocalSuffix),
+  AB_CSV_FIELD_CHAR("localName", AB_Transaction_SetLocalName),
+  AB_CSV_FIELD_CHAR("remoteCountry", AB_Transaction_SetRemoteCountry),
+  AB_CSV_FIELD_CHAR("remoteBankCode", AB_Transaction_SetRemoteBankCode),
+  AB_CSV_FIELD_CHAR("remoteBranchId", AB_Transaction_SetRemoteBranchId),
+  AB_CSV_FIELD_CHAR("remoteAccountNumber", AB_Transaction_SetRemoteAccountNumber),
+  AB_CSV_FIELD_CHAR("remoteSuffix", AB_Transaction_SetRemoteSuffix),
+  AB_CSV_FIELD_CHAR("remoteIban", AB_Transaction_SetRemoteIban),
+  AB_CSV_FIELD_CHAR("remoteBic", AB_Transaction_SetRemoteBic),
+  AB_CSV_FIELD_CHAR("remoteName", AB_Transaction_SetRemoteName),
+  AB_CSV_FIELD_DATE("date", AB_Transaction_SetDate),
+  AB_CSV_FIELD_DATE("valutaDate", AB_Transaction_SetValutaDate),
+  AB_CSV_FIELD_VALUE("value", AB_Transaction_SetValue),
+  AB_CSV_FIELD_VALUE("fees", AB_Transaction_SetFees),
+  AB_CSV_FIELD_VALUE("taxes", AB_Transaction_SetTaxes),
+  AB_CSV_FIELD_INT("transactionCode", AB_Transaction_SetTransactionCode),
+  AB_CSV_FIELD_CHAR("transactionText", AB_Transaction_SetTransactionText),
+  AB_CSV_FIELD_CHAR("transactionKey", AB_Transaction_SetTransactionKey),
+  AB_CSV_FIELD_INT("textKey", AB_Transaction_SetTextKey),
+  AB_CSV_FIELD_CHAR("primanota", AB_Transaction_SetPrimanota),
+  AB_CSV_FIELD_OTHER("purpose", AB_CSV_FieldType_Purpose),
+  AB_CSV_FIELD_CHAR("category", AB_Transaction_SetCategory),
+  AB_CSV_FIELD_CHAR("customerReference", AB_Transaction_SetCustomerReference),
+  AB_CSV_FIELD_CHAR("bankReference", AB_Transaction_SetBankReference),
+  AB_CSV_FIELD_CHAR("endToEndReference", AB_Transaction_SetEndToEndReference),
+  AB_CSV_FIELD_CHAR("ultimateCreditor", AB_Transaction_SetUltimateCreditor),
+  AB_CSV_FIELD_CHAR("ultimateDebtor", AB_Transaction_SetUltimateDebtor),
+  AB_CSV_FIELD_CHAR("creditorSchemeId", AB_Transaction_SetCreditorSchemeId),
+  AB_CSV_FIELD_CHAR("originatorId", AB_Transaction_SetOriginatorId),
+  AB_CSV_FIELD_CHAR("mandateId", AB_Transaction_SetMandateId),
+  AB_CSV_FIELD_DATE("mandateDate", AB_Transaction_SetMandateDate),
+  AB_CSV_FIELD_CHAR("mandateDebitorName", AB_Transaction_SetMandateDebitorName),
+  AB_CSV_FIELD_CHAR("originalCreditorSchemeId", AB_Transaction_SetOriginalCreditorSchemeId),
+  AB_CSV_FIELD_CHAR("originalMandateId", AB_Transaction_SetOriginalMandateId),
+  AB_CSV_FIELD_CHAR("originalCreditorName", AB_Transaction_SetOriginalCreditorName),
+  AB_CSV_FIELD_OTHER("sequence", AB_CSV_FieldType_EnumSequence),
+  AB_CSV_FIELD_OTHER("charge", AB_CSV_FieldType_EnumCharge),
+  AB_CSV_FIELD_CHAR("remoteAddrStreet", AB_Transaction_SetRemoteAddrStreet),
+  AB_CSV_FIELD_CHAR("remoteAddrZipcode", AB_Transaction_SetRemoteAddrZipcode),
+  AB_CSV_FIELD_CHAR("remoteAddrCity", AB_Transaction_SetRemoteAddrCity),
+  AB_CSV_FIELD_CHAR("remoteAddrPhone", AB_Transaction_SetRemoteAddrPhone),
+  AB_CSV_FIELD_OTHER("period", AB_CSV_FieldType_EnumPeriod),
+  AB_CSV_FIELD_UINT32("cycle", AB_Transaction_SetCycle),
+  AB_CSV_FIELD_UINT32("executionDay", AB_Transaction_SetExecutionDay),
+  AB_CSV_FIELD_DATE("firstDate", AB_Transaction_SetFirstDate),
+  AB_CSV_FIELD_DATE("lastDate", AB_Transaction_SetLastDate),
+  AB_CSV_FIELD_DATE("nextDate", AB_Transaction_SetNextDate),
+  AB_CSV_FIELD_CHAR("unitId", AB_Transaction_SetUnitId),
+  AB_CSV_FIELD_CHAR("unitIdNameSpace", AB_Transaction_SetUnitIdNameSpace),
+  AB_CSV_FIELD_CHAR("tickerSymbol", AB_Transaction_SetTickerSymbol),
+  {"units", AB_CSV_FieldType_PlainValue, NULL, NULL, AB_Transaction_SetUnits, NULL, NULL},
+  AB_CSV_FIELD_VALUE("unitPriceValue", AB_Transaction_SetUnitPriceValue),
+  AB_CSV_FIELD_DATE("unitPriceDate", AB_Transaction_SetUnitPriceDate),
+  AB_CSV_FIELD_VALUE("commissionValue", AB_Transaction_SetCommissionValue),
+  AB_CSV_FIELD_UINT32("estatementNumber", AB_Transaction_SetEstatementNumber),
+  AB_CSV_FIELD_UINT32("estatementMaxEntries", AB_Transaction_SetEstatementMaxEntries),
+  AB_CSV_FIELD_CHAR("memo", AB_Transaction_SetMemo),
+  /* not members of AB_TRANSACTION, used with "splitValueInOut" */
+  AB_CSV_FIELD_OTHER("valueIn", AB_CSV_FieldType_SplitValue),
+  AB_CSV_FIELD_OTHER("valueOut", AB_CSV_FieldType_SplitValue),
+  AB_CSV_FIELD_OTHER(NULL, AB_CSV_FieldType_Char)
+};
+
+#define AB_CSV_FIELD_COUNT ((int)(sizeof(_fieldDefs)/sizeof(_fieldDefs[0]))-1)
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AB_CSV_READER *AB_CSV_Reader_new(GWEN_DB_NODE *dbProfile)
+{
+  AB_CSV_READER *rd;
+  GWEN_DB_NODE *dbParams;
+  GWEN_DB_NODE *dbColumns;
+  const char *s;
+  int rv;
+
+  dbParams=GWEN_DB_GetGroup(dbProfile, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "params");
+  if (dbParams==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No params in profile");
+    return NULL;
+  }
+  dbColumns=GWEN_DB_GetGroup(dbParams, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "columns");
+  if (dbColumns==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No column definitions in profile");
+    return NULL;
+  }
+  if (GWEN_DB_GetIntValue(dbParams, "fixedWidth", 0, 0) || GWEN_DB_GetIntValue(dbParams, "condense", 0, 0)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Profile uses features not supported by the native reader");
+    return NULL;
+  }
+
+  GWEN_NEW_OBJECT(AB_CSV_READER, rd);
+
+  /* same defaults as used by the profile editor */
+  s=GWEN_DB_GetCharValue(dbParams, "delimiter", 0, "TAB");
+  if (strcasecmp(s, "TAB")==0)
+    s="\t";
+  else if (strcasecmp(s, "SPACE")==0)
+    s=" ";
+  rd->delimiters=strdup(s);
+  rd->wordFlags=
+    GWEN_TEXT_FLAGS_DEL_LEADING_BLANKS |
+    GWEN_TEXT_FLAGS_DEL_TRAILING_BLANKS |
+    GWEN_TEXT_FLAGS_NULL_IS_DELIMITER;
+  if (GWEN_DB_GetIntValue(dbParams, "quote", 0, 1))
+    rd->wordFlags|=GWEN_TEXT_FLAGS_DEL_QUOTES;
+  rd->ignoreLines=GWEN_DB_GetIntValue(dbParams, "ignoreLines", 0, 0);
+  if (GWEN_DB_GetIntValue(dbParams, "title", 0, 0))
+    rd->ignoreLines++;
+
+  rd->dateFormat=strdup(GWEN_DB_GetCharValue(dbProfile, "dateFormat", 0, "YYYY/MM/DD"));
+  s=GWEN_DB_GetCharValue(dbProfile, "commaThousands", 0, 0);
+  if (s)
+    rd->commaThousands=*s;
+  s=GWEN_DB_GetCharValue(dbProfile, "commaDecimal", 0, 0);
+  if (s)
+    rd->commaDecimal=*s;
+  rd->splitValueInOut=GWEN_DB_GetIntValue(dbProfile, "splitValueInOut", 0, 0);
+
+  rd->posNegColumn=-1;
+  rv=_compileColumns(rd, dbColumns, GWEN_DB_GetCharValue(dbProfile, "posNegFieldName", 0, "posNeg"));
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Column definitions not supported by the native reader (%d)", rv);
+    AB_CSV_Reader_free(rd);
+    return NULL;
+  }
+
+  rd->slotCount=AB_CSV_FIELD_COUNT*AB_CSV_READER_SLOTS_PER_FIELD;
+  rd->slotOffsets=(int *) malloc(rd->slotCount*sizeof(int));
+  rd->lineBuffer=GWEN_Buffer_new(0, 1024, 0, 1);
+  rd->wordBuffer=GWEN_Buffer_new(0, 256, 0, 1);
+  rd->rowBuffer=GWEN_Buffer_new(0, 1024, 0, 1);
+  rd->purposeBuffer=GWEN_Buffer_new(0, 256, 0, 1);
+
+  return rd;
+}
+
+
+
+void AB_CSV_Reader_free(AB_CSV_READER *rd)
+{
+  if (rd) {
+    GWEN_Buffer_free(rd->purposeBuffer);
+    GWEN_Buffer_free(rd->rowBuffer);
+    GWEN_Buffer_free(rd->wordBuffer);
+    GWEN_Buffer_free(rd->lineBuffer);
+    free(rd->slotOffsets);
+    free(rd->columnTargets);
+    free(rd->dateFormat);
+    free(rd->delimiters);
+    GWEN_FREE_OBJECT(rd);
+  }
+}
+
+
+
+int _compileColumns(AB_CSV_READER *rd, GWEN_DB_NODE *dbColumns, const char *posNegFieldName)
+{
+  GWEN_DB_NODE *dbVar;
+  int columnCount=0;
+  int i;
+
+  /* fields checked for every line */
+  rd->valueFieldIdx=_findFieldDef("value", 5);
+  rd->unitsFieldIdx=_findFieldDef("units", 5);
+  rd->valueInFieldIdx=_findFieldDef("valueIn", 7);
+  rd->valueOutFieldIdx=_findFieldDef("valueOut", 8);
+
+  /* determine number of columns (variables are named after the column number starting with 1) */
+  dbVar=GWEN_DB_GetFirstVar(dbColumns);
+  while (dbVar) {
+    i=atoi(GWEN_DB_VariableName(dbVar));
+    if (i>columnCount)
+      columnCount=i;
+    dbVar=GWEN_DB_GetNextVar(dbVar);
+  }
+  if (columnCount<1)
+    return GWEN_ERROR_NO_DATA;
+
+  rd->columnCount=columnCount;
+  rd->columnTargets=(int *) malloc(columnCount*sizeof(int));
+  memset(rd->columnTargets, 0, columnCount*sizeof(int));
+
+  dbVar=GWEN_DB_GetFirstVar(dbColumns);
+  while (dbVar) {
+    i=atoi(GWEN_DB_VariableName(dbVar));
+    if (i>0)
+      rd->columnTargets[i-1]=1;
+    dbVar=GWEN_DB_GetNextVar(dbVar);
+  }
+
+  for (i=0; i<columnCount; i++) {
+    if (rd->columnTargets[i]) {
+      char numBuf[16];
+      const char *colName;
+      int target;
+
+      snprintf(numBuf, sizeof(numBuf), "%d", i+1);
+      colName=GWEN_DB_GetCharValue(dbColumns, numBuf, 0, NULL);
+      if (colName && *colName) {
+        target=_compileColumn(colName, rd->splitValueInOut);
+        if (rd->posNegColumn<0 && posNegFieldName && strcasecmp(colName, posNegFieldName)==0)
+          rd->posNegColumn=i;
+      }
+      else
+        target=AB_CSV_READER_COLUMN_IGNORE;
+      rd->columnTargets[i]=target;
+    }
+    else
+      rd->columnTargets[i]=AB_CSV_READER_COLUMN_IGNORE;
+  }
+
+  return 0;
+}
+
+
+
+/* returns slot number or AB_CSV_READER_COLUMN_PURPOSE/_IGNORE */
+int _compileColumn(const char *colName, int splitValueInOut)
+{
+  const char *sGroupEnd;
+  const char *sIndex;
+  const AB_CSV_FIELD_DEF *fd;
+  int fieldIdx;
+  int len;
+
+  /* name of the first path element without index ("purpose[1]" -> "purpose") */
+  sGroupEnd=strchr(colName, '/');
+  len=sGroupEnd?(sGroupEnd-colName):((int)strlen(colName));
+  sIndex=memchr(colName, '[', len);
+  fieldIdx=_findFieldDef(colName, sIndex?(sIndex-colName):len);
+  if (fieldIdx<0)
+    /* not a member of AB_TRANSACTION */
+    return AB_CSV_READER_COLUMN_IGNORE;
+  fd=&_fieldDefs[fieldIdx];
+
+  if (sGroupEnd) {
+    const char *sVarName;
+
+    /* only the groups of AB_VALUE members are read ("value/value", "value/currency") */
+    if (!(fd->fieldType==AB_CSV_FieldType_Value ||
+          (fd->fieldType==AB_CSV_FieldType_SplitValue && splitValueInOut)))
+      return AB_CSV_READER_COLUMN_IGNORE;
+    if (sIndex && atoi(sIndex+1)!=0)
+      return AB_CSV_READER_COLUMN_IGNORE;
+
+    sVarName=sGroupEnd+1;
+    if (strncasecmp(sVarName, "value", 5)==0 && (sVarName[5]==0 || sVarName[5]=='['))
+      return fieldIdx*AB_CSV_READER_SLOTS_PER_FIELD+AB_CSV_READER_SLOT_VALUE;
+    if (strncasecmp(sVarName, "currency", 8)==0 && (sVarName[8]==0 || sVarName[8]=='['))
+      return fieldIdx*AB_CSV_READER_SLOTS_PER_FIELD+AB_CSV_READER_SLOT_CURRENCY;
+    return AB_CSV_READER_COLUMN_IGNORE;
+  }
+
+  if (fd->fieldType==AB_CSV_FieldType_Purpose)
+    return AB_CSV_READER_COLUMN_PURPOSE;
+  if (fd->fieldType==AB_CSV_FieldType_SplitValue)
+    return AB_CSV_READER_COLUMN_IGNORE;
+  return fieldIdx*AB_CSV_READER_SLOTS_PER_FIELD+AB_CSV_READER_SLOT_PLAIN;
+}
+
+
+
+int _findFieldDef(const char *name, int len)
+{
+  int i;
+
+  for (i=0; i<AB_CSV_FIELD_COUNT; i++) {
+    if (strncasecmp(name, _fieldDefs[i].name, len)==0 && _fieldDefs[i].name[len]==0)
+      return i;
+  }
+
+  return -1;
+}
+
+
+
+int AB_CSV_Reader_ReadTransaction(AB_CSV_READER *rd,
+                                  GWEN_FAST_BUFFER *fb,
+                                  AB_TRANSACTION **pTransaction,
+                                  const char **pPosNeg)
+{
+  for (;;) {
+    AB_VALUE *splitValue=NULL;
+    int c;
+    int rv;
+
+    GWEN_FASTBUFFER_PEEKBYTE(fb, c);
+    if (c<0) {
+      if (c!=GWEN_ERROR_EOF) {
+        DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", c);
+      }
+      return c;
+    }
+
+    GWEN_Buffer_Reset(rd->lineBuffer);
+    rv=GWEN_FastBuffer_ReadLineToBuffer(fb, rd->lineBuffer);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+
+    if (rd->ignoreLines>0) {
+      rd->ignoreLines--;
+      continue;
+    }
+
+    rv=_readFieldsFromLine(rd, GWEN_Buffer_GetStart(rd->lineBuffer));
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+
+    if (rd->splitValueInOut)
+      splitValue=_readSplitValue(rd);
+
+    if (_hasTransactionData(rd, splitValue)) {
+      *pTransaction=_createTransaction(rd, splitValue);
+      *pPosNeg=(rd->posNegOffset>=0)?(GWEN_Buffer_GetStart(rd->rowBuffer)+rd->posNegOffset):NULL;
+      AB_Value_free(splitValue);
+      return 0;
+    }
+    else {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Empty line in imported file");
+    }
+    AB_Value_free(splitValue);
+  }
+}
+
+
+
+/* splits the line like the GWEN DBIO plugin "csv" does and stores the fields used into rowBuffer */
+int _readFieldsFromLine(AB_CSV_READER *rd, const char *s)
+{
+  int col=0;
+  int i;
+
+  for (i=0; i<rd->slotCount; i++)
+    rd->slotOffsets[i]=-1;
+  rd->purposeCount=0;
+  rd->firstPurposeOffset=-1;
+  rd->posNegOffset=-1;
+  GWEN_Buffer_Reset(rd->rowBuffer);
+  GWEN_Buffer_Reset(rd->purposeBuffer);
+
+  while (*s) {
+    const char *sBegin;
+    int rv;
+
+    sBegin=s;
+    GWEN_Buffer_Reset(rd->wordBuffer);
+    rv=GWEN_Text_GetWordToBuffer(s, rd->delimiters, rd->wordBuffer, rd->wordFlags, &s);
+    if (rv) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return GWEN_ERROR_BAD_DATA;
+    }
+
+    if (col<rd->columnCount) {
+      int target;
+
+      target=rd->columnTargets[col];
+      if (target!=AB_CSV_READER_COLUMN_IGNORE || col==rd->posNegColumn) {
+        int offset;
+
+        offset=_storeWord(rd);
+        if (target>=0) {
+          /* only the first value of a variable is used */
+          if (rd->slotOffsets[target]<0)
+            rd->slotOffsets[target]=offset;
+        }
+        else if (target==AB_CSV_READER_COLUMN_PURPOSE) {
+          const char *sPurpose;
+
+          sPurpose=GWEN_Buffer_GetStart(rd->rowBuffer)+offset;
+          if (rd->purposeCount==0)
+            rd->firstPurposeOffset=offset;
+          if (rd->purposeCount<AB_CSV_READER_MAX_PURPOSE_LINES && *sPurpose) {
+            if (GWEN_Buffer_GetUsedBytes(rd->purposeBuffer))
+              GWEN_Buffer_AppendByte(rd->purposeBuffer, '\n');
+            GWEN_Buffer_AppendString(rd->purposeBuffer, sPurpose);
+          }
+          rd->purposeCount++;
+        }
+        if (col==rd->posNegColumn)
+          rd->posNegOffset=offset;
+      }
+    }
+    col++;
+
+    if (*s && strchr(rd->delimiters, *s))
+      s++;
+    else if (s==sBegin)
+      /* no progress, should not happen */
+      break;
+  }
+
+  return 0;
+}
+
+
+
+/* converts the current word to UTF-8 and appends it to rowBuffer, returns the offset of the stored word */
+int _storeWord(AB_CSV_READER *rd)
+{
+  int offset;
+  uint32_t len;
+
+  offset=GWEN_Buffer_GetUsedBytes(rd->rowBuffer);
+  len=GWEN_Buffer_GetUsedBytes(rd->wordBuffer);
+  if (len)
+    AB_ImExporter_Iso8859_1ToUtf8(GWEN_Buffer_GetStart(rd->wordBuffer), len, rd->rowBuffer);
+  GWEN_Buffer_AppendByte(rd->rowBuffer, 0);
+  return offset;
+}
+
+
+
+const char *_getSlot(const AB_CSV_READER *rd, int fieldIdx, int slot)
+{
+  int offset;
+
+  offset=rd->slotOffsets[fieldIdx*AB_CSV_READER_SLOTS_PER_FIELD+slot];
+  return (offset>=0)?(GWEN_Buffer_GetStart(rd->rowBuffer)+offset):NULL;
+}
+
+
+
+/* lines are only imported if they contain "value/value" or "units" */
+int _hasTransactionData(const AB_CSV_READER *rd, const AB_VALUE *splitValue)
+{
+  return (splitValue ||
+          _getSlot(rd, rd->valueFieldIdx, AB_CSV_READER_SLOT_VALUE) ||
+          _getSlot(rd, rd->unitsFieldIdx, AB_CSV_READER_SLOT_PLAIN));
+}
+
+
+
+/* merges "valueIn" and "valueOut" into a single value */
+AB_VALUE *_readSplitValue(const AB_CSV_READER *rd)
+{
+  AB_VALUE *v=NULL;
+  const char *sv;
+  const char *sc;
+  int fieldIdx;
+
+  fieldIdx=rd->valueInFieldIdx;
+  sv=_getSlot(rd, fieldIdx, AB_CSV_READER_SLOT_VALUE);
+  if (sv && *sv) {
+    sc=_getSlot(rd, fieldIdx, AB_CSV_READER_SLOT_CURRENCY);
+    v=AB_CSV_ValueFromString(sv, sc?sc:"EUR", rd->commaThousands, rd->commaDecimal);
+  }
+  else {
+    fieldIdx=rd->valueOutFieldIdx;
+    sv=_getSlot(rd, fieldIdx, AB_CSV_READER_SLOT_VALUE);
+    if (sv && *sv) {
+      sc=_getSlot(rd, fieldIdx, AB_CSV_READER_SLOT_CURRENCY);
+      v=AB_CSV_ValueFromString(sv, sc?sc:"EUR", rd->commaThousands, rd->commaDecimal);
+      if (v && !AB_Value_IsNegative(v))
+        /* outgoing but positive, negate */
+        AB_Value_Negate(v);
+    }
+  }
+
+  if (v) {
+    sc=_getSlot(rd, rd->valueFieldIdx, AB_CSV_READER_SLOT_CURRENCY);
+    if (sc)
+      AB_Value_SetCurrency(v, sc);
+  }
+
+  return v;
+}
+
+
+
+AB_TRANSACTION *_createTransaction(const AB_CSV_READER *rd, const AB_VALUE *splitValue)
+{
+  AB_TRANSACTION *t;
+  int i;
+
+  t=AB_Transaction_new();
+
+  /* plain variables */
+  for (i=0; i<AB_CSV_FIELD_COUNT; i++) {
+    const char *s;
+
+    s=_getSlot(rd, i, AB_CSV_READER_SLOT_PLAIN);
+    if (s)
+      _setFieldFromString(t, &_fieldDefs[i], s, rd->dateFormat);
+  }
+
+  /* values given as groups (e.g. "value/value" and "value/currency") */
+  for (i=0; i<AB_CSV_FIELD_COUNT; i++) {
+    const AB_CSV_FIELD_DEF *fd;
+
+    fd=&_fieldDefs[i];
+    if (fd->fieldType==AB_CSV_FieldType_Value) {
+      const char *sv;
+
+      sv=_getSlot(rd, i, AB_CSV_READER_SLOT_VALUE);
+      if (sv) {
+        const char *sc;
+        AB_VALUE *v;
+
+        sc=_getSlot(rd, i, AB_CSV_READER_SLOT_CURRENCY);
+        v=AB_CSV_ValueFromString(sv, sc?sc:"EUR", rd->commaThousands, rd->commaDecimal);
+        fd->setValueFn(t, v);
+        AB_Value_free(v);
+      }
+    }
+  }
+  if (splitValue)
+    AB_Transaction_SetValue(t, splitValue);
+
+  /* purpose */
+  if (rd->purposeCount>1)
+    AB_Transaction_SetPurpose(t, GWEN_Buffer_GetUsedBytes(rd->purposeBuffer)?GWEN_Buffer_GetStart(rd->purposeBuffer):NULL);
+  else if (rd->purposeCount==1)
+    AB_Transaction_SetPurpose(t, GWEN_Buffer_GetStart(rd->rowBuffer)+rd->firstPurposeOffset);
+
+  return t;
+}
+
+
+
+void _setFieldFromString(AB_TRANSACTION *t, const AB_CSV_FIELD_DEF *fd, const char *s, const char *dateFormat)
+{
+  switch (fd->fieldType) {
+  case AB_CSV_FieldType_Char:
+    fd->setCharFn(t, s);
+    break;
+
+  case AB_CSV_FieldType_Date: {
+    GWEN_DATE *dt;
+
+    dt=GWEN_Date_fromStringWithTemplate(s, dateFormat);
+    if (dt==NULL)
+      dt=GWEN_Date_fromString(s);
+    if (dt) {
+      fd->setDateFn(t, dt);
+      GWEN_Date_free(dt);
+    }
+    break;
+  }
+
+  case AB_CSV_FieldType_Value:
+  case AB_CSV_FieldType_PlainValue: {
+    AB_VALUE *v;
+
+    v=AB_Value_fromString(s);
+    fd->setValueFn(t, v);
+    AB_Value_free(v);
+    break;
+  }
+
+  case AB_CSV_FieldType_Int:
+    fd->setIntFn(t, _intFromString(s));
+    break;
+  case AB_CSV_FieldType_Uint32:
+    fd->setUint32Fn(t, (uint32_t) _intFromString(s));
+    break;
+
+  case AB_CSV_FieldType_EnumType:
+    AB_Transaction_SetType(t, AB_Transaction_Type_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumSubType:
+    AB_Transaction_SetSubType(t, AB_Transaction_SubType_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumCommand:
+    AB_Transaction_SetCommand(t, AB_Transaction_Command_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumStatus:
+    AB_Transaction_SetStatus(t, AB_Transaction_Status_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumAcknowledge:
+    AB_Transaction_SetAcknowledge(t, AB_Transaction_Ack_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumSequence:
+    AB_Transaction_SetSequence(t, AB_Transaction_Sequence_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumCharge:
+    AB_Transaction_SetCharge(t, AB_Transaction_Charge_fromString(s));
+    break;
+  case AB_CSV_FieldType_EnumPeriod:
+    AB_Transaction_SetPeriod(t, AB_Transaction_Period_fromString(s));
+    break;
+
+  case AB_CSV_FieldType_Purpose:
+  case AB_CSV_FieldType_SplitValue:
+    /* handled elsewhere */
+    break;
+  }
+}
+
+
+
+/* same as GWEN_DB_GetIntValue() does for char values */
+int _intFromString(const char *s)
+{
+  int i;
+
+  if (sscanf(s, "%d", &i)!=1)
+    return 0;
+  return i;
+}
+
+
+
+AB_VALUE *AB_CSV_ValueFromString(const char *sv, const char *sc, int commaThousands, int commaDecimal)
+{
+  char localBuf[64];
+  char *cbuf=NULL;
+  AB_VALUE *val;
+
+  if (sv && (commaThousands || commaDecimal)) {
+    const char *pSrc;
+    char *pDst;
+    int len;
+
+    len=strlen(sv);
+    if (len<(int)sizeof(localBuf))
+      pDst=localBuf;
+    else {
+      cbuf=(char *) malloc(len+1);
+      pDst=cbuf;
+    }
+    pSrc=sv;
+    sv=pDst;
+
+    /* copy all but thousands commas to new buffer */
+    while (*pSrc) {
+      if (commaThousands && *pSrc==commaThousands) {
+        /* skip thousands comma */
+      }
+      else if (commaDecimal && *pSrc==commaDecimal)
+        /* replace whatever is given by a recognizable decimal point */
+        *(pDst++)='.';
+      else
+        *(pDst++)=*pSrc;
+      pSrc++;
+    }
+    /* add trailing 0 to end the string */
+    *pDst=0;
+  }
+
+  val=AB_Value_fromString(sv);
+  if (cbuf)
+    free(cbuf);
+  if (val && sc)
+    AB_Value_SetCurrency(val, sc);
+
+  return val;
+}
+
+
@@ -0,0 +1,68 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AB_CSV_READER_L_H
+#define AB_CSV_READER_L_H
+
+
+#include <aqbanking/types/transaction.h>
+#include <aqbanking/types/value.h>
+
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/fastbuffer.h>
+
+
+/**
+ * Reader for CSV files which creates transactions directly from the lines of a CSV file
+ * without creating a GWEN_DB for the whole file (as the GWEN DBIO plugin "csv" does).
+ *
+ * The column mapping of the profile (group "params/columns") is compiled once into a table
+ * which maps every column to a field of AB_TRANSACTION.
+ */
+typedef struct AB_CSV_READER AB_CSV_READER;
+
+
+/**
+ * Compiles the given profile.
+ * @return reader object or NULL if the profile uses features not supported by this reader
+ *   (the caller should use the GWEN DBIO plugin in that case)
+ * @param dbProfile import profile (containing the group "params")
+ */
+AB_CSV_READER *AB_CSV_Reader_new(GWEN_DB_NODE *dbProfile);
+
+void AB_CSV_Reader_free(AB_CSV_READER *rd);
+
+/**
+ * Reads lines until a transaction has been read. Lines without a value (like empty lines) are skipped.
+ * Post-processing according to the profile which doesn't depend on the column mapping (like sign
+ * handling or switching local and remote names) is left to the caller.
+ * @return 0 if ok, GWEN_ERROR_EOF if there are no more transactions, error code otherwise
+ * @param rd reader object
+ * @param fb fast buffer to read lines from
+ * @param pTransaction pointer to receive the transaction read (to be freed by the caller)
+ * @param pPosNeg pointer to receive the content of the positive/negative marker column (or NULL),
+ *   valid until the next call to this function
+ */
+int AB_CSV_Reader_ReadTransaction(AB_CSV_READER *rd,
+                                  GWEN_FAST_BUFFER *fb,
+                                  AB_TRANSACTION **pTransaction,
+                                  const char **pPosNeg);
+
+
+/**
+ * Creates a value from a string which might use special characters as thousands and decimal comma.
+ * @param sv value string
+ * @param sc currency (or NULL)
+ * @param commaThousands character used to separate thousands (0 for none)
+ * @param commaDecimal character used as decimal comma (0 if it is the decimal point)
+ */
+AB_VALUE *AB_CSV_ValueFromString(const char *sv, const char *sc, int commaThousands, int commaDecimal);
+
+
+
+#endif
+
@@ -0,0 +1,99 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+#ifndef AB_CSV_READER_P_H
+#define AB_CSV_READER_P_H
+
+
+#include "csv_reader_l.h"
+
+#include <gwenhywfar/buffer.h>
+
+
+/* special column targets (other targets are slot numbers) */
+#define AB_CSV_READER_COLUMN_IGNORE  (-1)
+#define AB_CSV_READER_COLUMN_PURPOSE (-2)
+
+/* every field has 3 slots: plain variable ("value"), and for values "value/value" and "value/currency" */
+#define AB_CSV_READER_SLOTS_PER_FIELD 3
+#define AB_CSV_READER_SLOT_PLAIN      0
+#define AB_CSV_READER_SLOT_VALUE      1
+#define AB_CSV_READER_SLOT_CURRENCY   2
+
+#define AB_CSV_READER_MAX_PURPOSE_LINES 99
+
+
+typedef enum {
+  AB_CSV_FieldType_Char=0,
+  AB_CSV_FieldType_Date,
+  AB_CSV_FieldType_Value,
+  AB_CSV_FieldType_PlainValue,
+  AB_CSV_FieldType_SplitValue,
+  AB_CSV_FieldType_Int,
+  AB_CSV_FieldType_Uint32,
+  AB_CSV_FieldType_Purpose,
+  AB_CSV_FieldType_EnumType,
+  AB_CSV_FieldType_EnumSubType,
+  AB_CSV_FieldType_EnumCommand,
+  AB_CSV_FieldType_EnumStatus,
+  AB_CSV_FieldType_EnumAcknowledge,
+  AB_CSV_FieldType_EnumSequence,
+  AB_CSV_FieldType_EnumCharge,
+  AB_CSV_FieldType_EnumPeriod
+} AB_CSV_FIELDTYPE;
+
+
+typedef struct AB_CSV_FIELD_DEF AB_CSV_FIELD_DEF;
+struct AB_CSV_FIELD_DEF {
+  const char *name;
+  AB_CSV_FIELDTYPE fieldType;
+  void (*setCharFn)(AB_TRANSACTION *t, const char *s);
+  void (*setDateFn)(AB_TRANSACTION *t, const GWEN_DATE *dt);
+  void (*setValueFn)(AB_TRANSACTION *t, const AB_VALUE *v);
+  void (*setIntFn)(AB_TRANSACTION *t, int i);
+  void (*setUint32Fn)(AB_TRANSACTION *t, uint32_t i);
+};
+
+
+struct AB_CSV_READER {
+  /* compiled profile */
+  char *delimiters;
+  uint32_t wordFlags;
+  int ignoreLines;
+  char *dateFormat;
+  int commaThousands;
+  int commaDecimal;
+  int splitValueInOut;
+
+  int *columnTargets;
+  int columnCount;
+  int posNegColumn;
+
+  /* indices into the field definitions of fields checked for every line */
+  int valueFieldIdx;
+  int unitsFieldIdx;
+  int valueInFieldIdx;
+  int valueOutFieldIdx;
+
+  /* work buffers */
+  GWEN_BUFFER *lineBuffer;
+  GWEN_BUFFER *wordBuffer;
+  GWEN_BUFFER *rowBuffer;
+  GWEN_BUFFER *purposeBuffer;
+
+  /* data of the current line (offsets into rowBuffer, -1 if not set) */
+  int *slotOffsets;
+  int slotCount;
+  int purposeCount;
+  int firstPurposeOffset;
+  int posNegOffset;
+};
+
+
+
+#endif
+
@@ -15,6 +15,7 @@
 
 #include "aqbanking/i18n_l.h"
 #include <aqbanking/banking.h>
+#include "aqbanking/types/imexporter_context_bin_l.h"
 
 #include <gwenhywfar/debug.h>
 #include <gwenhywfar/misc.h>
@@ -60,6 +61,7 @@ int AH_ImExporterCtxFile_Import(AB_IMEXPORTER *ie,
                                 GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_CTXFILE *ieh;
+  GWEN_BUFFER *dataBuf;
   GWEN_DB_NODE *dbData;
   int rv;
 
@@ -67,11 +69,38 @@ int AH_ImExporterCtxFile_Import(AB_IMEXPORTER *ie,
   ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AH_IMEXPORTER_CTXFILE, ie);
   assert(ieh);
 
+  dataBuf=GWEN_Buffer_new(0, 1024, 0, 1);
+  rv=AB_ImExporterContext_ReadAll(sio, dataBuf);
+  if (rv<0) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading data (%d)", rv);
+    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                         "Error reading data");
+    GWEN_Buffer_free(dataBuf);
+    return rv;
+  }
+
+  if (AB_ImExporterContext_IsBinary((const uint8_t *) GWEN_Buffer_GetStart(dataBuf), GWEN_Buffer_GetUsedBytes(dataBuf))) {
+    /* binary context file, already UTF-8 */
+    rv=AB_ImExporterContext_ReadBinary(ctx,
+                                       (const uint8_t *) GWEN_Buffer_GetStart(dataBuf),
+                                       GWEN_Buffer_GetUsedBytes(dataBuf));
+    GWEN_Buffer_free(dataBuf);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error importing binary data (%d)", rv);
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                           "Error importing data");
+      return rv;
+    }
+    return 0;
+  }
+
   dbData=GWEN_DB_Group_new("context");
-  rv=GWEN_DB_ReadFromIo(dbData,
-                        sio,
-                        GWEN_DB_FLAGS_DEFAULT |
-                        GWEN_PATH_FLAGS_CREATE_GROUP);
+  rv=GWEN_DB_ReadFromString(dbData,
+                            GWEN_Buffer_GetStart(dataBuf),
+                            GWEN_Buffer_GetUsedBytes(dataBuf),
+                            GWEN_DB_FLAGS_DEFAULT |
+                            GWEN_PATH_FLAGS_CREATE_GROUP);
+  GWEN_Buffer_free(dataBuf);
   if (rv) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error importing data (%d)", rv);
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
@@ -140,6 +169,26 @@ int AH_ImExporterCtxFile_Export(AB_IMEXPORTER *ie,
     return GWEN_ERROR_GENERIC;
   }
 
+  if (GWEN_DB_GetIntValue(params, "binary", 0, 0)) {
+    GWEN_BUFFER *dataBuf;
+
+    dataBuf=GWEN_Buffer_new(0, 4096, 0, 1);
+    rv=AB_ImExporterContext_WriteBinary(ctx, dataBuf);
+    if (rv==0)
+      rv=GWEN_SyncIo_WriteForced(sio,
+                                 (const uint8_t *) GWEN_Buffer_GetStart(dataBuf),
+                                 GWEN_Buffer_GetUsedBytes(dataBuf));
+    GWEN_Buffer_free(dataBuf);
+    GWEN_DB_Group_free(dbData);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error exporting binary data (%d)", rv);
+      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                           "Error exporting data");
+      return rv;
+    }
+    return 0;
+  }
+
   rv=GWEN_DB_WriteToIo(dbData, sio, GWEN_DB_FLAGS_DEFAULT);
   if (rv) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error exporting data (%d)", rv);
@@ -38,4 +38,5 @@ static int AH_ImExporterCtxFile_Export(AB_IMEXPORTER *ie,
 static int AH_ImExporterCtxFile_CheckFile(AB_IMEXPORTER *ie, const char *fname);
 
 
+
 #endif /* AQHBCI_IMEX_CTXFILE_P_H */
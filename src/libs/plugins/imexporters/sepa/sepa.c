@@ -60,6 +60,108 @@ static void AH_ImExporter_Sepa_PmtInf_free(AH_IMEXPORTER_SEPA_PMTINF *pmtinf)
 
 
 
+static AH_IMEXPORTER_SEPA_PMTINF_INDEX *AH_ImExporter_Sepa_PmtInfIndex_new(void)
+{
+  AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx;
+
+  GWEN_NEW_OBJECT(AH_IMEXPORTER_SEPA_PMTINF_INDEX, idx);
+  idx->slotCount=16;
+  idx->slots=(AH_IMEXPORTER_SEPA_PMTINF **) calloc(idx->slotCount, sizeof(AH_IMEXPORTER_SEPA_PMTINF *));
+  assert(idx->slots);
+
+  return idx;
+}
+
+
+
+static void AH_ImExporter_Sepa_PmtInfIndex_free(AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx)
+{
+  if (idx) {
+    /* the blocks themselves belong to the PmtInf list */
+    free(idx->slots);
+    GWEN_FREE_OBJECT(idx);
+  }
+}
+
+
+
+static void AH_ImExporter_Sepa_PmtInfIndex_Add(AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx, AH_IMEXPORTER_SEPA_PMTINF *pmtinf)
+{
+  uint32_t pos;
+
+  /* keep the table at most half full */
+  if ((idx->usedCount+1)*2>idx->slotCount) {
+    AH_IMEXPORTER_SEPA_PMTINF **oldSlots;
+    uint32_t oldSlotCount;
+    uint32_t i;
+
+    oldSlots=idx->slots;
+    oldSlotCount=idx->slotCount;
+    idx->slotCount*=2;
+    idx->slots=(AH_IMEXPORTER_SEPA_PMTINF **) calloc(idx->slotCount, sizeof(AH_IMEXPORTER_SEPA_PMTINF *));
+    assert(idx->slots);
+    for (i=0; i<oldSlotCount; i++) {
+      if (oldSlots[i]) {
+        pos=oldSlots[i]->hash & (idx->slotCount-1);
+        while (idx->slots[pos])
+          pos=(pos+1) & (idx->slotCount-1);
+        idx->slots[pos]=oldSlots[i];
+      }
+    }
+    free(oldSlots);
+  }
+
+  pos=pmtinf->hash & (idx->slotCount-1);
+  while (idx->slots[pos])
+    pos=(pos+1) & (idx->slotCount-1);
+  idx->slots[pos]=pmtinf;
+  idx->usedCount++;
+}
+
+
+
+static uint32_t _hashString(uint32_t h, const char *s)
+{
+  if (s) {
+    while (*s) {
+      h^=(uint8_t) *s;
+      h*=16777619u;
+      s++;
+    }
+  }
+  /* separator, so that ("ab", "c") and ("a", "bc") differ */
+  h^=0xff;
+  h*=16777619u;
+  return h;
+}
+
+
+
+static uint32_t AH_ImExporter_Sepa_PmtInf_Hash(uint32_t transDate,
+                                               const char *localName,
+                                               const char *localIban,
+                                               const char *localBic,
+                                               AB_TRANSACTION_SEQUENCE sequenceType,
+                                               const char *creditorSchemeId)
+{
+  uint32_t h=2166136261u;
+  int i;
+
+  for (i=0; i<4; i++) {
+    h^=(transDate>>(i*8)) & 0xff;
+    h*=16777619u;
+  }
+  h^=(uint32_t) sequenceType;
+  h*=16777619u;
+  h=_hashString(h, localName);
+  h=_hashString(h, localIban);
+  h=_hashString(h, localBic);
+  h=_hashString(h, creditorSchemeId);
+  return h;
+}
+
+
+
 AB_IMEXPORTER *AB_ImExporterSEPA_new(AB_BANKING *ab)
 {
   AB_IMEXPORTER *ie;
@@ -108,19 +210,17 @@ int AH_ImExporterSEPA_Import(AB_IMEXPORTER *ie,
 
 static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
                                                AB_IMEXPORTER_CONTEXT *ctx,
-                                               GWEN_XMLNODE *painNode,
                                                uint32_t doctype[],
+                                               GWEN_DB_NODE *params,
                                                AH_IMEXPORTER_SEPA_PMTINF_LIST **pList)
 {
-  GWEN_XMLNODE *n;
   AB_IMEXPORTER_ACCOUNTINFO *ai;
   AB_TRANSACTION *t;
   AH_IMEXPORTER_SEPA_PMTINF_LIST *pl;
+  AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx;
   AH_IMEXPORTER_SEPA_PMTINF *pmtinf;
   int tcount=0;
-  AB_VALUE *v;
   GWEN_BUFFER *tbuf;
-  char *ctrlsum;
 
   ai=AB_ImExporterContext_GetFirstAccountInfo(ctx);
   if (ai==0) {
@@ -139,18 +239,34 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     return GWEN_ERROR_NO_DATA;
   }
 
+  if (doctype[0]==8 && !(doctype[1]==1 && doctype[2]==1)) {
+    const char *s;
+
+    s=GWEN_DB_GetCharValue(params, "LocalInstrumentSEPACode", 0, "CORE");
+    if (!((doctype[1]>=3 && !strcmp(s, "COR1")) || /* new in 008.003.02 */
+          !strcmp(s, "CORE") ||
+          !strcmp(s, "B2B"))) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN,
+                "Invalid Local InstrumentCode");
+      return GWEN_ERROR_BAD_DATA;
+    }
+  }
+
   /* collect matching transactions for storage in a shared PmtInf block */
   pl=AH_ImExporter_Sepa_PmtInf_List_new();
+  idx=AH_ImExporter_Sepa_PmtInfIndex_new();
   pmtinf=AH_ImExporter_Sepa_PmtInf_new();
   AH_ImExporter_Sepa_PmtInf_List_Add(pmtinf, pl);
   while (t) {
     const GWEN_DATE *da;
     int day, month, year;
     uint32_t transDate;
+    uint32_t hash;
     const char *name=NULL, *iban=NULL, *bic=NULL, *cdtrSchmeId=NULL;
     AB_TRANSACTION_SEQUENCE sequenceType=AB_Transaction_SequenceUnknown;
     const char *s;
     const AB_VALUE *tv;
+    int rv;
 
     tcount++;
     da=AB_Transaction_GetDate(t);
@@ -168,6 +284,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       if (!name || !*name) {
         DBG_ERROR(AQBANKING_LOGDOMAIN,
                   "Missing local name in transaction %d", tcount);
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
         AH_ImExporter_Sepa_PmtInf_List_free(pl);
         return GWEN_ERROR_BAD_DATA;
       }
@@ -178,6 +295,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       if (!iban || !*iban) {
         DBG_ERROR(AQBANKING_LOGDOMAIN,
                   "Missing local IBAN in transaction %d", tcount);
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
         AH_ImExporter_Sepa_PmtInf_List_free(pl);
         return GWEN_ERROR_BAD_DATA;
       }
@@ -189,6 +307,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       if (!bic || !*bic) {
         DBG_ERROR(AQBANKING_LOGDOMAIN,
                   "Missing local BIC in transaction %d", tcount);
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
         AH_ImExporter_Sepa_PmtInf_List_free(pl);
         return GWEN_ERROR_BAD_DATA;
       }
@@ -199,6 +318,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       if (sequenceType==AB_Transaction_SequenceUnknown) {
         DBG_ERROR(AQBANKING_LOGDOMAIN,
                   "Missing sequence type in transaction %d", tcount);
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
         AH_ImExporter_Sepa_PmtInf_List_free(pl);
         return GWEN_ERROR_BAD_DATA;
       }
@@ -206,15 +326,37 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
       if (!cdtrSchmeId || !*cdtrSchmeId) {
         DBG_ERROR(AQBANKING_LOGDOMAIN,
                   "Missing creditor scheme id in transaction %d", tcount);
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
         AH_ImExporter_Sepa_PmtInf_List_free(pl);
         return GWEN_ERROR_BAD_DATA;
       }
     }
 
+    /* the document is written while walking the PmtInf blocks, so check everything beforehand */
+    if (doctype[0]==8)
+      rv=AH_ImExporterSEPA_Export_Pain_008_CheckTransaction(t, doctype, tcount);
+    else
+      rv=AH_ImExporterSEPA_Export_Pain_001_CheckTransaction(t, doctype, tcount);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      AH_ImExporter_Sepa_PmtInfIndex_free(idx);
+      AH_ImExporter_Sepa_PmtInf_List_free(pl);
+      return rv;
+    }
+
+    /* blocks with the same match criteria have the same hash */
+    hash=AH_ImExporter_Sepa_PmtInf_Hash(transDate,
+                                        name ? name : AB_ImExporterAccountInfo_GetOwner(ai),
+                                        iban ? iban : AB_ImExporterAccountInfo_GetIban(ai),
+                                        bic  ? bic  : AB_ImExporterAccountInfo_GetBic(ai),
+                                        sequenceType,
+                                        cdtrSchmeId);
+
     if (pmtinf->tcount) {
       /* specify list of match criteria in one place */
 #define TRANSACTION_DOES_NOT_MATCH          \
-      (transDate!=pmtinf->transDate ||          \
+      (hash!=pmtinf->hash ||            \
+       transDate!=pmtinf->transDate ||          \
        (name && strcmp(name, pmtinf->localName)) ||     \
        (iban && strcmp(iban, pmtinf->localIban)) ||     \
        (bic && strcmp(bic, pmtinf->localBic)) ||      \
@@ -224,10 +366,15 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
 
       /* match against current PmtInf block */
       if (TRANSACTION_DOES_NOT_MATCH) {
-        /* search for a fitting PmtInf block */
-        pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
-        while (pmtinf && TRANSACTION_DOES_NOT_MATCH)
-          pmtinf=AH_ImExporter_Sepa_PmtInf_List_Next(pmtinf);
+        uint32_t pos;
+
+        /* search for a fitting PmtInf block in the index */
+        pos=hash & (idx->slotCount-1);
+        pmtinf=idx->slots[pos];
+        while (pmtinf && TRANSACTION_DOES_NOT_MATCH) {
+          pos=(pos+1) & (idx->slotCount-1);
+          pmtinf=idx->slots[pos];
+        }
 #undef TRANSACTION_DOES_NOT_MATCH
 
         if (!pmtinf) {
@@ -248,6 +395,16 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
         pmtinf->sequenceType=sequenceType;
         pmtinf->creditorSchemeId=cdtrSchmeId;
       }
+      pmtinf->hash=hash;
+      AH_ImExporter_Sepa_PmtInfIndex_Add(idx, pmtinf);
+
+      /* BIC not required since 001.003.03/008.003.02, but before it always is */
+      if (doctype[1]<3 && !(pmtinf->localBic && *pmtinf->localBic)) {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "No local BIC, but is required");
+        AH_ImExporter_Sepa_PmtInfIndex_free(idx);
+        AH_ImExporter_Sepa_PmtInf_List_free(pl);
+        return GWEN_ERROR_BAD_DATA;
+      }
     }
 
     AB_Transaction_List2_PushBack(pmtinf->transactions, t);
@@ -256,6 +413,7 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     if (tv==NULL) {
       DBG_ERROR(AQBANKING_LOGDOMAIN,
                 "Missing value in transaction %d", tcount);
+      AH_ImExporter_Sepa_PmtInfIndex_free(idx);
       AH_ImExporter_Sepa_PmtInf_List_free(pl);
       return GWEN_ERROR_BAD_DATA;
     }
@@ -263,9 +421,9 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
 
     t=AB_Transaction_List_Next(t);
   }
+  AH_ImExporter_Sepa_PmtInfIndex_free(idx);
 
-  /* construct CtrlSum for PmtInf blocks and GrpHdr */
-  v=AB_Value_new();
+  /* construct CtrlSum for PmtInf blocks */
   tbuf=GWEN_Buffer_new(0, 64, 0, 1);
   pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
   while (pmtinf) {
@@ -273,66 +431,82 @@ static int AH_ImExporterSEPA_Export_Pain_Setup(AB_IMEXPORTER *ie,
     pmtinf->ctrlsum=strdup(GWEN_Buffer_GetStart(tbuf));
     assert(pmtinf->ctrlsum);
     GWEN_Buffer_Reset(tbuf);
-    AB_Value_AddValue(v, pmtinf->value);
     pmtinf=AH_ImExporter_Sepa_PmtInf_List_Next(pmtinf);
   }
+  GWEN_Buffer_free(tbuf);
 
-  AB_Value_toHumanReadableString(v, tbuf, 2, 0);
-  ctrlsum=strdup(GWEN_Buffer_GetStart(tbuf));
-  assert(ctrlsum);
+  *pList=pl;
+  return 0;
+}
+
+
+
+static void AH_ImExporterSEPA_Export_AddUniqueId(AB_IMEXPORTER *ie,
+                                                 AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                 const char *name)
+{
+  GWEN_TIME *ti;
+  GWEN_BUFFER *tbuf;
+  uint32_t uid;
+  char numbuf[32];
+
+  ti=GWEN_CurrentTime();
+  tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+
+  uid=AB_Banking_GetNamedUniqueId(AB_ImExporter_GetBanking(ie), "sepamsg", 1);
+  GWEN_Time_toUtcString(ti, "YYYYMMDD-hh:mm:ss-", tbuf);
+  snprintf(numbuf, sizeof(numbuf)-1, "%08x", uid);
+  GWEN_Buffer_AppendString(tbuf, numbuf);
+  AH_ImExporterSEPA_XmlWriter_AddElement(xw, name, NULL, NULL, GWEN_Buffer_GetStart(tbuf));
   GWEN_Buffer_free(tbuf);
-  AB_Value_free(v);
-
-  /* create GrpHdr */
-  n=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "GrpHdr");
-  if (n) {
-    GWEN_TIME *ti;
-    uint32_t uid;
-    char numbuf[32];
-    GWEN_XMLNODE *nn;
-
-    GWEN_XMLNode_AddChild(painNode, n);
-    ti=GWEN_CurrentTime();
-
-    tbuf=GWEN_Buffer_new(0, 64, 0, 1);
-
-    /* generate MsgId */
-    uid=AB_Banking_GetNamedUniqueId(AB_ImExporter_GetBanking(ie), "sepamsg", 1);
-    GWEN_Time_toUtcString(ti, "YYYYMMDD-hh:mm:ss-", tbuf);
-    snprintf(numbuf, sizeof(numbuf)-1, "%08x", uid);
-    GWEN_Buffer_AppendString(tbuf, numbuf);
-    GWEN_XMLNode_SetCharValue(n, "MsgId", GWEN_Buffer_GetStart(tbuf));
-    GWEN_Buffer_Reset(tbuf);
+  GWEN_Time_free(ti);
+}
 
-    /* generate CreDtTm */
-    GWEN_Time_toUtcString(ti, "YYYY-MM-DDThh:mm:ssZ", tbuf);
-    GWEN_XMLNode_SetCharValue(n, "CreDtTm", GWEN_Buffer_GetStart(tbuf));
-    GWEN_Time_free(ti);
-    GWEN_Buffer_free(tbuf);
 
-    /* store NbOfTxs */
-    GWEN_XMLNode_SetIntValue(n, "NbOfTxs", tcount);
-#if 0
-    /* store CtrlSum */
-    GWEN_XMLNode_SetCharValue(n, "CtrlSum", ctrlsum);
-#endif
 
-    /* special treatment for pain.001.001.02 and pain.008.001.01 */
-    if (doctype[1]==1 && ((doctype[0]==1 && doctype[2]==2) ||
-                          (doctype[0]==8 && doctype[2]==1)))
-      GWEN_XMLNode_SetCharValue(n, "Grpg", "GRPD");
+static void AH_ImExporterSEPA_Export_Pain_GrpHdr(AB_IMEXPORTER *ie,
+                                                 AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                 AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
+                                                 uint32_t doctype[])
+{
+  AH_IMEXPORTER_SEPA_PMTINF *pmtinf;
+  GWEN_TIME *ti;
+  GWEN_BUFFER *tbuf;
+  int tcount=0;
 
-    nn=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "InitgPty");
-    if (nn) {
-      GWEN_XMLNode_AddChild(n, nn);
-      pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
-      AH_ImExporterSEPA_XmlSetCharValueEscaped(nn, "Nm", pmtinf->localName);
-    }
+  pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
+  while (pmtinf) {
+    tcount+=pmtinf->tcount;
+    pmtinf=AH_ImExporter_Sepa_PmtInf_List_Next(pmtinf);
   }
-  free(ctrlsum);
 
-  *pList=pl;
-  return 0;
+  AH_ImExporterSEPA_XmlWriter_StartElement(xw, "GrpHdr", NULL, NULL);
+
+  /* generate MsgId */
+  AH_ImExporterSEPA_Export_AddUniqueId(ie, xw, "MsgId");
+
+  /* generate CreDtTm */
+  ti=GWEN_CurrentTime();
+  tbuf=GWEN_Buffer_new(0, 64, 0, 1);
+  GWEN_Time_toUtcString(ti, "YYYY-MM-DDThh:mm:ssZ", tbuf);
+  AH_ImExporterSEPA_XmlWriter_AddElement(xw, "CreDtTm", NULL, NULL, GWEN_Buffer_GetStart(tbuf));
+  GWEN_Buffer_free(tbuf);
+  GWEN_Time_free(ti);
+
+  /* store NbOfTxs */
+  AH_ImExporterSEPA_XmlWriter_AddIntElement(xw, "NbOfTxs", tcount);
+
+  /* special treatment for pain.001.001.02 and pain.008.001.01 */
+  if (doctype[1]==1 && ((doctype[0]==1 && doctype[2]==2) ||
+                        (doctype[0]==8 && doctype[2]==1)))
+    AH_ImExporterSEPA_XmlWriter_AddElement(xw, "Grpg", NULL, NULL, "GRPD");
+
+  AH_ImExporterSEPA_XmlWriter_StartElement(xw, "InitgPty", NULL, NULL);
+  pmtinf=AH_ImExporter_Sepa_PmtInf_List_First(pl);
+  AH_ImExporterSEPA_XmlWriter_AddElement(xw, "Nm", NULL, NULL, pmtinf->localName);
+  AH_ImExporterSEPA_XmlWriter_EndElement(xw, "InitgPty");
+
+  AH_ImExporterSEPA_XmlWriter_EndElement(xw, "GrpHdr");
 }
 
 
@@ -343,11 +517,11 @@ int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
                              GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_SEPA *ieh;
-  GWEN_XMLNODE *root;
-  GWEN_XMLNODE *documentNode;
-  GWEN_XMLNODE *topNode;
-  GWEN_XMLNODE *n;
+  AH_IMEXPORTER_SEPA_PMTINF_LIST *pl;
+  AH_IMEXPORTER_SEPA_XMLWRITER *xw;
   uint32_t doctype[]= {0, 0, 0};
+  const char *xmlns;
+  const char *topName;
   const char *s;
   int rv;
 
@@ -378,69 +552,65 @@ int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
       doctype[0]=0;
   }
 
-  root=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "root");
-  n=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "?xml");
-  if (n) {
-    GWEN_XMLNode_AddHeader(root, n);
-    GWEN_XMLNode_SetProperty(n, "version", "1.0");
-    GWEN_XMLNode_SetProperty(n, "encoding", "UTF-8");
-  }
-
-  documentNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "Document");
-  s=GWEN_DB_GetCharValue(params, "xmlns", 0, 0);
-  if (!s || !*s) {
+  xmlns=GWEN_DB_GetCharValue(params, "xmlns", 0, 0);
+  if (!xmlns || !*xmlns) {
     DBG_ERROR(AQBANKING_LOGDOMAIN,
               "xmlns not specified in profile \"%s\"",
               GWEN_DB_GetCharValue(params, "name", 0, 0));
-    GWEN_XMLNode_free(root);
     return GWEN_ERROR_INVALID;
   }
-  GWEN_XMLNode_SetProperty(documentNode, "xmlns", s);
-  GWEN_XMLNode_AddChild(root, documentNode);
 
   switch (doctype[0]) {
   case 1:
     if (doctype[1]>1 || doctype[2]>2)
-      s="CstmrCdtTrfInitn";
+      topName="CstmrCdtTrfInitn";
     else
-      s=strstr(s, "pain");
-    topNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, s);
-    GWEN_XMLNode_AddChild(documentNode, topNode);
-    rv=AH_ImExporterSEPA_Export_Pain_001(ie, ctx, topNode, doctype, params);
+      topName=strstr(xmlns, "pain");
     break;
   case 8:
     if (!(doctype[1]==1 && doctype[2]==1))
-      s="CstmrDrctDbtInitn";
+      topName="CstmrDrctDbtInitn";
     else
-      s=strstr(s, "pain");
-    topNode=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, s);
-    GWEN_XMLNode_AddChild(documentNode, topNode);
-    rv=AH_ImExporterSEPA_Export_Pain_008(ie, ctx, topNode, doctype, params);
+      topName=strstr(xmlns, "pain");
     break;
   default:
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Unknown SEPA type \"%s\"",
               GWEN_DB_GetCharValue(params, "type", 0, 0));
-    GWEN_XMLNode_free(root);
     return GWEN_ERROR_INVALID;
   }
 
-  if (rv==0) {
-    GWEN_XML_CONTEXT *xmlctx;
+  /* group transactions into PmtInf blocks and compute NbOfTxs and CtrlSum */
+  rv=AH_ImExporterSEPA_Export_Pain_Setup(ie, ctx, doctype, params, &pl);
+  if (rv) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
 
-    xmlctx=GWEN_XmlCtxStore_new(root,
-                                GWEN_XML_FLAGS_INDENT |
-                                GWEN_XML_FLAGS_SIMPLE |
-                                GWEN_XML_FLAGS_HANDLE_HEADERS);
+  /* write document */
+  xw=AH_ImExporterSEPA_XmlWriter_new(sio);
+  AH_ImExporterSEPA_XmlWriter_AddHeader(xw);
+  AH_ImExporterSEPA_XmlWriter_StartElement(xw, "Document", "xmlns", xmlns);
+  AH_ImExporterSEPA_XmlWriter_StartElement(xw, topName, NULL, NULL);
+  AH_ImExporterSEPA_Export_Pain_GrpHdr(ie, xw, pl, doctype);
+  if (doctype[0]==1)
+    rv=AH_ImExporterSEPA_Export_Pain_001(ie, xw, pl, doctype, params);
+  else
+    rv=AH_ImExporterSEPA_Export_Pain_008(ie, xw, pl, doctype, params);
+  AH_ImExporter_Sepa_PmtInf_List_free(pl);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    AH_ImExporterSEPA_XmlWriter_free(xw);
+    return rv;
+  }
+  AH_ImExporterSEPA_XmlWriter_EndElement(xw, topName);
+  AH_ImExporterSEPA_XmlWriter_EndElement(xw, "Document");
 
-    rv=GWEN_XMLNode_WriteToStream(root, xmlctx, sio);
-    if (rv) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-    }
-    GWEN_XmlCtx_free(xmlctx);
-    GWEN_XMLNode_free(root);
+  rv=AH_ImExporterSEPA_XmlWriter_Flush(xw);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
   }
+  AH_ImExporterSEPA_XmlWriter_free(xw);
 
-  /* TODO */
   return rv;
 }
 
@@ -464,31 +634,7 @@ int AH_ImExporterSEPA_CheckFile(AB_IMEXPORTER *ie, const char *fname)
 
 
 
-int AH_ImExporterSEPA_XmlSetCharValueEscaped(GWEN_XMLNODE *n, const char *varName, const char *value)
-{
-  if (value && *value) {
-    GWEN_BUFFER *dbuf;
-    int rv;
-
-    dbuf=GWEN_Buffer_new(0, 256, 0, 1);
-    rv=GWEN_Text_EscapeXmlToBuffer(value, dbuf);
-    if (rv<0) {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
-      GWEN_Buffer_free(dbuf);
-      return rv;
-    }
-
-    GWEN_XMLNode_SetCharValue(n, varName, GWEN_Buffer_GetStart(dbuf));
-    GWEN_Buffer_free(dbuf);
-  }
-  return 0;
-}
-
-
-
-
-
-
+#include "sepa_xmlwriter.c"
 #include "sepa_pain_001.c"
 #include "sepa_pain_008.c"
 
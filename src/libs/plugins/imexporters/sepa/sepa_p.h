@@ -36,12 +36,39 @@ struct AH_IMEXPORTER_SEPA_PMTINF {
   AB_TRANSACTION_SEQUENCE sequenceType;
   const char *creditorSchemeId;
   AB_TRANSACTION_LIST2 *transactions;
+  uint32_t hash;
+};
+
+/* hash table of PmtInf blocks keyed by their match criteria (open addressing) */
+typedef struct AH_IMEXPORTER_SEPA_PMTINF_INDEX AH_IMEXPORTER_SEPA_PMTINF_INDEX;
+struct AH_IMEXPORTER_SEPA_PMTINF_INDEX {
+  AH_IMEXPORTER_SEPA_PMTINF **slots;
+  uint32_t slotCount;
+  uint32_t usedCount;
+};
+
+typedef struct AH_IMEXPORTER_SEPA_XMLWRITER AH_IMEXPORTER_SEPA_XMLWRITER;
+struct AH_IMEXPORTER_SEPA_XMLWRITER {
+  GWEN_SYNCIO *sio;
+  GWEN_BUFFER *buffer;
+  int depth;
+  int lastError;
 };
 
 /* these functions are not part of the public API */
 static void AH_ImExporter_Sepa_PmtInf_free(AH_IMEXPORTER_SEPA_PMTINF *pmtinf);
 GWEN_LIST_FUNCTION_DEFS(AH_IMEXPORTER_SEPA_PMTINF, AH_ImExporter_Sepa_PmtInf)
 
+static AH_IMEXPORTER_SEPA_PMTINF_INDEX *AH_ImExporter_Sepa_PmtInfIndex_new(void);
+static void AH_ImExporter_Sepa_PmtInfIndex_free(AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx);
+static void AH_ImExporter_Sepa_PmtInfIndex_Add(AH_IMEXPORTER_SEPA_PMTINF_INDEX *idx, AH_IMEXPORTER_SEPA_PMTINF *pmtinf);
+static uint32_t AH_ImExporter_Sepa_PmtInf_Hash(uint32_t transDate,
+                                               const char *localName,
+                                               const char *localIban,
+                                               const char *localBic,
+                                               AB_TRANSACTION_SEQUENCE sequenceType,
+                                               const char *creditorSchemeId);
+
 
 static void GWENHYWFAR_CB AH_ImExporterSEPA_FreeData(void *bp, void *p);
 
@@ -59,18 +86,43 @@ static int AH_ImExporterSEPA_Export(AB_IMEXPORTER *ie,
 static int AH_ImExporterSEPA_CheckFile(AB_IMEXPORTER *ie, const char *fname);
 
 
-static int AH_ImExporterSEPA_XmlSetCharValueEscaped(GWEN_XMLNODE *n, const char *varName, const char *value);
-
+static AH_IMEXPORTER_SEPA_XMLWRITER *AH_ImExporterSEPA_XmlWriter_new(GWEN_SYNCIO *sio);
+static void AH_ImExporterSEPA_XmlWriter_free(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+static int AH_ImExporterSEPA_XmlWriter_Flush(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+static void AH_ImExporterSEPA_XmlWriter_AddHeader(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+static void AH_ImExporterSEPA_XmlWriter_StartElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                     const char *name,
+                                                     const char *attrName,
+                                                     const char *attrValue);
+static void AH_ImExporterSEPA_XmlWriter_EndElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *name);
+static void AH_ImExporterSEPA_XmlWriter_AddElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                   const char *name,
+                                                   const char *attrName,
+                                                   const char *attrValue,
+                                                   const char *value);
+static void AH_ImExporterSEPA_XmlWriter_AddIntElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *name, int value);
+static void AH_ImExporterSEPA_XmlWriter_AddElementByPath(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                         const char *path,
+                                                         const char *value);
+
+
+static int AH_ImExporterSEPA_Export_Pain_001_CheckTransaction(const AB_TRANSACTION *t,
+                                                              uint32_t doctype[],
+                                                              int tcount);
 
 static int AH_ImExporterSEPA_Export_Pain_001(AB_IMEXPORTER *ie,
-                                             AB_IMEXPORTER_CONTEXT *ctx,
-                                             GWEN_XMLNODE *painNode,
+                                             AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                             AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
                                              uint32_t doctype[],
                                              GWEN_DB_NODE *params);
 
+static int AH_ImExporterSEPA_Export_Pain_008_CheckTransaction(const AB_TRANSACTION *t,
+                                                              uint32_t doctype[],
+                                                              int tcount);
+
 static int AH_ImExporterSEPA_Export_Pain_008(AB_IMEXPORTER *ie,
-                                             AB_IMEXPORTER_CONTEXT *ctx,
-                                             GWEN_XMLNODE *painNode,
+                                             AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                             AH_IMEXPORTER_SEPA_PMTINF_LIST *pl,
                                              uint32_t doctype[],
                                              GWEN_DB_NODE *params);
 
@@ -0,0 +1,243 @@
+/***************************************************************************
+
+ ***************************************************************************
+ *          Please see toplevel file COPYING for license details           *
+ ***************************************************************************/
+
+
+/* This file is included by sepa.c */
+
+
+/*
+ * Minimal XML writer for the pain exporters: elements are written to the output stream
+ * in the order they are created, so no XML tree of the whole document is needed.
+ * Errors are remembered and reported by AH_ImExporterSEPA_XmlWriter_Flush(), all other
+ * functions do nothing once an error occurred.
+ */
+
+
+#define AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE (32*1024)
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static void _xmlWriterAppendTag(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                const char *name,
+                                const char *attrName,
+                                const char *attrValue);
+static void _xmlWriterIndent(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+static void _xmlWriterAppendEscaped(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *s);
+static void _xmlWriterFlushIfFull(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+static int _xmlWriterWriteBuffer(AH_IMEXPORTER_SEPA_XMLWRITER *xw);
+
+
+
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+
+
+AH_IMEXPORTER_SEPA_XMLWRITER *AH_ImExporterSEPA_XmlWriter_new(GWEN_SYNCIO *sio)
+{
+  AH_IMEXPORTER_SEPA_XMLWRITER *xw;
+
+  GWEN_NEW_OBJECT(AH_IMEXPORTER_SEPA_XMLWRITER, xw);
+  xw->sio=sio;
+  xw->buffer=GWEN_Buffer_new(0, AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE+1024, 0, 1);
+
+  return xw;
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_free(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  if (xw) {
+    GWEN_Buffer_free(xw->buffer);
+    GWEN_FREE_OBJECT(xw);
+  }
+}
+
+
+
+int AH_ImExporterSEPA_XmlWriter_Flush(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  if (xw->lastError==0)
+    xw->lastError=_xmlWriterWriteBuffer(xw);
+  return xw->lastError;
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_AddHeader(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  if (xw->lastError==0)
+    GWEN_Buffer_AppendString(xw->buffer, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_StartElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                              const char *name,
+                                              const char *attrName,
+                                              const char *attrValue)
+{
+  if (xw->lastError==0) {
+    _xmlWriterIndent(xw);
+    _xmlWriterAppendTag(xw, name, attrName, attrValue);
+    GWEN_Buffer_AppendByte(xw->buffer, '\n');
+    xw->depth++;
+  }
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_EndElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *name)
+{
+  if (xw->lastError==0) {
+    assert(xw->depth>0);
+    xw->depth--;
+    _xmlWriterIndent(xw);
+    GWEN_Buffer_AppendString(xw->buffer, "</");
+    GWEN_Buffer_AppendString(xw->buffer, name);
+    GWEN_Buffer_AppendString(xw->buffer, ">\n");
+    _xmlWriterFlushIfFull(xw);
+  }
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_AddElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                            const char *name,
+                                            const char *attrName,
+                                            const char *attrValue,
+                                            const char *value)
+{
+  /* empty values are omitted */
+  if (xw->lastError==0 && value && *value) {
+    _xmlWriterIndent(xw);
+    _xmlWriterAppendTag(xw, name, attrName, attrValue);
+    _xmlWriterAppendEscaped(xw, value);
+    GWEN_Buffer_AppendString(xw->buffer, "</");
+    GWEN_Buffer_AppendString(xw->buffer, name);
+    GWEN_Buffer_AppendString(xw->buffer, ">\n");
+  }
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_AddIntElement(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *name, int value)
+{
+  char numbuf[32];
+
+  snprintf(numbuf, sizeof(numbuf)-1, "%d", value);
+  numbuf[sizeof(numbuf)-1]=0;
+  AH_ImExporterSEPA_XmlWriter_AddElement(xw, name, NULL, NULL, numbuf);
+}
+
+
+
+void AH_ImExporterSEPA_XmlWriter_AddElementByPath(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                                                  const char *path,
+                                                  const char *value)
+{
+  if (xw->lastError==0 && value && *value) {
+    const char *p;
+
+    p=strchr(path, '/');
+    if (p) {
+      char nameBuf[64];
+      size_t len;
+
+      /* open the first element of the path, write the rest into it */
+      len=p-path;
+      assert(len<sizeof(nameBuf));
+      memmove(nameBuf, path, len);
+      nameBuf[len]=0;
+      AH_ImExporterSEPA_XmlWriter_StartElement(xw, nameBuf, NULL, NULL);
+      AH_ImExporterSEPA_XmlWriter_AddElementByPath(xw, p+1, value);
+      AH_ImExporterSEPA_XmlWriter_EndElement(xw, nameBuf);
+    }
+    else
+      AH_ImExporterSEPA_XmlWriter_AddElement(xw, path, NULL, NULL, value);
+  }
+}
+
+
+
+void _xmlWriterAppendTag(AH_IMEXPORTER_SEPA_XMLWRITER *xw,
+                         const char *name,
+                         const char *attrName,
+                         const char *attrValue)
+{
+  GWEN_Buffer_AppendByte(xw->buffer, '<');
+  GWEN_Buffer_AppendString(xw->buffer, name);
+  if (attrName && attrValue) {
+    GWEN_Buffer_AppendByte(xw->buffer, ' ');
+    GWEN_Buffer_AppendString(xw->buffer, attrName);
+    GWEN_Buffer_AppendString(xw->buffer, "=\"");
+    _xmlWriterAppendEscaped(xw, attrValue);
+    GWEN_Buffer_AppendByte(xw->buffer, '"');
+  }
+  GWEN_Buffer_AppendByte(xw->buffer, '>');
+}
+
+
+
+void _xmlWriterIndent(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  int i;
+
+  for (i=0; i<xw->depth; i++)
+    GWEN_Buffer_AppendString(xw->buffer, "  ");
+}
+
+
+
+void _xmlWriterAppendEscaped(AH_IMEXPORTER_SEPA_XMLWRITER *xw, const char *s)
+{
+  int rv;
+
+  rv=GWEN_Text_EscapeXmlToBuffer(s, xw->buffer);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    xw->lastError=rv;
+  }
+}
+
+
+
+void _xmlWriterFlushIfFull(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  if (xw->lastError==0 && GWEN_Buffer_GetUsedBytes(xw->buffer)>=AH_IMEXPORTER_SEPA_XMLWRITER_FLUSHSIZE)
+    xw->lastError=_xmlWriterWriteBuffer(xw);
+}
+
+
+
+int _xmlWriterWriteBuffer(AH_IMEXPORTER_SEPA_XMLWRITER *xw)
+{
+  if (GWEN_Buffer_GetUsedBytes(xw->buffer)) {
+    int rv;
+
+    rv=GWEN_SyncIo_WriteForced(xw->sio,
+                               (const uint8_t *) GWEN_Buffer_GetStart(xw->buffer),
+                               GWEN_Buffer_GetUsedBytes(xw->buffer));
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+      return rv;
+    }
+    GWEN_Buffer_Reset(xw->buffer);
+  }
+
+  return 0;
+}
+
+
+
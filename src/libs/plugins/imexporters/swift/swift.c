@@ -28,6 +28,10 @@
 
 
 static int _importSecuritiesFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db);
+static int _groupNameMatches(GWEN_DB_NODE *dbParams, const char *groupName);
+static int _importTransactionFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT);
+static void _importBalanceFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT);
+static int _handleStreamedGroup(GWEN_DB_NODE *dbGroup, void *userData);
 static void _replaceValueInDb(GWEN_DB_NODE *db, const char *grpName, const char *destName);
 
 
@@ -79,8 +83,11 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
                               GWEN_DB_NODE *params)
 {
   AH_IMEXPORTER_SWIFT *ieh;
+  AB_IMEXPORTER_CONTEXT *importCtx;
   GWEN_DB_NODE *dbData;
   GWEN_DB_NODE *dbSubParams;
+  AH_IMEXPORTER_SWIFT_STREAM stream;
+  AHB_SWIFT_GROUP_HANDLER groupHandler;
   int rv;
 
   assert(ie);
@@ -89,6 +96,25 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
   assert(ieh->dbio);
 
   dbSubParams=GWEN_DB_GetGroup(params, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "params");
+  if (dbSubParams)
+    dbSubParams=GWEN_DB_Group_dup(dbSubParams);
+  else
+    dbSubParams=GWEN_DB_Group_new("params");
+
+  /* import into a separate context which is only added to the given one if the whole file could be read,
+   * so a parse error near the end of a file doesn't leave the transactions already streamed in ctx */
+  importCtx=AB_ImExporterContext_new();
+
+  if (GWEN_DB_GetIntValue(params, "streaming", 0, 1)) {
+    /* let the parser hand over every transaction as soon as it is complete instead of
+     * collecting the whole file in dbData first */
+    stream.ctx=importCtx;
+    stream.dbParams=params;
+    groupHandler.groupFn=_handleStreamedGroup;
+    groupHandler.userData=&stream;
+    GWEN_DB_SetPtrValue(dbSubParams, GWEN_DB_FLAGS_OVERWRITE_VARS, "groupHandler", &groupHandler);
+  }
+
   dbData=GWEN_DB_Group_new("transactions");
   GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
                        I18N("Reading file..."));
@@ -108,11 +134,13 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
                       dbSubParams,
                       GWEN_DB_FLAGS_DEFAULT |
                       GWEN_PATH_FLAGS_CREATE_GROUP);
+  GWEN_DB_Group_free(dbSubParams);
   if (rv) {
     DBG_ERROR(AQBANKING_LOGDOMAIN, "Error importing data (%d)", rv);
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
                          I18N("Error importing data"));
     GWEN_DB_Group_free(dbData);
+    AB_ImExporterContext_free(importCtx);
     return GWEN_ERROR_BAD_DATA;
   }
   DBG_INFO(AQBANKING_LOGDOMAIN, "Importing SWIFT data into GWEN_DB: done");
@@ -122,25 +150,28 @@ int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
   GWEN_DB_Dump(dbData, 2);
 #endif
 
-  /* transform DB to transactions */
+  /* transform DB to transactions (in streaming mode only data not handed to _handleStreamedGroup is left) */
   GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug,
                        "Data imported, transforming to transactions");
-  rv=AH_ImExporterSWIFT__ImportFromGroup(ctx, dbData, params);
+  rv=AH_ImExporterSWIFT__ImportFromGroup(importCtx, dbData, params);
   if (rv) {
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error, "Error importing data");
     GWEN_DB_Group_free(dbData);
+    AB_ImExporterContext_free(importCtx);
     return rv;
   }
 
   /* read securities (if any) */
-  rv=_importSecuritiesFromGroup(ctx, dbData);
+  rv=_importSecuritiesFromGroup(importCtx, dbData);
   if (rv) {
     GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error, "Error importing data");
     GWEN_DB_Group_free(dbData);
+    AB_ImExporterContext_free(importCtx);
     return rv;
   }
 
   GWEN_DB_Group_free(dbData);
+  AB_ImExporterContext_AddContext(ctx, importCtx);
   return 0;
 }
 
@@ -165,109 +196,14 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
                                     0);
   dbT=GWEN_DB_GetFirstGroup(db);
   while (dbT) {
-    int matches;
-    int i;
-    const char *p;
-    const char *gn;
-
-    // check whether the name of the current groups matches
-    matches=0;
-    gn=GWEN_DB_GroupName(dbT);
-    for (i=0; ; i++) {
-      p=GWEN_DB_GetCharValue(dbParams, "groupNames", i, 0);
-      if (!p)
-        break;
-      if (strcasecmp(gn, p)==0) {
-        matches=1;
-        break;
-      }
-    } // for
-
-    if (!matches && i==0) {
-      // no names given, check default
-      if ((strcasecmp(GWEN_DB_GroupName(dbT), "transaction")==0) ||
-          (strcasecmp(GWEN_DB_GroupName(dbT), "debitnote")==0))
-        matches=1;
-    }
-
-    if (matches) {
-      AB_TRANSACTION *t;
-      const char *s;
-      const GWEN_DATE *dt;
-
-      /* replace "name/value" and "name/currency" by "name=value:currency" */
-      _replaceValueInDb(dbT, "value", "value");
-      _replaceValueInDb(dbT, "fees", "fees");
-      _replaceValueInDb(dbT, "unitPriceValue", "unitPriceValue");
-      _replaceValueInDb(dbT, "commissionValue", "commissionValue");
-
-      t=AB_Transaction_fromDb(dbT);
-      if (!t) {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Error in config file");
-        GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
-                             I18N("Error in config file"));
-        return GWEN_ERROR_GENERIC;
-      }
-
-      /* check for date */
-      dt=AB_Transaction_GetDate(t);
-      if (dt==NULL) {
-        /* no date, use valutaDate for both fields */
-        dt=AB_Transaction_GetValutaDate(t);
-        AB_Transaction_SetDate(t, dt);
-      }
-
-      /* some translations */
-      s=AB_Transaction_GetRemoteIban(t);
-      if (!(s && *s)) {
-        const char *sAid;
-
-        /* no remote IBAN set, check whether the bank sends this info in the
-         * fields for national account specifications (instead of the SWIFT
-         * field "?38" which was specified for this case) */
-        sAid=AB_Transaction_GetRemoteAccountNumber(t);
-        if (sAid && *sAid && AB_Banking_CheckIban(sAid)==0) {
-          /* there is a remote account number specification, and that is an IBAN,
-           * so we set that accordingly */
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote IBAN from account number");
-          AB_Transaction_SetRemoteIban(t, sAid);
-
-          /* set remote BIC if it not already is */
-          s=AB_Transaction_GetRemoteBic(t);
-          if (!(s && *s)) {
-            const char *sBid;
-
-            sBid=AB_Transaction_GetRemoteBankCode(t);
-            if (sBid && *sBid) {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote BIC from bank code");
-              AB_Transaction_SetRemoteBic(t, sBid);
-            }
-          }
-        }
-      }
+    if (_groupNameMatches(dbParams, GWEN_DB_GroupName(dbT))) {
+      int rv;
 
-      /* read all lines of the remote name and concatenate them (addresses bug #57) */
-      if (1) {
-        int i;
-        GWEN_BUFFER *nameBuf;
-
-        nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
-        for (i=0; i<4; i++) {
-          s=GWEN_DB_GetCharValue(dbT, "remoteName", i, NULL);
-          if (s && *s)
-            GWEN_Buffer_AppendString(nameBuf, s);
-          else
-            break;
-        }
-        if (GWEN_Buffer_GetUsedBytes(nameBuf))
-          AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
-        GWEN_Buffer_free(nameBuf);
+      rv=_importTransactionFromDb(ctx, dbT);
+      if (rv) {
+        GWEN_Gui_ProgressEnd(progressId);
+        return rv;
       }
-
-      /* add transaction */
-      DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
-      GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug, I18N("Adding transaction"));
-      AB_ImExporterContext_AddTransaction(ctx, t);
     }
     else if (strcasecmp(GWEN_DB_GroupName(dbT), "startSaldo")==0) {
       /* ignore start saldo, but since the existence of this group shows
@@ -275,53 +211,7 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
        */
     }
     else if (strcasecmp(GWEN_DB_GroupName(dbT), "endSaldo")==0) {
-      GWEN_DB_NODE *dbX;
-      GWEN_DATE *dt=0;
-      const char *s;
-      const char *bankCode;
-      const char *accountNumber;
-      const char *iban;
-
-      bankCode=GWEN_DB_GetCharValue(dbT, "localBankCode", 0, 0);
-      accountNumber=GWEN_DB_GetCharValue(dbT, "localAccountNumber", 0, 0);
-      iban=GWEN_DB_GetCharValue(dbT, "localIban", 0, 0);
-
-      /* read date */
-      s=GWEN_DB_GetCharValue(dbT, "date", 0, NULL);
-      if (s && *s) {
-        dt=GWEN_Date_fromString(s);
-        if (dt==NULL) {
-          DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad date in saldo");
-        }
-      }
-
-      dbX=GWEN_DB_GetGroup(dbT, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "value");
-      if (dbX) {
-        AB_VALUE *v;
-
-        v=AB_Value_fromDb(dbX);
-        if (v) {
-          AB_BALANCE *bal;
-          AB_IMEXPORTER_ACCOUNTINFO *iea;
-
-          bal=AB_Balance_new();
-          AB_Balance_SetDate(bal, dt);
-          AB_Balance_SetValue(bal, v);
-          AB_Value_free(v);
-
-          /* determine saldo type */
-          s=GWEN_DB_GetCharValue(dbT, "type", 0, NULL);
-          if (s && *s && strcasecmp(s, "final")==0)
-            AB_Balance_SetType(bal, AB_Balance_TypeNoted); /* TODO: maybe use "booked" here? */
-          else
-            AB_Balance_SetType(bal, AB_Balance_TypeTemporary);
-
-          iea=AB_ImExporterContext_GetOrAddAccountInfo(ctx, 0, iban, bankCode, accountNumber, 0);
-          DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding balance");
-          AB_ImExporterAccountInfo_AddBalance(iea, bal);
-        }
-      }
-      GWEN_Date_free(dt);
+      _importBalanceFromDb(ctx, dbT);
     }
     else {
       int rv;
@@ -351,6 +241,189 @@ int AH_ImExporterSWIFT__ImportFromGroup(AB_IMEXPORTER_CONTEXT *ctx,
 
 
 
+int _groupNameMatches(GWEN_DB_NODE *dbParams, const char *groupName)
+{
+  int i;
+
+  for (i=0; ; i++) {
+    const char *p;
+
+    p=GWEN_DB_GetCharValue(dbParams, "groupNames", i, 0);
+    if (!p)
+      break;
+    if (strcasecmp(groupName, p)==0)
+      return 1;
+  } // for
+
+  if (i==0) {
+    // no names given, check default
+    if ((strcasecmp(groupName, "transaction")==0) ||
+        (strcasecmp(groupName, "debitnote")==0))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+
+int _importTransactionFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT)
+{
+  AB_TRANSACTION *t;
+  const char *s;
+  const GWEN_DATE *dt;
+
+  /* replace "name/value" and "name/currency" by "name=value:currency" */
+  _replaceValueInDb(dbT, "value", "value");
+  _replaceValueInDb(dbT, "fees", "fees");
+  _replaceValueInDb(dbT, "unitPriceValue", "unitPriceValue");
+  _replaceValueInDb(dbT, "commissionValue", "commissionValue");
+
+  t=AB_Transaction_fromDb(dbT);
+  if (!t) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Error in config file");
+    GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Error,
+                         I18N("Error in config file"));
+    return GWEN_ERROR_GENERIC;
+  }
+
+  /* check for date */
+  dt=AB_Transaction_GetDate(t);
+  if (dt==NULL) {
+    /* no date, use valutaDate for both fields */
+    dt=AB_Transaction_GetValutaDate(t);
+    AB_Transaction_SetDate(t, dt);
+  }
+
+  /* some translations */
+  s=AB_Transaction_GetRemoteIban(t);
+  if (!(s && *s)) {
+    const char *sAid;
+
+    /* no remote IBAN set, check whether the bank sends this info in the
+     * fields for national account specifications (instead of the SWIFT
+     * field "?38" which was specified for this case) */
+    sAid=AB_Transaction_GetRemoteAccountNumber(t);
+    if (sAid && *sAid && AB_Banking_CheckIban(sAid)==0) {
+      /* there is a remote account number specification, and that is an IBAN,
+       * so we set that accordingly */
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote IBAN from account number");
+      AB_Transaction_SetRemoteIban(t, sAid);
+
+      /* set remote BIC if it not already is */
+      s=AB_Transaction_GetRemoteBic(t);
+      if (!(s && *s)) {
+        const char *sBid;
+
+        sBid=AB_Transaction_GetRemoteBankCode(t);
+        if (sBid && *sBid) {
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Setting remote BIC from bank code");
+          AB_Transaction_SetRemoteBic(t, sBid);
+        }
+      }
+    }
+  }
+
+  /* read all lines of the remote name and concatenate them (addresses bug #57) */
+  if (1) {
+    int i;
+    GWEN_BUFFER *nameBuf;
+
+    nameBuf=GWEN_Buffer_new(0, 256, 0, 1);
+    for (i=0; i<4; i++) {
+      s=GWEN_DB_GetCharValue(dbT, "remoteName", i, NULL);
+      if (s && *s)
+        GWEN_Buffer_AppendString(nameBuf, s);
+      else
+        break;
+    }
+    if (GWEN_Buffer_GetUsedBytes(nameBuf))
+      AB_Transaction_SetRemoteName(t, GWEN_Buffer_GetStart(nameBuf));
+    GWEN_Buffer_free(nameBuf);
+  }
+
+  /* add transaction */
+  DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding transaction");
+  GWEN_Gui_ProgressLog(0, GWEN_LoggerLevel_Debug, I18N("Adding transaction"));
+  AB_ImExporterContext_AddTransaction(ctx, t);
+
+  return 0;
+}
+
+
+
+void _importBalanceFromDb(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *dbT)
+{
+  GWEN_DB_NODE *dbX;
+  GWEN_DATE *dt=0;
+  const char *s;
+  const char *bankCode;
+  const char *accountNumber;
+  const char *iban;
+
+  bankCode=GWEN_DB_GetCharValue(dbT, "localBankCode", 0, 0);
+  accountNumber=GWEN_DB_GetCharValue(dbT, "localAccountNumber", 0, 0);
+  iban=GWEN_DB_GetCharValue(dbT, "localIban", 0, 0);
+
+  /* read date */
+  s=GWEN_DB_GetCharValue(dbT, "date", 0, NULL);
+  if (s && *s) {
+    dt=GWEN_Date_fromString(s);
+    if (dt==NULL) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Bad date in saldo");
+    }
+  }
+
+  dbX=GWEN_DB_GetGroup(dbT, GWEN_PATH_FLAGS_NAMEMUSTEXIST, "value");
+  if (dbX) {
+    AB_VALUE *v;
+
+    v=AB_Value_fromDb(dbX);
+    if (v) {
+      AB_BALANCE *bal;
+      AB_IMEXPORTER_ACCOUNTINFO *iea;
+
+      bal=AB_Balance_new();
+      AB_Balance_SetDate(bal, dt);
+      AB_Balance_SetValue(bal, v);
+      AB_Value_free(v);
+
+      /* determine saldo type */
+      s=GWEN_DB_GetCharValue(dbT, "type", 0, NULL);
+      if (s && *s && strcasecmp(s, "final")==0)
+        AB_Balance_SetType(bal, AB_Balance_TypeNoted); /* TODO: maybe use "booked" here? */
+      else
+        AB_Balance_SetType(bal, AB_Balance_TypeTemporary);
+
+      iea=AB_ImExporterContext_GetOrAddAccountInfo(ctx, 0, iban, bankCode, accountNumber, 0);
+      DBG_DEBUG(AQBANKING_LOGDOMAIN, "Adding balance");
+      AB_ImExporterAccountInfo_AddBalance(iea, bal);
+    }
+  }
+  GWEN_Date_free(dt);
+}
+
+
+
+/* called by the SWIFT parser for every finished group in streaming mode */
+int _handleStreamedGroup(GWEN_DB_NODE *dbGroup, void *userData)
+{
+  AH_IMEXPORTER_SWIFT_STREAM *stream;
+  const char *gn;
+
+  stream=(AH_IMEXPORTER_SWIFT_STREAM *) userData;
+  gn=GWEN_DB_GroupName(dbGroup);
+
+  if (_groupNameMatches(stream->dbParams, gn))
+    return _importTransactionFromDb(stream->ctx, dbGroup);
+  else if (strcasecmp(gn, "endSaldo")==0)
+    _importBalanceFromDb(stream->ctx, dbGroup);
+
+  return 0;
+}
+
+
+
 int _importSecuritiesFromGroup(AB_IMEXPORTER_CONTEXT *ctx, GWEN_DB_NODE *db)
 {
   GWEN_DB_NODE *dbT;
@@ -13,6 +13,7 @@
 
 
 #include "swift.h"
+#include "plugins/parsers/swift/swift.h"
 
 #include <gwenhywfar/dbio.h>
 #include <aqbanking/backendsupport/imexporter_be.h>
@@ -24,6 +25,14 @@ struct AH_IMEXPORTER_SWIFT {
 };
 
 
+/* data for the group handler used in streaming mode */
+typedef struct AH_IMEXPORTER_SWIFT_STREAM AH_IMEXPORTER_SWIFT_STREAM;
+struct AH_IMEXPORTER_SWIFT_STREAM {
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_DB_NODE *dbParams;
+};
+
+
 static void GWENHYWFAR_CB AH_ImExporterSWIFT_FreeData(void *bp, void *p);
 
 static int AH_ImExporterSWIFT_Import(AB_IMEXPORTER *ie,
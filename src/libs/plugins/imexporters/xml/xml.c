@@ -26,6 +26,10 @@
 #include <gwenhywfar/inherit.h>
 #include <gwenhywfar/xml2db.h>
 
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
 
 
 
@@ -68,10 +72,9 @@ static GWEN_DB_NODE *AB_ImExporterXML_ImportIntoDbWithSchemaDoc(AB_IMEXPORTER *i
                                                                 GWEN_XMLNODE *xmlDocSchema);
 
 
-static GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie);
+static int AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie);
 
-static GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlNodeAllSchemata,
-                                                         GWEN_XMLNODE *xmlDocData);
+static GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlDocData);
 static const char *AB_ImExporterXML_GetCharValueByPath(GWEN_XMLNODE *xmlNode, const char *path, const char *defValue);
 
 
@@ -82,6 +85,16 @@ static int AB_ImExporterXML_ImportDb(AB_IMEXPORTER *ie,
 static void _transformValue(GWEN_DB_NODE *dbData, const char *varNameValue, const char *varNameCurrency,
                             const char *destVarName);
 
+static int _schemaCacheIsValid(const AB_IMEXPORTER_XML *ieh, GWEN_STRINGLIST *slDataFiles);
+static void _schemaCacheBuild(AB_IMEXPORTER_XML *ieh, GWEN_STRINGLIST *slDataFiles);
+static void _schemaCacheReadMatch(AB_IMEXPORTER_XML *ieh, AB_IMEXPORTER_XML_SCHEMAFILE *sf);
+static void _schemaCacheBuildMatchTable(AB_IMEXPORTER_XML *ieh);
+static int _schemaCacheFindLiteralMatch(const AB_IMEXPORTER_XML *ieh, int pathIndex, const char *sDocData);
+static GWEN_XMLNODE *_schemaCacheGetSchemaForFile(const AB_IMEXPORTER_XML *ieh, const char *fileName);
+static void _schemaCacheClear(AB_IMEXPORTER_XML *ieh);
+static uint32_t _matchHash(int pathIndex, const char *s);
+static int _getFileStat(const char *fileName, int64_t *pModTime, uint64_t *pFileSize);
+
 
 
 
@@ -137,6 +150,7 @@ void GWENHYWFAR_CB AB_ImExporterXML_FreeData(void *bp, void *p)
 
   ieh=(AB_IMEXPORTER_XML *)p;
 
+  _schemaCacheClear(ieh);
   GWEN_FREE_OBJECT(ieh);
 }
 
@@ -349,12 +363,17 @@ GWEN_DB_NODE *AB_ImExporterXML_ImportIntoDbWithSchemaDoc(AB_IMEXPORTER *ie, GWEN
 
 GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char *schemaName)
 {
+  AB_IMEXPORTER_XML *ieh;
   GWEN_BUFFER *tbuf;
   GWEN_BUFFER *fullPathBuffer;
   GWEN_XMLNODE *xmlNodeFile;
   GWEN_XMLNODE *xmlNodeSchema;
   int rv;
 
+  assert(ie);
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie);
+  assert(ieh);
+
   fullPathBuffer=GWEN_Buffer_new(0, 256, 0, 1);
 
   tbuf=GWEN_Buffer_new(0, 256, 0, 1);
@@ -371,6 +390,13 @@ GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char
   }
   GWEN_Buffer_free(tbuf);
 
+  /* use schema from cache if the file is unchanged */
+  xmlNodeSchema=_schemaCacheGetSchemaForFile(ieh, GWEN_Buffer_GetStart(fullPathBuffer));
+  if (xmlNodeSchema) {
+    GWEN_Buffer_free(fullPathBuffer);
+    return GWEN_XMLNode_dup(xmlNodeSchema);
+  }
+
   xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
   rv=GWEN_XML_ReadFile(xmlNodeFile, GWEN_Buffer_GetStart(fullPathBuffer),
                        GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
@@ -401,144 +427,113 @@ GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFromFile(AB_IMEXPORTER *ie, const char
 
 GWEN_XMLNODE *AB_ImExporterXML_DetermineSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlDocData)
 {
-  GWEN_XMLNODE *xmlNodeAllSchemata;
-
-  xmlNodeAllSchemata=AB_ImExporterXML_ReadSchemaFiles(ie);
-  if (xmlNodeAllSchemata) {
-    GWEN_XMLNODE *xmlNodeSchema;
+  GWEN_XMLNODE *xmlNodeSchema;
+  int rv;
 
-    xmlNodeSchema=AB_ImExporterXML_FindMatchingSchema(ie, xmlNodeAllSchemata, xmlDocData);
-    if (xmlNodeSchema) {
-      GWEN_XMLNode_UnlinkChild(xmlNodeAllSchemata, xmlNodeSchema);
-      GWEN_XMLNode_free(xmlNodeAllSchemata);
-      return xmlNodeSchema;
-    }
-    else {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "No matching schema");
-      GWEN_XMLNode_free(xmlNodeAllSchemata);
-      return NULL;
-    }
-  }
-  else {
-    DBG_INFO(AQBANKING_LOGDOMAIN, "No schemata");
+  rv=AB_ImExporterXML_ReadSchemaFiles(ie);
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No schemata (%d)", rv);
     return NULL;
   }
 
+  xmlNodeSchema=AB_ImExporterXML_FindMatchingSchema(ie, xmlDocData);
+  if (xmlNodeSchema==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No matching schema");
+    return NULL;
+  }
 
+  /* the cached schema stays in the cache, the caller gets a copy */
+  return GWEN_XMLNode_dup(xmlNodeSchema);
 }
 
 
 
-GWEN_XMLNODE *AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie)
+int AB_ImExporterXML_ReadSchemaFiles(AB_IMEXPORTER *ie)
 {
+  AB_IMEXPORTER_XML *ieh;
   GWEN_STRINGLIST *slDataFiles;
 
+  assert(ie);
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie);
+  assert(ieh);
+
   /* get list of all schema files */
   slDataFiles=AB_Banking_ListDataFilesForImExporter(AB_ImExporter_GetBanking(ie), "xml", "*.xml");
-  if (slDataFiles) {
-    GWEN_XMLNODE *xmlNodeAllSchemata;
-    GWEN_STRINGLISTENTRY *seDataFile;
-
-    xmlNodeAllSchemata=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "allSchemaFiles");
-
-    seDataFile=GWEN_StringList_FirstEntry(slDataFiles);
-    while (seDataFile) {
-      GWEN_XMLNODE *xmlNodeFile;
-      int rv;
-
-      xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
-      rv=GWEN_XML_ReadFile(xmlNodeFile, GWEN_StringListEntry_Data(seDataFile),
-                           GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
-      if (rv<0) {
-        DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading schema file \"%s\" (%d), ignoring.",
-                  GWEN_StringListEntry_Data(seDataFile), rv);
-      }
-      else {
-        GWEN_XMLNODE *xmlNodeSchema;
-
-        xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeFile, "Schema", NULL, NULL);
-        if (xmlNodeSchema) {
-          GWEN_XMLNode_UnlinkChild(xmlNodeFile, xmlNodeSchema);
-          GWEN_XMLNode_AddChild(xmlNodeAllSchemata, xmlNodeSchema);
-        }
-        else {
-          DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing \"Schema\" in schema file \"%s\", ignoring.",
-                    GWEN_StringListEntry_Data(seDataFile));
-        }
-      } /* if (xmlNode) */
-      GWEN_XMLNode_free(xmlNodeFile);
-
-      seDataFile=GWEN_StringListEntry_Next(seDataFile);
-    } /* while(se) */
-
-    GWEN_StringList_free(slDataFiles);
-
-    return xmlNodeAllSchemata;
-  } /* if (sl) */
-  else {
+  if (slDataFiles==NULL) {
     DBG_INFO(AQBANKING_LOGDOMAIN, "No data files");
-    return NULL;
+    _schemaCacheClear(ieh);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  /* only parse the files again if any of them was added, removed or modified */
+  if (!_schemaCacheIsValid(ieh, slDataFiles)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Schema files changed, reading them");
+    _schemaCacheClear(ieh);
+    _schemaCacheBuild(ieh, slDataFiles);
   }
+  GWEN_StringList_free(slDataFiles);
+
+  return 0;
 }
 
 
 
-GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlNodeAllSchemata,
-                                                  GWEN_XMLNODE *xmlDocData)
+GWEN_XMLNODE *AB_ImExporterXML_FindMatchingSchema(AB_IMEXPORTER *ie, GWEN_XMLNODE *xmlDocData)
 {
-  GWEN_XMLNODE *xmlNodeSchema;
+  AB_IMEXPORTER_XML *ieh;
+  int bestIndex=-1;
+  int pathIndex;
 
-  xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeAllSchemata, "Schema", NULL, NULL);
-  while (xmlNodeSchema) {
-    GWEN_XMLNODE *xmlNodeDocMatches;
-
-    xmlNodeDocMatches=GWEN_XMLNode_FindFirstTag(xmlNodeSchema, "DocMatches", NULL, NULL);
-    if (xmlNodeDocMatches) {
-      GWEN_XMLNODE *xmlNodeMatch;
-
-      xmlNodeMatch=GWEN_XMLNode_FindFirstTag(xmlNodeDocMatches, "Match", NULL, NULL);
-      if (xmlNodeMatch) {
-        const char *xmlPropPath;
-        const char *sPattern;
-
-        xmlPropPath=GWEN_XMLNode_GetProperty(xmlNodeMatch, "path", NULL);
-        sPattern=GWEN_XMLNode_GetCharValue(xmlNodeMatch, NULL, NULL);
-        if (xmlPropPath && *xmlPropPath && sPattern && *sPattern) {
-          const char *sDocData;
-
-          sDocData=AB_ImExporterXML_GetCharValueByPath(xmlDocData, xmlPropPath, NULL);
-          if (sDocData && *sDocData) {
-            if (-1!=GWEN_Text_ComparePattern(sDocData, sPattern, 0)) {
-              /* found match */
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Document data matches (path=%s, data=%s, pattern=%s",
-                       xmlPropPath, sDocData, sPattern);
-              return xmlNodeSchema;
-            } /* if (-1!=GWEN_Text_ComparePattern(sDocData, sPattern)) */
-            else {
-              DBG_INFO(AQBANKING_LOGDOMAIN, "Document data does not match (path=%s, data=%s, pattern=%s",
-                       xmlPropPath, sDocData, sPattern);
-            }
-          }
-          else {
-            DBG_INFO(AQBANKING_LOGDOMAIN, "Missing or empty match data in document (path=%s)", xmlPropPath);
-          }
-        }  /* if (xmlPropPath && *xmlPropPath && sPattern && *sPattern) */
+  assert(ie);
+  ieh=GWEN_INHERIT_GETDATA(AB_IMEXPORTER, AB_IMEXPORTER_XML, ie);
+  assert(ieh);
+
+  /* the first schema (in file order) whose pattern matches the document wins */
+  for (pathIndex=0; pathIndex<ieh->matchPathCount; pathIndex++) {
+    const char *xmlPropPath;
+    const char *sDocData;
+    int idx;
+    int lastIndex;
+
+    xmlPropPath=ieh->matchPaths[pathIndex];
+    sDocData=AB_ImExporterXML_GetCharValueByPath(xmlDocData, xmlPropPath, NULL);
+    if (!(sDocData && *sDocData)) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Missing or empty match data in document (path=%s)", xmlPropPath);
+      continue;
+    }
+
+    /* literal patterns: hash probe */
+    idx=_schemaCacheFindLiteralMatch(ieh, pathIndex, sDocData);
+    if (idx>=0 && (bestIndex<0 || idx<bestIndex))
+      bestIndex=idx;
+
+    /* wildcard patterns: only those of schemata preceding the best match so far need to be checked */
+    lastIndex=(bestIndex<0)?ieh->schemaFileCount:bestIndex;
+    for (idx=0; idx<lastIndex; idx++) {
+      const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+
+      sf=&(ieh->schemaFiles[idx]);
+      if (sf->matchPathIndex==pathIndex && !sf->matchIsLiteral) {
+        if (-1!=GWEN_Text_ComparePattern(sDocData, sf->matchPattern, 0)) {
+          bestIndex=idx;
+          break;
+        }
         else {
-          DBG_INFO(AQBANKING_LOGDOMAIN, "Missing data in schema file: path=%s, pattern=%s",
-                   (xmlPropPath && *xmlPropPath)?xmlPropPath:"-- empty --",
-                   (sPattern && *sPattern)?sPattern:"-- empty --");
+          DBG_INFO(AQBANKING_LOGDOMAIN, "Document data does not match (path=%s, data=%s, pattern=%s",
+                   xmlPropPath, sDocData, sf->matchPattern);
         }
-      } /* if (xmlNodeMatch) */
-      else {
-        DBG_INFO(AQBANKING_LOGDOMAIN, "<DocMatches> element has no <Match> element");
       }
-    } /* xmlNodeDocMatches */
-    else {
-      DBG_INFO(AQBANKING_LOGDOMAIN, "Schema has no <DocMatches> element");
-      GWEN_XMLNode_Dump(xmlNodeSchema, 2);
     }
-    xmlNodeSchema=GWEN_XMLNode_FindNextTag(xmlNodeSchema, "Schema", NULL, NULL);
-  } /* while(xmlNodeSchema) */
+  }
+
+  if (bestIndex>=0) {
+    const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+
+    sf=&(ieh->schemaFiles[bestIndex]);
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Document data matches (path=%s, pattern=%s, file=%s)",
+             ieh->matchPaths[sf->matchPathIndex], sf->matchPattern, sf->fileName);
+    return sf->xmlNodeSchema;
+  }
 
   return NULL;
 }
@@ -858,3 +853,280 @@ void _transformValue(GWEN_DB_NODE *dbData, const char *varNameValue, const char
 
 
 
+int _schemaCacheIsValid(const AB_IMEXPORTER_XML *ieh, GWEN_STRINGLIST *slDataFiles)
+{
+  GWEN_STRINGLISTENTRY *seDataFile;
+  int idx=0;
+
+  if (ieh->cachedSchemata==NULL || ieh->schemaFileCount!=(int) GWEN_StringList_Count(slDataFiles))
+    return 0;
+
+  seDataFile=GWEN_StringList_FirstEntry(slDataFiles);
+  while (seDataFile) {
+    const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+    const char *fileName;
+    int64_t modTime;
+    uint64_t fileSize;
+
+    sf=&(ieh->schemaFiles[idx++]);
+    fileName=GWEN_StringListEntry_Data(seDataFile);
+    if (strcmp(sf->fileName, fileName)!=0 ||
+        _getFileStat(fileName, &modTime, &fileSize)<0 ||
+        modTime!=sf->modTime ||
+        fileSize!=sf->fileSize)
+      return 0;
+    seDataFile=GWEN_StringListEntry_Next(seDataFile);
+  }
+
+  return 1;
+}
+
+
+
+void _schemaCacheBuild(AB_IMEXPORTER_XML *ieh, GWEN_STRINGLIST *slDataFiles)
+{
+  GWEN_STRINGLISTENTRY *seDataFile;
+  int fileCount;
+
+  fileCount=GWEN_StringList_Count(slDataFiles);
+  ieh->cachedSchemata=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "allSchemaFiles");
+  ieh->schemaFiles=(AB_IMEXPORTER_XML_SCHEMAFILE *) calloc(fileCount?fileCount:1, sizeof(AB_IMEXPORTER_XML_SCHEMAFILE));
+  ieh->matchPaths=(const char **) calloc(fileCount?fileCount:1, sizeof(const char *));
+  assert(ieh->schemaFiles && ieh->matchPaths);
+
+  seDataFile=GWEN_StringList_FirstEntry(slDataFiles);
+  while (seDataFile) {
+    AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+    GWEN_XMLNODE *xmlNodeFile;
+    const char *fileName;
+    int rv;
+
+    fileName=GWEN_StringListEntry_Data(seDataFile);
+    sf=&(ieh->schemaFiles[ieh->schemaFileCount++]);
+    sf->fileName=strdup(fileName);
+    sf->matchPathIndex=-1;
+
+    /* stat before reading so that a modification while reading leads to reading the file again next time */
+    rv=_getFileStat(fileName, &(sf->modTime), &(sf->fileSize));
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Could not stat schema file \"%s\" (%d)", fileName, rv);
+    }
+
+    xmlNodeFile=GWEN_XMLNode_new(GWEN_XMLNodeTypeTag, "schemaFile");
+    rv=GWEN_XML_ReadFile(xmlNodeFile, fileName, GWEN_XML_FLAGS_HANDLE_COMMENTS | GWEN_XML_FLAGS_HANDLE_HEADERS);
+    if (rv<0) {
+      DBG_ERROR(AQBANKING_LOGDOMAIN, "Error reading schema file \"%s\" (%d), ignoring.", fileName, rv);
+    }
+    else {
+      GWEN_XMLNODE *xmlNodeSchema;
+
+      xmlNodeSchema=GWEN_XMLNode_FindFirstTag(xmlNodeFile, "Schema", NULL, NULL);
+      if (xmlNodeSchema) {
+        GWEN_XMLNode_UnlinkChild(xmlNodeFile, xmlNodeSchema);
+        GWEN_XMLNode_AddChild(ieh->cachedSchemata, xmlNodeSchema);
+        sf->xmlNodeSchema=xmlNodeSchema;
+        _schemaCacheReadMatch(ieh, sf);
+      }
+      else {
+        DBG_ERROR(AQBANKING_LOGDOMAIN, "Missing \"Schema\" in schema file \"%s\", ignoring.", fileName);
+      }
+    }
+    GWEN_XMLNode_free(xmlNodeFile);
+
+    seDataFile=GWEN_StringListEntry_Next(seDataFile);
+  }
+
+  _schemaCacheBuildMatchTable(ieh);
+}
+
+
+
+void _schemaCacheReadMatch(AB_IMEXPORTER_XML *ieh, AB_IMEXPORTER_XML_SCHEMAFILE *sf)
+{
+  GWEN_XMLNODE *xmlNodeDocMatches;
+  GWEN_XMLNODE *xmlNodeMatch;
+  const char *xmlPropPath;
+  const char *sPattern;
+  int i;
+
+  xmlNodeDocMatches=GWEN_XMLNode_FindFirstTag(sf->xmlNodeSchema, "DocMatches", NULL, NULL);
+  if (xmlNodeDocMatches==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Schema in \"%s\" has no <DocMatches> element", sf->fileName);
+    return;
+  }
+
+  xmlNodeMatch=GWEN_XMLNode_FindFirstTag(xmlNodeDocMatches, "Match", NULL, NULL);
+  if (xmlNodeMatch==NULL) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "<DocMatches> element in \"%s\" has no <Match> element", sf->fileName);
+    return;
+  }
+
+  xmlPropPath=GWEN_XMLNode_GetProperty(xmlNodeMatch, "path", NULL);
+  sPattern=GWEN_XMLNode_GetCharValue(xmlNodeMatch, NULL, NULL);
+  if (!(xmlPropPath && *xmlPropPath && sPattern && *sPattern)) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "Missing data in schema file \"%s\": path=%s, pattern=%s",
+             sf->fileName,
+             (xmlPropPath && *xmlPropPath)?xmlPropPath:"-- empty --",
+             (sPattern && *sPattern)?sPattern:"-- empty --");
+    return;
+  }
+
+  for (i=0; i<ieh->matchPathCount; i++) {
+    if (strcmp(ieh->matchPaths[i], xmlPropPath)==0)
+      break;
+  }
+  if (i>=ieh->matchPathCount)
+    ieh->matchPaths[ieh->matchPathCount++]=xmlPropPath;
+
+  sf->matchPathIndex=i;
+  sf->matchPattern=sPattern;
+  sf->matchIsLiteral=(strchr(sPattern, '*')==NULL && strchr(sPattern, '?')==NULL);
+}
+
+
+
+void _schemaCacheBuildMatchTable(AB_IMEXPORTER_XML *ieh)
+{
+  uint32_t mask;
+  int literalCount=0;
+  int idx;
+
+  for (idx=0; idx<ieh->schemaFileCount; idx++) {
+    if (ieh->schemaFiles[idx].matchIsLiteral)
+      literalCount++;
+  }
+
+  /* power of two, at most half full */
+  ieh->matchSlotCount=16;
+  while (ieh->matchSlotCount<(uint32_t)(2*literalCount))
+    ieh->matchSlotCount<<=1;
+  ieh->matchSlots=(int *) malloc(ieh->matchSlotCount*sizeof(int));
+  assert(ieh->matchSlots);
+  memset(ieh->matchSlots, 0xff, ieh->matchSlotCount*sizeof(int));
+  mask=ieh->matchSlotCount-1;
+
+  /* inserted in file order, so a probe finds the first of several schemata with the same pattern */
+  for (idx=0; idx<ieh->schemaFileCount; idx++) {
+    const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+
+    sf=&(ieh->schemaFiles[idx]);
+    if (sf->matchIsLiteral) {
+      uint32_t pos;
+
+      pos=_matchHash(sf->matchPathIndex, sf->matchPattern) & mask;
+      while (ieh->matchSlots[pos]>=0)
+        pos=(pos+1) & mask;
+      ieh->matchSlots[pos]=idx;
+    }
+  }
+}
+
+
+
+int _schemaCacheFindLiteralMatch(const AB_IMEXPORTER_XML *ieh, int pathIndex, const char *sDocData)
+{
+  uint32_t mask;
+  uint32_t pos;
+
+  if (ieh->matchSlots==NULL)
+    return -1;
+
+  mask=ieh->matchSlotCount-1;
+  pos=_matchHash(pathIndex, sDocData) & mask;
+  while (ieh->matchSlots[pos]>=0) {
+    const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+
+    sf=&(ieh->schemaFiles[ieh->matchSlots[pos]]);
+    /* GWEN_Text_ComparePattern() is used case-insensitive, so are literal patterns */
+    if (sf->matchPathIndex==pathIndex && strcasecmp(sf->matchPattern, sDocData)==0)
+      return ieh->matchSlots[pos];
+    pos=(pos+1) & mask;
+  }
+
+  return -1;
+}
+
+
+
+GWEN_XMLNODE *_schemaCacheGetSchemaForFile(const AB_IMEXPORTER_XML *ieh, const char *fileName)
+{
+  int idx;
+
+  for (idx=0; idx<ieh->schemaFileCount; idx++) {
+    const AB_IMEXPORTER_XML_SCHEMAFILE *sf;
+
+    sf=&(ieh->schemaFiles[idx]);
+    if (sf->xmlNodeSchema && strcmp(sf->fileName, fileName)==0) {
+      int64_t modTime;
+      uint64_t fileSize;
+
+      if (_getFileStat(fileName, &modTime, &fileSize)==0 && modTime==sf->modTime && fileSize==sf->fileSize)
+        return sf->xmlNodeSchema;
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+void _schemaCacheClear(AB_IMEXPORTER_XML *ieh)
+{
+  int idx;
+
+  for (idx=0; idx<ieh->schemaFileCount; idx++)
+    free(ieh->schemaFiles[idx].fileName);
+  free(ieh->schemaFiles);
+  ieh->schemaFiles=NULL;
+  ieh->schemaFileCount=0;
+
+  free(ieh->matchPaths);
+  ieh->matchPaths=NULL;
+  ieh->matchPathCount=0;
+
+  free(ieh->matchSlots);
+  ieh->matchSlots=NULL;
+  ieh->matchSlotCount=0;
+
+  if (ieh->cachedSchemata) {
+    GWEN_XMLNode_free(ieh->cachedSchemata);
+    ieh->cachedSchemata=NULL;
+  }
+}
+
+
+
+uint32_t _matchHash(int pathIndex, const char *s)
+{
+  uint32_t h=2166136261u;
+
+  /* FNV-1a over path index and lower case pattern */
+  h^=(uint32_t) pathIndex;
+  h*=16777619u;
+  while (*s) {
+    h^=(uint32_t) tolower((unsigned char) *(s++));
+    h*=16777619u;
+  }
+
+  return h;
+}
+
+
+
+int _getFileStat(const char *fileName, int64_t *pModTime, uint64_t *pFileSize)
+{
+  struct stat st;
+
+  if (stat(fileName, &st)!=0) {
+    *pModTime=0;
+    *pFileSize=0;
+    return GWEN_ERROR_IO;
+  }
+  *pModTime=(int64_t) st.st_mtime;
+  *pFileSize=(uint64_t) st.st_size;
+  return 0;
+}
+
+
+
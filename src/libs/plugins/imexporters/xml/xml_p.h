@@ -22,9 +22,33 @@
 
 
 
+/* one entry per schema file in the cache */
+typedef struct AB_IMEXPORTER_XML_SCHEMAFILE AB_IMEXPORTER_XML_SCHEMAFILE;
+struct AB_IMEXPORTER_XML_SCHEMAFILE {
+  char *fileName;
+  int64_t modTime;
+  uint64_t fileSize;
+  GWEN_XMLNODE *xmlNodeSchema;   /* child of cachedSchemata, NULL if the file contains no schema */
+  int matchPathIndex;            /* index into matchPaths, -1 if the schema has no usable <Match> */
+  const char *matchPattern;      /* pattern of <Match> (owned by xmlNodeSchema) */
+  int matchIsLiteral;            /* pattern contains no wildcards */
+};
+
+
 typedef struct AB_IMEXPORTER_XML AB_IMEXPORTER_XML;
 struct AB_IMEXPORTER_XML {
-  int dummy;
+  /* parsed schema files, revalidated on every import by comparing file list, mtime and size */
+  GWEN_XMLNODE *cachedSchemata;
+  AB_IMEXPORTER_XML_SCHEMAFILE *schemaFiles;
+  int schemaFileCount;
+
+  /* distinct <Match> paths, each one only needs to be looked up once per document */
+  const char **matchPaths;
+  int matchPathCount;
+
+  /* schemata with literal patterns hashed by path index and pattern (index into schemaFiles, -1 if free) */
+  int *matchSlots;
+  uint32_t matchSlotCount;
 };
 
 
@@ -0,0 +1,289 @@
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "swift_l.h"
+#include "swift940_61.h"
+#include "swift940_86.h"
+
+#include <gwenhywfar/buffer.h>
+#include <gwenhywfar/db.h>
+#include <gwenhywfar/syncio_file.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+/* Parses a synthetic MT940 statement (tags :61: and :86: of every booking) and reports the throughput
+ * and the number of tag and subtag allocations per booking (counted in swift_tag.c, this program is
+ * built with AHB_SWIFT_COUNT_ALLOCS). The subtags of :86: are additionally tokenized
+ * once by creating a subtag list (AHB_SWIFT_ParseSubTags) and once by using views into the tag data
+ * (AHB_SWIFT_GetNextSubTagView) to compare both tokenizers.
+ * If an MT940 file is given it is also read through the reader in streaming mode like the SWIFT
+ * importer does.
+ *
+ * Usage: swift_bench [COUNT [MT940-FILE]]
+ */
+
+
+#define BENCH_DEFAULT_COUNT 1000000
+#define BENCH_POOL_SIZE     1024
+
+
+typedef struct {
+  char tag61[256];
+  char tag86[512];
+} BENCH_BOOKING;
+
+
+/* bookings are created once and reused cyclically, so that only the parser is measured */
+static void createBooking(int i, BENCH_BOOKING *booking)
+{
+  snprintf(booking->tag61, sizeof(booking->tag61), "2310%02d%02d16CR%d,%02dNMSCNONREF//%08d\n/OCMT/EUR%d,%02d/",
+           1+(i % 12), 1+(i % 28), (i*7) % 100000, i % 100, i, (i*7) % 100000, i % 100);
+  snprintf(booking->tag86, sizeof(booking->tag86),
+           "166?00SEPA-UEBERWEISUNG?10%04d"
+           "?20EREF+%08d?21KREF+NONREF?22MREF+M-%06d?23CRED+DE98ZZZ09999999999"
+           "?24SVWZ+Rechnung %d vom 16.10.?25%02d Kunde %d"
+           "?30BYLADEM1001?31DE02120300000000202051?32Max Mustermann?34%03d",
+           i % 10000, i, i % 1000000, i, 1+(i % 28), i % 5000, i % 1000);
+}
+
+
+
+static double runParser(const BENCH_BOOKING *pool, int count, GWEN_DB_NODE *cfg,
+                        unsigned long *pBytes)
+{
+  clock_t startTime;
+  unsigned long bytes=0;
+  int i;
+
+  startTime=clock();
+  for (i=0; i<count; i++) {
+    const BENCH_BOOKING *booking;
+    GWEN_DB_NODE *dbTransaction;
+    AHB_SWIFT_TAG *tg;
+
+    booking=&pool[i % BENCH_POOL_SIZE];
+    bytes+=strlen(booking->tag61)+strlen(booking->tag86);
+    dbTransaction=GWEN_DB_Group_new("transaction");
+
+    tg=AHB_SWIFT_Tag_new("61", booking->tag61);
+    if (AHB_SWIFT940_Parse_61(tg, GWEN_DB_FLAGS_DEFAULT, dbTransaction, cfg)) {
+      fprintf(stderr, "ERROR: Could not parse :61: of booking %d\n", i);
+      exit(2);
+    }
+    AHB_SWIFT_Tag_free(tg);
+
+    tg=AHB_SWIFT_Tag_new("86", booking->tag86);
+    if (AHB_SWIFT940_Parse_86(tg, GWEN_DB_FLAGS_DEFAULT, dbTransaction, cfg)) {
+      fprintf(stderr, "ERROR: Could not parse :86: of booking %d\n", i);
+      exit(2);
+    }
+    AHB_SWIFT_Tag_free(tg);
+
+    GWEN_DB_Group_free(dbTransaction);
+  }
+
+  *pBytes=bytes;
+  return ((double)(clock()-startTime))/CLOCKS_PER_SEC;
+}
+
+
+
+static double runSubTagList(const BENCH_BOOKING *pool, int count,
+                            unsigned long *pBytes, int *pSubTags)
+{
+  clock_t startTime;
+  unsigned long bytes=0;
+  int subTags=0;
+  int i;
+
+  startTime=clock();
+  for (i=0; i<count; i++) {
+    const BENCH_BOOKING *booking;
+    AHB_SWIFT_SUBTAG_LIST *stlist;
+
+    booking=&pool[i % BENCH_POOL_SIZE];
+    bytes+=strlen(booking->tag86);
+    stlist=AHB_SWIFT_SubTag_List_new();
+    if (AHB_SWIFT_ParseSubTags(booking->tag86+3, stlist, 0)) {
+      fprintf(stderr, "ERROR: Could not tokenize :86: of booking %d\n", i);
+      exit(2);
+    }
+    subTags+=AHB_SWIFT_SubTag_List_GetCount(stlist);
+    AHB_SWIFT_SubTag_List_free(stlist);
+  }
+
+  *pBytes=bytes;
+  *pSubTags=subTags;
+  return ((double)(clock()-startTime))/CLOCKS_PER_SEC;
+}
+
+
+
+static double runSubTagView(const BENCH_BOOKING *pool, int count,
+                            unsigned long *pBytes, int *pSubTags)
+{
+  clock_t startTime;
+  unsigned long bytes=0;
+  GWEN_BUFFER *tmpBuf;
+  GWEN_BUFFER *valueBuf;
+  int subTags=0;
+  int i;
+
+  tmpBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  valueBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  startTime=clock();
+  for (i=0; i<count; i++) {
+    const BENCH_BOOKING *booking;
+    AHB_SWIFT_SUBTAG_VIEW view;
+    const char *s;
+
+    booking=&pool[i % BENCH_POOL_SIZE];
+    bytes+=strlen(booking->tag86);
+    s=booking->tag86+3;
+    while (s && *s) {
+      if (AHB_SWIFT_GetNextSubTagView(&s, &view)) {
+        fprintf(stderr, "ERROR: Could not tokenize :86: of booking %d\n", i);
+        exit(2);
+      }
+      /* condense like AHB_SWIFT_ParseSubTags does (includes the conversion to UTF-8 done when storing) */
+      GWEN_Buffer_Reset(valueBuf);
+      AHB_SWIFT_CondenseToUtf8(view.content, view.contentLen, 0, tmpBuf, valueBuf);
+      subTags++;
+    }
+  }
+
+  *pBytes=bytes;
+  *pSubTags=subTags;
+  GWEN_Buffer_free(valueBuf);
+  GWEN_Buffer_free(tmpBuf);
+  return ((double)(clock()-startTime))/CLOCKS_PER_SEC;
+}
+
+
+
+static int countTransaction(GWEN_DB_NODE *dbGroup, void *userData)
+{
+  if (strcasecmp(GWEN_DB_GroupName(dbGroup), "transaction")==0)
+    (*((int *) userData))++;
+  return 0;
+}
+
+
+
+static double runFile(const char *fname, unsigned long *pBytes, int *pBookings)
+{
+  clock_t startTime;
+  struct stat st;
+  GWEN_SYNCIO *sio;
+  GWEN_DB_NODE *cfg;
+  GWEN_DB_NODE *data;
+  AHB_SWIFT_GROUP_HANDLER groupHandler;
+  int bookings=0;
+  int rv;
+
+  if (stat(fname, &st)) {
+    fprintf(stderr, "ERROR: File \"%s\" not found\n", fname);
+    exit(2);
+  }
+
+  sio=GWEN_SyncIo_File_new(fname, GWEN_SyncIo_File_CreationMode_OpenExisting);
+  GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    fprintf(stderr, "ERROR: Could not open file \"%s\" (%d)\n", fname, rv);
+    exit(2);
+  }
+
+  groupHandler.groupFn=countTransaction;
+  groupHandler.userData=&bookings;
+  cfg=GWEN_DB_Group_new("cfg");
+  GWEN_DB_SetCharValue(cfg, GWEN_DB_FLAGS_DEFAULT, "type", "mt940");
+  GWEN_DB_SetPtrValue(cfg, GWEN_DB_FLAGS_DEFAULT, "groupHandler", &groupHandler);
+  data=GWEN_DB_Group_new("transactions");
+
+  startTime=clock();
+  rv=AHB_SWIFT_Import(sio, data, cfg, GWEN_DB_FLAGS_DEFAULT | GWEN_PATH_FLAGS_CREATE_GROUP);
+  if (rv<0) {
+    fprintf(stderr, "ERROR: Could not import file \"%s\" (%d)\n", fname, rv);
+    exit(2);
+  }
+  *pBytes=(unsigned long) st.st_size;
+  *pBookings=bookings;
+  startTime=clock()-startTime;
+
+  GWEN_DB_Group_free(data);
+  GWEN_DB_Group_free(cfg);
+  GWEN_SyncIo_Disconnect(sio);
+  GWEN_SyncIo_free(sio);
+  return ((double)startTime)/CLOCKS_PER_SEC;
+}
+
+
+
+static void printResult(const char *name, double t, unsigned long bytes, unsigned long allocs, int bookings)
+{
+  printf("  %-14s: %8.3f s, %8.2f MB/s, %6.2f tag/subtag allocations per booking\n",
+         name, t, (t>0.0)?(((double)bytes)/t/(1024.0*1024.0)):0.0,
+         (bookings>0)?(((double)allocs)/bookings):0.0);
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  BENCH_BOOKING *pool;
+  GWEN_DB_NODE *cfg;
+  unsigned long bytes;
+  int subTagsList=0;
+  int subTagsView=0;
+  int count=BENCH_DEFAULT_COUNT;
+  double t;
+  int i;
+
+  if (argc>1)
+    count=atoi(argv[1]);
+  if (count<1)
+    count=1;
+
+  pool=(BENCH_BOOKING *) malloc(BENCH_POOL_SIZE*sizeof(BENCH_BOOKING));
+  for (i=0; i<BENCH_POOL_SIZE; i++)
+    createBooking(i, &pool[i]);
+  cfg=GWEN_DB_Group_new("cfg");
+
+  printf("%d bookings\n", count);
+  ahb_swift_tag_allocs=0;
+  t=runParser(pool, count, cfg, &bytes);
+  printResult(":61: and :86:", t, bytes, ahb_swift_tag_allocs, count);
+  ahb_swift_tag_allocs=0;
+  t=runSubTagList(pool, count, &bytes, &subTagsList);
+  printResult("subtag list", t, bytes, ahb_swift_tag_allocs, count);
+  ahb_swift_tag_allocs=0;
+  t=runSubTagView(pool, count, &bytes, &subTagsView);
+  printResult("subtag view", t, bytes, ahb_swift_tag_allocs, count);
+
+  if (argc>2) {
+    int bookings=0;
+
+    ahb_swift_tag_allocs=0;
+    t=runFile(argv[2], &bytes, &bookings);
+    printf("%s: %d bookings\n", argv[2], bookings);
+    printResult("reader", t, bytes, ahb_swift_tag_allocs, bookings);
+  }
+
+  GWEN_DB_Group_free(cfg);
+  free(pool);
+
+  if (subTagsList!=subTagsView) {
+    fprintf(stderr, "ERROR: Number of subtags differs (%d, %d)\n", subTagsList, subTagsView);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "swift.h"
+#include "swift_l.h"
+#include "swift940_l.h"
+#include "swift940_86.h"
+
+#include <gwenhywfar/db.h>
+
+#include <stdio.h>
+#include <string.h>
+
+
+/* Checks the conversion of :86: values to UTF-8. Every subtag is converted exactly once: bytes which are not
+ * part of a 2-byte UTF-8 sequence for U+0080..U+00FF are taken as ISO-8859-1, so characters beyond Latin-1
+ * (like the Euro sign) are not decoded but re-encoded byte by byte. SEPA fields are cut from the already
+ * converted purpose lines and stored without another conversion.
+ * Also checks that the transactions of an MT942 report are handed to the group handler in streaming mode. */
+
+
+static int checkValue(GWEN_DB_NODE *db, const char *name, const char *expected)
+{
+  const char *s;
+
+  s=GWEN_DB_GetCharValue(db, name, 0, NULL);
+  if (s==NULL || strcmp(s, expected)!=0) {
+    fprintf(stderr, "ERROR: Unexpected value for \"%s\": [%s], expected [%s]\n", name, s?s:"<null>", expected);
+    return -1;
+  }
+  return 0;
+}
+
+
+
+static int parse86(const char *content, GWEN_DB_NODE *dbTransaction)
+{
+  GWEN_DB_NODE *cfg;
+  AHB_SWIFT_TAG *tg;
+  int rv;
+
+  cfg=GWEN_DB_Group_new("cfg");
+  tg=AHB_SWIFT_Tag_new("86", content);
+  rv=AHB_SWIFT940_Parse_86(tg, GWEN_DB_FLAGS_DEFAULT, dbTransaction, cfg);
+  AHB_SWIFT_Tag_free(tg);
+  GWEN_DB_Group_free(cfg);
+  if (rv) {
+    fprintf(stderr, "ERROR: Could not parse :86: [%s] (%d)\n", content, rv);
+    return -1;
+  }
+  return 0;
+}
+
+
+
+static int countTransaction(GWEN_DB_NODE *dbGroup, void *userData)
+{
+  if (strcasecmp(GWEN_DB_GroupName(dbGroup), "transaction")==0)
+    (*((int *) userData))++;
+  return 0;
+}
+
+
+
+static int checkMt942Streaming(void)
+{
+  static const char *tags[][2]= {
+    {"20", "STARTDISPE"},
+    {"25", "10020030/1234567"},
+    {"28C", "00001/001"},
+    {"34F", "EURD0,"},
+    {"13D", "2610171200+0200"},
+    {"61", "2610171017DR12,50NTRFNONREF"},
+    {"86", "166?00GUTSCHRIFT?20SVWZ+Test 1"},
+    {"61", "2610171017CR20,NTRFNONREF"},
+    {"86", "166?00GUTSCHRIFT?20SVWZ+Test 2"},
+    {"90D", "1EUR12,50"},
+    {"90C", "1EUR20,"},
+    {NULL, NULL}
+  };
+  AHB_SWIFT_TAG_LIST *tl;
+  AHB_SWIFT_GROUP_HANDLER groupHandler;
+  GWEN_DB_NODE *cfg;
+  GWEN_DB_NODE *data;
+  int count=0;
+  int i;
+  int rv;
+
+  tl=AHB_SWIFT_Tag_List_new();
+  for (i=0; tags[i][0]; i++)
+    AHB_SWIFT_Tag_List_Add(AHB_SWIFT_Tag_new(tags[i][0], tags[i][1]), tl);
+
+  groupHandler.groupFn=countTransaction;
+  groupHandler.userData=&count;
+  cfg=GWEN_DB_Group_new("cfg");
+  GWEN_DB_SetPtrValue(cfg, GWEN_DB_FLAGS_DEFAULT, "groupHandler", &groupHandler);
+  data=GWEN_DB_Group_new("transactions");
+
+  rv=AHB_SWIFT940_Import(tl, data, cfg, GWEN_DB_FLAGS_DEFAULT);
+  if (rv) {
+    fprintf(stderr, "ERROR: Could not import MT942 report (%d)\n", rv);
+    rv=-1;
+  }
+  else if (count!=2 || GWEN_DB_GetFirstGroup(data)!=NULL) {
+    fprintf(stderr, "ERROR: %d transactions streamed (expected 2), data left: %s\n",
+            count, GWEN_DB_GetFirstGroup(data)?"yes":"no");
+    rv=-1;
+  }
+
+  GWEN_DB_Group_free(data);
+  GWEN_DB_Group_free(cfg);
+  AHB_SWIFT_Tag_List_free(tl);
+  return rv;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+  GWEN_DB_NODE *db;
+  int result=0;
+
+  /* ISO-8859-1 input, Euro sign as UTF-8 in a SEPA field spanning two purpose lines */
+  db=GWEN_DB_Group_new("transaction");
+  if (parse86("166?00GUTSCHRIFT?20EREF+E1?21SVWZ+Miete \xe2\x82\xac 5?32M\xfcller", db) ||
+      checkValue(db, "transactionText", "GUTSCHRIFT") ||
+      checkValue(db, "endToEndReference", "E1") ||
+      checkValue(db, "purpose", "Miete \xc3\xa2\xc2\x82\xc2\xac 5") ||
+      checkValue(db, "remoteName", "M\xc3\xbcller"))
+    result=1;
+  GWEN_DB_Group_free(db);
+
+  /* UTF-8 input for U+0080..U+00FF is kept */
+  db=GWEN_DB_Group_new("transaction");
+  if (parse86("166?00GUTSCHRIFT?20SVWZ+Gr\xc3\xbc\xc3\x9f""e?32M\xc3\xbcller", db) ||
+      checkValue(db, "purpose", "Gr\xc3\xbc\xc3\x9f""e") ||
+      checkValue(db, "remoteName", "M\xc3\xbcller"))
+    result=1;
+  GWEN_DB_Group_free(db);
+
+  if (checkMt942Streaming())
+    result=1;
+
+  return result;
+}
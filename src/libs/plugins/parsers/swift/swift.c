@@ -110,6 +110,61 @@ int AHB_SWIFT_Condense(char *buffer, int keepMultipleBlanks)
 
 
 
+void AHB_SWIFT_CondenseToUtf8(const char *s, int len, int keepMultipleBlanks, GWEN_BUFFER *tmpBuf, GWEN_BUFFER *destBuf)
+{
+  const char *src;
+  const char *end;
+
+  GWEN_Buffer_Reset(tmpBuf);
+  src=s;
+  end=s+len;
+
+  /* same rules as in AHB_SWIFT_Condense(), but copying runs of characters at once */
+  if (keepMultipleBlanks) {
+    while (src<end && *src) {
+      const char *runStart;
+
+      runStart=src;
+      while (src<end && *src && *src!=10)
+        src++;
+      if (src>runStart)
+        GWEN_Buffer_AppendBytes(tmpBuf, runStart, src-runStart);
+      if (src<end && *src==10)
+        src++;
+    }
+  }
+  else {
+    int lastWasBlank=0;
+
+    while (src<end && *src && isspace(*src))
+      src++;
+    while (src<end && *src) {
+      const char *runStart;
+
+      runStart=src;
+      while (src<end && *src && !isspace(*src))
+        src++;
+      if (src>runStart) {
+        GWEN_Buffer_AppendBytes(tmpBuf, runStart, src-runStart);
+        lastWasBlank=0;
+      }
+      if (src<end && *src) {
+        if (*src==10)
+          lastWasBlank=0;
+        else if (!lastWasBlank) {
+          GWEN_Buffer_AppendByte(tmpBuf, ' ');
+          lastWasBlank=1;
+        }
+        src++;
+      }
+    }
+  }
+
+  _iso8859_1ToUtf8(GWEN_Buffer_GetStart(tmpBuf), -1, destBuf);
+}
+
+
+
 /* This reads a line within a SWIFT data block (block 4)
    @param *fb     pointer to a GWEN_FAST_BUFFER input buffer
    @param *buffer pointer to a char* output buffer
@@ -349,6 +404,10 @@ int _readTextBlock(GWEN_FAST_BUFFER *fb, AHB_SWIFT_TAG_LIST *tl, unsigned int ma
     DBG_DEBUG(AQBANKING_LOGDOMAIN,
               "Creating tag \"%s\" (%s)", p, p2);
     tag=AHB_SWIFT_Tag_new(p, p2);
+    if (tag==NULL) {
+      GWEN_Buffer_free(lbuf);
+      return GWEN_ERROR_MEMORY_FULL;
+    }
     AHB_SWIFT_Tag_List_Add(tag, tl);
     tagCount++;
     if (maxTags && tagCount>=maxTags) {
@@ -494,12 +553,7 @@ int _pluginImport(GWEN_DBIO *dbio,
                   GWEN_DB_NODE *cfg,
                   uint32_t flags)
 {
-  int rv;
   const char *p;
-  int skipFileLines;
-  int skipDocLines;
-  GWEN_FAST_BUFFER *fb;
-  int docsImported=0;
 
   p=GWEN_DB_GetCharValue(cfg, "type", 0, "mt940");
   if (strcasecmp(p, "mt940")!=0 &&
@@ -512,6 +566,21 @@ int _pluginImport(GWEN_DBIO *dbio,
     return GWEN_ERROR_INVALID;
   }
 
+  return AHB_SWIFT_Import(sio, data, cfg, flags);
+}
+
+
+
+int AHB_SWIFT_Import(GWEN_SYNCIO *sio, GWEN_DB_NODE *data, GWEN_DB_NODE *cfg, uint32_t flags)
+{
+  int rv;
+  const char *p;
+  int skipFileLines;
+  int skipDocLines;
+  GWEN_FAST_BUFFER *fb;
+  int docsImported=0;
+
+  p=GWEN_DB_GetCharValue(cfg, "type", 0, "mt940");
   skipFileLines=GWEN_DB_GetIntValue(cfg, "skipFileLines", 0, 0);
   skipDocLines=GWEN_DB_GetIntValue(cfg, "skipDocLines", 0, 0);
 
@@ -774,10 +843,23 @@ void _iso8859_1ToUtf8(const char *p, int size, GWEN_BUFFER *buf)
 {
   while (*p) {
     unsigned int c;
+    const char *runStart;
 
     if (!size)
       break;
 
+    /* copy runs of printable ASCII characters at once */
+    runStart=p;
+    while (*p && size && (unsigned char)(*p)>=32 && (unsigned char)(*p)<127) {
+      p++;
+      if (size!=-1)
+        size--;
+    }
+    if (p>runStart) {
+      GWEN_Buffer_AppendBytes(buf, runStart, p-runStart);
+      continue;
+    }
+
     c=(unsigned char)(*(p++));
     if (c<32 || c==127)
       c=32;
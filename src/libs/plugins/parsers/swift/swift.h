@@ -11,6 +11,8 @@
 #ifndef AQHBCIBANK_SWIFT_H
 #define AQHBCIBANK_SWIFT_H
 
+#include <gwenhywfar/db.h>
+
 /**
  * @defgroup MOD_PLUGIN_SWIFT SWIFT Parser
  * @ingroup MOD_PLUGINS
@@ -38,9 +40,37 @@
  *   <td>required</td>
  * </tr>
  *
+ * <tr>
+ *   <td><b>groupHandler</b></td>
+ *   <td>pointer</td>
+ *   <td>pointer to an @ref AHB_SWIFT_GROUP_HANDLER (MT940 and MT942). If set every
+ *       transaction group and every saldo group is handed to the handler as soon as
+ *       it is complete and removed from the data afterwards, so the memory needed
+ *       is bounded by a single statement instead of the whole file. MT942 reports
+ *       have no saldo groups, only their transactions are handed over.</td>
+ *   <td>optional</td>
+ * </tr>
+ *
  * </table>
  *
  */
 
 
+
+/**
+ * Function called for every finished group ("transaction", "StartSaldo", "InterimStartSaldo",
+ * "EndSaldo") in streaming mode.
+ * The group is removed and freed after this function returns, so it must not be kept.
+ * @return 0 if ok, error code otherwise (aborts the import)
+ */
+typedef int (*AHB_SWIFT_GROUP_FN)(GWEN_DB_NODE *dbGroup, void *userData);
+
+
+typedef struct AHB_SWIFT_GROUP_HANDLER AHB_SWIFT_GROUP_HANDLER;
+struct AHB_SWIFT_GROUP_HANDLER {
+  AHB_SWIFT_GROUP_FN groupFn;
+  void *userData;
+};
+
+
 #endif /* AQHBCIBANK_SWIFT_H */
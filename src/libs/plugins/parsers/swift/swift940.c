@@ -12,6 +12,7 @@
 #endif
 
 #include "swift940_p.h"
+#include "swift.h"
 #include "swift940_25.h"
 #include "swift940_60.h"
 #include "swift940_61.h"
@@ -26,14 +27,31 @@
 #include <gwenhywfar/gui.h>
 
 #include <ctype.h>
+#include <string.h>
 
 
 
+/* ------------------------------------------------------------------------------------------------
+ * forward declarations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+static int _emitGroup(const AHB_SWIFT_GROUP_HANDLER *gh, GWEN_DB_NODE *dbGroup);
+static void _dropGroup(const AHB_SWIFT_GROUP_HANDLER *gh, GWEN_DB_NODE *dbGroup);
+
 
 
-/* Import SWIFT MT940 data.
+/* ------------------------------------------------------------------------------------------------
+ * implementations
+ * ------------------------------------------------------------------------------------------------
+ */
+
+/* Import SWIFT MT940 and MT942 data.
    @param tl input: list of tags. Tags are lines in a SWIFT data block (block 4). A tag has an
           id and content. See the AHB_SWIFT_Tag_new function for more information.
+
+   If cfg contains a pointer "groupHandler" (see @ref AHB_SWIFT_GROUP_HANDLER) finished transaction
+   and saldo groups are handed to that handler and removed from data afterwards (streaming mode).
  */
 int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
                         GWEN_DB_NODE *data,
@@ -45,11 +63,18 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
   GWEN_DB_NODE *dbTemplate=NULL;
   GWEN_DB_NODE *dbTransaction=NULL;
   const char *sDate=NULL;
+  char sDateBuf[32];
   uint32_t progressId;
   const char *acceptTag20="*";
   const char *rejectTag20=NULL;
   const char *dateFallback="balanceDate";
   int ignoreCurrentReport=0;
+  const AHB_SWIFT_GROUP_HANDLER *groupHandler;
+  int rv;
+
+  groupHandler=(const AHB_SWIFT_GROUP_HANDLER *) GWEN_DB_GetPtrValue(cfg, "groupHandler", 0, NULL);
+  if (groupHandler && groupHandler->groupFn==NULL)
+    groupHandler=NULL;
 
   acceptTag20=GWEN_DB_GetCharValue(cfg, "acceptTag20", 0, NULL);
   if (acceptTag20 && *acceptTag20==0)
@@ -125,10 +150,20 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
           GWEN_DB_NODE *dbSaldo;
           const char *curr;
 
+          /* finish previous transaction */
+          rv=_emitGroup(groupHandler, dbTransaction);
+          dbTransaction=0;
+          if (rv<0) {
+            DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+            GWEN_DB_Group_free(dbTemplate);
+            GWEN_Gui_ProgressEnd(progressId);
+            return rv;
+          }
+
           /* start a new day */
+          _dropGroup(groupHandler, dbDay);
           dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
 
-          dbTransaction=0;
           DBG_INFO(AQBANKING_LOGDOMAIN, "Starting new day");
           if (strcasecmp(id, "60F")==0)
             dbSaldo=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "StartSaldo");
@@ -142,7 +177,13 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
             return -1;
           }
           else {
+            /* copy date, the saldo group might be released before the end of the statement */
             sDate=GWEN_DB_GetCharValue(dbSaldo, "date", 0, NULL);
+            if (sDate) {
+              strncpy(sDateBuf, sDate, sizeof(sDateBuf)-1);
+              sDateBuf[sizeof(sDateBuf)-1]=0;
+              sDate=sDateBuf;
+            }
             DBG_INFO(AQBANKING_LOGDOMAIN, "Storing date \"%s\" as default for maybe later", sDate?sDate:"(empty)");
           }
 
@@ -156,13 +197,27 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
           else
             GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
 
+          rv=_emitGroup(groupHandler, dbSaldo);
+          if (rv<0) {
+            DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+            GWEN_DB_Group_free(dbTemplate);
+            GWEN_Gui_ProgressEnd(progressId);
+            return rv;
+          }
         }
         else if (strcasecmp(id, "62M")==0 || /* Interim EndSaldo */
                  strcasecmp(id, "62F")==0) { /* EndSaldo */
           GWEN_DB_NODE *dbSaldo;
 
           /* end current day */
+          rv=_emitGroup(groupHandler, dbTransaction);
           dbTransaction=0;
+          if (rv<0) {
+            DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+            GWEN_DB_Group_free(dbTemplate);
+            GWEN_Gui_ProgressEnd(progressId);
+            return rv;
+          }
           if (!dbDay) {
             DBG_WARN(AQBANKING_LOGDOMAIN, "Your bank does not send an opening saldo");
             dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
@@ -179,7 +234,15 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
             GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "final");
           else
             GWEN_DB_SetCharValue(dbSaldo, GWEN_DB_FLAGS_OVERWRITE_VARS, "type", "interim");
+          rv=_emitGroup(groupHandler, dbSaldo);
+          _dropGroup(groupHandler, dbDay);
           dbDay=0;
+          if (rv<0) {
+            DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+            GWEN_DB_Group_free(dbTemplate);
+            GWEN_Gui_ProgressEnd(progressId);
+            return rv;
+          }
 
         }
         else if (strcasecmp(id, "61")==0) {
@@ -190,6 +253,16 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
             dbDay=GWEN_DB_GetGroup(data, GWEN_PATH_FLAGS_CREATE_GROUP, "day");
           }
 
+          /* finish previous transaction */
+          rv=_emitGroup(groupHandler, dbTransaction);
+          dbTransaction=0;
+          if (rv<0) {
+            DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+            GWEN_DB_Group_free(dbTemplate);
+            GWEN_Gui_ProgressEnd(progressId);
+            return rv;
+          }
+
           DBG_INFO(AQBANKING_LOGDOMAIN, "Creating new transaction");
           dbTransaction=GWEN_DB_GetGroup(dbDay, GWEN_PATH_FLAGS_CREATE_GROUP, "transaction");
           GWEN_DB_AddGroupChildren(dbTransaction, dbTemplate);
@@ -262,6 +335,7 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
           }
         }
         else if (strcmp(id, "13")==0 ||  /* "Erstellungszeitpunkt */
+                 strcmp(id, "13D")==0 || /* "Erstellungszeitpunkt" in MT942 */
                  strcmp(id, "34F")==0 || /* "Mindestbetrag" (sometimes contains some strange values) */
                  strcmp(id, "90D")==0 || /* "Anzahl und Summe Soll-Buchungen" (examples I've seen are invalid anyway) */
                  strcmp(id, "90C")==0) { /* "Anzahl und Summe Haben-Buchungen" (examples I've seen are invalid anyway) */
@@ -294,11 +368,50 @@ int AHB_SWIFT940_Import(AHB_SWIFT_TAG_LIST *tl,
     tg=AHB_SWIFT_Tag_List_Next(tg);
   } /* while */
 
+  /* finish last transaction of an incomplete statement */
+  rv=_emitGroup(groupHandler, dbTransaction);
+  _dropGroup(groupHandler, dbDay);
+
   GWEN_DB_Group_free(dbTemplate);
   GWEN_Gui_ProgressEnd(progressId);
 
+  if (rv<0) {
+    DBG_INFO(AQBANKING_LOGDOMAIN, "here (%d)", rv);
+    return rv;
+  }
+
   return 0;
 }
 
 
 
+/* hand a finished group to the group handler (if any) and release it */
+int _emitGroup(const AHB_SWIFT_GROUP_HANDLER *gh, GWEN_DB_NODE *dbGroup)
+{
+  int rv=0;
+
+  if (gh && dbGroup) {
+    rv=gh->groupFn(dbGroup, gh->userData);
+    if (rv<0) {
+      DBG_INFO(AQBANKING_LOGDOMAIN, "Error in group handler (%d)", rv);
+    }
+    GWEN_DB_UnlinkGroup(dbGroup);
+    GWEN_DB_Group_free(dbGroup);
+  }
+
+  return rv;
+}
+
+
+
+/* release a group without handing it to the group handler (only in streaming mode) */
+void _dropGroup(const AHB_SWIFT_GROUP_HANDLER *gh, GWEN_DB_NODE *dbGroup)
+{
+  if (gh && dbGroup) {
+    GWEN_DB_UnlinkGroup(dbGroup);
+    GWEN_DB_Group_free(dbGroup);
+  }
+}
+
+
+
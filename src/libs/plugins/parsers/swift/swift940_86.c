@@ -25,17 +25,37 @@
 
 
 
+/* known SEPA fields inside purpose lines, AHB_SWIFT940_86_SEPA_PURPOSE is used for data outside any SEPA field
+ * and AHB_SWIFT940_86_SEPA_UNKNOWN for other fields looking like a SEPA field ("XXXX+") */
+#define AHB_SWIFT940_86_SEPA_KNOWN   8
+#define AHB_SWIFT940_86_SEPA_PURPOSE 8
+#define AHB_SWIFT940_86_SEPA_UNKNOWN 9
+#define AHB_SWIFT940_86_SEPA_IGNORE  (-1)
+
+
+static const char *_sepaFieldIds[AHB_SWIFT940_86_SEPA_KNOWN]= {
+  "EREF+", "KREF+", "MREF+", "CRED+", "DEBT+", "SVWZ+", "ABWA+", "ABWE+"
+};
+
+static const char *_sepaFieldVarNames[AHB_SWIFT940_86_SEPA_KNOWN]= {
+  "endToEndReference", "customerReference", "mandateId", "creditorSchemeId", "originatorId", "purpose",
+  "ultimateDebtor", "ultimateCreditor"
+};
+
+
+
 /* ------------------------------------------------------------------------------------------------
  * forward declarations
  * ------------------------------------------------------------------------------------------------
  */
 
-static void _extractAndHandleSepaTags(GWEN_DB_NODE *dbData, uint32_t flags);
-static void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags);
-static void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags);
-static int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags);
-static int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags);
-static void _transformSepaTags(GWEN_DB_NODE *dbData, GWEN_DB_NODE *dbSepaTags, uint32_t flags);
+static void _readSubTagsIntoDb(const char *p, GWEN_DB_NODE *dbData, uint32_t flags, int keepMultipleBlanks,
+                               GWEN_BUFFER *tmpBuf, GWEN_BUFFER *valueBuf);
+static void _handleSepaFields(const char *sPurpose, GWEN_DB_NODE *dbData, uint32_t flags, GWEN_BUFFER *valueBuf);
+static const char *_getNextSepaField(const char *s, const char **pFieldStart, int *pFieldLen);
+static int _isSepaFieldStart(const char *s);
+static int _classifySepaField(const char *sFieldStart, int fieldLen, const char **pPayload, int *pPayloadLen);
+static void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags, GWEN_BUFFER *tbuf);
 static void _parseTransactionData(const char *p, GWEN_DB_NODE *dbData, uint32_t flags);
 
 
@@ -59,7 +79,7 @@ int AHB_SWIFT940_Parse_86(const AHB_SWIFT_TAG *tg, uint32_t flags, GWEN_DB_NODE
   assert(p);
   isStructured=0;
   code=999;
-  if ((strlen(p)>3) && isdigit(p[0]) && isdigit(p[1]) && isdigit(p[2]) && p[3]=='?') {
+  if ((AHB_SWIFT_Tag_GetDataLen(tg)>3) && isdigit(p[0]) && isdigit(p[1]) && isdigit(p[2]) && p[3]=='?') {
     /* it is structured, get the code */
     code=(((p[0]-'0')*100) + ((p[1]-'0')*10) + (p[2]-'0'));
     isStructured=1;
@@ -67,39 +87,61 @@ int AHB_SWIFT940_Parse_86(const AHB_SWIFT_TAG *tg, uint32_t flags, GWEN_DB_NODE
   }
 
   if (isStructured) {
-    AHB_SWIFT_SUBTAG_LIST *stlist;
-    int rv;
+    AHB_SWIFT_SUBTAG_VIEW view;
+    const char *s;
 
     /* store code */
     GWEN_DB_SetIntValue(dbData, flags, "transactioncode", code);
 
-    stlist=AHB_SWIFT_SubTag_List_new();
-    rv=AHB_SWIFT_ParseSubTags(p, stlist, keepMultipleBlanks);
-    if (rv<0) {
-      DBG_WARN(AQBANKING_LOGDOMAIN, "Handling tag :86: as unstructured (%d)", rv);
-      isStructured=0;
+    /* subtags are read directly from the tag data, values are only copied when stored in dbData */
+    s=p;
+    if (AHB_SWIFT_GetNextSubTagView(&s, &view)<0) {
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Handling tag :86: as unstructured (%d)", GWEN_ERROR_NO_DATA);
     }
     else {
+      GWEN_BUFFER *tmpBuf;
+      GWEN_BUFFER *valueBuf;
+
+      tmpBuf=GWEN_Buffer_new(0, 256, 0, 1);
+      valueBuf=GWEN_Buffer_new(0, 256, 0, 1);
+      _readSubTagsIntoDb(p, dbData, flags, keepMultipleBlanks, tmpBuf, valueBuf);
       if (code<900) {
         /* sepa */
+        int i;
+
         DBG_INFO(AQBANKING_LOGDOMAIN, "Reading as SEPA tag (%d)", code);
-        _readSubTagsIntoDb(stlist, dbData, flags);
-        _extractAndHandleSepaTags(dbData, flags);
-        _transformPurposeIntoOneString(dbData, flags);
+        /* SEPA fields may span multiple purpose lines, so concatenate them first (the lines are already
+         * converted to UTF-8, the fields cut from them are stored as they are) */
+        GWEN_Buffer_Reset(tmpBuf);
+        for (i=0; i<99; i++) {
+          const char *sPurpose;
+
+          sPurpose=GWEN_DB_GetCharValue(dbData, "purpose", i, 0);
+          if (sPurpose==NULL)
+            break;
+          GWEN_Buffer_AppendString(tmpBuf, sPurpose);
+        }
+        if (GWEN_Buffer_GetUsedBytes(tmpBuf))
+          _handleSepaFields(GWEN_Buffer_GetStart(tmpBuf), dbData, flags, valueBuf);
       }
       else {
         /* non-sepa */
         DBG_INFO(AQBANKING_LOGDOMAIN, "Reading as non-SEPA tag (%d)", code);
-        _readSubTagsIntoDb(stlist, dbData, flags);
-        _transformPurposeIntoOneString(dbData, flags);
       }
+      _transformPurposeIntoOneString(dbData, flags, valueBuf);
+
+      GWEN_Buffer_free(valueBuf);
+      GWEN_Buffer_free(tmpBuf);
     } /* if really structured */
-    AHB_SWIFT_SubTag_List_free(stlist);
   } /* if isStructured */
   else {
+    GWEN_BUFFER *tbuf;
+
     /* unstructured :86:, simply store as mutliple purpose lines */
     _parseTransactionData(p, dbData, GWEN_DB_FLAGS_DEFAULT);
-    _transformPurposeIntoOneString(dbData, flags);
+    tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+    _transformPurposeIntoOneString(dbData, flags, tbuf);
+    GWEN_Buffer_free(tbuf);
   }
 
   return 0;
@@ -107,24 +149,27 @@ int AHB_SWIFT940_Parse_86(const AHB_SWIFT_TAG *tg, uint32_t flags, GWEN_DB_NODE
 
 
 
-void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uint32_t flags)
+void _readSubTagsIntoDb(const char *p, GWEN_DB_NODE *dbData, uint32_t flags, int keepMultipleBlanks,
+                        GWEN_BUFFER *tmpBuf, GWEN_BUFFER *valueBuf)
 {
-  AHB_SWIFT_SUBTAG *stg;
-
-  stg=AHB_SWIFT_SubTag_List_First(stlist);
-  while (stg) {
+  while (p && *p) {
+    AHB_SWIFT_SUBTAG_VIEW view;
     const char *s;
-    int id;
     int intVal;
 
-    id=AHB_SWIFT_SubTag_GetId(stg);
-    s=AHB_SWIFT_SubTag_GetData(stg);
-    switch (id) {
+    if (AHB_SWIFT_GetNextSubTagView(&p, &view)<0)
+      break;
+
+    GWEN_Buffer_Reset(valueBuf);
+    AHB_SWIFT_CondenseToUtf8(view.content, view.contentLen, keepMultipleBlanks, tmpBuf, valueBuf);
+    s=GWEN_Buffer_GetStart(valueBuf);
+
+    switch (view.id) {
     case 0: /* Buchungstext */
-      AHB_SWIFT_SetCharValue(dbData, flags, "transactionText", s);
+      GWEN_DB_SetCharValue(dbData, flags, "transactionText", s);
       break;
     case 10: /* Primanota */
-      AHB_SWIFT_SetCharValue(dbData, flags, "primanota", s);
+      GWEN_DB_SetCharValue(dbData, flags, "primanota", s);
       break;
 
     case 20:
@@ -141,21 +186,21 @@ void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uin
     case 61:
     case 62:
     case 63: /* Verwendungszweck */
-      AHB_SWIFT_SetCharValue(dbData, flags, "purpose", s);
+      GWEN_DB_SetCharValue(dbData, flags, "purpose", s);
       break;
 
     case 30: /* BLZ Gegenseite */
-      AHB_SWIFT_SetCharValue(dbData, flags, "remoteBankCode", s);
+      GWEN_DB_SetCharValue(dbData, flags, "remoteBankCode", s);
       break;
 
     case 31: /* Kontonummer Gegenseite */
-      AHB_SWIFT_SetCharValue(dbData, flags, "remoteAccountNumber", s);
+      GWEN_DB_SetCharValue(dbData, flags, "remoteAccountNumber", s);
       break;
 
     case 32:
     case 33: /* Name Auftraggeber */
       //DBG_ERROR(AQBANKING_LOGDOMAIN, "Setting remote name: [%s]", s);
-      AHB_SWIFT_SetCharValue(dbData, flags, "remoteName", s);
+      GWEN_DB_SetCharValue(dbData, flags, "remoteName", s);
       break;
 
     case 34: /* Textschluesselergaenzung */
@@ -168,63 +213,30 @@ void _readSubTagsIntoDb(AHB_SWIFT_SUBTAG_LIST *stlist, GWEN_DB_NODE *dbData, uin
       break;
 
     case 38: /* IBAN */
-      AHB_SWIFT_SetCharValue(dbData, flags, "remoteIban", s);
+      GWEN_DB_SetCharValue(dbData, flags, "remoteIban", s);
       break;
 
     default: /* ignore all other fields (if any) */
-      DBG_WARN(AQBANKING_LOGDOMAIN, "Unknown :86: field \"%02d\" (%s)", id, s);
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Unknown :86: field \"%02d\" (%s)", view.id, s);
       break;
     } /* switch */
-    stg=AHB_SWIFT_SubTag_List_Next(stg);
   } /* while */
 }
 
 
 
-void _extractAndHandleSepaTags(GWEN_DB_NODE *dbData, uint32_t flags)
+void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags, GWEN_BUFFER *tbuf)
 {
-  GWEN_BUFFER *tbuf;
   int i;
 
-  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
+  GWEN_Buffer_Reset(tbuf);
   for (i=0; i<99; i++) {
     const char *s;
 
     s=GWEN_DB_GetCharValue(dbData, "purpose", i, 0);
-    if (s && *s)
-      GWEN_Buffer_AppendString(tbuf, s);
-  }
-
-  if (GWEN_Buffer_GetUsedBytes(tbuf)) {
-    GWEN_DB_NODE *dbSepaTags;
-    int realSepaTagCount;
-
-    dbSepaTags=GWEN_DB_Group_new("sepa-tags");
-    realSepaTagCount=_readSepaTags(GWEN_Buffer_GetStart(tbuf), dbSepaTags);
-
-    if (realSepaTagCount>0 && GWEN_DB_Variables_Count(dbSepaTags))
-      _transformSepaTags(dbData, dbSepaTags, flags);
-
-    GWEN_DB_Group_free(dbSepaTags);
-  }
-
-  /* buffer no longer needed */
-  GWEN_Buffer_free(tbuf);
-}
-
-
-
-void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags)
-{
-  GWEN_BUFFER *tbuf;
-  int i;
-
-  tbuf=GWEN_Buffer_new(0, 256, 0, 1);
-  for (i=0; i<99; i++) {
-    const char *s;
-
-    s=GWEN_DB_GetCharValue(dbData, "purpose", i, 0);
-    if (s && *s) {
+    if (s==NULL)
+      break;
+    if (*s) {
       if (GWEN_Buffer_GetUsedBytes(tbuf))
         GWEN_Buffer_AppendString(tbuf, "\n");
       GWEN_Buffer_AppendString(tbuf, s);
@@ -235,207 +247,170 @@ void _transformPurposeIntoOneString(GWEN_DB_NODE *dbData, uint32_t flags)
     GWEN_DB_DeleteVar(dbData, "purpose");
     GWEN_DB_SetCharValue(dbData, GWEN_DB_FLAGS_DEFAULT, "purpose", GWEN_Buffer_GetStart(tbuf));
   }
-  GWEN_Buffer_free(tbuf);
 }
 
 
 
-int _readSepaTags(const char *sPurpose, GWEN_DB_NODE *dbSepaTags)
+/* Extracts SEPA fields (like "EREF+") from the concatenated purpose lines and stores them in dbData.
+ * Fields appearing multiple times are concatenated, fields are stored in the order of their first
+ * appearance. The purpose is replaced by the content of "SVWZ+" (or by the data outside of SEPA fields). */
+void _handleSepaFields(const char *sPurpose, GWEN_DB_NODE *dbData, uint32_t flags, GWEN_BUFFER *valueBuf)
 {
+  int fieldOrder[AHB_SWIFT940_86_SEPA_KNOWN+1];
+  int fieldCount=0;
+  int realSepaFieldCount=0;
   const char *s;
-  const char *sLastTagStart;
-  int realSepaTagCount=0;
-
-#ifdef ENABLE_FULL_SEPA_LOG
-  DBG_ERROR(AQHBCI_LOGDOMAIN, "FullPurposeBuffer");
-  GWEN_Buffer_Dump(bufFullPurpose, 2);
-#endif
+  int i;
 
+  /* first pass: determine the order of the fields and check whether there are any real SEPA fields */
   s=sPurpose;
-  sLastTagStart=s;
-
-  /* sample all SEPA fields from concatenated string of purpose lines */
   while (*s) {
-    /* look for begin of next tag */
-    while (*s) {
-      if ((*s && isalpha(*s)) &&
-          (s[1] && isalpha(s[1])) &&
-          (s[2] && isalpha(s[2])) &&
-          (s[3] && isalpha(s[3])) &&
-          s[4]=='+') {
-        if (strncasecmp(s, "EREF+", 5)==0 ||
-            strncasecmp(s, "KREF+", 5)==0 ||
-            strncasecmp(s, "MREF+", 5)==0 ||
-            strncasecmp(s, "CRED+", 5)==0 ||
-            strncasecmp(s, "DEBT+", 5)==0 ||
-            strncasecmp(s, "SVWZ+", 5)==0 ||
-            strncasecmp(s, "ABWA+", 5)==0 ||
-            strncasecmp(s, "ABWE+", 5)==0)
+    const char *sFieldStart;
+    int fieldLen;
+    const char *sPayload;
+    int payloadLen;
+    int idx;
+
+    s=_getNextSepaField(s, &sFieldStart, &fieldLen);
+    if (fieldLen<1)
+      continue;
+
+    idx=_classifySepaField(sFieldStart, fieldLen, &sPayload, &payloadLen);
+    if (idx!=AHB_SWIFT940_86_SEPA_IGNORE && idx!=AHB_SWIFT940_86_SEPA_PURPOSE)
+      realSepaFieldCount++;
+    if (idx>=0 && idx<=AHB_SWIFT940_86_SEPA_PURPOSE) {
+      int j;
+
+      for (j=0; j<fieldCount; j++) {
+        if (fieldOrder[j]==idx)
           break;
       }
-      /* not the beginning of a SEPA field, just skip */
-      s++;
+      if (j>=fieldCount)
+        fieldOrder[fieldCount++]=idx;
     }
+  }
 
-    /* found begin of the next SEPA field or end of buffer */
-    if (s > sLastTagStart) {
-      int tagLen;
-
-      /* we currently have a field, close that first */
-      tagLen=s-sLastTagStart;
+  if (realSepaFieldCount<1)
+    return;
 
-      if (_storeSepaTag(sLastTagStart, tagLen, dbSepaTags)>0)
-        realSepaTagCount++;
-    }
+  /* clear purpose variable, since we are about to add it back from SEPA fields */
+  GWEN_DB_DeleteVar(dbData, "purpose");
 
-    if (*s) {
-      /* save start of next tag */
-      sLastTagStart=s;
-      /* skip XXX+ at the beginning, otherwise we would immediately stop in next loop
-       * we know that the next 5 bytes are valid, so it is safe to skip them */
-      s+=5;
+  /* second pass: sample the payloads of every field and store them */
+  for (i=0; i<fieldCount; i++) {
+    GWEN_Buffer_Reset(valueBuf);
+    s=sPurpose;
+    while (*s) {
+      const char *sFieldStart;
+      int fieldLen;
+      const char *sPayload;
+      int payloadLen;
+
+      s=_getNextSepaField(s, &sFieldStart, &fieldLen);
+      if (fieldLen>0 && _classifySepaField(sFieldStart, fieldLen, &sPayload, &payloadLen)==fieldOrder[i])
+        GWEN_Buffer_AppendBytes(valueBuf, sPayload, payloadLen);
     }
-  } /* while */
 
-  return realSepaTagCount;
+    if (fieldOrder[i]==AHB_SWIFT940_86_SEPA_PURPOSE)
+      /* data outside a field, will be replaced if there was a real purpose field (i.e. "SVWZ+") */
+      GWEN_DB_SetCharValue(dbData, flags, "purpose", GWEN_Buffer_GetStart(valueBuf));
+    else if (strcasecmp(_sepaFieldIds[fieldOrder[i]], "SVWZ+")==0)
+      GWEN_DB_SetCharValue(dbData, flags | GWEN_DB_FLAGS_OVERWRITE_VARS, "purpose", GWEN_Buffer_GetStart(valueBuf));
+    else
+      GWEN_DB_SetCharValue(dbData, flags, _sepaFieldVarNames[fieldOrder[i]], GWEN_Buffer_GetStart(valueBuf));
+  }
 }
 
 
 
-int _storeSepaTag(const char *sTagStart, int tagLen, GWEN_DB_NODE *dbSepaTags)
+/* returns the start of the field following the one returned via pFieldStart/pFieldLen
+ * (a field consisting only of a SEPA field id at the very end of the string is dropped) */
+const char *_getNextSepaField(const char *s, const char **pFieldStart, int *pFieldLen)
 {
-  int isRealSepaTag=0;
-
-#ifdef ENABLE_FULL_SEPA_LOG
-  DBG_ERROR(0, "Current tag:");
-  GWEN_Text_LogString(sTagStart, tagLen, 0, GWEN_LoggerLevel_Error);
-#endif
-
-  /* check tag length (must be long enough for 'XXX+', i.e. at least 5 bytes) */
-  if (tagLen>5 && sTagStart[4]=='+') {
-    char sIdentifier[6];
-    const char *sPayload;
-
-    /* ok, 5 bytes or more, 4 alphas and a plus sign, should be the begin of a SEPA tag */
-    strncpy(sIdentifier, sTagStart, 5);
-    sIdentifier[5]=0;
-
-    /* remove leading blanks */
-    sPayload=sTagStart+5;
-    tagLen-=5;
-    while (tagLen>0 && *sPayload && isblank(*sPayload)) {
-      sPayload++;
-      tagLen--;
-    }
-
-    /* remove trailing blanks */
-    if (tagLen>0) {
-      while (tagLen>0) {
-        if (!isblank(sPayload[tagLen-1]))
-          break;
-        tagLen--;
-      }
-    }
-
-    /* store tag, if still data left */
-    if (tagLen>0) {
-      char *sCopyPayload;
-
-      sCopyPayload=GWEN_Text_strndup(sPayload, tagLen);
-      GWEN_DB_SetCharValue(dbSepaTags, GWEN_DB_FLAGS_DEFAULT, sIdentifier, sCopyPayload);
-      free(sCopyPayload);
-      isRealSepaTag=1;
-    }
-    else {
-      DBG_WARN(GWEN_LOGDOMAIN, "Ignoring empty SEPA field \"%s\"", sIdentifier);
+  const char *sFieldStart;
+  const char *t;
+
+  sFieldStart=s;
+  /* skip "XXXX+" at the beginning of a field, otherwise we would immediately stop in the loop below */
+  if (_isSepaFieldStart(s)) {
+    s+=5;
+    if (*s==0) {
+      *pFieldStart=sFieldStart;
+      *pFieldLen=0;
+      return s;
     }
   }
-  else {
-    /* tag is shorter than 5 bytes or pos 4 doesn't contain a plus, treat as normal purpose */
-    if (tagLen>0) {
-      char *sCopyPayload;
 
-      sCopyPayload=GWEN_Text_strndup(sTagStart, tagLen);
-      GWEN_DB_SetCharValue(dbSepaTags, GWEN_DB_FLAGS_DEFAULT, "_purpose", sCopyPayload);
-      free(sCopyPayload);
-    }
+  /* look for begin of next field (the id of a field is always followed by a '+' at position 4) */
+  t=s;
+  while ((t=strchr(t, '+'))) {
+    if (t-4>=s && _isSepaFieldStart(t-4))
+      break;
+    t++;
   }
+  s=t?(t-4):(s+strlen(s));
 
-  return isRealSepaTag?1:0;
+  *pFieldStart=sFieldStart;
+  *pFieldLen=s-sFieldStart;
+  return s;
 }
 
 
 
-void _transformSepaTags(GWEN_DB_NODE *dbData, GWEN_DB_NODE *dbSepaTags, uint32_t flags)
+int _isSepaFieldStart(const char *s)
 {
-  GWEN_DB_NODE *dbVar;
+  if (isalpha(s[0]) && isalpha(s[1]) && isalpha(s[2]) && isalpha(s[3]) && s[4]=='+') {
+    int i;
 
-#ifdef ENABLE_FULL_SEPA_LOG
-  DBG_ERROR(0, "Got these SEPA tags:");
-  GWEN_DB_Dump(dbSepaTags, 2);
-#endif
-
-  /* clear purpose variable, since we are about to add it back from SEPA tags */
-  GWEN_DB_DeleteVar(dbData, "purpose");
+    for (i=0; i<AHB_SWIFT940_86_SEPA_KNOWN; i++) {
+      if (strncasecmp(s, _sepaFieldIds[i], 5)==0)
+        return 1;
+    }
+  }
+  return 0;
+}
 
-  dbVar=GWEN_DB_GetFirstVar(dbSepaTags);
-  while (dbVar) {
-    const char *sVarName;
 
-    sVarName=GWEN_DB_VariableName(dbVar);
-    if (sVarName && *sVarName) {
-      GWEN_BUFFER *tbuf;
-      GWEN_DB_NODE *dbValue;
 
-      /* sample all values into a buffer and concatenate */
-      tbuf=GWEN_Buffer_new(0, 128, 0, 1);
-      dbValue=GWEN_DB_GetFirstValue(dbVar);
-      while (dbValue) {
-        const char *s;
+/* returns the field index (see _sepaFieldIds), AHB_SWIFT940_86_SEPA_PURPOSE, AHB_SWIFT940_86_SEPA_UNKNOWN or
+ * AHB_SWIFT940_86_SEPA_IGNORE for empty fields */
+int _classifySepaField(const char *sFieldStart, int fieldLen, const char **pPayload, int *pPayloadLen)
+{
+  /* check field length (must be long enough for 'XXX+', i.e. at least 5 bytes) */
+  if (fieldLen>5 && sFieldStart[4]=='+') {
+    const char *sPayload;
+    int i;
 
-        s=GWEN_DB_GetCharValueFromNode(dbValue);
-        if (s && *s)
-          GWEN_Buffer_AppendString(tbuf, s);
+    /* remove leading blanks */
+    sPayload=sFieldStart+5;
+    fieldLen-=5;
+    while (fieldLen>0 && *sPayload && isblank(*sPayload)) {
+      sPayload++;
+      fieldLen--;
+    }
 
-        dbValue=GWEN_DB_GetNextValue(dbValue);
-      }
+    /* remove trailing blanks */
+    while (fieldLen>0 && isblank(sPayload[fieldLen-1]))
+      fieldLen--;
 
-      if (strcasecmp(sVarName, "EREF+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags, "endToEndReference", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "KREF+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags, "customerReference", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "MREF+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags, "mandateId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "CRED+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags, "creditorSchemeId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "DEBT+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags, "originatorId", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "SVWZ+")==0) {
-        AHB_SWIFT_SetCharValue(dbData, flags | GWEN_DB_FLAGS_OVERWRITE_VARS, "purpose", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "ABWA+")==0) {
-        /* "abweichender Auftraggeber" */
-        AHB_SWIFT_SetCharValue(dbData, flags, "ultimateDebtor", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "ABWE+")==0) {
-        /* "abweichender Empfaenger" */
-        AHB_SWIFT_SetCharValue(dbData, flags, "ultimateCreditor", GWEN_Buffer_GetStart(tbuf));
-      }
-      else if (strcasecmp(sVarName, "_purpose")==0) {
-        /* manually added tag (i.e. data outside a tag)
-        * will be replaced if there was a real purpose field (i.e. "SVWZ+") */
-        AHB_SWIFT_SetCharValue(dbData, flags, "purpose", GWEN_Buffer_GetStart(tbuf));
-      }
-      GWEN_Buffer_free(tbuf);
+    if (fieldLen<1) {
+      DBG_WARN(AQBANKING_LOGDOMAIN, "Ignoring empty SEPA field \"%.5s\"", sFieldStart);
+      return AHB_SWIFT940_86_SEPA_IGNORE;
     }
 
-    dbVar=GWEN_DB_GetNextVar(dbVar);
+    *pPayload=sPayload;
+    *pPayloadLen=fieldLen;
+    for (i=0; i<AHB_SWIFT940_86_SEPA_KNOWN; i++) {
+      if (strncasecmp(sFieldStart, _sepaFieldIds[i], 5)==0)
+        return i;
+    }
+    return AHB_SWIFT940_86_SEPA_UNKNOWN;
   }
+
+  /* field is shorter than 5 bytes or pos 4 doesn't contain a plus, treat as normal purpose */
+  *pPayload=sFieldStart;
+  *pPayloadLen=fieldLen;
+  return AHB_SWIFT940_86_SEPA_PURPOSE;
 }
 
 
@@ -14,6 +14,7 @@
 #include "swift_tag.h"
 
 #include <gwenhywfar/misc.h>
+#include <gwenhywfar/buffer.h>
 #include <gwenhywfar/dbio.h>
 #include <gwenhywfar/gwendate.h>
 
@@ -27,6 +28,25 @@
 
 int AHB_SWIFT_Condense(char *buffer, int keepDoubleBlanks);
 
+/**
+ * Reads all SWIFT documents from the given io layer (this is what the DBIO plugin does on import,
+ * also used by swift_bench).
+ * @param cfg module params, "type" ("mt940", "mt942" or "mt535") must be valid
+ */
+int AHB_SWIFT_Import(GWEN_SYNCIO *sio, GWEN_DB_NODE *data, GWEN_DB_NODE *cfg, uint32_t flags);
+
+/**
+ * Condenses the given string like @ref AHB_SWIFT_Condense and appends the result converted
+ * to UTF-8 to destBuf (like @ref AHB_SWIFT_SetCharValue would store it).
+ * The source is not modified and doesn't need to be 0-terminated.
+ * @param s string to condense
+ * @param len length of the string
+ * @param keepMultipleBlanks see @ref AHB_SWIFT_Condense
+ * @param tmpBuf work buffer (will be reset), allows reusing buffers over multiple calls
+ * @param destBuf buffer to append the result to
+ */
+void AHB_SWIFT_CondenseToUtf8(const char *s, int len, int keepMultipleBlanks, GWEN_BUFFER *tmpBuf, GWEN_BUFFER *destBuf);
+
 int AHB_SWIFT_SetCharValue(GWEN_DB_NODE *db, uint32_t flags, const char *name, const char *s);
 
 GWEN_DATE *AHB_SWIFT_ReadDateYYMMDD(const char **pCurrentChar, unsigned int *pBytesLeft);
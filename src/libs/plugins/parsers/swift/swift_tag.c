@@ -27,6 +27,11 @@ GWEN_LIST_FUNCTIONS(AHB_SWIFT_TAG, AHB_SWIFT_Tag);
 GWEN_LIST_FUNCTIONS(AHB_SWIFT_SUBTAG, AHB_SWIFT_SubTag);
 
 
+#ifdef AHB_SWIFT_COUNT_ALLOCS
+unsigned long ahb_swift_tag_allocs=0;
+#endif
+
+
 
 /* ------------------------------------------------------------------------------------------------
  * forward declarations
@@ -49,19 +54,32 @@ static const char *_findStartOfSubTag(const char *sptr);
 
      AHB_SWIFT_Tag_new("28C", "7/1")
 
-   @return a new AHB_SWIFT_TAG
+   @return a new AHB_SWIFT_TAG (NULL if memory is exhausted)
  */
 AHB_SWIFT_TAG *AHB_SWIFT_Tag_new(const char *id,
                                  const char *content)
 {
   AHB_SWIFT_TAG *tg;
+  int idLen;
 
   assert(id);
   assert(content);
   GWEN_NEW_OBJECT(AHB_SWIFT_TAG, tg);
   GWEN_LIST_INIT(AHB_SWIFT_TAG, tg);
-  tg->id=strdup(id);
-  tg->content=strdup(content);
+  idLen=strlen(id);
+  tg->contentLen=strlen(content);
+  /* id and content share a single allocation */
+  tg->id=(char *) malloc(idLen+1+tg->contentLen+1);
+  if (tg->id==NULL) {
+    DBG_ERROR(AQBANKING_LOGDOMAIN, "Memory full (%d bytes)", idLen+1+tg->contentLen+1);
+    GWEN_LIST_FINI(AHB_SWIFT_TAG, tg);
+    GWEN_FREE_OBJECT(tg);
+    return NULL;
+  }
+  memmove(tg->id, id, idLen+1);
+  tg->content=tg->id+idLen+1;
+  memmove(tg->content, content, tg->contentLen+1);
+  AHB_SWIFT_ADD_ALLOCS(2);
 
   return tg;
 }
@@ -73,7 +91,6 @@ void AHB_SWIFT_Tag_free(AHB_SWIFT_TAG *tg)
   if (tg) {
     GWEN_LIST_FINI(AHB_SWIFT_TAG, tg);
     free(tg->id);
-    free(tg->content);
     GWEN_FREE_OBJECT(tg);
   }
 }
@@ -96,6 +113,14 @@ const char *AHB_SWIFT_Tag_GetData(const AHB_SWIFT_TAG *tg)
 
 
 
+int AHB_SWIFT_Tag_GetDataLen(const AHB_SWIFT_TAG *tg)
+{
+  assert(tg);
+  return tg->contentLen;
+}
+
+
+
 
 
 AHB_SWIFT_SUBTAG *AHB_SWIFT_SubTag_new(int id, const char *content, int clen)
@@ -111,6 +136,7 @@ AHB_SWIFT_SUBTAG *AHB_SWIFT_SubTag_new(int id, const char *content, int clen)
   stg->content=(char *)malloc(clen+1);
   memmove(stg->content, content, clen);
   stg->content[clen]=0;
+  AHB_SWIFT_ADD_ALLOCS(2);
   return stg;
 }
 
@@ -194,14 +220,11 @@ const char *_findStartOfSubTag(const char *sptr)
 
 
 
-int AHB_SWIFT_GetNextSubTag(const char **sptr, AHB_SWIFT_SUBTAG **tptr)
+int AHB_SWIFT_GetNextSubTagView(const char **sptr, AHB_SWIFT_SUBTAG_VIEW *view)
 {
   const char *s;
   int id=0;
-  /*int nextId=0;*/
-  const char *content=NULL;
   const char *startOfSubTag;
-  AHB_SWIFT_SUBTAG *stg;
 
   s=*sptr;
   startOfSubTag=_findStartOfSubTag(s);
@@ -222,28 +245,45 @@ int AHB_SWIFT_GetNextSubTag(const char **sptr, AHB_SWIFT_SUBTAG **tptr)
         s=t;
       }
     }
-    content=s;
 
-    /* create subtag */
     startOfNextSubTag=_findStartOfSubTag(s);
+    view->id=id;
+    view->content=s;
     if (startOfNextSubTag)
-      stg=AHB_SWIFT_SubTag_new(id, content, startOfNextSubTag-content);
+      view->contentLen=startOfNextSubTag-s;
     else
       /* rest of line */
-      stg=AHB_SWIFT_SubTag_new(id, content, -1);
-    /* update return pointers */
-    *tptr=stg;
+      view->contentLen=strlen(s);
+
+    /* update return pointer */
     *sptr=startOfNextSubTag;
     return 0;
   }
   else {
-    DBG_ERROR(GWEN_LOGDOMAIN, "No subtag found");
+    DBG_INFO(AQBANKING_LOGDOMAIN, "No subtag found");
     return GWEN_ERROR_NO_DATA;
   }
 }
 
 
 
+int AHB_SWIFT_GetNextSubTag(const char **sptr, AHB_SWIFT_SUBTAG **tptr)
+{
+  AHB_SWIFT_SUBTAG_VIEW view;
+  int rv;
+
+  rv=AHB_SWIFT_GetNextSubTagView(sptr, &view);
+  if (rv<0) {
+    DBG_ERROR(GWEN_LOGDOMAIN, "No subtag found");
+    return rv;
+  }
+
+  *tptr=AHB_SWIFT_SubTag_new(view.id, view.content, view.contentLen);
+  return 0;
+}
+
+
+
 int AHB_SWIFT_ParseSubTags(const char *s, AHB_SWIFT_SUBTAG_LIST *stlist, int keepMultipleBlanks)
 {
   while (s && *s) {
@@ -13,6 +13,7 @@
 
 typedef struct AHB_SWIFT_TAG AHB_SWIFT_TAG;
 typedef struct AHB_SWIFT_SUBTAG AHB_SWIFT_SUBTAG;
+typedef struct AHB_SWIFT_SUBTAG_VIEW AHB_SWIFT_SUBTAG_VIEW;
 
 
 #include "swift.h"
@@ -20,6 +21,15 @@ typedef struct AHB_SWIFT_SUBTAG AHB_SWIFT_SUBTAG;
 #include <gwenhywfar/inherit.h>
 
 
+/* only defined for swift_bench: count heap allocations of tags and subtags */
+#ifdef AHB_SWIFT_COUNT_ALLOCS
+extern unsigned long ahb_swift_tag_allocs;
+# define AHB_SWIFT_ADD_ALLOCS(n) (ahb_swift_tag_allocs+=(n))
+#else
+# define AHB_SWIFT_ADD_ALLOCS(n)
+#endif
+
+
 GWEN_LIST_FUNCTION_DEFS(AHB_SWIFT_TAG, AHB_SWIFT_Tag);
 
 
@@ -29,6 +39,7 @@ void AHB_SWIFT_Tag_free(AHB_SWIFT_TAG *tg);
 
 const char *AHB_SWIFT_Tag_GetId(const AHB_SWIFT_TAG *tg);
 const char *AHB_SWIFT_Tag_GetData(const AHB_SWIFT_TAG *tg);
+int AHB_SWIFT_Tag_GetDataLen(const AHB_SWIFT_TAG *tg);
 
 
 
@@ -48,6 +59,27 @@ int AHB_SWIFT_ParseSubTags(const char *s, AHB_SWIFT_SUBTAG_LIST *stlist, int kee
 
 
 
+/**
+ * View on a subtag inside the data of a tag. Nothing is copied, content points into the
+ * data of the tag and is NOT 0-terminated (use contentLen).
+ */
+struct AHB_SWIFT_SUBTAG_VIEW {
+  int id;
+  const char *content;
+  int contentLen;
+};
+
+/**
+ * Finds the next subtag (e.g. "?20") and lets the given view point to it.
+ * Uncondensed data is returned (see @ref AHB_SWIFT_CondenseToUtf8).
+ * @return 0 if ok, GWEN_ERROR_NO_DATA if there is no further subtag
+ * @param sptr pointer to the current position, updated to the start of the next subtag (or NULL)
+ * @param view view to fill
+ */
+int AHB_SWIFT_GetNextSubTagView(const char **sptr, AHB_SWIFT_SUBTAG_VIEW *view);
+
+
+
 
 
 #endif /* AQHBCIBANK_SWIDT_TAG_H */
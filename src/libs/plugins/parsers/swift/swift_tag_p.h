@@ -16,8 +16,9 @@
 
 struct AHB_SWIFT_TAG {
   GWEN_LIST_ELEMENT(AHB_SWIFT_TAG);
-  char *id;
+  char *id;        /* id and content share a single allocation */
   char *content;
+  int contentLen;
 };
 
 
@@ -14,6 +14,20 @@
 #include "globals.h"
 #include <gwenhywfar/text.h>
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* number of IBANs read from stdin and checked at once */
+#define CHKIBAN_BATCH_SIZE  4096
+#define CHKIBAN_MAX_IBANLEN 64
+
+
+
+static int _checkIbansFromStdin(int numThreads);
+
 
 
 int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
@@ -22,17 +36,29 @@ int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   int rv;
   AB_BANKINFO_CHECKRESULT res;
   const char *iban;
+  int numThreads;
   const GWEN_ARGS args[]= {
     {
       GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
       GWEN_ArgsType_Char,            /* type */
       "iban",                       /* name */
-      1,                            /* minnum */
+      0,                            /* minnum */
       1,                            /* maxnum */
       0,                            /* short option */
       "iban",                       /* long option */
       "Specify the IBAN to check",  /* short description */
-      "Specify the IBAN to check"   /* long description */
+      "Specify the IBAN to check (read IBANs from stdin, one per line, if omitted)" /* long description */
+    },
+    {
+      GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
+      GWEN_ArgsType_Int,            /* type */
+      "threads",                    /* name */
+      0,                            /* minnum */
+      1,                            /* maxnum */
+      0,                            /* short option */
+      "threads",                    /* long option */
+      "Number of threads for checking IBANs from stdin",  /* short description */
+      "Number of threads for checking IBANs from stdin"   /* long description */
     },
     {
       GWEN_ARGS_FLAGS_HELP | GWEN_ARGS_FLAGS_LAST, /* flags */
@@ -65,8 +91,9 @@ int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
       return 1;
     }
     fprintf(stdout,
-            I18N("This command checks the given combination of account id\n"
-                 "and bank code for validity.\n"
+            I18N("This command checks the given IBAN for validity.\n"
+                 "If no IBAN is given IBANs are read from stdin (one per line)\n"
+                 "and all invalid IBANs are printed.\n"
                  "\n"
                  "Return codes:\n"
                  " 1: missing/bad arguments\n"
@@ -82,7 +109,7 @@ int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   }
 
   iban=GWEN_DB_GetCharValue(db, "iban", 0, 0);
-  assert(iban);
+  numThreads=GWEN_DB_GetIntValue(db, "threads", 0, 1);
 
   rv=AB_Banking_Init(ab);
   if (rv) {
@@ -90,11 +117,25 @@ int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     return 2;
   }
 
-  res=AB_Banking_CheckIban(iban);
-  if (res != 0) {
-    DBG_ERROR(0,
-              "IBAN is invalid");
-    return 3;
+  if (iban) {
+    res=AB_Banking_CheckIban(iban);
+    if (res != 0) {
+      DBG_ERROR(0,
+                "IBAN is invalid");
+      return 3;
+    }
+  }
+  else {
+    rv=_checkIbansFromStdin(numThreads);
+    if (rv<0) {
+      AB_Banking_Fini(ab);
+      return 1;
+    }
+    else if (rv>0) {
+      DBG_ERROR(0, "%d IBAN(s) invalid", rv);
+      AB_Banking_Fini(ab);
+      return 3;
+    }
   }
 
   rv=AB_Banking_Fini(ab);
@@ -108,6 +149,73 @@ int chkIban(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
 
 
+int _checkIbansFromStdin(int numThreads)
+{
+  char (*lines)[CHKIBAN_MAX_IBANLEN];
+  const char **ibans;
+  int *results;
+  int numInvalid=0;
+  int eof=0;
+
+  lines=malloc(CHKIBAN_BATCH_SIZE*sizeof(*lines));
+  ibans=malloc(CHKIBAN_BATCH_SIZE*sizeof(*ibans));
+  results=malloc(CHKIBAN_BATCH_SIZE*sizeof(*results));
+  if (lines==NULL || ibans==NULL || results==NULL) {
+    fprintf(stderr, "ERROR: Out of memory\n");
+    free(results);
+    free(ibans);
+    free(lines);
+    return GWEN_ERROR_MEMORY_FULL;
+  }
+
+  while (!eof) {
+    int count=0;
+    int rv;
+    int i;
+
+    /* read next batch */
+    while (count<CHKIBAN_BATCH_SIZE) {
+      char *s;
+
+      if (fgets(lines[count], CHKIBAN_MAX_IBANLEN, stdin)==NULL) {
+        eof=1;
+        break;
+      }
+      s=strchr(lines[count], '\n');
+      if (s==NULL && !feof(stdin)) {
+        int c;
+
+        /* line too long, skip rest of it (the IBAN will be reported as invalid) */
+        while ((c=getchar())!=EOF && c!='\n');
+      }
+      lines[count][strcspn(lines[count], "\r\n")]=0;
+      if (lines[count][0]) {
+        ibans[count]=lines[count];
+        count++;
+      }
+    }
+
+    rv=AB_Banking_CheckIbanList(ibans, count, results, numThreads);
+    if (rv<0) {
+      fprintf(stderr, "ERROR: Error checking IBANs (%d)\n", rv);
+      free(results);
+      free(ibans);
+      free(lines);
+      return rv;
+    }
+    numInvalid+=rv;
+
+    for (i=0; i<count; i++) {
+      if (results[i]!=0)
+        fprintf(stdout, "%s\n", ibans[i]);
+    }
+  }
+
+  free(results);
+  free(ibans);
+  free(lines);
+  return numInvalid;
+}
 
 
 
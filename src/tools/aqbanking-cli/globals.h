@@ -54,6 +54,44 @@ typedef enum {
 
 
 
+enum {
+  AQBANKING_TOOL_TEMPLATE_FIELD_LITERAL=0,
+  AQBANKING_TOOL_TEMPLATE_FIELD_CHAR,
+  AQBANKING_TOOL_TEMPLATE_FIELD_DB,
+  AQBANKING_TOOL_TEMPLATE_FIELD_VALUE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_DATE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_VALUTADATE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_DATEORVALUTADATE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSELINE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSEINONELINE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_TYPE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_SUBTYPE,
+  AQBANKING_TOOL_TEMPLATE_FIELD_COMMAND,
+  AQBANKING_TOOL_TEMPLATE_FIELD_STATUS,
+  AQBANKING_TOOL_TEMPLATE_FIELD_SEQUENCE
+};
+
+
+/** part of a compiled output template: literal text or a variable */
+typedef struct AQBANKING_TOOL_TEMPLATE_PART AQBANKING_TOOL_TEMPLATE_PART;
+struct AQBANKING_TOOL_TEMPLATE_PART {
+  int field;
+  char *text;                 /* literal text or name of the variable */
+  int textLen;
+  int index;
+  const char *(*getCharFn)(const AB_TRANSACTION *t);
+};
+
+
+typedef struct AQBANKING_TOOL_TEMPLATE AQBANKING_TOOL_TEMPLATE;
+struct AQBANKING_TOOL_TEMPLATE {
+  AQBANKING_TOOL_TEMPLATE_PART *parts;
+  int partCount;
+  const char *dateTemplate;
+};
+
+
+
 
 /* ========================================================================================================================
  *                                                util.c
@@ -64,6 +102,25 @@ typedef enum {
 int readContext(const char *ctxFile, AB_IMEXPORTER_CONTEXT **pCtx, int mustExist);
 int writeContext(const char *ctxFile, const AB_IMEXPORTER_CONTEXT *ctx);
 
+/**
+ * Read only the account infos matching the given parameters (and transactions within the given date range).
+ * Uses @ref AB_ImExporterContext_ReadAccountInfos, so for binary context files only the matching parts are decoded.
+ */
+int readContextForAccounts(const char *ctxFile,
+                           AB_IMEXPORTER_CONTEXT **pCtx,
+                           uint32_t uniqueAccountId,
+                           const char *bankId,
+                           const char *accountId,
+                           const char *subAccountId,
+                           const char *iban,
+                           const GWEN_DATE *fromDate,
+                           const GWEN_DATE *toDate);
+
+/**
+ * Write context files in the binary format (reading always detects the format automatically).
+ */
+void setBinaryContextFiles(int i);
+
 AB_TRANSACTION *mkSepaTransfer(GWEN_DB_NODE *db, int cmd);
 
 AB_TRANSACTION *mkSepaDebitNote(GWEN_DB_NODE *db, int cmd);
@@ -125,6 +182,14 @@ int createAndAddRequests(AB_BANKING *ab,
 
 int addTransactionToBufferByTemplate(const AB_TRANSACTION *t, const char *tmplString, GWEN_BUFFER *dbuf);
 
+/**
+ * Compile a template string (containing variables like "$(remoteName)") for use with
+ * @ref addTransactionToBufferByCompiledTemplate. Use this when writing many transactions with the same template.
+ */
+AQBANKING_TOOL_TEMPLATE *compileTransactionTemplate(const char *tmplString);
+void freeTransactionTemplate(AQBANKING_TOOL_TEMPLATE *tmpl);
+int addTransactionToBufferByCompiledTemplate(const AB_TRANSACTION *t, const AQBANKING_TOOL_TEMPLATE *tmpl, GWEN_BUFFER *dbuf);
+
 
 
 /* ========================================================================================================================
@@ -79,7 +79,7 @@ int listBal(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
   /* load ctx file */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
-  rv=readContext(ctxFile, &ctx, 1);
+  rv=readContextForAccounts(ctxFile, &ctx, aid, bankId, accountId, subAccountId, iban, NULL, NULL);
   if (rv<0) {
     DBG_ERROR(0, "Error reading context (%d)", rv);
     AB_ImExporterContext_free(ctx);
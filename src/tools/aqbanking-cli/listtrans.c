@@ -17,6 +17,7 @@
 
 
 static GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv);
+static int _transactionInDateRange(const AB_TRANSACTION *t, const GWEN_DATE *fromDate, const GWEN_DATE *toDate);
 
 
 
@@ -36,7 +37,10 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
   int transactionType=0;
   int transactionCommand=0;
   const char *tmplString;
+  AQBANKING_TOOL_TEMPLATE *tmpl;
   const char *s;
+  GWEN_DATE *fromDate=NULL;
+  GWEN_DATE *toDate=NULL;
 
   /* parse command line arguments */
   db=_readCommandLine(dbArgs, argc, argv);
@@ -79,19 +83,53 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     }
   }
 
+  s=GWEN_DB_GetCharValue(db, "fromDate", 0, NULL);
+  if (s && *s) {
+    fromDate=GWEN_Date_fromStringWithTemplate(s, "YYYYMMDD");
+    if (fromDate==NULL) {
+      fprintf(stderr, "ERROR: Invalid fromdate value \"%s\"\n", s);
+      return 1;
+    }
+  }
+
+  s=GWEN_DB_GetCharValue(db, "toDate", 0, NULL);
+  if (s && *s) {
+    toDate=GWEN_Date_fromStringWithTemplate(s, "YYYYMMDD");
+    if (toDate==NULL) {
+      fprintf(stderr, "ERROR: Invalid todate value \"%s\"\n", s);
+      GWEN_Date_free(fromDate);
+      return 1;
+    }
+  }
+
+  /* parse the template only once instead of for every transaction */
+  tmpl=compileTransactionTemplate(tmplString);
+  if (tmpl==NULL) {
+    fprintf(stderr, "ERROR: Invalid template \"%s\"\n", tmplString);
+    GWEN_Date_free(toDate);
+    GWEN_Date_free(fromDate);
+    return 1;
+  }
+
   /* init AqBanking */
   rv=AB_Banking_Init(ab);
   if (rv) {
     DBG_ERROR(0, "Error on init (%d)", rv);
+    freeTransactionTemplate(tmpl);
+    GWEN_Date_free(toDate);
+    GWEN_Date_free(fromDate);
     return 2;
   }
 
   /* load ctx file */
   ctxFile=GWEN_DB_GetCharValue(db, "ctxfile", 0, 0);
-  rv=readContext(ctxFile, &ctx, 1);
+  rv=readContextForAccounts(ctxFile, &ctx, aid, bankId, accountId, subAccountId, iban, fromDate, toDate);
   if (rv<0) {
     DBG_ERROR(0, "Error reading context (%d)", rv);
     AB_ImExporterContext_free(ctx);
+    freeTransactionTemplate(tmpl);
+    GWEN_Date_free(toDate);
+    GWEN_Date_free(fromDate);
     return 4;
   }
 
@@ -118,13 +156,17 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
         t=AB_Transaction_List_FindFirstByType(tl, transactionType, transactionCommand);
         while (t) {
-          rv=addTransactionToBufferByTemplate(t, tmplString, dbuf);
-          if (rv<0) {
+          /* text context files are not filtered while reading */
+          if (_transactionInDateRange(t, fromDate, toDate)) {
+            rv=addTransactionToBufferByCompiledTemplate(t, tmpl, dbuf);
+            if (rv<0) {
+            }
+
+            GWEN_Buffer_AppendByte(dbuf, '\n');
+            fwrite(GWEN_Buffer_GetStart(dbuf), GWEN_Buffer_GetUsedBytes(dbuf), 1, stdout);
+            GWEN_Buffer_Reset(dbuf);
           }
 
-          fprintf(stdout, "%s\n", GWEN_Buffer_GetStart(dbuf));
-          GWEN_Buffer_Reset(dbuf);
-
           t=AB_Transaction_List_FindNextByType(t, transactionType, transactionCommand);
         }
         GWEN_Buffer_free(dbuf);
@@ -134,6 +176,9 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
     iea=AB_ImExporterAccountInfo_List_Next(iea);
   } /* while */
   AB_ImExporterContext_free(ctx);
+  freeTransactionTemplate(tmpl);
+  GWEN_Date_free(toDate);
+  GWEN_Date_free(fromDate);
 
   /* deinit */
   rv=AB_Banking_Fini(ab);
@@ -147,6 +192,24 @@ int listTrans(AB_BANKING *ab, GWEN_DB_NODE *dbArgs, int argc, char **argv)
 
 
 
+int _transactionInDateRange(const AB_TRANSACTION *t, const GWEN_DATE *fromDate, const GWEN_DATE *toDate)
+{
+  const GWEN_DATE *dt;
+
+  dt=AB_Transaction_GetDate(t);
+  if (dt==NULL)
+    dt=AB_Transaction_GetValutaDate(t);
+  if (dt==NULL)
+    return 1;
+  if (fromDate && GWEN_Date_Diff(dt, fromDate)<0)
+    return 0;
+  if (toDate && GWEN_Date_Diff(dt, toDate)>0)
+    return 0;
+  return 1;
+}
+
+
+
 /* parse command line */
 GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv)
 {
@@ -230,6 +293,28 @@ GWEN_DB_NODE *_readCommandLine(GWEN_DB_NODE *dbArgs, int argc, char **argv)
       "Specify the transaction command to filter",      /* short description */
       "Specify the transaction command to filter"       /* long description */
     },
+    {
+      GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
+      GWEN_ArgsType_Char,           /* type */
+      "fromDate",                   /* name */
+      0,                            /* minnum */
+      1,                            /* maxnum */
+      0,                            /* short option */
+      "fromdate",                   /* long option */
+      "Specify the first date of transactions to list (YYYYMMDD)", /* short description */
+      "Specify the first date of transactions to list (YYYYMMDD)"  /* long description */
+    },
+    {
+      GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
+      GWEN_ArgsType_Char,           /* type */
+      "toDate",                     /* name */
+      0,                            /* minnum */
+      1,                            /* maxnum */
+      0,                            /* short option */
+      "todate",                     /* long option */
+      "Specify the last date of transactions to list (YYYYMMDD)", /* short description */
+      "Specify the last date of transactions to list (YYYYMMDD)"  /* long description */
+    },
     {
       GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
       GWEN_ArgsType_Char,            /* type */
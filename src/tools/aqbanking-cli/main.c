@@ -92,6 +92,18 @@ int main(int argc, char **argv)
       "Automatically accept all valid TLS certificate",
       "Automatically accept all valid TLS certificate"
     },
+    {
+      0,                            /* flags */
+      GWEN_ArgsType_Int,            /* type */
+      "binaryContext",              /* name */
+      0,                            /* minnum */
+      1,                            /* maxnum */
+      0,                            /* short option */
+      "binctx",                     /* long option */
+      "Write context files in binary format",
+      "Write context files in the binary format which is much faster to read.\n"
+      "Context files are always read in the format they are written in."
+    },
     {
       GWEN_ARGS_FLAGS_HAS_ARGUMENT, /* flags */
       GWEN_ArgsType_Char,           /* type */
@@ -286,6 +298,7 @@ int main(int argc, char **argv)
   acceptValidCerts=GWEN_DB_GetIntValue(db, "acceptValidCerts", 0, 0);
   cfgDir=GWEN_DB_GetCharValue(db, "cfgdir", 0, 0);
   ctrlBackend=GWEN_DB_GetCharValue(db, "control", 0, 0);
+  setBinaryContextFiles(GWEN_DB_GetIntValue(db, "binaryContext", 0, 0));
 
   gui=GWEN_Gui_CGui_new();
   s=GWEN_DB_GetCharValue(db, "charset", 0, NULL);
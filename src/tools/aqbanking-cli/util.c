@@ -13,16 +13,113 @@
 
 #include "globals.h"
 
+#include <aqbanking/types/imexporter_context_bin.h>
+
 #include <gwenhywfar/text.h>
 #include <gwenhywfar/syncio_file.h>
 
 #include <errno.h>
 #include <ctype.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+static void _templateAddLiteral(AQBANKING_TOOL_TEMPLATE *tmpl, const char *s, int len);
+static int _templateAddVariable(AQBANKING_TOOL_TEMPLATE *tmpl, const char *s, int len);
+static AQBANKING_TOOL_TEMPLATE_PART *_templateNewPart(AQBANKING_TOOL_TEMPLATE *tmpl);
+static void _templateWriteDerivedField(const AQBANKING_TOOL_TEMPLATE *tmpl,
+                                       const AQBANKING_TOOL_TEMPLATE_PART *part,
+                                       const AB_TRANSACTION *t,
+                                       GWEN_BUFFER *dbuf);
+static void _templateWritePurposeLine(const char *purpose, int index, GWEN_BUFFER *dbuf);
+static int _readContextData(const char *ctxFile, GWEN_BUFFER *dataBuf, int mustExist);
+static int _readAll(GWEN_SYNCIO *sio, GWEN_BUFFER *destBuf);
+static int _contextFromTextData(GWEN_BUFFER *dataBuf, AB_IMEXPORTER_CONTEXT **pCtx);
+static int _writeBinaryContext(GWEN_SYNCIO *sio, const AB_IMEXPORTER_CONTEXT *ctx);
+static int _checkBinaryContextFile(const char *ctxFile);
+static int _appendTransactionToBinaryContextFile(const AB_TRANSACTION *t, const char *ctxFile);
+
+
+
+static int _binaryContextFiles=0;
+
+
+
+/* template variables read directly from the transaction */
+static const struct {
+  const char *name;
+  const char *(*getCharFn)(const AB_TRANSACTION *t);
+} _templateCharFields[]= {
+  {"stringIdForApplication", AB_Transaction_GetStringIdForApplication},
+  {"fiId",                   AB_Transaction_GetFiId},
+  {"localIban",              AB_Transaction_GetLocalIban},
+  {"localBic",               AB_Transaction_GetLocalBic},
+  {"localCountry",           AB_Transaction_GetLocalCountry},
+  {"localBankCode",          AB_Transaction_GetLocalBankCode},
+  {"localBranchId",          AB_Transaction_GetLocalBranchId},
+  {"localAccountNumber",     AB_Transaction_GetLocalAccountNumber},
+  {"localSuffix",            AB_Transaction_GetLocalSuffix},
+  {"localName",              AB_Transaction_GetLocalName},
+  {"remoteCountry",          AB_Transaction_GetRemoteCountry},
+  {"remoteBankCode",         AB_Transaction_GetRemoteBankCode},
+  {"remoteBranchId",         AB_Transaction_GetRemoteBranchId},
+  {"remoteAccountNumber",    AB_Transaction_GetRemoteAccountNumber},
+  {"remoteSuffix",           AB_Transaction_GetRemoteSuffix},
+  {"remoteIban",             AB_Transaction_GetRemoteIban},
+  {"remoteBic",              AB_Transaction_GetRemoteBic},
+  {"remoteName",             AB_Transaction_GetRemoteName},
+  {"transactionText",        AB_Transaction_GetTransactionText},
+  {"transactionKey",         AB_Transaction_GetTransactionKey},
+  {"primanota",              AB_Transaction_GetPrimanota},
+  {"purpose",                AB_Transaction_GetPurpose},
+  {"category",               AB_Transaction_GetCategory},
+  {"customerReference",      AB_Transaction_GetCustomerReference},
+  {"bankReference",          AB_Transaction_GetBankReference},
+  {"endToEndReference",      AB_Transaction_GetEndToEndReference},
+  {"ultimateCreditor",       AB_Transaction_GetUltimateCreditor},
+  {"ultimateDebtor",         AB_Transaction_GetUltimateDebtor},
+  {"creditorSchemeId",       AB_Transaction_GetCreditorSchemeId},
+  {"originatorId",           AB_Transaction_GetOriginatorId},
+  {"mandateId",              AB_Transaction_GetMandateId},
+  {"mandateDebitorName",     AB_Transaction_GetMandateDebitorName},
+  {"memo",                   AB_Transaction_GetMemo},
+  {NULL, NULL}
+};
+
+
+/* template variables which are formatted or derived from other members */
+static const struct {
+  const char *name;
+  int field;
+} _templateDerivedFields[]= {
+  {"valueAsString",            AQBANKING_TOOL_TEMPLATE_FIELD_VALUE},
+  {"dateAsString",             AQBANKING_TOOL_TEMPLATE_FIELD_DATE},
+  {"valutaDateAsString",       AQBANKING_TOOL_TEMPLATE_FIELD_VALUTADATE},
+  {"dateOrValutaDateAsString", AQBANKING_TOOL_TEMPLATE_FIELD_DATEORVALUTADATE},
+  {"purposeLine",              AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSELINE},
+  {"purposeInOneLine",         AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSEINONELINE},
+  {"type",                     AQBANKING_TOOL_TEMPLATE_FIELD_TYPE},
+  {"subType",                  AQBANKING_TOOL_TEMPLATE_FIELD_SUBTYPE},
+  {"command",                  AQBANKING_TOOL_TEMPLATE_FIELD_COMMAND},
+  {"status",                   AQBANKING_TOOL_TEMPLATE_FIELD_STATUS},
+  {"sequence",                 AQBANKING_TOOL_TEMPLATE_FIELD_SEQUENCE},
+  {NULL, 0}
+};
+
 
 
 
-static int GWENHYWFAR_CB _replaceVarsCb(void *cbPtr, const char *name, int index, int maxLen, GWEN_BUFFER *dstBuf);
+/* ========================================================================================================================
+ *                                                setBinaryContextFiles
+ * ========================================================================================================================
+ */
 
+void setBinaryContextFiles(int i)
+{
+  _binaryContextFiles=i;
+}
 
 
 
@@ -36,8 +133,99 @@ int readContext(const char *ctxFile,
                 int mustExist)
 {
   AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_BUFFER *dataBuf;
+  int rv;
+
+  dataBuf=GWEN_Buffer_new(0, 4096, 0, 1);
+  rv=_readContextData(ctxFile, dataBuf, mustExist);
+  if (rv!=0) {
+    GWEN_Buffer_free(dataBuf);
+    if (rv==GWEN_ERROR_NOT_FOUND) {
+      *pCtx=AB_ImExporterContext_new();
+      return 0;
+    }
+    return rv;
+  }
+
+  if (AB_ImExporterContext_IsBinary((const uint8_t *) GWEN_Buffer_GetStart(dataBuf), GWEN_Buffer_GetUsedBytes(dataBuf))) {
+    ctx=AB_ImExporterContext_new();
+    rv=AB_ImExporterContext_ReadBinary(ctx,
+                                       (const uint8_t *) GWEN_Buffer_GetStart(dataBuf),
+                                       GWEN_Buffer_GetUsedBytes(dataBuf));
+    GWEN_Buffer_free(dataBuf);
+    if (rv<0) {
+      DBG_ERROR(0, "Error reading binary context file (%d)", rv);
+      AB_ImExporterContext_free(ctx);
+      return rv;
+    }
+    *pCtx=ctx;
+    return 0;
+  }
+
+  rv=_contextFromTextData(dataBuf, pCtx);
+  GWEN_Buffer_free(dataBuf);
+  return rv;
+}
+
+
+
+/* ========================================================================================================================
+ *                                                readContextForAccounts
+ * ========================================================================================================================
+ */
+
+int readContextForAccounts(const char *ctxFile,
+                           AB_IMEXPORTER_CONTEXT **pCtx,
+                           uint32_t uniqueAccountId,
+                           const char *bankId,
+                           const char *accountId,
+                           const char *subAccountId,
+                           const char *iban,
+                           const GWEN_DATE *fromDate,
+                           const GWEN_DATE *toDate)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_BUFFER *dataBuf;
+  int rv;
+
+  dataBuf=GWEN_Buffer_new(0, 4096, 0, 1);
+  rv=_readContextData(ctxFile, dataBuf, 1);
+  if (rv!=0) {
+    GWEN_Buffer_free(dataBuf);
+    return rv;
+  }
+
+  ctx=AB_ImExporterContext_new();
+  rv=AB_ImExporterContext_ReadAccountInfos(ctx,
+                                           (const uint8_t *) GWEN_Buffer_GetStart(dataBuf),
+                                           GWEN_Buffer_GetUsedBytes(dataBuf),
+                                           uniqueAccountId,
+                                           "*",
+                                           bankId,
+                                           accountId,
+                                           subAccountId,
+                                           iban,
+                                           "*", /* currency */
+                                           AB_AccountType_Unknown,
+                                           fromDate,
+                                           toDate);
+  GWEN_Buffer_free(dataBuf);
+  if (rv<0) {
+    DBG_ERROR(0, "Error reading context file (%d)", rv);
+    AB_ImExporterContext_free(ctx);
+    return rv;
+  }
+  *pCtx=ctx;
+
+  return 0;
+}
+
+
+
+/* returns GWEN_ERROR_NOT_FOUND if the file doesn't exist and mustExist is 0 */
+int _readContextData(const char *ctxFile, GWEN_BUFFER *dataBuf, int mustExist)
+{
   GWEN_SYNCIO *sio;
-  GWEN_DB_NODE *dbCtx;
   int rv;
 
   if (ctxFile==NULL) {
@@ -51,31 +239,68 @@ int readContext(const char *ctxFile,
     GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
     rv=GWEN_SyncIo_Connect(sio);
     if (rv<0) {
-      if (!mustExist) {
-        ctx=AB_ImExporterContext_new();
-        *pCtx=ctx;
-        GWEN_SyncIo_free(sio);
-        return 0;
-      }
       GWEN_SyncIo_free(sio);
+      if (!mustExist)
+        return GWEN_ERROR_NOT_FOUND;
       return 4;
     }
   }
 
   /* actually read */
+  rv=_readAll(sio, dataBuf);
+  GWEN_SyncIo_Disconnect(sio);
+  GWEN_SyncIo_free(sio);
+  if (rv<0) {
+    DBG_ERROR(0, "Error reading context file (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
+int _readAll(GWEN_SYNCIO *sio, GWEN_BUFFER *destBuf)
+{
+  for (;;) {
+    int rv;
+
+    GWEN_Buffer_AllocRoom(destBuf, 4096);
+    rv=GWEN_SyncIo_Read(sio,
+                        (uint8_t *) GWEN_Buffer_GetPosPointer(destBuf),
+                        GWEN_Buffer_GetMaxUnsegmentedWrite(destBuf));
+    if (rv==0 || rv==GWEN_ERROR_EOF)
+      break;
+    else if (rv<0) {
+      DBG_INFO(0, "here (%d)", rv);
+      return rv;
+    }
+    GWEN_Buffer_IncrementPos(destBuf, rv);
+    GWEN_Buffer_AdjustUsedBytes(destBuf);
+  }
+
+  return 0;
+}
+
+
+
+int _contextFromTextData(GWEN_BUFFER *dataBuf, AB_IMEXPORTER_CONTEXT **pCtx)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_DB_NODE *dbCtx;
+  int rv;
+
   dbCtx=GWEN_DB_Group_new("context");
-  rv=GWEN_DB_ReadFromIo(dbCtx, sio,
-                        GWEN_DB_FLAGS_DEFAULT |
-                        GWEN_PATH_FLAGS_CREATE_GROUP);
+  rv=GWEN_DB_ReadFromString(dbCtx,
+                            GWEN_Buffer_GetStart(dataBuf),
+                            GWEN_Buffer_GetUsedBytes(dataBuf),
+                            GWEN_DB_FLAGS_DEFAULT |
+                            GWEN_PATH_FLAGS_CREATE_GROUP);
   if (rv<0) {
     DBG_ERROR(0, "Error reading context file (%d)", rv);
     GWEN_DB_Group_free(dbCtx);
-    GWEN_SyncIo_Disconnect(sio);
-    GWEN_SyncIo_free(sio);
     return rv;
   }
-  GWEN_SyncIo_Disconnect(sio);
-  GWEN_SyncIo_free(sio);
 
   ctx=AB_ImExporterContext_fromDb(dbCtx);
   if (!ctx) {
@@ -126,6 +351,12 @@ int writeContext(const char *ctxFile, const AB_IMEXPORTER_CONTEXT *ctx)
     }
   }
 
+  if (_binaryContextFiles) {
+    rv=_writeBinaryContext(sio, ctx);
+    GWEN_SyncIo_Disconnect(sio);
+    GWEN_SyncIo_free(sio);
+    return rv;
+  }
 
   dbCtx=GWEN_DB_Group_new("context");
   rv=AB_ImExporterContext_toDb(ctx, dbCtx);
@@ -153,6 +384,31 @@ int writeContext(const char *ctxFile, const AB_IMEXPORTER_CONTEXT *ctx)
 
 
 
+int _writeBinaryContext(GWEN_SYNCIO *sio, const AB_IMEXPORTER_CONTEXT *ctx)
+{
+  GWEN_BUFFER *dataBuf;
+  int rv;
+
+  dataBuf=GWEN_Buffer_new(0, 4096, 0, 1);
+  rv=AB_ImExporterContext_WriteBinary(ctx, dataBuf);
+  if (rv<0) {
+    DBG_ERROR(0, "Error writing binary context (%d)", rv);
+    GWEN_Buffer_free(dataBuf);
+    return rv;
+  }
+
+  rv=GWEN_SyncIo_WriteForced(sio, (const uint8_t *) GWEN_Buffer_GetStart(dataBuf), GWEN_Buffer_GetUsedBytes(dataBuf));
+  GWEN_Buffer_free(dataBuf);
+  if (rv<0) {
+    DBG_ERROR(0, "Error writing context (%d)", rv);
+    return rv;
+  }
+
+  return 0;
+}
+
+
+
 /* ========================================================================================================================
  *                                                mkSepaTransfer
  * ========================================================================================================================
@@ -833,6 +1089,19 @@ int addTransactionToContextFile(const AB_TRANSACTION *t, const char *ctxFile)
   int rv;
   AB_IMEXPORTER_CONTEXT *ctx=NULL;
 
+  if (ctxFile) {
+    rv=_checkBinaryContextFile(ctxFile);
+    if (rv==1 || (rv==GWEN_ERROR_NOT_FOUND && _binaryContextFiles)) {
+      /* binary files can be extended without reading them */
+      rv=_appendTransactionToBinaryContextFile(t, ctxFile);
+      if (rv<0) {
+        DBG_ERROR(0, "Error writing context file (%d)", rv);
+        return 4;
+      }
+      return 0;
+    }
+  }
+
   /* load ctx file */
   rv=readContext(ctxFile, &ctx, 0);
   if (rv<0) {
@@ -856,6 +1125,65 @@ int addTransactionToContextFile(const AB_TRANSACTION *t, const char *ctxFile)
 
 
 
+int _checkBinaryContextFile(const char *ctxFile)
+{
+  GWEN_SYNCIO *sio;
+  uint8_t header[AB_IMEXPORTER_CONTEXT_BIN_HEADER_SIZE];
+  int rv;
+
+  sio=GWEN_SyncIo_File_new(ctxFile, GWEN_SyncIo_File_CreationMode_OpenExisting);
+  GWEN_SyncIo_AddFlags(sio, GWEN_SYNCIO_FILE_FLAGS_READ);
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    GWEN_SyncIo_free(sio);
+    return GWEN_ERROR_NOT_FOUND;
+  }
+
+  rv=GWEN_SyncIo_ReadForced(sio, header, sizeof(header));
+  GWEN_SyncIo_Disconnect(sio);
+  GWEN_SyncIo_free(sio);
+  if (rv<(int) sizeof(header))
+    return 0;
+
+  return AB_ImExporterContext_IsBinary(header, sizeof(header));
+}
+
+
+
+int _appendTransactionToBinaryContextFile(const AB_TRANSACTION *t, const char *ctxFile)
+{
+  AB_IMEXPORTER_CONTEXT *ctx;
+  GWEN_SYNCIO *sio;
+  int rv;
+
+  sio=GWEN_SyncIo_File_new(ctxFile, GWEN_SyncIo_File_CreationMode_OpenAlways);
+  GWEN_SyncIo_AddFlags(sio,
+                       GWEN_SYNCIO_FILE_FLAGS_WRITE |
+                       GWEN_SYNCIO_FILE_FLAGS_APPEND |
+                       GWEN_SYNCIO_FILE_FLAGS_UREAD |
+                       GWEN_SYNCIO_FILE_FLAGS_UWRITE |
+                       GWEN_SYNCIO_FILE_FLAGS_GREAD |
+                       GWEN_SYNCIO_FILE_FLAGS_GWRITE);
+  rv=GWEN_SyncIo_Connect(sio);
+  if (rv<0) {
+    DBG_ERROR(0, "Error opening context file \"%s\" (%d)", ctxFile, rv);
+    GWEN_SyncIo_free(sio);
+    return rv;
+  }
+
+  ctx=AB_ImExporterContext_new();
+  AB_ImExporterContext_AddTransaction(ctx, AB_Transaction_dup(t));
+  rv=_writeBinaryContext(sio, ctx);
+  AB_ImExporterContext_free(ctx);
+  GWEN_SyncIo_Disconnect(sio);
+  GWEN_SyncIo_free(sio);
+
+  return rv;
+}
+
+
+
+
 /* ========================================================================================================================
  *                                                execBankingJobs
  * ========================================================================================================================
@@ -1099,129 +1427,303 @@ int createAndAddRequests(AB_BANKING *ab,
 
 int addTransactionToBufferByTemplate(const AB_TRANSACTION *t, const char *tmplString, GWEN_BUFFER *dbuf)
 {
-  GWEN_DB_NODE *dbTransaction;
-  const AB_VALUE *v;
-  const GWEN_DATE *dt;
-  const char *s;
+  AQBANKING_TOOL_TEMPLATE *tmpl;
   int rv;
 
-  dbTransaction=GWEN_DB_Group_new("transaction");
-  AB_Transaction_toDb(t, dbTransaction);
+  tmpl=compileTransactionTemplate(tmplString);
+  if (tmpl==NULL)
+    return GWEN_ERROR_BAD_DATA;
+  rv=addTransactionToBufferByCompiledTemplate(t, tmpl, dbuf);
+  freeTransactionTemplate(tmpl);
+  return rv;
+}
+
 
-  /* translate value */
-  v=AB_Transaction_GetValue(t);
-  if (v) {
-    AB_Value_toHumanReadableString(v, dbuf, 2, 0);
-    GWEN_DB_SetCharValue(dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "valueAsString", GWEN_Buffer_GetStart(dbuf));
-    GWEN_Buffer_Reset(dbuf);
-  }
 
-  /* translate date */
-  dt=AB_Transaction_GetDate(t);
-  if (dt) {
-    rv=GWEN_Date_toStringWithTemplate(dt, I18N("DD.MM.YYYY"), dbuf);
-    if (rv>=0) {
-      GWEN_DB_SetCharValue(dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "dateAsString", GWEN_Buffer_GetStart(dbuf));
+/* ========================================================================================================================
+ *                                            compileTransactionTemplate
+ * ========================================================================================================================
+ */
+
+AQBANKING_TOOL_TEMPLATE *compileTransactionTemplate(const char *tmplString)
+{
+  AQBANKING_TOOL_TEMPLATE *tmpl;
+  const char *p;
+
+  tmpl=(AQBANKING_TOOL_TEMPLATE *) calloc(1, sizeof(AQBANKING_TOOL_TEMPLATE));
+  assert(tmpl);
+  tmpl->dateTemplate=I18N("DD.MM.YYYY");
+
+  p=tmplString;
+  while (*p) {
+    const char *pStart;
+
+    /* literal text up to the next variable */
+    pStart=p;
+    while (*p && !(p[0]=='$' && p[1]=='('))
+      p++;
+    if (p>pStart)
+      _templateAddLiteral(tmpl, pStart, p-pStart);
+
+    if (*p) {
+      int rv;
+
+      p+=2;
+      pStart=p;
+      while (*p && *p!=')')
+        p++;
+      if (*p!=')') {
+        DBG_ERROR(0, "Unterminated variable name in template \"%s\"", tmplString);
+        freeTransactionTemplate(tmpl);
+        return NULL;
+      }
+      rv=_templateAddVariable(tmpl, pStart, p-pStart);
+      if (rv<0) {
+        DBG_ERROR(0, "Invalid variable in template \"%s\" (%d)", tmplString, rv);
+        freeTransactionTemplate(tmpl);
+        return NULL;
+      }
+      p++;
     }
-    GWEN_Buffer_Reset(dbuf);
   }
 
-  /* translate valuta date */
-  dt=AB_Transaction_GetValutaDate(t);
-  if (dt) {
-    rv=GWEN_Date_toStringWithTemplate(dt, I18N("DD.MM.YYYY"), dbuf);
-    if (rv>=0) {
-      GWEN_DB_SetCharValue(dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "valutaDateAsString", GWEN_Buffer_GetStart(dbuf));
-    }
-    GWEN_Buffer_Reset(dbuf);
+  return tmpl;
+}
+
+
+
+void freeTransactionTemplate(AQBANKING_TOOL_TEMPLATE *tmpl)
+{
+  if (tmpl) {
+    int i;
+
+    for (i=0; i<tmpl->partCount; i++)
+      free(tmpl->parts[i].text);
+    free(tmpl->parts);
+    free(tmpl);
   }
+}
 
-  /* translate date or valuta date */
-  dt=AB_Transaction_GetDate(t);
-  if (dt==NULL)
-    dt=AB_Transaction_GetValutaDate(t);
-  if (dt) {
-    rv=GWEN_Date_toStringWithTemplate(dt, I18N("DD.MM.YYYY"), dbuf);
-    if (rv>=0) {
-      GWEN_DB_SetCharValue(dbTransaction, GWEN_DB_FLAGS_OVERWRITE_VARS, "dateOrValutaDateAsString",
-                           GWEN_Buffer_GetStart(dbuf));
+
+
+/* ========================================================================================================================
+ *                                            addTransactionToBufferByCompiledTemplate
+ * ========================================================================================================================
+ */
+
+int addTransactionToBufferByCompiledTemplate(const AB_TRANSACTION *t, const AQBANKING_TOOL_TEMPLATE *tmpl, GWEN_BUFFER *dbuf)
+{
+  GWEN_DB_NODE *dbTransaction=NULL;
+  int i;
+
+  for (i=0; i<tmpl->partCount; i++) {
+    const AQBANKING_TOOL_TEMPLATE_PART *part;
+
+    part=&(tmpl->parts[i]);
+    if (part->field==AQBANKING_TOOL_TEMPLATE_FIELD_LITERAL)
+      GWEN_Buffer_AppendBytes(dbuf, part->text, part->textLen);
+    else if (part->getCharFn) {
+      const char *s;
+
+      s=part->getCharFn(t);
+      if (s && part->index==0)
+        GWEN_Buffer_AppendString(dbuf, s);
+    }
+    else if (part->field==AQBANKING_TOOL_TEMPLATE_FIELD_DB) {
+      /* any other member, only serialize the transaction if really needed */
+      if (dbTransaction==NULL) {
+        dbTransaction=GWEN_DB_Group_new("transaction");
+        AB_Transaction_toDb(t, dbTransaction);
+      }
+      GWEN_DB_WriteVarValueToBuffer(dbTransaction, part->text, part->index, dbuf);
     }
-    GWEN_Buffer_Reset(dbuf);
+    else
+      _templateWriteDerivedField(tmpl, part, t, dbuf);
   }
 
-  /* translate purpose into "purposeLine" entries */
-  s=AB_Transaction_GetPurpose(t);
-  if (s && *s) {
-    GWEN_STRINGLIST *stringList;
+  GWEN_DB_Group_free(dbTransaction);
+  return 0;
+}
 
-    GWEN_DB_DeleteVar(dbTransaction, "purposeLine");
-    stringList=GWEN_StringList_fromString(s, "\n", 0);
-    if (stringList) {
-      GWEN_STRINGLISTENTRY *sEntry;
 
-      sEntry=GWEN_StringList_FirstEntry(stringList);
-      while (sEntry) {
-        const char *entryString;
 
-        entryString=GWEN_StringListEntry_Data(sEntry);
-        if (entryString && *entryString) {
-          GWEN_DB_SetCharValue(dbTransaction, 0, "purposeLine", entryString);
-        }
+void _templateAddLiteral(AQBANKING_TOOL_TEMPLATE *tmpl, const char *s, int len)
+{
+  AQBANKING_TOOL_TEMPLATE_PART *part;
+
+  part=_templateNewPart(tmpl);
+  part->field=AQBANKING_TOOL_TEMPLATE_FIELD_LITERAL;
+  part->text=(char *) malloc(len+1);
+  assert(part->text);
+  memmove(part->text, s, len);
+  part->text[len]=0;
+  part->textLen=len;
+}
 
-        sEntry=GWEN_StringListEntry_Next(sEntry);
-      }
+
+
+/* variable names have the form "name" or "name[index]" */
+int _templateAddVariable(AQBANKING_TOOL_TEMPLATE *tmpl, const char *s, int len)
+{
+  AQBANKING_TOOL_TEMPLATE_PART *part;
+  char *name;
+  char *pIndex;
+  int index=0;
+  int i;
+
+  name=(char *) malloc(len+1);
+  assert(name);
+  memmove(name, s, len);
+  name[len]=0;
+  pIndex=strchr(name, '[');
+  if (pIndex) {
+    *(pIndex++)=0;
+    if (sscanf(pIndex, "%d]", &index)!=1 || index<0) {
+      free(name);
+      return GWEN_ERROR_BAD_DATA;
     }
   }
 
-  rv=GWEN_Text_ReplaceVars(tmplString, dbuf, _replaceVarsCb, dbTransaction);
-  if (rv<0) {
-    DBG_ERROR(0, "Error on GWEN_DB_ReplaceVars(): %d", rv);
-    GWEN_DB_Group_free(dbTransaction);
-    return rv;
+  part=_templateNewPart(tmpl);
+  part->text=name;
+  part->textLen=strlen(name);
+  part->index=index;
+
+  /* names are case-insensitive like variables of a GWEN_DB */
+  for (i=0; _templateCharFields[i].name; i++) {
+    if (strcasecmp(name, _templateCharFields[i].name)==0) {
+      part->field=AQBANKING_TOOL_TEMPLATE_FIELD_CHAR;
+      part->getCharFn=_templateCharFields[i].getCharFn;
+      return 0;
+    }
   }
-  GWEN_DB_Group_free(dbTransaction);
+  for (i=0; _templateDerivedFields[i].name; i++) {
+    if (strcasecmp(name, _templateDerivedFields[i].name)==0) {
+      part->field=_templateDerivedFields[i].field;
+      return 0;
+    }
+  }
+  part->field=AQBANKING_TOOL_TEMPLATE_FIELD_DB;
   return 0;
 }
 
 
 
-int GWENHYWFAR_CB _replaceVarsCb(void *cbPtr, const char *name, int index, int maxLen, GWEN_BUFFER *dstBuf)
+AQBANKING_TOOL_TEMPLATE_PART *_templateNewPart(AQBANKING_TOOL_TEMPLATE *tmpl)
 {
-  GWEN_DB_NODE *db;
+  AQBANKING_TOOL_TEMPLATE_PART *part;
+
+  tmpl->parts=(AQBANKING_TOOL_TEMPLATE_PART *) realloc(tmpl->parts,
+                                                        (tmpl->partCount+1)*sizeof(AQBANKING_TOOL_TEMPLATE_PART));
+  assert(tmpl->parts);
+  part=&(tmpl->parts[tmpl->partCount++]);
+  memset(part, 0, sizeof(AQBANKING_TOOL_TEMPLATE_PART));
+  return part;
+}
 
-  db=(GWEN_DB_NODE *) cbPtr;
-  if (strcasecmp(name, "purposeInOneLine")==0) {
-    const char *s;
 
-    s=GWEN_DB_GetCharValue(db, "purpose", 0, NULL);
-    if (!(s && *s))
-      return GWEN_ERROR_NO_DATA;
-    else {
-      char *sCopy;
 
-      sCopy=strdup(s);
-      assert(sCopy);
-      if (sCopy==NULL)
-        return GWEN_ERROR_MEMORY_FULL;
-      else {
-        char *p;
-
-        /* replace control characters */
-        p=sCopy;
-        while (*p) {
-          if (iscntrl(*p))
-            *p=' ';
-          p++;
-        } /* while */
-        GWEN_Buffer_AppendString(dstBuf, sCopy);
-        free(sCopy);
-        return 0;
+void _templateWriteDerivedField(const AQBANKING_TOOL_TEMPLATE *tmpl,
+                                const AQBANKING_TOOL_TEMPLATE_PART *part,
+                                const AB_TRANSACTION *t,
+                                GWEN_BUFFER *dbuf)
+{
+  const GWEN_DATE *dt=NULL;
+  const char *s=NULL;
+
+  if (part->index!=0 && part->field!=AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSELINE)
+    return;
+
+  switch (part->field) {
+  case AQBANKING_TOOL_TEMPLATE_FIELD_VALUE: {
+    const AB_VALUE *v;
+
+    v=AB_Transaction_GetValue(t);
+    if (v)
+      AB_Value_toHumanReadableString(v, dbuf, 2, 0);
+    return;
+  }
+
+  case AQBANKING_TOOL_TEMPLATE_FIELD_DATE:
+    dt=AB_Transaction_GetDate(t);
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_VALUTADATE:
+    dt=AB_Transaction_GetValutaDate(t);
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_DATEORVALUTADATE:
+    dt=AB_Transaction_GetDate(t);
+    if (dt==NULL)
+      dt=AB_Transaction_GetValutaDate(t);
+    break;
+
+  case AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSELINE:
+    _templateWritePurposeLine(AB_Transaction_GetPurpose(t), part->index, dbuf);
+    return;
+
+  case AQBANKING_TOOL_TEMPLATE_FIELD_PURPOSEINONELINE:
+    s=AB_Transaction_GetPurpose(t);
+    if (s) {
+      /* replace control characters */
+      while (*s) {
+        GWEN_Buffer_AppendByte(dbuf, iscntrl(*s)?' ':*s);
+        s++;
       }
     }
-  }
-  return GWEN_DB_WriteVarValueToBuffer(db, name, index, dstBuf);
+    return;
+
+  case AQBANKING_TOOL_TEMPLATE_FIELD_TYPE:
+    s=AB_Transaction_Type_toString(AB_Transaction_GetType(t));
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_SUBTYPE:
+    s=AB_Transaction_SubType_toString(AB_Transaction_GetSubType(t));
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_COMMAND:
+    s=AB_Transaction_Command_toString(AB_Transaction_GetCommand(t));
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_STATUS:
+    s=AB_Transaction_Status_toString(AB_Transaction_GetStatus(t));
+    break;
+  case AQBANKING_TOOL_TEMPLATE_FIELD_SEQUENCE:
+    s=AB_Transaction_Sequence_toString(AB_Transaction_GetSequence(t));
+    break;
+
+  default:
+    return;
+  }
+
+  if (dt)
+    GWEN_Date_toStringWithTemplate(dt, tmpl->dateTemplate, dbuf);
+  else if (s)
+    GWEN_Buffer_AppendString(dbuf, s);
 }
 
 
 
+/* writes the given non-empty line of the purpose */
+void _templateWritePurposeLine(const char *purpose, int index, GWEN_BUFFER *dbuf)
+{
+  const char *p;
+
+  if (purpose==NULL)
+    return;
+
+  p=purpose;
+  while (*p) {
+    const char *pEnd;
+
+    pEnd=strchr(p, '\n');
+    if (pEnd==NULL)
+      pEnd=p+strlen(p);
+    if (pEnd>p) {
+      if (index==0) {
+        GWEN_Buffer_AppendBytes(dbuf, p, pEnd-p);
+        return;
+      }
+      index--;
+    }
+    p=(*pEnd)?pEnd+1:pEnd;
+  }
+}
+
+
 
@@ -37,6 +37,16 @@
 #define FUZZY_SHIFT 10
 #define FUZZY_THRESHOLD 850
 
+/* binary index format and key comparison shared with the generic bankinfo plugin */
+#include "plugins/bankinfo/generic/generic_bidx_l.h"
+
+
+typedef struct {
+  char *key1;
+  char *key2;
+  uint32_t pos;
+} BIDX_ENTRY;
+
 
 static AB_BANKINFO_LIST *bis=0;
 static GWEN_DB_NODE *dbIdx=0;
@@ -1791,6 +1801,178 @@ int loadBanks(const char *fname, AB_BANKINFO_LIST *biList)
 
 
 
+int compareBinaryIndexEntries(const void *a, const void *b)
+{
+  const BIDX_ENTRY *e1;
+  const BIDX_ENTRY *e2;
+  int rv;
+
+  e1=(const BIDX_ENTRY *) a;
+  e2=(const BIDX_ENTRY *) b;
+  rv=AB_BankInfoGenericIndex_CompareKeys(e1->key1, e2->key1);
+  if (rv==0 && e1->key2 && e2->key2)
+    rv=AB_BankInfoGenericIndex_CompareKeys(e1->key2, e2->key2);
+  if (rv==0)
+    rv=(e1->pos<e2->pos)?-1:((e1->pos>e2->pos)?1:0);
+  return rv;
+}
+
+
+
+void freeBinaryIndexEntries(BIDX_ENTRY *entries, uint32_t entryCount)
+{
+  uint32_t i;
+
+  for (i=0; i<entryCount; i++) {
+    free(entries[i].key2);
+    free(entries[i].key1);
+  }
+  free(entries);
+}
+
+
+
+void writeBigEndian(FILE *f, uint32_t v, int len)
+{
+  while (len--)
+    fputc((v>>(len*8)) & 0xff, f);
+}
+
+
+
+/* create a sorted binary index from a text index file ("KEY1[\tKEY2]\tPOS" per line) */
+int makeBinaryIndex(const char *srcFile, const char *dstFile, int numKeys)
+{
+  FILE *f;
+  char lbuf[512];
+  BIDX_ENTRY *entries=NULL;
+  uint32_t entryCount=0;
+  uint32_t maxEntries=0;
+  uint32_t keySize1=1;
+  uint32_t keySize2=0;
+  uint32_t i;
+
+  f=fopen(srcFile, "r");
+  if (!f) {
+    DBG_ERROR(0, "Error opening file \"%s\"", srcFile);
+    return -1;
+  }
+
+  while (fgets(lbuf, sizeof(lbuf), f)) {
+    char *fields[3];
+    char *t;
+    int fieldCount=0;
+    unsigned int pos;
+    BIDX_ENTRY *e;
+
+    i=strlen(lbuf);
+    if (i && lbuf[i-1]==10)
+      lbuf[i-1]=0;
+    t=lbuf;
+    while (fieldCount<3) {
+      fields[fieldCount++]=t;
+      t=strchr(t, '\t');
+      if (t==NULL)
+        break;
+      *(t++)=0;
+    }
+    if (fieldCount!=numKeys+1 || 1!=sscanf(fields[numKeys], "%08x", &pos)) {
+      DBG_ERROR(0, "Invalid line in file \"%s\"", srcFile);
+      continue;
+    }
+
+    if (entryCount>=maxEntries) {
+      maxEntries+=1024;
+      entries=(BIDX_ENTRY *) realloc(entries, maxEntries*sizeof(BIDX_ENTRY));
+      assert(entries);
+    }
+    e=&(entries[entryCount++]);
+    e->key1=strdup(fields[0]);
+    e->key2=(numKeys>1)?strdup(fields[1]):NULL;
+    e->pos=pos;
+    if (strlen(e->key1)+1>keySize1)
+      keySize1=strlen(e->key1)+1;
+    if (e->key2 && strlen(e->key2)+1>keySize2)
+      keySize2=strlen(e->key2)+1;
+  }
+  fclose(f);
+
+  qsort(entries, entryCount, sizeof(BIDX_ENTRY), compareBinaryIndexEntries);
+
+  f=fopen(dstFile, "wb");
+  if (!f) {
+    DBG_ERROR(0, "Error creating file \"%s\"", dstFile);
+    freeBinaryIndexEntries(entries, entryCount);
+    return -1;
+  }
+
+  fwrite(AB_BANKINFO_GENERIC_BIDX_MAGIC, AB_BANKINFO_GENERIC_BIDX_MAGICSIZE, 1, f);
+  writeBigEndian(f, entryCount, 4);
+  writeBigEndian(f, keySize1, 2);
+  writeBigEndian(f, keySize2, 2);
+  for (i=0; i<entryCount; i++) {
+    BIDX_ENTRY *e;
+    uint32_t len;
+
+    e=&(entries[i]);
+    len=strlen(e->key1);
+    fwrite(e->key1, len, 1, f);
+    while (len++<keySize1)
+      fputc(0, f);
+    if (keySize2) {
+      len=strlen(e->key2);
+      fwrite(e->key2, len, 1, f);
+      while (len++<keySize2)
+        fputc(0, f);
+    }
+    writeBigEndian(f, e->pos, 4);
+  }
+  freeBinaryIndexEntries(entries, entryCount);
+
+  if (fclose(f)) {
+    DBG_ERROR(0, "Error closing file \"%s\"", dstFile);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+
+int makeBinaryIndexes(const char *path)
+{
+  static const char *indexNames[]= {"blz", "bic", "namloc"};
+  GWEN_BUFFER *srcBuf;
+  GWEN_BUFFER *dstBuf;
+  int i;
+
+  srcBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  dstBuf=GWEN_Buffer_new(0, 256, 0, 1);
+  for (i=0; i<3; i++) {
+    GWEN_Buffer_AppendString(srcBuf, path);
+    GWEN_Buffer_AppendByte(srcBuf, GWEN_DIR_SEPARATOR);
+    GWEN_Buffer_AppendString(srcBuf, indexNames[i]);
+    GWEN_Buffer_AppendBuffer(dstBuf, srcBuf);
+    GWEN_Buffer_AppendString(srcBuf, ".idx");
+    GWEN_Buffer_AppendString(dstBuf, ".bidx");
+
+    fprintf(stdout, "- writing binary index %s...\n", GWEN_Buffer_GetStart(dstBuf));
+    if (makeBinaryIndex(GWEN_Buffer_GetStart(srcBuf), GWEN_Buffer_GetStart(dstBuf), (i==2)?2:1)) {
+      GWEN_Buffer_free(dstBuf);
+      GWEN_Buffer_free(srcBuf);
+      return -1;
+    }
+    GWEN_Buffer_Reset(srcBuf);
+    GWEN_Buffer_Reset(dstBuf);
+  }
+  GWEN_Buffer_free(dstBuf);
+  GWEN_Buffer_free(srcBuf);
+
+  return 0;
+}
+
+
+
 int main(int argc, char **argv)
 {
   if (argc<2) {
@@ -1983,6 +2165,27 @@ int main(int argc, char **argv)
       return 3;
     }
     GWEN_Buffer_free(dbuf);
+
+    if (makeBinaryIndexes(path)) {
+      fprintf(stderr, "Error saving binary index files.\n");
+      return 3;
+    }
+  }
+  else if (strcasecmp(argv[1], "mkbidx")==0) {
+    const char *path;
+
+    if (argc<3) {
+      fprintf(stderr,
+              "Usage:\n"
+              "%s mkbidx DIR\n",
+              argv[0]);
+      return 1;
+    }
+    path=argv[2];
+    if (makeBinaryIndexes(path)) {
+      fprintf(stderr, "Error saving binary index files.\n");
+      return 3;
+    }
   }
   else if (strcasecmp(argv[1], "update")==0) {
     const char *srcFile1;